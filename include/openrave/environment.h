@@ -445,7 +445,10 @@ public:
     /// \return true if the kinbody was successfully removed from the environment.
     virtual bool RemoveKinBodyByName(const std::string& name) = 0;
 
-    /// \brief Query a body from its name. <b>[multi-thread safe]</b>
+    /// \brief Query a body from its name. <b>[multi-thread safe]</b> as long as no lazy body is created
+    ///
+    /// If no body matches and a lazy body of that name was registered with \ref AddLazyBody, the lazy body is created and added to the environment first.
+    /// Creating it locks the environment mutex, so in that case the call blocks while another thread holds the environment lock.
     /// \return first KinBody (including robots) that matches with name
     virtual KinBodyPtr GetKinBody(const std::string& name) const =0;
 
@@ -465,6 +468,31 @@ public:
     /// \throw openrave_exception with ORE_Timeout error code
     virtual void GetBodies(std::vector<KinBodyPtr>& bodies, uint64_t timeout=0) const = 0;
 
+    /// \brief Registers a body that is only created from its info when it is first needed. <b>[multi-thread safe]</b>
+    ///
+    /// Lazy bodies are not returned by \ref GetBodies and are not seen by collision checkers, physics engines or viewers until they are materialized,
+    /// either by querying them with \ref GetKinBody or by \ref MaterializeLazyBodies. The environment also materializes them when needed:
+    /// - the CheckCollision queries of a body, link or ray against the environment create the lazy bodies whose bounding box overlaps the query.
+    ///   Lazy bodies have no KinBody or links to pass to a collision checker, and queries that go to the collision checker directly (CollisionCheckerBase::CheckCollision,
+    ///   including the ones of planners and ik filters) do not create them. Call \ref MaterializeLazyBodies for the planning region first.
+    /// - setting a collision checker or physics engine and adding a viewer create all lazy bodies.
+    /// - saving or serializing the environment creates all lazy bodies, \ref ExtractInfo includes their infos without creating them.
+    ///
+    /// Only bodies without joints and grabbed bodies can be lazy.
+    /// The name has to be valid and unique among the bodies and lazy bodies of the environment. Adding a body with the same name to the environment discards the lazy body.
+    /// \param info the info of the body. it is held by the environment, so the caller should not modify it afterwards.
+    /// \throw openrave_exception with ORE_InvalidArguments if the body cannot be lazy or its name is not valid or unique
+    virtual void AddLazyBody(KinBody::KinBodyInfoConstPtr info) = 0;
+
+    /// \brief Fill an array with the names and world bounding boxes of the lazy bodies that were not materialized yet. <b>[multi-thread safe]</b>
+    virtual void GetLazyBodies(std::vector< std::pair<std::string, AABB> >& vLazyBodies) const = 0;
+
+    /// \brief Creates the lazy bodies whose world bounding box intersects ab and adds them to the environment.
+    ///
+    /// Call before planning in a region so that the collision checker sees all bodies around it.
+    /// \return the number of bodies added
+    virtual int MaterializeLazyBodies(const AABB& ab) = 0;
+
     /// \brief Fill an array with all robots loaded in the environment. <b>[multi-thread safe]</b>
     ///
     /// A separate **interface mutex** is locked for reading the bodies.
@@ -282,6 +282,16 @@ public:
      */
     virtual bool SolveAll(const IkParameterization& param, const std::vector<dReal>& vFreeParameters, int filteroptions, std::vector<IkReturnPtr>& ikreturns);
 
+    /** \brief Return all joint configurations for each of the given end effector poses.
+
+        Equivalent to calling \ref SolveAll for every element of params, except that solvers can amortize the state saving and collision setup across the poses. The default implementation calls SolveAll sequentially.
+        \param[in] params the poses the end effector has to achieve in the manipulator base's coordinate system.
+        \param[in] filteroptions A bitmask of \ref IkFilterOptions values controlling what is checked for each ik solution.
+        \param[out] vikreturns will be resized to params.size(), vikreturns[i] holds the solutions of params[i] in the same order SolveAll returns them.
+        \return the number of poses that have at least one solution
+     */
+    virtual int SolveAllBatch(const std::vector<IkParameterization>& params, int filteroptions, std::vector< std::vector<IkReturnPtr> >& vikreturns);
+
     /// \brief returns true if the solver supports a particular ik parameterization as input.
     virtual bool Supports(IkParameterizationType iktype) const OPENRAVE_DUMMY_IMPLEMENTATION;
 
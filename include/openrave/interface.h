@@ -43,6 +43,8 @@ enum SerializationOptions
 enum InfoSerializeOption
 {
     ISO_ReferenceUriHint = 1, ///< if set, will save the referenceURI as a hint rather than as a referenceUri
+    ISO_BinaryMesh = 2, ///< if set, will save the vertices and indices of trimeshes as base64 encoded binary blobs rather than as arrays of numbers
+    ISO_BinaryMeshRaw = 4, ///< used with ISO_BinaryMesh, will store the raw bytes of the blobs instead of base64. Only for msgpack output, which writes them as bin objects
 };
 
 enum InfoDeserializeOption
@@ -1960,6 +1960,7 @@ public:
         std::map<std::string, ReadablePtr> _mReadableInterfaces; ///< readable interface mapping
 
         bool _isRobot = false; ///< true if should create a RobotBasePtr
+        int _revision = 0; ///< revision of the info assigned by its producer. If non-zero, EnvironmentBase::UpdateFromInfo skips bodies that were last updated from an info with the same revision and have not changed since (\see KinBody::GetUpdateStamp), so producers have to change the revision whenever the info changes.
 protected:
         virtual void _DeserializeReadableInterface(const std::string& id, const rapidjson::Value& value);
 
@@ -2771,11 +2772,16 @@ private:
     ///
     /// The stamp is used by the collision checkers, physics engines, or any other item
     /// that needs to keep track of any changes of the KinBody as it moves.
-    /// Currently stamps monotonically increment for every transformation/joint angle change.
+    /// Currently stamps monotonically increment for every transformation/joint angle change and for every
+    /// change of the body parameters that is signaled through the KinBodyProperty callbacks, adjacency or readable interfaces.
     virtual int GetUpdateStamp() const {
         return _nUpdateStampId;
     }
 
+    virtual ReadablePtr SetReadableInterface(const std::string& id, ReadablePtr readable);
+    virtual void ClearReadableInterfaces();
+    virtual void ClearReadableInterface(const std::string& id);
+
     virtual void Clone(InterfaceBaseConstPtr preference, int cloningoptions);
 
     /// \brief Register a callback with the interface.
@@ -3076,6 +3082,8 @@ protected:
 
     std::string _id; ///< unique id of the KinBody
     std::string _referenceUri; ///< reference uri saved from InitFromInfo
+    int _infoRevision; ///< KinBodyInfo::_revision of the info the environment last updated the body from, 0 if unknown
+    int _infoRevisionUpdateStamp; ///< update stamp of the body right after it was updated from the info with _infoRevision
 
 private:
     mutable std::string __hashkinematics;
@@ -21,7 +21,9 @@
 #include <openrave/config.h>
 #include <openrave/openraveexception.h>
 
+#include <algorithm>
 #include <array>
+#include <cstring>
 #include <boost/shared_ptr.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/format.hpp>
@@ -450,12 +452,183 @@ inline void LoadJsonValue(const rapidjson::Value& v, OpenRAVE::RaveTransform<T>&
     }
 }
 
+/// \brief byte order of this machine as written in the "byteOrder" of binary blobs
+inline const char* GetNativeByteOrder()
+{
+    const uint16_t value = 1;
+    return *reinterpret_cast<const uint8_t*>(&value) == 1 ? "little" : "big";
+}
+
+/// \brief encodes size bytes of data to base64 with padding
+inline void EncodeBase64(const char* data, size_t size, std::string& out)
+{
+    static const char s_base64chars[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    out.resize(4*((size+2)/3));
+    size_t iout = 0;
+    size_t i = 0;
+    for(; i+2 < size; i += 3) {
+        uint32_t triple = (uint32_t(uint8_t(data[i])) << 16) | (uint32_t(uint8_t(data[i+1])) << 8) | uint32_t(uint8_t(data[i+2]));
+        out[iout++] = s_base64chars[(triple >> 18) & 0x3f];
+        out[iout++] = s_base64chars[(triple >> 12) & 0x3f];
+        out[iout++] = s_base64chars[(triple >> 6) & 0x3f];
+        out[iout++] = s_base64chars[triple & 0x3f];
+    }
+    if( i < size ) {
+        uint32_t triple = uint32_t(uint8_t(data[i])) << 16;
+        if( i+1 < size ) {
+            triple |= uint32_t(uint8_t(data[i+1])) << 8;
+        }
+        out[iout++] = s_base64chars[(triple >> 18) & 0x3f];
+        out[iout++] = s_base64chars[(triple >> 12) & 0x3f];
+        out[iout++] = i+1 < size ? s_base64chars[(triple >> 6) & 0x3f] : '=';
+        out[iout++] = '=';
+    }
+}
+
+/// \brief decodes base64 text with optional padding into out
+inline void DecodeBase64(const char* text, size_t size, std::vector<char>& out)
+{
+    struct DecodeTable
+    {
+        DecodeTable() {
+            std::fill(values, values+256, int8_t(-1));
+            const char* chars = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+            for(int i = 0; i < 64; ++i) {
+                values[uint8_t(chars[i])] = int8_t(i);
+            }
+        }
+        int8_t values[256];
+    };
+    static const DecodeTable s_table;
+
+    while( size > 0 && text[size-1] == '=' ) {
+        --size;
+    }
+    if( size % 4 == 1 ) {
+        throw OPENRAVE_EXCEPTION_FORMAT("invalid base64 length %d", size, OpenRAVE::ORE_InvalidArguments);
+    }
+    out.resize(size/4*3 + (size%4 > 0 ? size%4-1 : 0));
+    size_t iout = 0;
+    uint32_t accum = 0;
+    int nbits = 0;
+    for(size_t i = 0; i < size; ++i) {
+        int8_t value = s_table.values[uint8_t(text[i])];
+        if( value < 0 ) {
+            throw OPENRAVE_EXCEPTION_FORMAT("invalid base64 character at %d", i, OpenRAVE::ORE_InvalidArguments);
+        }
+        accum = (accum << 6) | uint32_t(value);
+        nbits += 6;
+        if( nbits >= 8 ) {
+            nbits -= 8;
+            out[iout++] = char((accum >> nbits) & 0xff);
+        }
+    }
+}
+
+/// \brief gets the bytes of a binary blob written by SaveJsonBinaryTriMesh in native byte order.
+///
+/// Raw blobs in native byte order point into the json string, otherwise the bytes are decoded into buffer.
+/// \param elementsize size of one element in bytes, used for swapping the byte order
+/// \param size set to the number of bytes
+inline const char* GetJsonBinaryBlobData(const rapidjson::Value& v, size_t elementsize, std::vector<char>& buffer, size_t& size)
+{
+    if (!v.IsObject() || !v.HasMember("data") || !v["data"].IsString() || !v.HasMember("encoding") || !v["encoding"].IsString()) {
+        throw OPENRAVE_EXCEPTION_FORMAT0("failed to deserialize json, binary blob needs \"data\" and \"encoding\"", OpenRAVE::ORE_InvalidArguments);
+    }
+    const rapidjson::Value& rData = v["data"];
+    const char* pdata = rData.GetString();
+    size = rData.GetStringLength();
+    const std::string encoding = v["encoding"].GetString();
+    if (encoding == "base64") {
+        DecodeBase64(pdata, size, buffer);
+        pdata = buffer.size() > 0 ? &buffer[0] : NULL;
+        size = buffer.size();
+    }
+    else if (encoding != "raw") {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to deserialize json, unsupported binary blob encoding \"%s\"", encoding, OpenRAVE::ORE_InvalidArguments);
+    }
+    if (size % elementsize != 0) {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to deserialize json, binary blob has %d bytes, which is not a multiple of %d", (size)%(elementsize), OpenRAVE::ORE_InvalidArguments);
+    }
+    if (v.HasMember("byteOrder") && v["byteOrder"].IsString() && strcmp(v["byteOrder"].GetString(), GetNativeByteOrder()) != 0 && elementsize > 1) {
+        if (encoding != "base64") {
+            buffer.assign(pdata, pdata+size);
+            pdata = buffer.size() > 0 ? &buffer[0] : NULL;
+        }
+        for(size_t i = 0; i < size; i += elementsize) {
+            std::reverse(buffer.begin()+i, buffer.begin()+i+elementsize);
+        }
+    }
+    return pdata;
+}
+
+template <typename T>
+inline void LoadJsonBinaryVertices(const char* pdata, size_t size, std::vector<OpenRAVE::Vector>& vertices)
+{
+    const size_t vertexsize = 3*sizeof(T);
+    if (size % vertexsize != 0) {
+        throw OPENRAVE_EXCEPTION_FORMAT0("failed to deserialize json, value cannot be decoded as a TriMesh, \"vertices\" malformatted", OpenRAVE::ORE_InvalidArguments);
+    }
+    vertices.resize(size/vertexsize);
+    T xyz[3];
+    for(size_t ivertex = 0; ivertex < vertices.size(); ++ivertex) {
+        memcpy(xyz, pdata+ivertex*vertexsize, vertexsize);
+        vertices[ivertex] = OpenRAVE::Vector(xyz[0], xyz[1], xyz[2]);
+    }
+}
+
+/// \brief loads a TriMesh whose vertices and indices are binary blobs, see SaveJsonBinaryTriMesh
+inline void LoadJsonBinaryTriMesh(const rapidjson::Value& v, OpenRAVE::TriMesh& t)
+{
+    std::vector<char> buffer;
+    size_t size = 0;
+    const rapidjson::Value& rVertices = v["vertices"];
+    const std::string vertexdtype = rVertices.HasMember("dtype") && rVertices["dtype"].IsString() ? rVertices["dtype"].GetString() : "";
+    if (vertexdtype == "float64") {
+        const char* pdata = GetJsonBinaryBlobData(rVertices, sizeof(double), buffer, size);
+        LoadJsonBinaryVertices<double>(pdata, size, t.vertices);
+    }
+    else if (vertexdtype == "float32") {
+        const char* pdata = GetJsonBinaryBlobData(rVertices, sizeof(float), buffer, size);
+        LoadJsonBinaryVertices<float>(pdata, size, t.vertices);
+    }
+    else {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to deserialize json, unsupported TriMesh vertices dtype \"%s\"", vertexdtype, OpenRAVE::ORE_InvalidArguments);
+    }
+
+    t.indices.clear();
+    if (v.HasMember("indices")) {
+        const rapidjson::Value& rIndices = v["indices"];
+        if (!rIndices.HasMember("dtype") || !rIndices["dtype"].IsString() || strcmp(rIndices["dtype"].GetString(), "int32") != 0) {
+            throw OPENRAVE_EXCEPTION_FORMAT0("failed to deserialize json, TriMesh indices need dtype int32", OpenRAVE::ORE_InvalidArguments);
+        }
+        const char* pdata = GetJsonBinaryBlobData(rIndices, sizeof(int32_t), buffer, size);
+        t.indices.resize(size/sizeof(int32_t));
+        if (size > 0) {
+            memcpy(&t.indices[0], pdata, size);
+        }
+        if (t.indices.size() % 3 != 0) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to deserialize json, TriMesh has %d indices, which is not a multiple of 3", t.indices.size(), OpenRAVE::ORE_InvalidArguments);
+        }
+        for(size_t iindex = 0; iindex < t.indices.size(); ++iindex) {
+            if (t.indices[iindex] < 0 || t.indices[iindex] >= (int)t.vertices.size()) {
+                throw OPENRAVE_EXCEPTION_FORMAT("failed to deserialize json, TriMesh index %d is %d, but there are only %d vertices", iindex%t.indices[iindex]%t.vertices.size(), OpenRAVE::ORE_InvalidArguments);
+            }
+        }
+    }
+}
+
 inline void LoadJsonValue(const rapidjson::Value& v, OpenRAVE::TriMesh& t)
 {
     if (!v.IsObject()) {
         throw OPENRAVE_EXCEPTION_FORMAT0("Cannot load value of non-object.", OpenRAVE::ORE_InvalidArguments);
     }
 
+    if (v.HasMember("vertices") && v["vertices"].IsObject()) {
+        LoadJsonBinaryTriMesh(v, t);
+        return;
+    }
+
     if (!v.HasMember("vertices") || !v["vertices"].IsArray() || v["vertices"].Size() % 3 != 0) {
         throw OPENRAVE_EXCEPTION_FORMAT0("failed to deserialize json, value cannot be decoded as a TriMesh, \"vertices\" malformatted", OpenRAVE::ORE_InvalidArguments);
     }
@@ -833,6 +1006,49 @@ inline void SaveJsonValue(rapidjson::Value &rTriMesh, const OpenRAVE::TriMesh& t
     SetJsonValueByKey(rTriMesh, "indices", t.indices, alloc);
 }
 
+/// \brief sets v to a binary blob object {"dtype", "byteOrder", "encoding", "data"} holding size bytes of native-endian elements
+///
+/// \param bRaw if true, "data" holds the raw bytes, otherwise their base64 encoding
+inline void SaveJsonBinaryBlob(rapidjson::Value& v, const char* dtype, const char* pdata, size_t size, bool bRaw, rapidjson::Document::AllocatorType& alloc)
+{
+    v.SetObject();
+    rapidjson::Value rDType(dtype, alloc);
+    v.AddMember("dtype", rDType, alloc);
+    v.AddMember("byteOrder", rapidjson::StringRef(GetNativeByteOrder()), alloc);
+    rapidjson::Value rData;
+    if (bRaw) {
+        v.AddMember("encoding", "raw", alloc);
+        rData.SetString(pdata != NULL ? pdata : "", (rapidjson::SizeType)size, alloc);
+    }
+    else {
+        v.AddMember("encoding", "base64", alloc);
+        std::string text;
+        EncodeBase64(pdata, size, text);
+        rData.SetString(text.c_str(), (rapidjson::SizeType)text.size(), alloc);
+    }
+    v.AddMember("data", rData, alloc);
+}
+
+/// \brief saves t with its vertices and indices as binary blobs instead of one json number per value. LoadJsonValue reads both formats.
+///
+/// \param fUnitScale multiply the vertices by fUnitScale
+/// \param bRaw if true, stores raw bytes in the blobs, which is only valid for msgpack output
+inline void SaveJsonBinaryTriMesh(rapidjson::Value& rTriMesh, const OpenRAVE::TriMesh& t, OpenRAVE::dReal fUnitScale, bool bRaw, rapidjson::Document::AllocatorType& alloc)
+{
+    rTriMesh.SetObject();
+    std::vector<OpenRAVE::dReal> vertices(3*t.vertices.size());
+    for(size_t ivertex = 0; ivertex < t.vertices.size(); ++ivertex) {
+        vertices[3*ivertex] = t.vertices[ivertex].x*fUnitScale;
+        vertices[3*ivertex+1] = t.vertices[ivertex].y*fUnitScale;
+        vertices[3*ivertex+2] = t.vertices[ivertex].z*fUnitScale;
+    }
+    rapidjson::Value rVertices, rIndices;
+    SaveJsonBinaryBlob(rVertices, sizeof(OpenRAVE::dReal) == sizeof(double) ? "float64" : "float32", vertices.size() > 0 ? reinterpret_cast<const char*>(&vertices[0]) : NULL, vertices.size()*sizeof(OpenRAVE::dReal), bRaw, alloc);
+    SaveJsonBinaryBlob(rIndices, "int32", t.indices.size() > 0 ? reinterpret_cast<const char*>(&t.indices[0]) : NULL, t.indices.size()*sizeof(int32_t), bRaw, alloc);
+    rTriMesh.AddMember("vertices", rVertices, alloc);
+    rTriMesh.AddMember("indices", rIndices, alloc);
+}
+
 template<class T, class U>
 inline void SetJsonValueByKey(rapidjson::Value& v, const U& key, const T& t, rapidjson::Document::AllocatorType& alloc)
 {
@@ -33,8 +33,10 @@ namespace MsgPack {
 OPENRAVE_API void DumpMsgPack(const rapidjson::Value& value, std::ostream& os);
 OPENRAVE_API void DumpMsgPack(const rapidjson::Value& value, std::vector<char>& output);
 
+/// \brief parses msgpack data directly into d without an intermediate msgpack object tree.
 OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, const std::string& str);
 OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, std::istream& is);
+OPENRAVE_API void ParseMsgPack(rapidjson::Document& d, const char* data, size_t size);
 
 } // namespace MsgPack
 
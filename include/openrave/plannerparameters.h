@@ -548,7 +548,7 @@ typedef boost::shared_ptr<TrajectoryTimingParameters const> TrajectoryTimingPara
 class OPENRAVE_API ConstraintTrajectoryTimingParameters : public TrajectoryTimingParameters
 {
 public:
-    ConstraintTrajectoryTimingParameters() : TrajectoryTimingParameters(), maxlinkspeed(0), maxlinkaccel(0), maxmanipspeed(0), maxmanipaccel(0), vConstraintManipDir(0,0,1), vConstraintGlobalDir(0,0,1), fCosManipAngleThresh(-1), mingripperdistance(0), velocitydistancethresh(0), maxmergeiterations(1000), minswitchtime(0.2),nshortcutcycles(1), fSearchVelAccelMult(0.8), durationImprovementCutoffRatio(0.001), _bCProcessing(false) {
+    ConstraintTrajectoryTimingParameters() : TrajectoryTimingParameters(), maxlinkspeed(0), maxlinkaccel(0), maxmanipspeed(0), maxmanipaccel(0), vConstraintManipDir(0,0,1), vConstraintGlobalDir(0,0,1), fCosManipAngleThresh(-1), mingripperdistance(0), velocitydistancethresh(0), maxmergeiterations(1000), minswitchtime(0.2),nshortcutcycles(1), fSearchVelAccelMult(0.8), durationImprovementCutoffRatio(0.001), nshortcutworkers(0), nshortcutcandidates(8), _bCProcessing(false) {
         _vXMLParameters.push_back("maxlinkspeed");
         _vXMLParameters.push_back("maxlinkaccel");
         _vXMLParameters.push_back("manipname");
@@ -564,6 +564,8 @@ public:
         _vXMLParameters.push_back("nshortcutcycles");
         _vXMLParameters.push_back("searchvelaccelmult");
         _vXMLParameters.push_back("durationimprovementcutoffratio");
+        _vXMLParameters.push_back("nshortcutworkers");
+        _vXMLParameters.push_back("nshortcutcandidates");
     }
 
     dReal maxlinkspeed; ///< max speed in m/s that any point on any link goes. 0 means no speed limit
@@ -588,6 +590,9 @@ public:
     dReal fSearchVelAccelMult; ///< a number in [0.0001,0.99999] that is the multipler of the velocity/acceleration limits when time-based constraints are invalidated (manip speed and/or dynamics). The closer to 1 it is, the more optimal the trajectory will be, but it will take more time to compute. A value around 0.5-0.8 is best.
     dReal durationImprovementCutoffRatio; ///< Whenever shortcut is accepted, if change is less than diff/iterations, then do not do anymore shortcutting.
 
+    int nshortcutworkers; ///< if > 0, the smoother checks shortcut candidates and the unchecked segments of the final path concurrently on this many worker environments. 0 means everything is checked one at a time.
+    int nshortcutcandidates; ///< when nshortcutworkers > 0, the number of shortcut candidates sampled and checked together before the best one is applied. The result only depends on this and the random seed, not on nshortcutworkers.
+
 protected:
     bool _bCProcessing;
     virtual bool serialize(std::ostream& O, int options=0) const
@@ -610,6 +615,8 @@ protected:
         O << "<nshortcutcycles>" << nshortcutcycles << "</nshortcutcycles>" << std::endl;
         O << "<searchvelaccelmult>" << fSearchVelAccelMult << "</searchvelaccelmult>" << std::endl;
         O << "<durationimprovementcutoffratio>" << durationImprovementCutoffRatio << "</durationimprovementcutoffratio>" << std::endl;
+        O << "<nshortcutworkers>" << nshortcutworkers << "</nshortcutworkers>" << std::endl;
+        O << "<nshortcutcandidates>" << nshortcutcandidates << "</nshortcutcandidates>" << std::endl;
         if( !(options & 1) ) {
             O << _sExtraParameters << std::endl;
         }
@@ -627,7 +634,7 @@ protected:
         case PE_Support: return PE_Support;
         case PE_Ignore: return PE_Ignore;
         }
-        _bCProcessing = name=="maxlinkspeed" || name =="maxlinkaccel" || name=="manipname" || name=="maxmanipspeed" || name =="maxmanipaccel" || name=="mingripperdistance" || name=="velocitydistancethresh" || name=="maxmergeiterations" || name=="minswitchtime"|| name=="nshortcutcycles" || name=="constraintmanipdir" || name=="constraintglobaldir" || name=="cosmanipanglethresh" || name=="searchvelaccelmult" || name=="durationimprovementcutoffratio";
+        _bCProcessing = name=="maxlinkspeed" || name =="maxlinkaccel" || name=="manipname" || name=="maxmanipspeed" || name =="maxmanipaccel" || name=="mingripperdistance" || name=="velocitydistancethresh" || name=="maxmergeiterations" || name=="minswitchtime"|| name=="nshortcutcycles" || name=="constraintmanipdir" || name=="constraintglobaldir" || name=="cosmanipanglethresh" || name=="searchvelaccelmult" || name=="durationimprovementcutoffratio" || name=="nshortcutworkers" || name=="nshortcutcandidates";
         return _bCProcessing ? PE_Support : PE_Pass;
     }
 
@@ -670,6 +677,12 @@ protected:
             else if( name == "durationimprovementcutoffratio" ) {
                 _ss >> durationImprovementCutoffRatio;
             }
+            else if( name == "nshortcutworkers" ) {
+                _ss >> nshortcutworkers;
+            }
+            else if( name == "nshortcutcandidates" ) {
+                _ss >> nshortcutcandidates;
+            }
             else if( name == "constraintmanipdir" ) {
                 _ss >> vConstraintManipDir;
             }
@@ -709,6 +722,8 @@ public:
     dReal ignorefirstcollisionee;     ///< if > 0, will allow the manipulator end effector to be in environment collision for the initial 'ignorefirstcollisionee' seconds of the trajectory. similar to 'ignorefirstcollision'
     dReal ignorelastcollisionee; /// if > 0, will allow the manipulator end effector to get into collision with the environment for the last 'ignorelastcollisionee' seconds of the trajrectory. The kinematics, self collisions, and environment collisions with the other parts of the robot will still be checked
     dReal minimumcompletetime;     ///< specifies the minimum trajectory that must be followed for planner to declare success. If 0, then the entire trajectory has to be followed.
+    bool highratetracking;     ///< if true, will track the workspace trajectory with a warm-started jacobian solver and only fall back to the ik solver when it does not converge. Meant for finely sampled paths like straight-line approach and retreat motions.
+    int highratecheckinterval;     ///< when highratetracking is set, environment collisions are checked every 'highratecheckinterval' steps, bisecting down to the first colliding step when a check fails.
     TrajectoryBasePtr workspacetraj;     ///< workspace trajectory
 
 protected:
@@ -29,6 +29,9 @@ namespace OpenRAVE {
 
 namespace planningutils {
 
+class PlannerParametersWorkerPool;
+typedef boost::shared_ptr<PlannerParametersWorkerPool> PlannerParametersWorkerPoolPtr;
+
 /// \brief Jitters the active joint angles of the robot until it escapes collision.
 ///
 /// \return 0 if jitter failed and robot is in collision, -1 if robot originally not in collision, 1 if jitter succeeded and position is different.
@@ -58,6 +61,15 @@ OPENRAVE_API int JitterCurrentConfiguration(PlannerBase::PlannerParametersConstP
  */
 OPENRAVE_API void VerifyTrajectory(PlannerBase::PlannerParametersConstPtr parameters, TrajectoryBaseConstPtr trajectory, dReal samplingstep=0.002);
 
+/** \brief validates a trajectory like \ref VerifyTrajectory, except that the sampled segments are checked concurrently on the worker contexts of a \ref PlannerParametersWorkerPool.
+
+    The waypoints and sampled configurations are computed on the calling thread, the segments are then split into chunks that are dispatched to the workers. Once a segment fails, chunks that come after it are cancelled. The thrown exception is always the one of the earliest failing segment, so the outcome is the same as the sequential version.
+    \param pool the worker contexts to check on. If not initialized, will use a pool that is kept for the trajectory environment across calls. The pool is synchronized with the current environment state and set to parameters before checking. The kept pools do not keep their environment alive.
+    \param nsegmentsperchunk the number of consecutive sampled segments each worker checks before picking a new chunk
+    \throw openrave_exception If the trajectory is invalid, will throw ORE_InconsistentConstraints.
+ */
+OPENRAVE_API void VerifyTrajectoryParallel(PlannerBase::PlannerParametersConstPtr parameters, TrajectoryBaseConstPtr trajectory, PlannerParametersWorkerPoolPtr pool, dReal samplingstep=0.002, int nsegmentsperchunk=16);
+
 /** \brief Extends the last ramp of the trajectory in order to reach a goal. THe configuration space matches the positional data of the trajectory.
 
     Useful when appending jittered points to the trajectory.
@@ -270,6 +282,69 @@ typedef boost::shared_ptr<AffineTrajectoryRetimer> AffineTrajectoryRetimerPtr;
  */
 OPENRAVE_API PlannerStatus RetimeTrajectory(TrajectoryBasePtr traj, bool hastimestamps=false, dReal fmaxvelmult=1, dReal fmaxaccelmult=1, const std::string& plannername="", const std::string& plannerparameters="");
 
+/** \brief Retimes a batch of trajectories concurrently, reusing one initialized retimer per thread and configuration specification.
+
+    Equivalent to calling \ref RetimeTrajectory on every trajectory, except that the retiming planners are kept across calls so that repeated batches (several robots, or the segments of one long motion) do not pay for planner creation and InitPlan each time. Trajectory i is always retimed by thread i%nthreads, so the results are deterministic and independent of scheduling. Collision is not checked.
+
+    Every thread owns a cloned environment of a \ref PlannerParametersWorkerPool and retimes a copy of the trajectory inside it, so the retimers never touch the source environment while it is unlocked. The clones are synchronized at the start of every \ref PlanPaths call, and the cached retimers are dropped whenever the clones had to be recreated (bodies were added, removed or changed other than by moving) so that new limits are always used. At most \ref GetMaxRetimersPerThread retimers are kept per thread, the least recently used one is released first.
+ */
+class OPENRAVE_API TrajectoryRetimerBatch
+{
+public:
+    /// \param plannername the name of the planner to use to retime. If empty, will use the default trajectory re-timer from the interpolation of each trajectory.
+    /// \param plannerparameters XML string to be appended to PlannerBase::PlannerParameters::_sExtraParameters passed in to the planner.
+    /// \param nthreads the number of threads to retime with. If <= 0, will use the hardware concurrency.
+    TrajectoryRetimerBatch(const std::string& plannername="", const std::string& plannerparameters="", int nthreads=0);
+    virtual ~TrajectoryRetimerBatch();
+
+    /// \brief Retimes all trajectories. <b>[multi-thread safe]</b>
+    ///
+    /// All trajectories have to belong to the same environment. The environment is locked only while the worker environments are synchronized and the retimers are being initialized.
+    /// \param vtrajs the trajectories that initially contain the input points, each one is modified to contain the new re-timed data.
+    /// \param vstatuses filled with the status of each trajectory in the same order as vtrajs. Errors are reported as PS_Failed without interrupting the other trajectories.
+    virtual void PlanPaths(const std::vector<TrajectoryBasePtr>& vtrajs, std::vector<PlannerStatus>& vstatuses, bool hastimestamps=false, dReal fmaxvelmult=1, dReal fmaxaccelmult=1);
+
+    /// \brief releases all cached retimers and worker environments
+    virtual void Reset();
+
+    virtual int GetNumThreads() const {
+        return _nthreads;
+    }
+
+    /// \brief the maximum number of retimers cached per thread
+    static size_t GetMaxRetimersPerThread();
+
+protected:
+    /// \brief an initialized retimer for one configuration specification
+    struct CachedRetimer
+    {
+        ConfigurationSpecification spec; ///< time derivative 0 of the trajectory specification
+        std::string plannername;
+        PlannerBasePtr planner;
+        TrajectoryTimingParametersPtr parameters;
+        std::vector<dReal> vmaxvelocities, vmaxaccelerations; ///< unscaled limits
+        bool hastimestamps;
+        dReal fmaxvelmult, fmaxaccelmult;
+    };
+    typedef boost::shared_ptr<CachedRetimer> CachedRetimerPtr;
+
+    /// \brief creates or synchronizes the worker environments with penv, dropping the cached retimers if the workers were cloned. Environment has to be locked.
+    virtual void _SynchronizeWorkers(EnvironmentBasePtr penv);
+
+    /// \brief returns the retimer of thread ithread for traj, creating it in the worker environment or calling InitPlan if necessary. Environment has to be locked.
+    virtual CachedRetimerPtr _GetRetimer(int ithread, TrajectoryBasePtr traj, bool hastimestamps, dReal fmaxvelmult, dReal fmaxaccelmult);
+
+    virtual void _RetimeThread(int ithread, int nthreads, const std::vector<TrajectoryBasePtr>& vtrajs, const std::vector<CachedRetimerPtr>& vretimers, std::vector<PlannerStatus>& vstatuses);
+
+    std::string _plannername, _extraparameters;
+    int _nthreads;
+    PlannerParametersWorkerPoolPtr _pool; ///< one cloned environment per thread
+    std::vector< std::vector<CachedRetimerPtr> > _vthreadretimers; ///< for every thread, the retimers initialized so far ordered from least to most recently used
+    boost::mutex _mutex; ///< protects _pool and _vthreadretimers across PlanPaths calls
+};
+
+typedef boost::shared_ptr<TrajectoryRetimerBatch> TrajectoryRetimerBatchPtr;
+
 /** \brief Inserts a waypoint into a trajectory at the index specified, and retimes the segment before and after the trajectory. This will \b not change the previous trajectory. <b>[multi-thread safe]</b>
 
     Collision is not checked on the modified segments of the trajectory.
@@ -475,6 +550,114 @@ protected:
 
 typedef boost::shared_ptr<DynamicsCollisionConstraint> DynamicsCollisionConstraintPtr;
 
+/** \brief Keeps a set of worker contexts, each with its own cloned environment and planner parameters rebound to it, so that independent constraint checks can run concurrently.
+
+    The worker parameters are copied from the source parameters and their state functions are rebuilt with \ref PlannerBase::PlannerParameters::SetConfigurationSpecification on the cloned environment. The configuration limits of the source parameters are kept. Custom callbacks that reference the source environment cannot be transferred, so the pool should only be used with parameters that were setup through \ref PlannerBase::PlannerParameters::SetRobotActiveJoints or \ref PlannerBase::PlannerParameters::SetConfigurationSpecification.
+
+    All functions should be called with the source environment locked. The pool does not keep the source environment alive.
+ */
+class OPENRAVE_API PlannerParametersWorkerPool
+{
+public:
+    /// \brief function called for every chunk. First argument is the worker index, second is the chunk index. Non-zero return means the chunk failed.
+    typedef boost::function<int(int, int)> ChunkFn;
+
+    /**
+       \param penv the source environment that parameters is bound to
+       \param parameters the source parameters. Can be empty if only the worker environments are needed, in which case \ref CheckPathAllConstraints cannot be used.
+       \param nworkers number of worker contexts to create. If 0, will use the number of hardware threads.
+       \param cloningoptions options passed to \ref EnvironmentBase::CloneSelf
+       \throw openrave_exception if the parameters cannot be rebuilt from their configuration specification
+     */
+    PlannerParametersWorkerPool(EnvironmentBasePtr penv, PlannerBase::PlannerParametersConstPtr parameters, int nworkers=0, int cloningoptions=Clone_Bodies);
+    virtual ~PlannerParametersWorkerPool();
+
+    /** \brief copies the current body states of the source environment into all the worker environments.
+
+        The worker environments are only cloned again when bodies were added to or removed from the source environment, or when a body changed in any other way than moving (geometry, joints, enabled links, grabbed bodies, ...) since the last synchronization. Otherwise only the link transformations and dof values of the bodies that moved are copied, so it is cheap to call before every use of the pool.
+        \param bforce if true, always clone the source environment
+        \return true if the worker environments were cloned, in which case any bodies or interfaces taken from them before are invalid
+     */
+    virtual bool Synchronize(bool bforce=false);
+
+    /** \brief rebinds the worker parameters to new source parameters without cloning the worker environments.
+
+        \param parameters the new source parameters, can be empty
+        \throw openrave_exception if the parameters cannot be rebuilt from their configuration specification
+     */
+    virtual void SetParameters(PlannerBase::PlannerParametersConstPtr parameters);
+
+    /** \brief calls fn for every chunk in [0, nchunks) on the worker threads and waits for all of them to finish.
+
+        Chunks are dispatched in increasing order. Once a chunk fails, chunks with a larger index are not dispatched anymore and \ref IsCancelled returns true for them, chunks with a smaller index are still finished. Exceptions thrown by fn count as failures.
+        Concurrent calls are serialized since they share the worker contexts. fn must not call Evaluate or \ref CheckPathAllConstraints of the same pool.
+        \return the smallest failed chunk index or -1 if all chunks succeeded. If the smallest failed chunk threw an exception, it is rethrown instead.
+     */
+    virtual int Evaluate(int nchunks, const ChunkFn& fn);
+
+    /** \brief checks consecutive segments (q_i, q_{i+1}) of a path with CheckPathAllConstraints on the workers.
+
+        \param vwaypoints N*dof positions
+        \param vvelocities N*dof velocities, can be empty
+        \param vdeltatimes N-1 elapsed times for each segment, can be empty
+        \param ifailedsegment set to the index of the first failing segment or -1
+        \return the return code of the first failing segment or 0, same as when calling CheckPathAllConstraints sequentially on every segment
+     */
+    virtual int CheckPathAllConstraints(const std::vector<dReal>& vwaypoints, const std::vector<dReal>& vvelocities, const std::vector<dReal>& vdeltatimes, IntervalType interval, int options, int nsegmentsperchunk, int& ifailedsegment);
+
+    /// \brief returns true if a chunk with a smaller index than ichunk already failed during the current \ref Evaluate call
+    bool IsCancelled(int ichunk) const;
+
+    inline int GetNumWorkers() const {
+        return (int)_vworkers.size();
+    }
+    inline EnvironmentBasePtr GetWorkerEnv(int iworker) const {
+        return _vworkers.at(iworker).penv;
+    }
+    inline PlannerBase::PlannerParametersConstPtr GetWorkerParameters(int iworker) const {
+        return _vworkers.at(iworker).parameters;
+    }
+    inline PlannerBase::PlannerParametersConstPtr GetParameters() const {
+        return _parameters;
+    }
+    /// \brief returns the source environment, empty if it was already destroyed
+    inline EnvironmentBasePtr GetEnv() const {
+        return _penv.lock();
+    }
+
+protected:
+    struct WorkerContext
+    {
+        EnvironmentBasePtr penv;
+        PlannerBase::PlannerParametersPtr parameters;
+    };
+
+    virtual void _WorkerThread(int iworker, int nchunks, const ChunkFn& fn);
+
+    /// \brief remembers the bodies of the source environment after cloning it and registers for their changes other than motions
+    virtual void _ResetSourceBodies(const std::vector<KinBodyPtr>& vbodies);
+
+    /// \brief called when a source body changed in any other way than moving
+    virtual void _OnSourceBodyChanged();
+
+    EnvironmentBaseWeakPtr _penv;
+    PlannerBase::PlannerParametersConstPtr _parameters;
+    int _cloningoptions;
+    std::vector<WorkerContext> _vworkers;
+    std::vector<int> _vsourcebodyids; ///< environment ids of the source bodies at the last cloning
+    std::vector<int> _vsourcebodystamps; ///< update stamps of the source bodies at the last synchronization, a different stamp means the body moved
+    std::vector<UserDataPtr> _vsourcebodycallbacks; ///< change callbacks registered on the source bodies
+    int _nSourceStructureStamp; ///< incremented by _OnSourceBodyChanged
+    int _nClonedStructureStamp; ///< _nSourceStructureStamp at the last cloning
+
+    boost::mutex _mutexEvaluate; ///< serializes Evaluate calls
+
+    mutable boost::mutex _mutex; ///< protects all the dispatch state below
+    int _nNextChunk; ///< next chunk to be dispatched
+    int _nFirstFailedChunk; ///< smallest failed chunk, or nchunks if nothing failed
+    std::exception_ptr _firstexception; ///< exception of _nFirstFailedChunk if any
+};
+
 /// \deprecated (13/05/29)
 class OPENRAVE_API LineCollisionConstraint
 {
@@ -600,6 +783,22 @@ public:
     /// \param maxdist If > 0, allows jittering of the goal IK if they cause the robot to be in collision and no IK solutions to be found
     virtual void SetJitter(dReal maxdist);
 
+    /** \brief evaluates several goal candidates concurrently on the worker environments of a pool.
+
+        Candidates are drawn in the same order as the serial sampler, so free parameters closest to the middle of their range are tried first, and solutions are returned in that order. Custom ik filters registered on the source ik solver are not run on the workers.
+        The pool is synchronized with the source environment here, so call this again before sampling if the scene changed.
+        \param pool worker environments that have the robot of the manipulator, usually created with empty parameters. If empty, goals are sampled serially.
+        \param numcandidates number of candidates evaluated in one batch. If 0, uses the number of workers.
+     */
+    virtual void SetParallel(PlannerParametersWorkerPoolPtr pool, int numcandidates=0);
+
+    /// \brief sets the time (as returned by utils::GetMonotonicTime) after which no more candidates are evaluated. If 0, there is no deadline.
+    virtual void SetDeadline(uint64_t deadline);
+
+    inline RobotBase::ManipulatorConstPtr GetManipulator() const {
+        return _pmanip;
+    }
+
 protected:
     struct SampleInfo
     {
@@ -610,6 +809,33 @@ protected:
         int _numleft;
         int _orgindex;
     };
+
+    /// \brief ik parameterization and free values that FindIKSolutions is called with
+    struct Candidate
+    {
+        Candidate() : _ikfilteroptions(0), _orgindex(-1), _status(0) {
+        }
+        IkParameterization _ikparam;
+        std::vector<dReal> _vfree;
+        int _ikfilteroptions;
+        int _orgindex;
+        int _status; ///< 0 if not evaluated yet, 1 if no solutions were found, 2 if _vikreturns has solutions
+        std::vector<IkReturnPtr> _vikreturns;
+    };
+
+    /// \brief picks the next candidate from _listsamples, pruning parameterizations whose end effector is in collision
+    ///
+    /// \return 1 if candidate was filled, 0 if the try did not produce a candidate, -1 if there are no samples left
+    virtual int _PopCandidate(Candidate& candidate, IkReturnPtr& ikreturnjittered);
+
+    /// \brief sets _vikreturns from a successful candidate and returns the first solution
+    virtual IkReturnPtr _ReturnCandidate(Candidate& candidate);
+
+    virtual IkReturnPtr _SampleParallel();
+
+    /// \brief called by the worker pool, returns non-zero if the candidate has solutions so that later candidates are not evaluated
+    virtual int _EvaluateCandidate(int iworker, int icandidate);
+
     RobotBasePtr _probot;
     RobotBase::ManipulatorConstPtr _pmanip;
     int _nummaxsamples, _nummaxtries;
@@ -625,6 +851,12 @@ protected:
     int _ikfilteroptions;
     bool _searchfreeparameters;
     std::vector<dReal> _vfreegoalvalues;
+
+    PlannerParametersWorkerPoolPtr _pool;
+    int _numparallelcandidates;
+    uint64_t _deadline;
+    std::list<Candidate> _listpendingcandidates; ///< candidates in sampling order that were either not evaluated yet or evaluated in a batch ahead of being returned
+    std::vector<Candidate> _vbatchcandidates;
 };
 
 typedef boost::shared_ptr<ManipulatorIKGoalSampler> ManipulatorIKGoalSamplerPtr;
@@ -310,6 +310,14 @@ public:
         virtual bool FindIKSolutions(const IkParameterization& param, int filteroptions, std::vector<IkReturnPtr>& vikreturns) const;
         virtual bool FindIKSolutions(const IkParameterization& param, const std::vector<dReal>& vFreeParameters, int filteroptions, std::vector<IkReturnPtr>& vikreturns) const;
 
+        /// \brief Find all the IK solutions for each of the given end effector poses in one call.
+        ///
+        /// \param params The transformations of the end-effector in the global coord system
+        /// \param[in] filteroptions A bitmask of \ref IkFilterOptions values controlling what is checked for each ik solution.
+        /// \param vikreturns vikreturns[i] holds the solutions of params[i]
+        /// \return the number of poses that have at least one solution
+        virtual int FindIKSolutionsBatch(const std::vector<IkParameterization>& params, int filteroptions, std::vector< std::vector<IkReturnPtr> >& vikreturns) const;
+
         /** \brief returns the parameterization of a given IK type for the current manipulator position.
 
             Ideally pluging the returned ik parameterization into FindIkSolution should return the a manipulator configuration
@@ -289,6 +289,18 @@ OPENRAVE_API std::string GetMD5HashString(const std::string& s);
 /// \brief compute the md5 hash of an array
 OPENRAVE_API std::string GetMD5HashString(const std::vector<uint8_t>& v);
 
+/// \brief returns nthreads if it is positive, otherwise the number of hardware threads
+OPENRAVE_API int GetNumParallelThreads(int nthreads);
+
+/// \brief calls fn(index) for every index in [0, count) from several threads and returns when all calls are done. <b>[multi-thread safe]</b>
+///
+/// The indices are handed out in increasing order to the calling thread and to the threads of a process-wide pool. The pool threads are created
+/// on first use and kept for later calls. Since the calling thread also runs indices, calls from inside fn or from several threads at once
+/// cannot deadlock even when all pool threads are busy.
+/// If fn throws, no more indices are started and the first exception is rethrown once the running calls return.
+/// \param nthreads maximum number of threads calling fn at the same time including the calling thread, see \ref GetNumParallelThreads
+OPENRAVE_API void ParallelFor(size_t count, const boost::function<void(size_t)>& fn, int nthreads=0);
+
 template<class T>
 inline T ClampOnRange(T value, T min, T max)
 {
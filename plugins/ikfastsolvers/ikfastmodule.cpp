@@ -198,6 +198,7 @@ public:
             LOAD_IKFUNCTION(GetIkFastVersion);
             LOAD_IKFUNCTION(GetIkType);
             LOAD_IKFUNCTION(GetKinematicsHash);
+            LOAD_IKFUNCTION0(ComputeIkBatch);
             return true;
         }
 
@@ -18,6 +18,8 @@
 #include <boost/bind.hpp>
 #include <boost/tuple/tuple.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/functional/hash.hpp>
+#include <openrave/planningutils.h>
 
 #ifdef OPENRAVE_HAS_LAPACK
 #include "jacobianinverse.h"
@@ -81,8 +83,24 @@ public:
         RegisterCommand("SetBackTraceSelfCollisionLinks",boost::bind(&IkFastSolver<IkReal>::_SetBackTraceSelfCollisionLinksCommand,this,_1,_2),
                         "format: int int\n\n\
 for numBacktraceLinksForSelfCollisionWithNonMoving numBacktraceLinksForSelfCollisionWithFree, when pruning self collisions, the number of links to look at. If the tip of the manip self collides with the base, then can safely quit the IK.");
+        RegisterCommand("SetParallelFreeJoints",boost::bind(&IkFastSolver<IkReal>::_SetParallelFreeJointsCommand,this,_1,_2),
+                        "format: int\n\n\
+number of worker threads to partition the free joint discretization among when calling Solve/SolveAll. Each worker uses its own cloned environment. 0 (default) disables it. Parallel solving is only used when no custom filters are active.");
+        RegisterCommand("SetSolutionCache",boost::bind(&IkFastSolver<IkReal>::_SetSolutionCacheCommand,this,_1,_2),
+                        "format: int [float]\n\n\
+maximum number of entries of the SolveAll result cache (0 disables it, default) and optionally the quantization step of the ik parameterization values (default 1e-6). Entries are keyed by the quantized ik parameterization, filter options and the state of the robot and the collision environment, and are evicted in least-recently-used order. The state covers the robot geometry, joint limits and non-arm joint values, body transforms, geometry, enable states and grabbed bodies.");
+        RegisterCommand("ClearSolutionCache",boost::bind(&IkFastSolver<IkReal>::_ClearSolutionCacheCommand,this,_1,_2),
+                        "removes all the entries of the SolveAll result cache.");
+        RegisterCommand("GetSolutionCacheStats",boost::bind(&IkFastSolver<IkReal>::_GetSolutionCacheStatsCommand,this,_1,_2),
+                        "returns the cache statistics: hits misses insertions evictions entries");
+        RegisterCommand("GetParallelFreeJoints",boost::bind(&IkFastSolver<IkReal>::_GetParallelFreeJointsCommand,this,_1,_2),
+                        "returns the number of worker threads set with SetParallelFreeJoints.");
         _numBacktraceLinksForSelfCollisionWithNonMoving = 2;
         _numBacktraceLinksForSelfCollisionWithFree = 0;
+        _nParallelWorkers = 0;
+        _nSolutionCacheMaxEntries = 0;
+        _fSolutionCacheQuantization = 1e-6;
+        _nSolutionPoolDepth = 0;
     }
     virtual ~IkFastSolver() {
     }
@@ -203,6 +221,58 @@ for numBacktraceLinksForSelfCollisionWithNonMoving numBacktraceLinksForSelfColli
         return true;
     }
 
+    bool _SetParallelFreeJointsCommand(ostream& sout, istream& sinput)
+    {
+        int nworkers = 0;
+        sinput >> nworkers;
+        if( !sinput ) {
+            return false;
+        }
+        _nParallelWorkers = max(0, nworkers);
+        // recreate the workers on the next call
+        _vworkersolvers.clear();
+        _pool.reset();
+        return true;
+    }
+
+    bool _GetParallelFreeJointsCommand(ostream& sout, istream& sinput)
+    {
+        sout << _nParallelWorkers;
+        return true;
+    }
+
+    bool _SetSolutionCacheCommand(ostream& sout, istream& sinput)
+    {
+        int nmaxentries = 0;
+        sinput >> nmaxentries;
+        if( !sinput ) {
+            return false;
+        }
+        dReal fquantization = 0;
+        sinput >> fquantization;
+        if( !!sinput ) {
+            if( fquantization <= 0 ) {
+                return false;
+            }
+            _fSolutionCacheQuantization = fquantization;
+        }
+        _nSolutionCacheMaxEntries = max(0, nmaxentries);
+        _ClearSolutionCache();
+        return true;
+    }
+
+    bool _ClearSolutionCacheCommand(ostream& sout, istream& sinput)
+    {
+        _ClearSolutionCache();
+        return true;
+    }
+
+    bool _GetSolutionCacheStatsCommand(ostream& sout, istream& sinput)
+    {
+        sout << _solutioncachestats.hits << " " << _solutioncachestats.misses << " " << _solutioncachestats.insertions << " " << _solutioncachestats.evictions << " " << _listSolutionCache.size();
+        return true;
+    }
+
     bool _SetBackTraceSelfCollisionLinksCommand(ostream& sout, istream& sinput)
     {
         sinput >> _numBacktraceLinksForSelfCollisionWithNonMoving >> _numBacktraceLinksForSelfCollisionWithFree;
@@ -679,6 +749,15 @@ protected:
         if( !!ikreturn ) {
             ikreturn->Clear();
         }
+        if( _CanSolveParallel(filteroptions) ) {
+            int retaction = _SolveParallel(param, q0, filteroptions, ikreturn);
+            if( retaction >= 0 ) {
+                if( !!ikreturn ) {
+                    ikreturn->_action = static_cast<IkReturnAction>(retaction);
+                }
+                return retaction == IKRA_Success;
+            }
+        }
         RobotBase::ManipulatorPtr pmanip(_pmanip);
         RobotBasePtr probot = pmanip->GetRobot();
         RobotBase::RobotStateSaver saver(probot);
@@ -698,8 +777,84 @@ protected:
         vikreturns.resize(0);
         IkParameterization ikparamdummy;
         const IkParameterization& param = _ConvertIkParameterization(rawparam, ikparamdummy);
+        if( _CanUseSolutionCache(filteroptions) ) {
+            SolutionCacheKey cachekey;
+            _ComputeSolutionCacheKey(param, filteroptions, cachekey);
+            if( _LookupSolutionCache(cachekey, param, vikreturns) ) {
+                return vikreturns.size()>0;
+            }
+            bool bsuccess = _SolveAllUncached(param, filteroptions, vikreturns);
+            _InsertSolutionCache(cachekey, vikreturns);
+            return bsuccess;
+        }
+        return _SolveAllUncached(param, filteroptions, vikreturns);
+    }
+
+    virtual int SolveAllBatch(const std::vector<IkParameterization>& rawparams, int filteroptions, std::vector< std::vector<IkReturnPtr> >& vikreturns)
+    {
+        vikreturns.resize(rawparams.size());
+        FOREACH(itikreturns, vikreturns) {
+            itikreturns->resize(0);
+        }
+        if( rawparams.size() == 0 ) {
+            return 0;
+        }
+
+        std::vector<IkParameterization> vparams(rawparams.size());
+        for(size_t iparam = 0; iparam < rawparams.size(); ++iparam) {
+            IkParameterization ikparamdummy;
+            vparams[iparam] = _ConvertIkParameterization(rawparams[iparam], ikparamdummy);
+        }
+        if( !_CanUseSolutionCache(filteroptions) ) {
+            return _SolveAllBatchUncached(vparams, filteroptions, vikreturns);
+        }
+
+        // only solve the poses that are not cached
+        int nsolved = 0;
+        std::vector<SolutionCacheKey> vcachekeys(vparams.size());
+        std::vector<IkParameterization> vmissedparams;
+        std::vector<size_t> vmissedindices;
+        for(size_t iparam = 0; iparam < vparams.size(); ++iparam) {
+            _ComputeSolutionCacheKey(vparams[iparam], filteroptions, vcachekeys[iparam]);
+            if( _LookupSolutionCache(vcachekeys[iparam], vparams[iparam], vikreturns[iparam]) ) {
+                if( vikreturns[iparam].size() > 0 ) {
+                    ++nsolved;
+                }
+            }
+            else {
+                vmissedparams.push_back(vparams[iparam]);
+                vmissedindices.push_back(iparam);
+            }
+        }
+        if( vmissedparams.size() > 0 ) {
+            std::vector< std::vector<IkReturnPtr> > vmissedikreturns;
+            nsolved += _SolveAllBatchUncached(vmissedparams, filteroptions, vmissedikreturns);
+            for(size_t imissed = 0; imissed < vmissedindices.size(); ++imissed) {
+                size_t iparam = vmissedindices[imissed];
+                vikreturns[iparam].swap(vmissedikreturns[imissed]);
+                _InsertSolutionCache(vcachekeys[iparam], vikreturns[iparam]);
+            }
+        }
+        return nsolved;
+    }
+
+    /// \param param already converted with _ConvertIkParameterization
+    bool _SolveAllUncached(const IkParameterization& param, int filteroptions, std::vector<IkReturnPtr>& vikreturns)
+    {
         RobotBase::ManipulatorPtr pmanip(_pmanip);
         RobotBasePtr probot = pmanip->GetRobot();
+        if( _CanSolveParallel(filteroptions) ) {
+            int retaction = _SolveAllParallel(param, filteroptions, vikreturns);
+            if( retaction >= 0 ) {
+                if( retaction & IKRA_Quit ) {
+                    return false;
+                }
+                RobotBase::RobotStateSaver saver(probot, KinBody::Save_ActiveDOF);
+                probot->SetActiveDOFs(pmanip->GetArmIndices());
+                _SortSolutions(probot, vikreturns);
+                return vikreturns.size()>0;
+            }
+        }
         RobotBase::RobotStateSaver saver(probot);
         probot->SetActiveDOFs(pmanip->GetArmIndices());
         std::vector<IkReal> vfree(_vfreeparams.size());
@@ -766,6 +921,48 @@ protected:
         return vikreturns.size()>0;
     }
 
+    /// \param vparams already converted with _ConvertIkParameterization
+    int _SolveAllBatchUncached(const std::vector<IkParameterization>& vparams, int filteroptions, std::vector< std::vector<IkReturnPtr> >& vikreturns)
+    {
+        vikreturns.resize(vparams.size());
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        RobotBasePtr probot = pmanip->GetRobot();
+        const Transform tLocalTool = pmanip->GetLocalToolTransform();
+
+        // first run the analytic ik for all the poses and free values. this does not touch the robot state
+        std::vector< std::list< boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > > > vlistsolutions(vparams.size());
+        if( !_ikfunctions->_ComputeIkBatch || !_CollectIkSolutionsBatch(vparams, tLocalTool, vlistsolutions) ) {
+            std::vector<IkReal> vfree(_vfreeparams.size());
+            for(size_t iparam = 0; iparam < vparams.size(); ++iparam) {
+                ComposeSolution(_vfreeparams, vfree, 0, vector<dReal>(), boost::bind(&IkFastSolver::_CollectIkSolutions,shared_solver(), boost::ref(vparams[iparam]), boost::ref(vfree), boost::ref(tLocalTool), boost::ref(vlistsolutions[iparam])), _vFreeInc);
+            }
+        }
+        BatchSolutionPoolsReleaser poolsreleaser(*this, vlistsolutions);
+
+        // validate all the solutions with the robot state and collision options set up only once
+        RobotBase::RobotStateSaver saver(probot);
+        probot->SetActiveDOFs(pmanip->GetArmIndices());
+        StateCheckEndEffector stateCheck(probot,_vchildlinks,_vindependentlinks,filteroptions);
+        CollisionOptionsStateSaver optionstate(GetEnv()->GetCollisionChecker(),GetEnv()->GetCollisionChecker()->GetCollisionOptions()|CO_ActiveDOFs,false);
+        int nsolved = 0;
+        for(size_t iparam = 0; iparam < vparams.size(); ++iparam) {
+            std::vector<IkReturnPtr>& vposeikreturns = vikreturns[iparam];
+            FOREACHC(itsolutions, vlistsolutions[iparam]) {
+                IkReturnAction retaction = _ValidateSolutionsAll(vparams[iparam], **itsolutions, filteroptions, vposeikreturns, stateCheck);
+                if( retaction & IKRA_Quit ) {
+                    // same as SolveAll returning false for this pose
+                    vposeikreturns.resize(0);
+                    break;
+                }
+            }
+            if( vposeikreturns.size() > 0 ) {
+                _SortSolutions(probot, vposeikreturns);
+                ++nsolved;
+            }
+        }
+        return nsolved;
+    }
+
     virtual int GetNumFreeParameters() const
     {
         return (int)_vfreeparams.size();
@@ -944,8 +1141,431 @@ protected:
         return static_cast<IkReturnAction>(allres);
     }
 
+    /// \brief key of the SolveAll result cache
+    struct SolutionCacheKey
+    {
+        bool operator<(const SolutionCacheKey& r) const {
+            if( envstamp != r.envstamp ) {
+                return envstamp < r.envstamp;
+            }
+            if( filteroptions != r.filteroptions ) {
+                return filteroptions < r.filteroptions;
+            }
+            if( iktype != r.iktype ) {
+                return iktype < r.iktype;
+            }
+            if( vquantizedvalues != r.vquantizedvalues ) {
+                return vquantizedvalues < r.vquantizedvalues;
+            }
+            // the hash only speeds up the comparison, two keys are only equal if their full states are
+            return envstate < r.envstate;
+        }
+
+        std::vector<int64_t> vquantizedvalues; ///< ik parameterization values divided by the quantization step
+        int iktype;
+        int filteroptions;
+        std::string envstate; ///< binary dump of the solver settings and the state of the robot and the collision environment, see _ComputeSolutionCacheKey
+        size_t envstamp; ///< hash of envstate
+    };
+
+    struct SolutionCacheEntry
+    {
+        SolutionCacheKey key;
+        std::vector<IkReturnPtr> vikreturns;
+    };
+    typedef std::list<SolutionCacheEntry> SolutionCacheList; ///< front is the most recently used
+
+    struct SolutionCacheStats
+    {
+        SolutionCacheStats() : hits(0), misses(0), insertions(0), evictions(0) {
+        }
+        uint64_t hits, misses, insertions, evictions;
+    };
+
+    /// \brief custom filters can depend on anything, so cannot cache their results
+    bool _CanUseSolutionCache(int filteroptions) const
+    {
+        if( _nSolutionCacheMaxEntries <= 0 ) {
+            return false;
+        }
+        return (filteroptions & IKFO_IgnoreCustomFilters) || !_HasFilterInRange(IKSP_MinPriority, IKSP_MaxPriority);
+    }
+
+    /// \brief computes the cache key of a converted ik parameterization.
+    ///
+    /// The state covers everything SolveAll depends on except the arm joint values: the solver settings, the robot geometry, joint limits,
+    /// transform and non-arm joint values, link enable states, grabbed bodies relative to their grabbing links, and the update stamps
+    /// (which change with the transform, joint values and geometry) and enable states of all the other bodies.
+    void _ComputeSolutionCacheKey(const IkParameterization& param, int filteroptions, SolutionCacheKey& key)
+    {
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        RobotBasePtr probot = pmanip->GetRobot();
+
+        std::vector<dReal> vvalues(param.GetNumberOfValues());
+        param.GetValues(vvalues.begin());
+        key.vquantizedvalues.resize(vvalues.size());
+        for(size_t i = 0; i < vvalues.size(); ++i) {
+            key.vquantizedvalues[i] = (int64_t)std::floor(vvalues[i]/_fSolutionCacheQuantization+0.5);
+        }
+        key.iktype = param.GetType();
+        key.filteroptions = filteroptions;
+
+        std::string& state = key.envstate;
+        state.resize(0);
+        _AppendCacheState(state, probot->GetKinematicsGeometryHash());
+        _AppendCacheState(state, pmanip->GetKinematicsStructureHash());
+        _AppendCacheState(state, pmanip->GetLocalToolTransform());
+        _AppendCacheState(state, _ikthreshold);
+        FOREACHC(itinc, _vFreeInc) {
+            _AppendCacheState(state, *itinc);
+        }
+        _AppendCacheState(state, GetEnv()->GetCollisionChecker()->GetCollisionOptions());
+
+        _AppendCacheState(state, probot->GetTransform());
+        std::vector<dReal> vdofvalues, vlowerlimits, vupperlimits;
+        probot->GetDOFValues(vdofvalues);
+        probot->GetDOFLimits(vlowerlimits, vupperlimits);
+        const std::vector<int>& varmindices = pmanip->GetArmIndices();
+        for(size_t idof = 0; idof < vdofvalues.size(); ++idof) {
+            if( find(varmindices.begin(), varmindices.end(), (int)idof) == varmindices.end() ) {
+                _AppendCacheState(state, vdofvalues[idof]);
+            }
+            _AppendCacheState(state, vlowerlimits[idof]);
+            _AppendCacheState(state, vupperlimits[idof]);
+        }
+        FOREACHC(itlink, probot->GetLinks()) {
+            _AppendCacheState(state, (*itlink)->IsEnabled());
+        }
+
+        // grabbed bodies move with the robot, so only their relative pose matters
+        std::vector<KinBodyPtr> vgrabbed;
+        probot->GetGrabbed(vgrabbed);
+        FOREACHC(itgrabbed, vgrabbed) {
+            KinBody::LinkPtr pgrabbinglink = probot->IsGrabbing(**itgrabbed);
+            _AppendCacheState(state, (*itgrabbed)->GetEnvironmentId());
+            _AppendCacheState(state, (*itgrabbed)->IsEnabled());
+            _AppendCacheState(state, (*itgrabbed)->GetKinematicsGeometryHash());
+            if( !!pgrabbinglink ) {
+                _AppendCacheState(state, pgrabbinglink->GetIndex());
+                _AppendCacheState(state, pgrabbinglink->GetTransform().inverse()*(*itgrabbed)->GetTransform());
+            }
+        }
+
+        std::vector<KinBodyPtr> vbodies;
+        GetEnv()->GetBodies(vbodies);
+        FOREACHC(itbody, vbodies) {
+            if( *itbody == probot || find(vgrabbed.begin(), vgrabbed.end(), *itbody) != vgrabbed.end() ) {
+                continue;
+            }
+            _AppendCacheState(state, (*itbody)->GetEnvironmentId());
+            _AppendCacheState(state, (*itbody)->GetUpdateStamp());
+            _AppendCacheState(state, (*itbody)->IsEnabled());
+        }
+        key.envstamp = boost::hash<std::string>()(state);
+    }
+
+    template <typename T>
+    static void _AppendCacheState(std::string& state, const T& value)
+    {
+        state.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static void _AppendCacheState(std::string& state, const std::string& value)
+    {
+        _AppendCacheState(state, value.size());
+        state.append(value);
+    }
+
+    static void _AppendCacheState(std::string& state, const Transform& t)
+    {
+        for(int i = 0; i < 4; ++i) {
+            _AppendCacheState(state, t.rot[i]);
+        }
+        for(int i = 0; i < 3; ++i) {
+            _AppendCacheState(state, t.trans[i]);
+        }
+    }
+
+    /// \brief if key is cached, copies the solutions into vikreturns and marks it as most recently used
+    ///
+    /// The finish callbacks are called on the copied solutions the same way SolveAll would.
+    /// \param param the converted ik parameterization the key was computed from
+    bool _LookupSolutionCache(const SolutionCacheKey& key, const IkParameterization& param, std::vector<IkReturnPtr>& vikreturns)
+    {
+        typename std::map<SolutionCacheKey, typename SolutionCacheList::iterator>::iterator itmap = _mapSolutionCache.find(key);
+        if( itmap == _mapSolutionCache.end() ) {
+            _solutioncachestats.misses++;
+            return false;
+        }
+        _solutioncachestats.hits++;
+        _listSolutionCache.splice(_listSolutionCache.begin(), _listSolutionCache, itmap->second);
+        const std::vector<IkReturnPtr>& vcached = itmap->second->vikreturns;
+        // copy so that users cannot modify the cached data
+        vikreturns.resize(vcached.size());
+        for(size_t i = 0; i < vcached.size(); ++i) {
+            vikreturns[i].reset(new IkReturn(*vcached[i]));
+        }
+        if( vikreturns.size() > 0 ) {
+            RobotBase::ManipulatorPtr pmanip(_pmanip);
+            IkParameterization paramglobal = pmanip->GetBase()->GetTransform()*param;
+            FOREACH(itikreturn, vikreturns) {
+                _CallFinishCallbacks(*itikreturn, pmanip, paramglobal);
+            }
+        }
+        return true;
+    }
+
+    void _InsertSolutionCache(const SolutionCacheKey& key, const std::vector<IkReturnPtr>& vikreturns)
+    {
+        if( _mapSolutionCache.find(key) != _mapSolutionCache.end() ) {
+            return;
+        }
+        _listSolutionCache.push_front(SolutionCacheEntry());
+        SolutionCacheEntry& entry = _listSolutionCache.front();
+        entry.key = key;
+        entry.vikreturns.resize(vikreturns.size());
+        for(size_t i = 0; i < vikreturns.size(); ++i) {
+            entry.vikreturns[i].reset(new IkReturn(*vikreturns[i]));
+        }
+        _mapSolutionCache[key] = _listSolutionCache.begin();
+        _solutioncachestats.insertions++;
+        while( (int)_listSolutionCache.size() > _nSolutionCacheMaxEntries ) {
+            _mapSolutionCache.erase(_listSolutionCache.back().key);
+            _listSolutionCache.pop_back();
+            _solutioncachestats.evictions++;
+        }
+    }
+
+    void _ClearSolutionCache()
+    {
+        _mapSolutionCache.clear();
+        _listSolutionCache.clear();
+        _solutioncachestats = SolutionCacheStats();
+    }
+
+    /// \brief records the free values in the order ComposeSolution visits them
+    IkReturnAction _CollectFreeValues(const vector<IkReal>& vfree, std::vector< std::vector<IkReal> >& vfreevalues)
+    {
+        vfreevalues.push_back(vfree);
+        return IKRA_Reject; // signals to continue
+    }
+
+    /// \brief true if Solve/SolveAll can partition the free values among the workers.
+    ///
+    /// Custom filters can reference the original environment (or python), so they cannot be called from the workers.
+    /// Finish callbacks do not prevent parallel solving since they are called on this thread with the merged solutions.
+    bool _CanSolveParallel(int filteroptions) const
+    {
+        if( _nParallelWorkers <= 0 || _vfreeparams.size() == 0 ) {
+            return false;
+        }
+        return (filteroptions & IKFO_IgnoreCustomFilters) || !_HasFilterInRange(IKSP_MinPriority, IKSP_MaxPriority);
+    }
+
+    /// \brief synchronizes the worker environments with the current environment and makes sure every worker has a solver for the manipulator.
+    ///
+    /// The worker environments are only recloned when a body of the environment changed its update stamp since the last call, and the worker solvers
+    /// are only looked up again after that.
+    /// \return false if the workers cannot be used
+    bool _PrepareWorkers()
+    {
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        bool bSynchronized = true;
+        if( !_pool ) {
+            _vworkersolvers.clear();
+            _pool.reset(new planningutils::PlannerParametersWorkerPool(GetEnv(), PlannerBase::PlannerParametersConstPtr(), _nParallelWorkers));
+        }
+        else {
+            bSynchronized = _pool->Synchronize();
+        }
+        _vworkersolvers.resize(_pool->GetNumWorkers());
+        for(int iworker = 0; iworker < _pool->GetNumWorkers(); ++iworker) {
+            boost::shared_ptr< IkFastSolver<IkReal> >& pworkersolver = _vworkersolvers[iworker];
+            if( !bSynchronized && !!pworkersolver ) {
+                _CopyWorkerSettings(*pworkersolver);
+                continue;
+            }
+            EnvironmentBasePtr pworkerenv = _pool->GetWorkerEnv(iworker);
+            EnvironmentMutex::scoped_lock lockworker(pworkerenv->GetMutex());
+            RobotBasePtr pworkerrobot = pworkerenv->GetRobot(pmanip->GetRobot()->GetName());
+            RobotBase::ManipulatorPtr pworkermanip;
+            if( !!pworkerrobot ) {
+                pworkermanip = pworkerrobot->GetManipulator(pmanip->GetName());
+            }
+            if( !pworkermanip ) {
+                RAVELOG_WARN_FORMAT("env=%d, worker %d does not have manipulator %s:%s, solving serially", GetEnv()->GetId()%iworker%pmanip->GetRobot()->GetName()%pmanip->GetName());
+                return false;
+            }
+            if( !pworkersolver || pworkersolver->GetManipulator() != pworkermanip ) {
+                std::stringstream sinput;
+                pworkersolver.reset(new IkFastSolver<IkReal>(pworkerenv, sinput, _ikfunctions, _vFreeInc, _ikthreshold));
+                if( !pworkersolver->Init(pworkermanip) ) {
+                    pworkersolver.reset();
+                    return false;
+                }
+            }
+            _CopyWorkerSettings(*pworkersolver);
+        }
+        return true;
+    }
+
+    /// \brief settings could have changed since the worker solver was created
+    void _CopyWorkerSettings(IkFastSolver<IkReal>& workersolver) const
+    {
+        workersolver._vFreeInc = _vFreeInc;
+        workersolver._ikthreshold = _ikthreshold;
+        workersolver._numBacktraceLinksForSelfCollisionWithNonMoving = _numBacktraceLinksForSelfCollisionWithNonMoving;
+        workersolver._numBacktraceLinksForSelfCollisionWithFree = _numBacktraceLinksForSelfCollisionWithFree;
+#ifdef OPENRAVE_HAS_LAPACK
+        workersolver._SetJacobianRefine(_fRefineWithJacobianInverseAllowedError, _jacobinvsolver._nMaxIterations);
+#endif
+    }
+
+    /// \brief parallel version of Solve. The free values are visited in the same order as ComposeSolution, and the solution of the first free value that succeeds is returned.
+    ///
+    /// \return the ik return action, or -1 if the workers could not be used and the caller should solve serially
+    int _SolveParallel(const IkParameterization& param, const vector<dReal>& q0, int filteroptions, IkReturnPtr ikreturn)
+    {
+        std::vector< std::vector<IkReal> > vfreevalues;
+        std::vector<IkReal> vfree(_vfreeparams.size());
+        ComposeSolution(_vfreeparams, vfree, 0, q0, boost::bind(&IkFastSolver::_CollectFreeValues,this,boost::ref(vfree),boost::ref(vfreevalues)), _vFreeInc);
+        if( (int)vfreevalues.size() < 2*_nParallelWorkers || !_PrepareWorkers() ) {
+            return -1;
+        }
+
+        // small chunks so that workers stop soon after a solution close to q0 is found
+        int nchunks = min((int)vfreevalues.size(), 8*_pool->GetNumWorkers());
+        std::vector<IkReturnPtr> vchunkikreturns(nchunks);
+        std::vector<int> vchunkactions(nchunks, IKRA_Reject);
+        for(int ichunk = 0; ichunk < nchunks; ++ichunk) {
+            vchunkikreturns[ichunk].reset(new IkReturn(IKRA_Reject));
+        }
+        int ifoundchunk = _pool->Evaluate(nchunks, [&](int iworker, int ichunk) {
+            size_t istart = vfreevalues.size()*ichunk/nchunks, iend = vfreevalues.size()*(ichunk+1)/nchunks;
+            IkReturnAction retaction = _vworkersolvers.at(iworker)->_SolveFreeValues(param, vfreevalues, istart, iend, q0, filteroptions, vchunkikreturns.at(ichunk));
+            vchunkactions.at(ichunk) = retaction;
+            // stop at the first chunk that found a solution or quit
+            return (!(retaction & IKRA_Reject) || (retaction & IKRA_Quit)) ? 1 : 0;
+        });
+        if( ifoundchunk < 0 ) {
+            int allres = IKRA_Reject;
+            FOREACHC(itaction, vchunkactions) {
+                allres |= *itaction;
+            }
+            return allres;
+        }
+        if( vchunkactions[ifoundchunk] == IKRA_Success ) {
+            if( !!ikreturn ) {
+                *ikreturn = *vchunkikreturns[ifoundchunk];
+            }
+            RobotBase::ManipulatorPtr pmanip(_pmanip);
+            _CallFinishCallbacks(vchunkikreturns[ifoundchunk], pmanip, pmanip->GetBase()->GetTransform()*param);
+        }
+        return vchunkactions[ifoundchunk];
+    }
+
+    /// \brief calls _SolveSingle on a range of free values of the worker robot, same as the ComposeSolution loop
+    IkReturnAction _SolveFreeValues(const IkParameterization& param, const std::vector< std::vector<IkReal> >& vfreevalues, size_t istart, size_t iend, const vector<dReal>& q0, int filteroptions, IkReturnPtr ikreturn)
+    {
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        RobotBasePtr probot = pmanip->GetRobot();
+        RobotBase::RobotStateSaver saver(probot);
+        probot->SetActiveDOFs(pmanip->GetArmIndices());
+        StateCheckEndEffector stateCheck(probot,_vchildlinks,_vindependentlinks,filteroptions);
+        CollisionOptionsStateSaver optionstate(GetEnv()->GetCollisionChecker(),GetEnv()->GetCollisionChecker()->GetCollisionOptions()|CO_ActiveDOFs,false);
+        int allres = IKRA_Reject;
+        for(size_t ifree = istart; ifree < iend; ++ifree) {
+            IkReturnAction res = _SolveSingle(param, vfreevalues[ifree], q0, filteroptions, ikreturn, stateCheck);
+            if( !(res & IKRA_Reject) || (res & IKRA_Quit) ) {
+                return res;
+            }
+            allres |= res;
+        }
+        return static_cast<IkReturnAction>(allres);
+    }
+
+    /// \brief parallel version of SolveAll. The solutions of every chunk of free values are concatenated in the order ComposeSolution visits them.
+    ///
+    /// \return the accumulated ik return action, or -1 if the workers could not be used and the caller should solve serially
+    int _SolveAllParallel(const IkParameterization& param, int filteroptions, std::vector<IkReturnPtr>& vikreturns)
+    {
+        std::vector< std::vector<IkReal> > vfreevalues;
+        std::vector<IkReal> vfree(_vfreeparams.size());
+        ComposeSolution(_vfreeparams, vfree, 0, vector<dReal>(), boost::bind(&IkFastSolver::_CollectFreeValues,this,boost::ref(vfree),boost::ref(vfreevalues)), _vFreeInc);
+        if( (int)vfreevalues.size() < 2*_nParallelWorkers || !_PrepareWorkers() ) {
+            return -1;
+        }
+
+        int nchunks = min((int)vfreevalues.size(), 4*_pool->GetNumWorkers());
+        std::vector< std::vector<IkReturnPtr> > vchunkikreturns(nchunks);
+        int iquitchunk = _pool->Evaluate(nchunks, [&](int iworker, int ichunk) {
+            size_t istart = vfreevalues.size()*ichunk/nchunks, iend = vfreevalues.size()*(ichunk+1)/nchunks;
+            IkReturnAction retaction = _vworkersolvers.at(iworker)->_SolveAllFreeValues(param, vfreevalues, istart, iend, filteroptions, vchunkikreturns.at(ichunk));
+            return (retaction & IKRA_Quit) ? 1 : 0;
+        });
+        if( iquitchunk >= 0 ) {
+            return IKRA_Quit;
+        }
+        FOREACH(itchunkikreturns, vchunkikreturns) {
+            vikreturns.insert(vikreturns.end(), itchunkikreturns->begin(), itchunkikreturns->end());
+        }
+        // the worker solvers do not have the callbacks registered on this solver, so call them here in the same order as the serial SolveAll
+        if( vikreturns.size() > 0 ) {
+            RobotBase::ManipulatorPtr pmanip(_pmanip);
+            IkParameterization paramglobal = pmanip->GetBase()->GetTransform()*param;
+            FOREACH(itikreturn, vikreturns) {
+                _CallFinishCallbacks(*itikreturn, pmanip, paramglobal);
+            }
+        }
+        return IKRA_Reject;
+    }
+
+    /// \brief calls _SolveAll on a range of free values of the worker robot, same as the ComposeSolution loop
+    IkReturnAction _SolveAllFreeValues(const IkParameterization& param, const std::vector< std::vector<IkReal> >& vfreevalues, size_t istart, size_t iend, int filteroptions, std::vector<IkReturnPtr>& vikreturns)
+    {
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        RobotBasePtr probot = pmanip->GetRobot();
+        RobotBase::RobotStateSaver saver(probot);
+        probot->SetActiveDOFs(pmanip->GetArmIndices());
+        StateCheckEndEffector stateCheck(probot,_vchildlinks,_vindependentlinks,filteroptions);
+        CollisionOptionsStateSaver optionstate(GetEnv()->GetCollisionChecker(),GetEnv()->GetCollisionChecker()->GetCollisionOptions()|CO_ActiveDOFs,false);
+        for(size_t ifree = istart; ifree < iend; ++ifree) {
+            IkReturnAction retaction = _SolveAll(param, vfreevalues[ifree], filteroptions, vikreturns, stateCheck);
+            if( retaction & IKRA_Quit ) {
+                return retaction;
+            }
+        }
+        return IKRA_Reject;
+    }
+
+    /// \brief hands out a cleared solution pool for the current nesting depth of the ik calls.
+    ///
+    /// Filters can call back into the solver while the solutions of the outer call are still being validated, so every depth keeps its own pool.
+    class SolutionPoolScope
+    {
+public:
+        SolutionPoolScope(IkFastSolver<IkReal>& solver) : _solver(solver) {
+            if( solver._nSolutionPoolDepth >= (int)solver._vSolutionPools.size() ) {
+                solver._vSolutionPools.push_back(boost::shared_ptr< ikfast::IkSolutionPool<IkReal> >(new ikfast::IkSolutionPool<IkReal>()));
+            }
+            _psolutions = solver._vSolutionPools[solver._nSolutionPoolDepth++];
+            _psolutions->Clear();
+        }
+        ~SolutionPoolScope() {
+            _solver._nSolutionPoolDepth--;
+        }
+
+        inline ikfast::IkSolutionPool<IkReal>& GetSolutions() {
+            return *_psolutions;
+        }
+
+private:
+        IkFastSolver<IkReal>& _solver;
+        boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > _psolutions;
+    };
+
     /// \param tLocalTool _pmanip->GetLocalToolTransform()
-    inline bool _CallIk(const IkParameterization& param, const vector<IkReal>& vfree, const Transform& tLocalTool, ikfast::IkSolutionList<IkReal>& solutions)
+    inline bool _CallIk(const IkParameterization& param, const vector<IkReal>& vfree, const Transform& tLocalTool, ikfast::IkSolutionListBase<IkReal>& solutions)
     {
         bool bsuccess = false;
         if( !!_ikfunctions->_ComputeIk2 ) {
@@ -957,7 +1577,7 @@ protected:
         return bsuccess;
     }
 
-    bool _CallIk1(const IkParameterization& param, const vector<IkReal>& vfree, const Transform& tLocalTool, ikfast::IkSolutionList<IkReal>& solutions)
+    bool _CallIk1(const IkParameterization& param, const vector<IkReal>& vfree, const Transform& tLocalTool, ikfast::IkSolutionListBase<IkReal>& solutions)
     {
         try {
             switch(param.GetType()) {
@@ -1094,7 +1714,7 @@ protected:
         throw openrave_exception(str(boost::format(_("don't support ik parameterization 0x%x"))%param.GetType()),ORE_InvalidArguments);
     }
 
-    bool _CallIk2(const IkParameterization& param, const vector<IkReal>& vfree, const Transform& tLocalTool, ikfast::IkSolutionList<IkReal>& solutions)
+    bool _CallIk2(const IkParameterization& param, const vector<IkReal>& vfree, const Transform& tLocalTool, ikfast::IkSolutionListBase<IkReal>& solutions)
     {
         RobotBase::ManipulatorPtr pmanip = _pmanip.lock();
         try {
@@ -1306,7 +1926,8 @@ protected:
     IkReturnAction _SolveSingle(const IkParameterization& param, const vector<IkReal>& vfree, const vector<dReal>& q0, int filteroptions, IkReturnPtr ikreturn, StateCheckEndEffector& stateCheck)
     {
         RobotBase::ManipulatorPtr pmanip(_pmanip);
-        ikfast::IkSolutionList<IkReal> solutions;
+        SolutionPoolScope poolscope(*this);
+        ikfast::IkSolutionPool<IkReal>& solutions = poolscope.GetSolutions();
         if( !_CallIk(param,vfree, pmanip->GetLocalToolTransform(), solutions) ) {
             return IKRA_RejectKinematics;
         }
@@ -1863,33 +2484,228 @@ protected:
     IkReturnAction _SolveAll(const IkParameterization& param, const vector<IkReal>& vfree, int filteroptions, std::vector<IkReturnPtr>& vikreturns, StateCheckEndEffector& stateCheck)
     {
         RobotBase::ManipulatorPtr pmanip(_pmanip);
-        RobotBasePtr probot = pmanip->GetRobot();
-        ikfast::IkSolutionList<IkReal> solutions;
+        SolutionPoolScope poolscope(*this);
+        ikfast::IkSolutionPool<IkReal>& solutions = poolscope.GetSolutions();
         if( _CallIk(param,vfree, pmanip->GetLocalToolTransform(), solutions) ) {
-            vector<IkReal> vsolfree;
-            std::vector<IkReal> sol(pmanip->GetArmIndices().size());
-            for(size_t isolution = 0; isolution < solutions.GetNumSolutions(); ++isolution) {
-                const ikfast::IkSolution<IkReal>& iksol = dynamic_cast<const ikfast::IkSolution<IkReal>& >(solutions.GetSolution(isolution));
-                iksol.Validate();
-                //RAVELOG_VERBOSE_FORMAT("ikfast solution %d/%d (free=%d)", isolution%solutions.GetNumSolutions()%iksol.GetFree().size());
-                if( iksol.GetFree().size() > 0 ) {
-                    // have to search over all the free parameters of the solution!
-                    vsolfree.resize(iksol.GetFree().size());
-                    std::vector<dReal> vFreeInc(_GetFreeIncFromIndices(iksol.GetFree()));
-                    IkReturnAction retaction = ComposeSolution(iksol.GetFree(), vsolfree, 0, vector<dReal>(), boost::bind(&IkFastSolver::_ValidateSolutionAll,shared_solver(), boost::ref(param), boost::ref(iksol), boost::ref(vsolfree), filteroptions, boost::ref(sol), boost::ref(vikreturns), boost::ref(stateCheck)), vFreeInc);
-                    if( retaction & IKRA_Quit) {
-                        return retaction;
-                    }
+            IkReturnAction retaction = _ValidateSolutionsAll(param, solutions, filteroptions, vikreturns, stateCheck);
+            if( retaction & IKRA_Quit ) {
+                return retaction;
+            }
+        }
+        return IKRA_Reject; // signals to continue
+    }
+
+    /// \brief only calls the analytic ik for one free value and stores the raw solutions, used to separate the ikfast calls from the filtering in SolveAllBatch
+    IkReturnAction _CollectIkSolutions(const IkParameterization& param, const vector<IkReal>& vfree, const Transform& tLocalTool, std::list< boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > >& listsolutions)
+    {
+        boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > psolutions = _AcquireBatchSolutionPool();
+        if( _CallIk(param, vfree, tLocalTool, *psolutions) && psolutions->GetNumSolutions() > 0 ) {
+            listsolutions.push_back(psolutions);
+        }
+        else {
+            _ReleaseBatchSolutionPool(psolutions);
+        }
+        return IKRA_Reject; // signals to continue
+    }
+
+    /// \brief returns a cleared pool from _vFreeBatchSolutionPools, or a new one if there are no free pools
+    boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > _AcquireBatchSolutionPool()
+    {
+        if( _vFreeBatchSolutionPools.size() == 0 ) {
+            return boost::shared_ptr< ikfast::IkSolutionPool<IkReal> >(new ikfast::IkSolutionPool<IkReal>());
+        }
+        boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > psolutions = _vFreeBatchSolutionPools.back();
+        _vFreeBatchSolutionPools.pop_back();
+        psolutions->Clear();
+        return psolutions;
+    }
+
+    /// \brief gives a pool back so that later batch calls can reuse its storage. At most s_nMaxFreeBatchSolutionPools pools are kept.
+    void _ReleaseBatchSolutionPool(boost::shared_ptr< ikfast::IkSolutionPool<IkReal> >& psolutions)
+    {
+        if( _vFreeBatchSolutionPools.size() < s_nMaxFreeBatchSolutionPools ) {
+            _vFreeBatchSolutionPools.push_back(psolutions);
+        }
+        psolutions.reset();
+    }
+
+    /// \brief releases all the pools collected by a SolveAllBatch call when it returns
+    class BatchSolutionPoolsReleaser
+    {
+public:
+        BatchSolutionPoolsReleaser(IkFastSolver<IkReal>& solver, std::vector< std::list< boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > > >& vlistsolutions) : _solver(solver), _vlistsolutions(vlistsolutions) {
+        }
+        ~BatchSolutionPoolsReleaser() {
+            FOREACH(itlistsolutions, _vlistsolutions) {
+                FOREACH(itsolutions, *itlistsolutions) {
+                    _solver._ReleaseBatchSolutionPool(*itsolutions);
+                }
+                itlistsolutions->clear();
+            }
+        }
+
+private:
+        IkFastSolver<IkReal>& _solver;
+        std::vector< std::list< boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > > >& _vlistsolutions;
+    };
+
+    /// \brief same as calling _CollectIkSolutions for every pose and free value, except that the analytic ik of all the poses is computed by one ComputeIkBatch call per free value.
+    ///
+    /// \return false if the poses cannot be solved with ComputeIkBatch, in that case vlistsolutions is not modified
+    bool _CollectIkSolutionsBatch(const std::vector<IkParameterization>& vparams, const Transform& tLocalTool, std::vector< std::list< boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > > >& vlistsolutions)
+    {
+        const int numposes = (int)vparams.size();
+        std::vector<IkReal> veetrans(3*numposes), veerot(9*numposes);
+        bool busetrans = false, buserot = false;
+        for(int ipose = 0; ipose < numposes; ++ipose) {
+            if( vparams[ipose].GetType() != vparams[0].GetType() || !_GetIkFastInputs(vparams[ipose], tLocalTool, &veetrans[3*ipose], &veerot[9*ipose], busetrans, buserot) ) {
+                return false;
+            }
+        }
+
+        std::vector< std::vector<IkReal> > vfreevalues;
+        std::vector<IkReal> vfree(_vfreeparams.size());
+        ComposeSolution(_vfreeparams, vfree, 0, vector<dReal>(), boost::bind(&IkFastSolver::_CollectFreeValues,this,boost::ref(vfree),boost::ref(vfreevalues)), _vFreeInc);
+
+        std::vector<IkReal> vposesfree(numposes*_vfreeparams.size());
+        std::vector< boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > > vpsolutions(numposes);
+        std::vector< ikfast::IkSolutionListBase<IkReal>* > vsolutionptrs(numposes);
+        RobotBase::ManipulatorPtr pmanip = _pmanip.lock(); // passed like _CallIk2 does
+        FOREACHC(itfreevalues, vfreevalues) {
+            for(int ipose = 0; ipose < numposes; ++ipose) {
+                std::copy(itfreevalues->begin(), itfreevalues->end(), vposesfree.begin()+ipose*_vfreeparams.size());
+                // pools without solutions from the previous free value are still owned here and only need to be cleared
+                if( !vpsolutions[ipose] ) {
+                    vpsolutions[ipose] = _AcquireBatchSolutionPool();
                 }
                 else {
-                    IkReturnAction retaction = _ValidateSolutionAll(param, iksol, vector<IkReal>(), filteroptions, sol, vikreturns, stateCheck);
-                    if( retaction & IKRA_Quit ) {
-                        return retaction;
-                    }
+                    vpsolutions[ipose]->Clear();
+                }
+                vsolutionptrs[ipose] = vpsolutions[ipose].get();
+            }
+            _ikfunctions->_ComputeIkBatch(numposes, busetrans ? &veetrans[0] : NULL, buserot ? &veerot[0] : NULL, vposesfree.size() > 0 ? &vposesfree[0] : NULL, &vsolutionptrs[0], NULL, &pmanip);
+            for(int ipose = 0; ipose < numposes; ++ipose) {
+#ifdef OPENRAVE_HAS_LAPACK
+                if( vpsolutions[ipose]->GetNumSolutions() == 0 && _fRefineWithJacobianInverseAllowedError > 0 ) {
+                    // the single pose call retries with some jitter since the solutions will be refined
+                    _CallIk(vparams[ipose], *itfreevalues, tLocalTool, *vpsolutions[ipose]);
+                }
+#endif
+                if( vpsolutions[ipose]->GetNumSolutions() > 0 ) {
+                    vlistsolutions[ipose].push_back(vpsolutions[ipose]);
+                    vpsolutions[ipose].reset();
                 }
             }
         }
-        return IKRA_Reject; // signals to continue
+        FOREACH(itsolutions, vpsolutions) {
+            if( !!*itsolutions ) {
+                _ReleaseBatchSolutionPool(*itsolutions);
+            }
+        }
+        return true;
+    }
+
+    /// \brief fills the ikfast inputs of param like _CallIk1 does, only for the ik types that can be solved with ComputeIkBatch.
+    ///
+    /// \param[out] eetrans 3 values
+    /// \param[out] eerot 9 values
+    /// \param[out] busetrans set to true if the ik type uses eetrans
+    /// \param[out] buserot set to true if the ik type uses eerot
+    /// \return false if the ik type is not supported
+    bool _GetIkFastInputs(const IkParameterization& param, const Transform& tLocalTool, IkReal* eetrans, IkReal* eerot, bool& busetrans, bool& buserot) const
+    {
+        std::fill(eetrans, eetrans+3, IkReal(0));
+        std::fill(eerot, eerot+9, IkReal(0));
+        busetrans = false;
+        buserot = false;
+        switch(param.GetType()) {
+        case IKP_Transform6D: {
+            TransformMatrix t = param.GetTransform6D();
+            if( _bEmptyTransform6D ) {
+                t = t * tLocalTool.inverse();
+            }
+            eetrans[0] = t.trans.x; eetrans[1] = t.trans.y; eetrans[2] = t.trans.z;
+            eerot[0] = t.m[0]; eerot[1] = t.m[1]; eerot[2] = t.m[2];
+            eerot[3] = t.m[4]; eerot[4] = t.m[5]; eerot[5] = t.m[6];
+            eerot[6] = t.m[8]; eerot[7] = t.m[9]; eerot[8] = t.m[10];
+            busetrans = true;
+            buserot = true;
+            return true;
+        }
+        case IKP_Rotation3D: {
+            TransformMatrix t(Transform(param.GetRotation3D(),Vector()));
+            eerot[0] = t.m[0]; eerot[1] = t.m[1]; eerot[2] = t.m[2];
+            eerot[3] = t.m[4]; eerot[4] = t.m[5]; eerot[5] = t.m[6];
+            eerot[6] = t.m[8]; eerot[7] = t.m[9]; eerot[8] = t.m[10];
+            buserot = true;
+            return true;
+        }
+        case IKP_Translation3D: {
+            Vector v = param.GetTranslation3D();
+            eetrans[0] = v.x; eetrans[1] = v.y; eetrans[2] = v.z;
+            busetrans = true;
+            return true;
+        }
+        case IKP_Direction3D: {
+            Vector v = param.GetDirection3D();
+            eerot[0] = v.x; eerot[1] = v.y; eerot[2] = v.z;
+            buserot = true;
+            return true;
+        }
+        case IKP_Ray4D: {
+            RAY r = param.GetRay4D();
+            eetrans[0] = r.pos.x; eetrans[1] = r.pos.y; eetrans[2] = r.pos.z;
+            eerot[0] = r.dir.x; eerot[1] = r.dir.y; eerot[2] = r.dir.z;
+            busetrans = true;
+            buserot = true;
+            return true;
+        }
+        case IKP_Lookat3D: {
+            Vector v = param.GetLookat3D();
+            eetrans[0] = v.x; eetrans[1] = v.y; eetrans[2] = v.z;
+            busetrans = true;
+            return true;
+        }
+        case IKP_TranslationDirection5D: {
+            RAY r = param.GetTranslationDirection5D();
+            eetrans[0] = r.pos.x; eetrans[1] = r.pos.y; eetrans[2] = r.pos.z;
+            eerot[0] = r.dir.x; eerot[1] = r.dir.y; eerot[2] = r.dir.z;
+            busetrans = true;
+            buserot = true;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    /// \brief validates all the raw ikfast solutions and appends the good ones to vikreturns
+    IkReturnAction _ValidateSolutionsAll(const IkParameterization& param, const ikfast::IkSolutionListBase<IkReal>& solutions, int filteroptions, std::vector<IkReturnPtr>& vikreturns, StateCheckEndEffector& stateCheck)
+    {
+        RobotBase::ManipulatorPtr pmanip(_pmanip);
+        vector<IkReal> vsolfree;
+        std::vector<IkReal> sol(pmanip->GetArmIndices().size());
+        for(size_t isolution = 0; isolution < solutions.GetNumSolutions(); ++isolution) {
+            const ikfast::IkSolution<IkReal>& iksol = dynamic_cast<const ikfast::IkSolution<IkReal>& >(solutions.GetSolution(isolution));
+            iksol.Validate();
+            //RAVELOG_VERBOSE_FORMAT("ikfast solution %d/%d (free=%d)", isolution%solutions.GetNumSolutions()%iksol.GetFree().size());
+            if( iksol.GetFree().size() > 0 ) {
+                // have to search over all the free parameters of the solution!
+                vsolfree.resize(iksol.GetFree().size());
+                std::vector<dReal> vFreeInc(_GetFreeIncFromIndices(iksol.GetFree()));
+                IkReturnAction retaction = ComposeSolution(iksol.GetFree(), vsolfree, 0, vector<dReal>(), boost::bind(&IkFastSolver::_ValidateSolutionAll,shared_solver(), boost::ref(param), boost::ref(iksol), boost::ref(vsolfree), filteroptions, boost::ref(sol), boost::ref(vikreturns), boost::ref(stateCheck)), vFreeInc);
+                if( retaction & IKRA_Quit) {
+                    return retaction;
+                }
+            }
+            else {
+                IkReturnAction retaction = _ValidateSolutionAll(param, iksol, vector<IkReal>(), filteroptions, sol, vikreturns, stateCheck);
+                if( retaction & IKRA_Quit ) {
+                    return retaction;
+                }
+            }
+        }
+        return IKRA_Reject;
     }
 
     IkReturnAction _ValidateSolutionAll(const IkParameterization& param, const ikfast::IkSolution<IkReal>& iksol, const vector<IkReal>& vfree, int filteroptions, std::vector<IkReal>& sol, std::vector<IkReturnPtr>& vikreturns, StateCheckEndEffector& stateCheck)
@@ -2454,8 +3270,25 @@ protected:
     int _nSameStateRepeatCount;
     //@}
 
+    std::vector< boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > > _vSolutionPools; ///< reused by the analytic ik calls so that they do not allocate, one for every nesting depth. see SolutionPoolScope
+    int _nSolutionPoolDepth; ///< number of _vSolutionPools currently in use
+    std::vector< boost::shared_ptr< ikfast::IkSolutionPool<IkReal> > > _vFreeBatchSolutionPools; ///< pools not in use by SolveAllBatch, which keeps one pool per pose and free value until the solutions are validated
+    static const size_t s_nMaxFreeBatchSolutionPools = 1024;
+
     bool _bEmptyTransform6D; ///< if true, then the iksolver has been built with identity of the manipulator transform. Only valid for Transform6D IKs.
 
+    int _nParallelWorkers; ///< if > 0, Solve/SolveAll partition the free joint values among this many workers
+    planningutils::PlannerParametersWorkerPoolPtr _pool; ///< worker environments, created on the first parallel call
+    std::vector< boost::shared_ptr< IkFastSolver<IkReal> > > _vworkersolvers; ///< solver for the manipulator in each of the worker environments, has to be destroyed before _pool
+
+    //@{
+    // SolveAll result cache
+    int _nSolutionCacheMaxEntries; ///< 0 if cache is disabled
+    dReal _fSolutionCacheQuantization; ///< step the ik parameterization values are quantized with
+    SolutionCacheList _listSolutionCache;
+    std::map<SolutionCacheKey, typename SolutionCacheList::iterator> _mapSolutionCache;
+    SolutionCacheStats _solutioncachestats;
+    //@}
 };
 
 #ifdef OPENRAVE_IKFAST_FLOAT32
@@ -14,6 +14,7 @@
 #include "openraveplugindefs.h"
 #include <fstream>
 #include <openrave/planningutils.h>
+#include <boost/functional/hash.hpp>
 
 #include "rampoptimizer/interpolator.h"
 #include "rampoptimizer/parabolicchecker.h"
@@ -351,11 +352,117 @@ private:
 
     }; // end class MyRampNDFeasibilityChecker
 
+    /// \brief checks shortcut candidates with the parameters bound to a worker environment, used by _ShortcutParallel.
+    ///
+    /// Only handles the case without manip constraints and without modified configurations, so SegmentFeasible2 does not need to process the configurations returned by CheckPathAllConstraints.
+    class ShortcutWorker : public RampOptimizer::FeasibilityCheckerBase
+    {
+public:
+        ShortcutWorker() : _feasibilitychecker(this), _bUsePerturbation(true), _envid(0) {
+            _constraintreturn.reset(new ConstraintFilterReturn());
+        }
+
+        void Init(ConstraintTrajectoryTimingParametersPtr parameters, const MyRampNDFeasibilityChecker& feasibilitychecker, bool bUsePerturbation, int envid)
+        {
+            _parameters = parameters;
+            _feasibilitychecker.SetParameters(parameters);
+            _feasibilitychecker.SetEnvID(envid);
+            _feasibilitychecker.tol = feasibilitychecker.tol;
+            _feasibilitychecker.constraintmask = feasibilitychecker.constraintmask;
+            _bUsePerturbation = bUsePerturbation;
+            _envid = envid;
+        }
+
+        void SetUsePerturbation(bool bUsePerturbation)
+        {
+            _bUsePerturbation = bUsePerturbation;
+        }
+
+        virtual int ConfigFeasible(const std::vector<dReal>& q0, const std::vector<dReal>& dq0, int options)
+        {
+            return ConfigFeasible2(q0, dq0, options).retcode;
+        }
+
+        virtual RampOptimizer::CheckReturn ConfigFeasible2(const std::vector<dReal>& q0, const std::vector<dReal>& dq0, int options)
+        {
+            if( _bUsePerturbation ) {
+                options |= CFO_CheckWithPerturbation;
+            }
+            try {
+                int ret = _parameters->CheckPathAllConstraints(q0, q0, dq0, dq0, 0, IT_OpenStart, options);
+                RampOptimizer::CheckReturn checkret(ret);
+                if( ret == CFO_CheckTimeBasedConstraints ) {
+                    checkret.fTimeBasedSurpassMult = 0.98;
+                }
+                return checkret;
+            }
+            catch (const std::exception& ex) {
+                RAVELOG_WARN_FORMAT("env=%d, CheckPathAllConstraints threw an exception: %s", _envid%ex.what());
+                return 0xffff|CFO_FromTrajectorySmoother;
+            }
+        }
+
+        virtual RampOptimizer::CheckReturn SegmentFeasible2(const std::vector<dReal>& q0, const std::vector<dReal>& q1, const std::vector<dReal>& dq0, const std::vector<dReal>& dq1, dReal timeElapsed, int options, std::vector<RampOptimizer::RampND>& rampndVectOut, std::vector<dReal>& vIntermediateConfigurations)
+        {
+            rampndVectOut.resize(0);
+            if( timeElapsed <= g_fEpsilon ) {
+                rampndVectOut.resize(1);
+                rampndVectOut[0].Initialize(_parameters->GetDOF());
+                rampndVectOut[0].SetConstant(q0, 0);
+                rampndVectOut[0].SetV0Vect(dq0);
+                rampndVectOut[0].SetV1Vect(dq1);
+                return ConfigFeasible2(q0, dq0, options);
+            }
+
+            if( _bUsePerturbation ) {
+                options |= CFO_CheckWithPerturbation;
+            }
+            try {
+                int ret = _parameters->CheckPathAllConstraints(q0, q1, dq0, dq1, timeElapsed, IT_OpenStart, options, _constraintreturn);
+                if( ret != 0 ) {
+                    RampOptimizer::CheckReturn checkret(ret);
+                    if( ret == CFO_CheckTimeBasedConstraints ) {
+                        checkret.fTimeBasedSurpassMult = 0.98;
+                    }
+                    return checkret;
+                }
+            }
+            catch (const std::exception& ex) {
+                RAVELOG_WARN_FORMAT("env=%d, CheckPathAllConstraints threw an exception: %s", _envid%ex.what());
+                return RampOptimizer::CheckReturn(0xffff|CFO_FromTrajectorySmoother);
+            }
+
+            RampOptimizer::CheckReturn fixret = ParabolicSmoother2::_InitializeSegmentRampND(_cacheRampNDSeg, q0, q1, dq0, dq1, timeElapsed, *_parameters, _envid);
+            if( fixret.retcode != 0 ) {
+                return fixret;
+            }
+            rampndVectOut.push_back(_cacheRampNDSeg);
+            return RampOptimizer::CheckReturn(0);
+        }
+
+        virtual bool NeedDerivativeForFeasibility()
+        {
+            return true;
+        }
+
+        MyRampNDFeasibilityChecker _feasibilitychecker;
+
+private:
+        ConstraintTrajectoryTimingParametersPtr _parameters; ///< bound to the worker environment
+        ConstraintFilterReturnPtr _constraintreturn;
+        RampOptimizer::RampND _cacheRampNDSeg;
+        bool _bUsePerturbation;
+        int _envid; ///< id of the source environment, for logging
+    };
+    typedef boost::shared_ptr<ShortcutWorker> ShortcutWorkerPtr;
+
 public:
     ParabolicSmoother2(EnvironmentBasePtr penv, std::istream& sinput) : PlannerBase(penv), _feasibilitychecker(this)
     {
         __description = "";
         _bmanipconstraints = false;
+        _bUseFeasibilityMemo = false;
+        _bShortcutWorkersPrepared = false;
         _constraintreturn.reset(new ConstraintFilterReturn());
         _logginguniformsampler = RaveCreateSpaceSampler(GetEnv(), "mt19937");
         if (!!_logginguniformsampler) {
@@ -364,6 +471,10 @@ public:
         _environmentid = GetEnv()->GetId();
         _vVisitedDiscretizationCache.resize(0x1000*0x1000,0); // pre-allocate in order to keep memory growth predictable
         _feasibilitychecker.SetEnvID(_environmentid); // set envid for logging purpose
+        RegisterCommand("GetFeasibilityMemoStats",boost::bind(&ParabolicSmoother2::_GetFeasibilityMemoStatsCommand,this,_1,_2),
+                        "returns the hits, misses and entries of the feasibility memo since it was last cleared. The memo is cleared by InitPlan and by PlanPath when the environment changed.");
+        RegisterCommand("EvalParabolicPath",boost::bind(&ParabolicSmoother2::_EvalParabolicPathCommand,this,_1,_2),
+                        "evaluates a path of RampNDs at several times. The input is \"bulk|single ndof x0 v0 numrampnds duration a ... numtimes t ...\" where x0 and v0 are the initial state and every RampND is given by its duration and accelerations. Returns the numtimes*ndof positions, then the velocities, then the accelerations. bulk evaluates all the times with one call, single evaluates one time after another.");
     }
 
     virtual bool InitPlan(RobotBasePtr pbase, PlannerParametersConstPtr params)
@@ -392,6 +503,10 @@ public:
         _bmanipconstraints = (_parameters->manipname.size() > 0) && (_parameters->maxmanipspeed > 0 || _parameters->maxmanipaccel > 0);
         _feasibilitychecker.SetParameters(GetParameters());
 
+        // CheckPathAllConstraints can modify the segments when there are manip constraints, so only memoize the plain checks
+        _bUseFeasibilityMemo = !_bmanipconstraints && _parameters->fCosManipAngleThresh <= -1 + g_fEpsilonLinear;
+        _feasibilitymemo.Clear();
+
         _interpolator.Initialize(_parameters->GetDOF(), _environmentid);
 
         // Initialize workspace constraints on manipulators
@@ -483,6 +598,7 @@ public:
         }
 
         _basetime = utils::GetMilliTime();
+        _bShortcutWorkersPrepared = false;
 
         if( IS_DEBUGLEVEL(_dumplevel) ) {
             // Save parameters for planning
@@ -508,6 +624,9 @@ public:
         if( vusedbodies.size() == 0 ) {
             RAVELOG_WARN_FORMAT("env=%d, There is no used bodies in this configuration", _environmentid);
         }
+        if( _bUseFeasibilityMemo ) {
+            _feasibilitymemo.SetStamp(_ComputeFeasibilityMemoStamp(vusedbodies));
+        }
         FOREACH(itbody, vusedbodies) {
             KinBody::KinBodyStateSaverPtr statesaver;
             if( (*itbody)->IsRobot() ) {
@@ -725,7 +844,12 @@ public:
                     return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, Planning was interrupted")%_environmentid), PS_Interrupted);
                 }
 #endif
-                numShortcuts = _Shortcut(parabolicpath, parameters->_nMaxIterations, this, parameters->_fStepLength*0.99);
+                if( _CanShortcutParallel() ) {
+                    numShortcuts = _ShortcutParallel(parabolicpath, parameters->_nMaxIterations, this, parameters->_fStepLength*0.99);
+                }
+                else {
+                    numShortcuts = _Shortcut(parabolicpath, parameters->_nMaxIterations, this, parameters->_fStepLength*0.99);
+                }
 #ifdef SMOOTHER2_TIMING_DEBUG
                 _tShortcutEnd = utils::GetMicroTime();
 #endif
@@ -784,6 +908,12 @@ public:
             dReal fExpextedDuration = 0; // for consistency checking
             dReal durationDiscrepancyThresh = 0.01; // for consistency checking
 
+            // check the unchecked RampNDs on the workers first so that the loop below only has to fix the failing ones
+            std::vector<int> vParallelRetcodes;
+            if( _CanShortcutParallel() && _PrepareShortcutWorkers() ) {
+                _CheckRampNDsParallel(parabolicpath, fTrimEdgesTime, vParallelRetcodes);
+            }
+
             for (size_t irampnd = 0; irampnd < parabolicpath.GetRampNDVect().size(); ++irampnd) {
                 rampndTrimmed = parabolicpath.GetRampNDVect()[irampnd];
 
@@ -808,34 +938,17 @@ public:
                 if( !rampndTrimmed.constraintChecked ) {
                     bool bTrimmedFront = false;
                     bool bTrimmedBack = false;
-                    bool bCheck = true;
-                    if( irampnd == 0 ) {
-                        if( rampndTrimmed.GetDuration() <= fTrimEdgesTime + g_fEpsilonLinear ) {
-                            // The initial RampND is too short so ignore checking
-                            bCheck = false;
-                        }
-                        else {
-                            remRampND = rampndTrimmed;
-                            remRampND.Cut(fTrimEdgesTime, rampndTrimmed);
-                            bTrimmedFront = true;
-                        }
-                    }
-                    else if( irampnd + 1 == parabolicpath.GetRampNDVect().size() ) {
-                        if( rampndTrimmed.GetDuration() <= fTrimEdgesTime + g_fEpsilonLinear ) {
-                            // The final RampND is too short so ignore checking
-                            bCheck = false;
-                        }
-                        else {
-                            rampndTrimmed.Cut(rampndTrimmed.GetDuration() - fTrimEdgesTime, remRampND);
-                            bTrimmedBack = true;
-                        }
-                    }
+                    bool bCheck = _TrimRampNDEdges(irampnd, parabolicpath.GetRampNDVect().size(), fTrimEdgesTime, rampndTrimmed, remRampND, bTrimmedFront, bTrimmedBack);
 
                     _bUsePerturbation = false;
 
                     std::vector<RampOptimizer::RampND>& rampndVectOut = _cacheRampNDVectOut;
                     if( bCheck ) {
-                        RampOptimizer::CheckReturn checkret = _feasibilitychecker.Check2(rampndTrimmed, 0xffff|CFO_FromTrajectorySmoother, rampndVectOut);
+                        RampOptimizer::CheckReturn checkret(0);
+                        if( irampnd >= vParallelRetcodes.size() || vParallelRetcodes[irampnd] != 0 ) {
+                            // not checked on the workers or failed there, so the sequential check has to fix it
+                            checkret = _feasibilitychecker.Check2(rampndTrimmed, 0xffff|CFO_FromTrajectorySmoother, rampndVectOut);
+                        }
 #ifdef SMOOTHER2_TIMING_DEBUG
                         _nCallsCheckPathAllConstraints += _nCallsCheckPathAllConstraints_SegmentFeasible2;
                         _totalTimeCheckPathAllConstraints += _totalTimeCheckPathAllConstraints_SegmentFeasible2;
@@ -953,18 +1066,27 @@ public:
                     }
                 }// Finished checking constraints
 
-                waypoints.resize(newSpec.GetDOF());
-                FOREACH(itrampnd, tempRampNDVect) {
-                    fExpextedDuration += itrampnd->GetDuration();
-                    itrampnd->GetX1Vect(x1Vect);
-                    ConfigurationSpecification::ConvertData(waypoints.begin(), newSpec, x1Vect.begin(), posSpec, 1, GetEnv(), true);
-                    itrampnd->GetV1Vect(v1Vect);
-                    ConfigurationSpecification::ConvertData(waypoints.begin(), newSpec, v1Vect.begin(), velSpec, 1, GetEnv(), false);
-
-                    *(waypoints.begin() + timeOffset) = itrampnd->GetDuration();
-                    *(waypoints.begin() + waypointOffset) = 1;
-                    _pdummytraj->Insert(_pdummytraj->GetNumWaypoints(), waypoints);
-                }
+                // Gather the end points of all the rampnds so that they are converted and inserted with one call each
+                const size_t ndof = _parameters->GetDOF();
+                const size_t numWaypoints = tempRampNDVect.size();
+                std::vector<dReal>& vBatchPos = _cacheBatchPos, &vBatchVel = _cacheBatchVel;
+                vBatchPos.resize(numWaypoints*ndof);
+                vBatchVel.resize(numWaypoints*ndof);
+                for (size_t iwaypoint = 0; iwaypoint < numWaypoints; ++iwaypoint) {
+                    const RampOptimizer::RampND& rampnd = tempRampNDVect[iwaypoint];
+                    const dReal duration = rampnd.GetDuration();
+                    fExpextedDuration += duration;
+                    rampnd.EvalPos(&duration, 1, 0, &vBatchPos[iwaypoint*ndof]);
+                    rampnd.EvalVel(&duration, 1, 0, &vBatchVel[iwaypoint*ndof]);
+                }
+                waypoints.resize(numWaypoints*newSpec.GetDOF());
+                ConfigurationSpecification::ConvertData(waypoints.begin(), newSpec, vBatchPos.begin(), posSpec, numWaypoints, GetEnv(), true);
+                ConfigurationSpecification::ConvertData(waypoints.begin(), newSpec, vBatchVel.begin(), velSpec, numWaypoints, GetEnv(), false);
+                for (size_t iwaypoint = 0; iwaypoint < numWaypoints; ++iwaypoint) {
+                    *(waypoints.begin() + iwaypoint*newSpec.GetDOF() + timeOffset) = tempRampNDVect[iwaypoint].GetDuration();
+                    *(waypoints.begin() + iwaypoint*newSpec.GetDOF() + waypointOffset) = 1;
+                }
+                _pdummytraj->Insert(_pdummytraj->GetNumWaypoints(), waypoints);
 
                 if( IS_DEBUGLEVEL(Level_Verbose) ) {
                     // If verbose, do tighter bound checking
@@ -997,6 +1119,9 @@ public:
         }
         _DumpTrajectory(ptraj, _dumplevel);
 
+        if( _bUseFeasibilityMemo ) {
+            RAVELOG_DEBUG_FORMAT("env=%d, feasibility memo hits=%d, misses=%d, entries=%d", _environmentid%_feasibilitymemo.GetNumHits()%_feasibilitymemo.GetNumMisses()%_feasibilitymemo.GetNumEntries());
+        }
 #ifdef SMOOTHER2_TIMING_DEBUG
         dReal tTotalShortcutTime = 0.000001f*(float)(_tShortcutEnd - _tShortcutStart);
         RAVELOG_INFO_FORMAT("env=%d, shortcutting time=%.15e; iter=%d; time/iter=%.15e", _environmentid%tTotalShortcutTime%_numShortcutIters%(tTotalShortcutTime/_numShortcutIters));
@@ -1013,8 +1138,15 @@ public:
         if( _bUsePerturbation ) {
             options |= CFO_CheckWithPerturbation;
         }
+        if( _bUseFeasibilityMemo && _feasibilitymemo.FindConfig(q0, dq0, options) ) {
+            return 0;
+        }
         try {
-            return _parameters->CheckPathAllConstraints(q0, q0, dq0, dq0, 0, IT_OpenStart, options);
+            int ret = _parameters->CheckPathAllConstraints(q0, q0, dq0, dq0, 0, IT_OpenStart, options);
+            if( ret == 0 && _bUseFeasibilityMemo ) {
+                _feasibilitymemo.InsertConfig(q0, dq0, options);
+            }
+            return ret;
         }
         catch (const std::exception& ex) {
             RAVELOG_WARN_FORMAT("env=%d, CheckPathAllConstraints threw an exception: %s", _environmentid%ex.what());
@@ -1030,6 +1162,9 @@ public:
         if( _bUsePerturbation ) {
             options |= CFO_CheckWithPerturbation;
         }
+        if( _bUseFeasibilityMemo && _feasibilitymemo.FindConfig(q0, dq0, options) ) {
+            return RampOptimizer::CheckReturn(0);
+        }
         try {
 #ifdef SMOOTHER2_TIMING_DEBUG
             _nCallsCheckPathAllConstraints_SegmentFeasible2 += 1;
@@ -1040,6 +1175,9 @@ public:
             _tEndCheckPathAllConstraints = utils::GetMicroTime();
             _totalTimeCheckPathAllConstraints_SegmentFeasible2 += 0.000001f*(float)(_tEndCheckPathAllConstraints - _tStartCheckPathAllConstraints);
 #endif
+            if( ret == 0 && _bUseFeasibilityMemo ) {
+                _feasibilitymemo.InsertConfig(q0, dq0, options);
+            }
             RampOptimizer::CheckReturn checkret(ret);
             if( ret == CFO_CheckTimeBasedConstraints ) {
                 checkret.fTimeBasedSurpassMult = 0.98;
@@ -1052,6 +1190,49 @@ public:
         }
     }
 
+    /// \brief initializes rampnd to interpolate (x0, v0) and (x1, v1) in duration and clamps its accelerations to the limits of parameters.
+    ///
+    /// Used by SegmentFeasible2 and ShortcutWorker::SegmentFeasible2 after the segment passed CheckPathAllConstraints.
+    /// \return 0 if rampnd is valid after the clamping, otherwise the CheckReturn SegmentFeasible2 should return
+    static RampOptimizer::CheckReturn _InitializeSegmentRampND(RampOptimizer::RampND& rampnd, const std::vector<dReal>& x0, const std::vector<dReal>& x1, const std::vector<dReal>& v0, const std::vector<dReal>& v1, dReal duration, const ConstraintTrajectoryTimingParameters& parameters, int envid)
+    {
+        rampnd.Initialize(x0, x1, v0, v1, std::vector<dReal>(), duration);
+        bool bAccelChanged = false;
+        for (size_t idof = 0; idof < x0.size(); ++idof) {
+            if( rampnd.GetAAt(idof) < -parameters._vConfigAccelerationLimit[idof] ) {
+                RAVELOG_VERBOSE_FORMAT("env=%d, idof=%d, accel changed: %.15e --> %.15e; diff=%.15e", envid%idof%rampnd.GetAAt(idof)%(-parameters._vConfigAccelerationLimit[idof])%(rampnd.GetAAt(idof) + parameters._vConfigAccelerationLimit[idof]));
+                rampnd.GetAAt(idof) = -parameters._vConfigAccelerationLimit[idof];
+                bAccelChanged = true;
+            }
+            else if( rampnd.GetAAt(idof) > parameters._vConfigAccelerationLimit[idof] ) {
+                RAVELOG_VERBOSE_FORMAT("env=%d, idof=%d, accel changed: %.15e --> %.15e; diff=%.15e", envid%idof%rampnd.GetAAt(idof)%(parameters._vConfigAccelerationLimit[idof])%(rampnd.GetAAt(idof) - parameters._vConfigAccelerationLimit[idof]));
+                rampnd.GetAAt(idof) = parameters._vConfigAccelerationLimit[idof];
+                bAccelChanged = true;
+            }
+        }
+        if( bAccelChanged ) { // Make sure the modification is valid
+            RampOptimizer::ParabolicCheckReturn parabolicret = RampOptimizer::CheckRampND(rampnd, parameters._vConfigLowerLimit, parameters._vConfigUpperLimit, parameters._vConfigVelocityLimit, parameters._vConfigAccelerationLimit);
+            if( parabolicret != RampOptimizer::PCR_Normal ) {
+                std::stringstream ss;
+                ss << std::setprecision(std::numeric_limits<dReal>::digits10 + 1);
+                ss << "x0 = [";
+                SerializeValues(ss, x0);
+                ss << "]; x1 = [";
+                SerializeValues(ss, x1);
+                ss << "]; v0 = [";
+                SerializeValues(ss, v0);
+                ss << "]; v1 = [";
+                SerializeValues(ss, v1);
+                ss << "]; deltatime = " << duration;
+
+                RAVELOG_WARN_FORMAT("env=%d, the output RampND becomes invalid (ret=%x) after fixing accelerations. %s", envid%parabolicret%ss.str());
+                return RampOptimizer::CheckReturn(CFO_CheckTimeBasedConstraints, 0.9);
+            }
+        }
+        rampnd.constraintChecked = true;
+        return RampOptimizer::CheckReturn(0);
+    }
+
     /// \brief Check if the segment interpolating (q0, dq0) and (q1, dq1) is feasible. The function
     /// first calls CheckPathAllConstraints to check all constraints. Since the input path may be
     /// modified from inside CheckPathAllConstraints, after the checking this function also try to
@@ -1111,12 +1292,16 @@ public:
             rampndVectOut.resize(0);
         }
 
+        // the memo is only used when the segment cannot be modified, so a memoized segment only needs the acceleration fixing below.
+        // it does not store the checked configurations, so it cannot be used when the caller wants them (lazy collision checking)
+        bool bUseMemo = _bUseFeasibilityMemo && !(options & CFO_FillCheckedConfiguration);
+        bool bMemoized = bUseMemo && _feasibilitymemo.FindSegment(q0, q1, dq0, dq1, timeElapsed, options);
         try {
 #ifdef SMOOTHER2_TIMING_DEBUG
             _nCallsCheckPathAllConstraints_SegmentFeasible2 += 1;
             _tStartCheckPathAllConstraints = utils::GetMicroTime();
 #endif
-            int ret = _parameters->CheckPathAllConstraints(q0, q1, dq0, dq1, timeElapsed, IT_OpenStart, options, _constraintreturn);
+            int ret = bMemoized ? 0 : _parameters->CheckPathAllConstraints(q0, q1, dq0, dq1, timeElapsed, IT_OpenStart, options, _constraintreturn);
 #ifdef SMOOTHER2_TIMING_DEBUG
             _tEndCheckPathAllConstraints = utils::GetMicroTime();
             _totalTimeCheckPathAllConstraints_SegmentFeasible2 += 0.000001f*(float)(_tEndCheckPathAllConstraints - _tStartCheckPathAllConstraints);
@@ -1136,6 +1321,9 @@ public:
                 }
                 return checkret;
             }
+            if( bUseMemo && !bMemoized ) {
+                _feasibilitymemo.InsertSegment(q0, q1, dq0, dq1, timeElapsed, options);
+            }
         }
         catch (const std::exception& ex) {
             RAVELOG_WARN_FORMAT("env=%d, CheckPathAllConstraints threw an exception: %s", _environmentid%ex.what());
@@ -1187,44 +1375,11 @@ public:
                         return RampOptimizer::CheckReturn(CFO_CheckTimeBasedConstraints, vdofscaling);
                     }
 
-                    // The computed next velocity is fine.
-                    _cacheRampNDSeg.Initialize(curPos, newPos, curVel, newVel, std::vector<dReal>(), deltaTime);
-
-                    // Now check the acceleration
-                    bool bAccelChanged = false;
-                    for (size_t idof = 0; idof < ndof; ++idof) {
-                        if( _cacheRampNDSeg.GetAAt(idof) < -_parameters->_vConfigAccelerationLimit[idof] ) {
-                            RAVELOG_VERBOSE_FORMAT("env=%d, idof=%d, accel changed: %.15e --> %.15e; diff=%.15e", _environmentid%idof%_cacheRampNDSeg.GetAAt(idof)%(-_parameters->_vConfigAccelerationLimit[idof])%(_cacheRampNDSeg.GetAAt(idof) + _parameters->_vConfigAccelerationLimit[idof]));
-                            _cacheRampNDSeg.GetAAt(idof) = -_parameters->_vConfigAccelerationLimit[idof];
-                            bAccelChanged = true;
-                        }
-                        else if( _cacheRampNDSeg.GetAAt(idof) > _parameters->_vConfigAccelerationLimit[idof] ) {
-                            RAVELOG_VERBOSE_FORMAT("env=%d, idof=%d, accel changed: %.15e --> %.15e; diff=%.15e", _environmentid%idof%_cacheRampNDSeg.GetAAt(idof)%(_parameters->_vConfigAccelerationLimit[idof])%(_cacheRampNDSeg.GetAAt(idof) - _parameters->_vConfigAccelerationLimit[idof]));
-                            _cacheRampNDSeg.GetAAt(idof) = _parameters->_vConfigAccelerationLimit[idof];
-                            bAccelChanged = true;
-                        }
+                    // The computed next velocity is fine. Now check the acceleration
+                    RampOptimizer::CheckReturn fixret = _InitializeSegmentRampND(_cacheRampNDSeg, curPos, newPos, curVel, newVel, deltaTime, *_parameters, _environmentid);
+                    if( fixret.retcode != 0 ) {
+                        return fixret;
                     }
-                    if( bAccelChanged ) {
-                        RampOptimizer::ParabolicCheckReturn parabolicret = RampOptimizer::CheckRampND(_cacheRampNDSeg, _parameters->_vConfigLowerLimit, _parameters->_vConfigUpperLimit, _parameters->_vConfigVelocityLimit, _parameters->_vConfigAccelerationLimit);
-                        if( parabolicret != RampOptimizer::PCR_Normal ) {
-                            std::stringstream ss;
-                            ss << std::setprecision(std::numeric_limits<dReal>::digits10 + 1);
-                            ss << "x0 = [";
-                            SerializeValues(ss, curPos);
-                            ss << "]; x1 = [";
-                            SerializeValues(ss, newPos);
-                            ss << "]; v0 = [";
-                            SerializeValues(ss, curVel);
-                            ss << "]; v1 = [";
-                            SerializeValues(ss, newVel);
-                            ss << "]; deltatime = " << deltaTime;
-
-                            RAVELOG_WARN_FORMAT("env=%d, the output RampND becomes invalid (ret=%x) after fixing accelerations. %s", _environmentid%parabolicret%ss.str());
-                            return RampOptimizer::CheckReturn(CFO_CheckTimeBasedConstraints, 0.9);
-                        }
-                    }
-                    _cacheRampNDSeg.constraintChecked = true;
-
                     rampndVectOut.push_back(_cacheRampNDSeg);
                     curTime = _constraintreturn->_configurationtimes[itime];
                     curPos.swap(newPos);
@@ -1240,7 +1395,7 @@ public:
                 }
             }
         }
-        else if( _constraintreturn->_configurationtimes.size() > 0 ) {
+        else if( !bMemoized && _constraintreturn->_configurationtimes.size() > 0 ) {
             // No manip tool direction constraint but CFO_FillCheckedConfiguration is enabled. We do
             // this because we want to keep the intermediate configurations for collision checking
             // at a later stage.
@@ -1248,40 +1403,10 @@ public:
         }
 
         if( rampndVectOut.size() == 0 ) {
-            _cacheRampNDSeg.Initialize(q0, q1, dq0, dq1, std::vector<dReal>(), timeElapsed);
-            // Now check the acceleration
-            bool bAccelChanged = false;
-            for (size_t idof = 0; idof < ndof; ++idof) {
-                if( _cacheRampNDSeg.GetAAt(idof) < -_parameters->_vConfigAccelerationLimit[idof] ) {
-                    _cacheRampNDSeg.GetAAt(idof) = -_parameters->_vConfigAccelerationLimit[idof];
-                    bAccelChanged = true;
-                }
-                else if( _cacheRampNDSeg.GetAAt(idof) > _parameters->_vConfigAccelerationLimit[idof] ) {
-                    _cacheRampNDSeg.GetAAt(idof) = _parameters->_vConfigAccelerationLimit[idof];
-                    bAccelChanged = true;
-                }
+            RampOptimizer::CheckReturn fixret = _InitializeSegmentRampND(_cacheRampNDSeg, q0, q1, dq0, dq1, timeElapsed, *_parameters, _environmentid);
+            if( fixret.retcode != 0 ) {
+                return fixret;
             }
-            if( bAccelChanged ) { // Make sure the modification is valid
-                RampOptimizer::ParabolicCheckReturn parabolicret = RampOptimizer::CheckRampND(_cacheRampNDSeg, _parameters->_vConfigLowerLimit, _parameters->_vConfigUpperLimit, _parameters->_vConfigVelocityLimit, _parameters->_vConfigAccelerationLimit);
-                if( parabolicret != RampOptimizer::PCR_Normal ) {
-                    std::stringstream ss;
-                    std::string separator = "";
-                    ss << std::setprecision(std::numeric_limits<dReal>::digits10 + 1);
-                    ss << "x0 = [";
-                    SerializeValues(ss, q0);
-                    ss << "]; x1 = [";
-                    SerializeValues(ss, q1);
-                    ss << "]; v0 = [";
-                    SerializeValues(ss, dq0);
-                    ss << "]; v1 = [";
-                    SerializeValues(ss, dq1);
-                    ss << "]; deltatime = " << timeElapsed;
-
-                    RAVELOG_WARN_FORMAT("env=%d, the output RampND becomes invalid (ret=%x) after fixing accelerations. %s", _environmentid%parabolicret%ss.str());
-                    return RampOptimizer::CheckReturn(CFO_CheckTimeBasedConstraints, 0.9);
-                }
-            }
-            _cacheRampNDSeg.constraintChecked = true;
             rampndVectOut.push_back(_cacheRampNDSeg);
         }
 
@@ -3246,25 +3371,7 @@ protected:
                     segmentTime += itrampnd->GetDuration();
                 }
                 dReal diff = (t1 - t0) - segmentTime;
-
-                size_t writeIndex = 0;
-                for( size_t readIndex = 0; readIndex < _vZeroVelPointInfos.size(); ++readIndex ) {
-                    if( _vZeroVelPointInfos[readIndex].point <= t0 ) {
-                        writeIndex += 1;
-                    }
-                    else if( _vZeroVelPointInfos[readIndex].point <= t1 ) {
-                        // Do nothing.
-                    }
-                    else {
-                        // Update all zero-velocity points after t1
-                        _vZeroVelPointInfos[writeIndex] = _vZeroVelPointInfos[readIndex];
-                        _vZeroVelPointInfos[writeIndex].point -= diff;
-                        _vZeroVelPointInfos[writeIndex].leftneighbor -= diff;
-                        _vZeroVelPointInfos[writeIndex].rightneighbor -= diff;
-                        writeIndex += 1;
-                    }
-                }
-                _vZeroVelPointInfos.resize(writeIndex);
+                _UpdateZeroVelPointsAfterShortcut(t0, t1, diff);
 
                 // Keep track of the multipliers
                 fStartTimeVelMult = min(1.0, fCurVelMult * fiSearchVelAccelMult);
@@ -3341,6 +3448,475 @@ protected:
         return numShortcuts;
     }
 
+    /// \brief computes the stamp of the environment state that the feasibility memo depends on.
+    ///
+    /// Covers the collision options, the used bodies including their geometry except for their planned dof values, bodies grabbed
+    /// by them relative to their grabbing links, and the update stamps (which change with geometry) and enable states of all the other bodies.
+    size_t _ComputeFeasibilityMemoStamp(const std::vector<KinBodyPtr>& vusedbodies) const
+    {
+        size_t stamp = 0;
+        CollisionCheckerBasePtr pchecker = GetEnv()->GetCollisionChecker();
+        if( !!pchecker ) {
+            boost::hash_combine(stamp, pchecker->GetCollisionOptions());
+        }
+
+        std::vector<KinBodyPtr> vgrabbed, vallgrabbed;
+        std::vector<int> vuseddofindices, vusedconfigindices;
+        std::vector<dReal> vdofvalues;
+        FOREACHC(itbody, vusedbodies) {
+            const KinBodyPtr& pbody = *itbody;
+            boost::hash_combine(stamp, pbody->GetEnvironmentId());
+            boost::hash_combine(stamp, pbody->GetKinematicsGeometryHash());
+            _HashTransform(stamp, pbody->GetTransform());
+            _parameters->_configurationspecification.ExtractUsedIndices(pbody, vuseddofindices, vusedconfigindices);
+            pbody->GetDOFValues(vdofvalues);
+            for(size_t idof = 0; idof < vdofvalues.size(); ++idof) {
+                if( find(vuseddofindices.begin(), vuseddofindices.end(), (int)idof) == vuseddofindices.end() ) {
+                    boost::hash_combine(stamp, vdofvalues[idof]);
+                }
+            }
+            FOREACHC(itlink, pbody->GetLinks()) {
+                boost::hash_combine(stamp, (*itlink)->IsEnabled());
+            }
+
+            // grabbed bodies move with the planned dofs, so only their relative pose matters
+            pbody->GetGrabbed(vgrabbed);
+            FOREACHC(itgrabbed, vgrabbed) {
+                KinBody::LinkPtr pgrabbinglink = pbody->IsGrabbing(**itgrabbed);
+                boost::hash_combine(stamp, (*itgrabbed)->GetEnvironmentId());
+                boost::hash_combine(stamp, (*itgrabbed)->IsEnabled());
+                boost::hash_combine(stamp, (*itgrabbed)->GetKinematicsGeometryHash());
+                if( !!pgrabbinglink ) {
+                    boost::hash_combine(stamp, pgrabbinglink->GetIndex());
+                    _HashTransform(stamp, pgrabbinglink->GetTransform().inverse()*(*itgrabbed)->GetTransform());
+                }
+            }
+            vallgrabbed.insert(vallgrabbed.end(), vgrabbed.begin(), vgrabbed.end());
+        }
+
+        std::vector<KinBodyPtr> vbodies;
+        GetEnv()->GetBodies(vbodies);
+        FOREACHC(itbody, vbodies) {
+            if( find(vusedbodies.begin(), vusedbodies.end(), *itbody) != vusedbodies.end() || find(vallgrabbed.begin(), vallgrabbed.end(), *itbody) != vallgrabbed.end() ) {
+                continue;
+            }
+            boost::hash_combine(stamp, (*itbody)->GetEnvironmentId());
+            boost::hash_combine(stamp, (*itbody)->GetUpdateStamp());
+            boost::hash_combine(stamp, (*itbody)->IsEnabled());
+        }
+        return stamp;
+    }
+
+    bool _GetFeasibilityMemoStatsCommand(std::ostream& sout, std::istream& sinput)
+    {
+        sout << _feasibilitymemo.GetNumHits() << " " << _feasibilitymemo.GetNumMisses() << " " << _feasibilitymemo.GetNumEntries();
+        return true;
+    }
+
+    bool _EvalParabolicPathCommand(std::ostream& sout, std::istream& sinput)
+    {
+        std::string mode;
+        size_t ndof = 0, numrampnds = 0, numtimes = 0;
+        sinput >> mode >> ndof;
+        std::vector<dReal> x0Vect(ndof), x1Vect(ndof), v0Vect(ndof), v1Vect(ndof), aVect(ndof);
+        FOREACH(it, x0Vect) {
+            sinput >> *it;
+        }
+        FOREACH(it, v0Vect) {
+            sinput >> *it;
+        }
+        sinput >> numrampnds;
+        RampOptimizer::ParabolicPath parabolicpath;
+        for (size_t irampnd = 0; irampnd < numrampnds && !!sinput; ++irampnd) {
+            dReal duration = 0;
+            sinput >> duration;
+            for (size_t idof = 0; idof < ndof; ++idof) {
+                sinput >> aVect[idof];
+                x1Vect[idof] = x0Vect[idof] + duration*(v0Vect[idof] + 0.5*duration*aVect[idof]);
+                v1Vect[idof] = v0Vect[idof] + duration*aVect[idof];
+            }
+            RampOptimizer::RampND rampnd(x0Vect, x1Vect, v0Vect, v1Vect, aVect, duration);
+            parabolicpath.AppendRampND(rampnd);
+            x0Vect.swap(x1Vect);
+            v0Vect.swap(v1Vect);
+        }
+        sinput >> numtimes;
+        std::vector<dReal> vtimes(numtimes);
+        FOREACH(it, vtimes) {
+            sinput >> *it;
+        }
+        if( !sinput || ndof == 0 || numrampnds == 0 ) {
+            return false;
+        }
+
+        std::vector<dReal> vpos, vvel, vacc;
+        if( mode == "bulk" ) {
+            parabolicpath.EvalPos(vtimes, vpos);
+            parabolicpath.EvalVel(vtimes, vvel);
+            parabolicpath.EvalAcc(vtimes, vacc);
+        }
+        else if( mode == "single" ) {
+            std::vector<dReal> vsample(ndof);
+            FOREACH(ittime, vtimes) {
+                parabolicpath.EvalPos(*ittime, vsample);
+                vpos.insert(vpos.end(), vsample.begin(), vsample.end());
+                parabolicpath.EvalVel(*ittime, vsample);
+                vvel.insert(vvel.end(), vsample.begin(), vsample.end());
+                parabolicpath.EvalAcc(*ittime, vsample);
+                vacc.insert(vacc.end(), vsample.begin(), vsample.end());
+            }
+        }
+        else {
+            return false;
+        }
+        sout << std::setprecision(std::numeric_limits<dReal>::digits10+1);
+        SerializeValues(sout, vpos, ' ');
+        sout << " ";
+        SerializeValues(sout, vvel, ' ');
+        sout << " ";
+        SerializeValues(sout, vacc, ' ');
+        return true;
+    }
+
+    static void _HashTransform(size_t& stamp, const Transform& t)
+    {
+        for(int i = 0; i < 4; ++i) {
+            boost::hash_combine(stamp, t.rot[i]);
+        }
+        for(int i = 0; i < 3; ++i) {
+            boost::hash_combine(stamp, t.trans[i]);
+        }
+    }
+
+    /// \brief removes the zero-velocity points inside [t0, t1] and moves the ones after t1 by the time saved by the shortcut
+    void _UpdateZeroVelPointsAfterShortcut(dReal t0, dReal t1, dReal diff)
+    {
+        size_t writeIndex = 0;
+        for( size_t readIndex = 0; readIndex < _vZeroVelPointInfos.size(); ++readIndex ) {
+            if( _vZeroVelPointInfos[readIndex].point <= t0 ) {
+                writeIndex += 1;
+            }
+            else if( _vZeroVelPointInfos[readIndex].point <= t1 ) {
+                // Do nothing.
+            }
+            else {
+                // Update all zero-velocity points after t1
+                _vZeroVelPointInfos[writeIndex] = _vZeroVelPointInfos[readIndex];
+                _vZeroVelPointInfos[writeIndex].point -= diff;
+                _vZeroVelPointInfos[writeIndex].leftneighbor -= diff;
+                _vZeroVelPointInfos[writeIndex].rightneighbor -= diff;
+                writeIndex += 1;
+            }
+        }
+        _vZeroVelPointInfos.resize(writeIndex);
+    }
+
+    /// \brief true if shortcut candidates can be checked with _ShortcutParallel.
+    ///
+    /// Candidates that violate time-based constraints are rejected instead of being slowed down, so manip constraints keep using _Shortcut.
+    bool _CanShortcutParallel() const
+    {
+        return _parameters->nshortcutworkers > 0 && !_bmanipconstraints && _parameters->fCosManipAngleThresh <= -1 + g_fEpsilonLinear;
+    }
+
+    /// \brief makes sure there is a synchronized worker environment with its own parameters for every shortcut worker.
+    ///
+    /// The worker environments are kept across plans. The worker parameters are only rebuilt when the worker environments were recloned
+    /// or the parameters of the plan differ from the ones the workers were built with, so consecutive plans with the same parameters
+    /// in an unchanged environment only pay for the stamp check of the pool.
+    /// \return false if the workers cannot be used
+    bool _PrepareShortcutWorkers()
+    {
+        if( _bShortcutWorkersPrepared ) {
+            return !!_shortcutpool;
+        }
+        _bShortcutWorkersPrepared = true;
+        int nworkers = _parameters->nshortcutworkers;
+        try {
+            bool bRebuildParameters = true;
+            std::stringstream ssparameters;
+            ssparameters << std::setprecision(std::numeric_limits<dReal>::digits10+1) << *_parameters;
+            if( !_shortcutpool || _shortcutpool->GetNumWorkers() != nworkers ) {
+                _vshortcutworkers.clear();
+                _shortcutpool.reset(new planningutils::PlannerParametersWorkerPool(GetEnv(), PlannerParametersConstPtr(), nworkers));
+            }
+            else if( !_shortcutpool->Synchronize() ) {
+                bRebuildParameters = (int)_vshortcutworkers.size() != nworkers || ssparameters.str() != _sShortcutWorkersParameters;
+            }
+            if( !bRebuildParameters ) {
+                FOREACH(itworker, _vshortcutworkers) {
+                    (*itworker)->SetUsePerturbation(_bUsePerturbation);
+                    (*itworker)->_feasibilitychecker.tol = _feasibilitychecker.tol;
+                    (*itworker)->_feasibilitychecker.constraintmask = _feasibilitychecker.constraintmask;
+                }
+                return true;
+            }
+            _sShortcutWorkersParameters = ssparameters.str();
+            _vshortcutworkers.resize(nworkers);
+            for(int iworker = 0; iworker < nworkers; ++iworker) {
+                EnvironmentBasePtr pworkerenv = _shortcutpool->GetWorkerEnv(iworker);
+                EnvironmentMutex::scoped_lock lockworker(pworkerenv->GetMutex());
+                ConstraintTrajectoryTimingParametersPtr workerparameters(new ConstraintTrajectoryTimingParameters());
+                workerparameters->copy(_parameters);
+                workerparameters->SetConfigurationSpecification(pworkerenv, _parameters->_configurationspecification);
+                // limits could have been changed after the parameters were setup, so keep them
+                workerparameters->_vConfigLowerLimit = _parameters->_vConfigLowerLimit;
+                workerparameters->_vConfigUpperLimit = _parameters->_vConfigUpperLimit;
+                workerparameters->_vConfigVelocityLimit = _parameters->_vConfigVelocityLimit;
+                workerparameters->_vConfigAccelerationLimit = _parameters->_vConfigAccelerationLimit;
+                workerparameters->_vConfigResolution = _parameters->_vConfigResolution;
+                if( !_vshortcutworkers[iworker] ) {
+                    _vshortcutworkers[iworker].reset(new ShortcutWorker());
+                }
+                _vshortcutworkers[iworker]->Init(workerparameters, _feasibilitychecker, _bUsePerturbation, _environmentid);
+            }
+        }
+        catch (const std::exception& ex) {
+            RAVELOG_WARN_FORMAT("env=%d, failed to prepare %d shortcut workers, so shortcutting sequentially: %s", _environmentid%nworkers%ex.what());
+            _vshortcutworkers.clear();
+            _sShortcutWorkersParameters.clear();
+            _shortcutpool.reset();
+            return false;
+        }
+        return true;
+    }
+
+    struct ShortcutCandidate
+    {
+        ShortcutCandidate() : t0(0), t1(0), retcode(0) {
+        }
+        dReal t0, t1;
+        std::vector<RampOptimizer::RampND> vrampnd; ///< interpolated shortcut
+        std::vector<RampOptimizer::RampND> vrampndOut; ///< shortcut after being checked
+        int retcode;
+    };
+
+    /// \brief cuts the parts of the first and last RampND of the final path that are not checked, see fTrimEdgesTime in PlanPath.
+    ///
+    /// \param remRampND the cut part if any
+    /// \return false if the RampND is too short to be checked at all
+    static bool _TrimRampNDEdges(size_t irampnd, size_t numrampnds, dReal fTrimEdgesTime, RampOptimizer::RampND& rampndTrimmed, RampOptimizer::RampND& remRampND, bool& bTrimmedFront, bool& bTrimmedBack)
+    {
+        bTrimmedFront = false;
+        bTrimmedBack = false;
+        if( irampnd == 0 ) {
+            if( rampndTrimmed.GetDuration() <= fTrimEdgesTime + g_fEpsilonLinear ) {
+                // The initial RampND is too short so ignore checking
+                return false;
+            }
+            remRampND = rampndTrimmed;
+            remRampND.Cut(fTrimEdgesTime, rampndTrimmed);
+            bTrimmedFront = true;
+        }
+        else if( irampnd + 1 == numrampnds ) {
+            if( rampndTrimmed.GetDuration() <= fTrimEdgesTime + g_fEpsilonLinear ) {
+                // The final RampND is too short so ignore checking
+                return false;
+            }
+            rampndTrimmed.Cut(rampndTrimmed.GetDuration() - fTrimEdgesTime, remRampND);
+            bTrimmedBack = true;
+        }
+        return true;
+    }
+
+    /// \brief checks all the RampNDs of the final path that are not constraintChecked concurrently on the shortcut workers.
+    ///
+    /// The RampNDs are checked the same way as the sequential final check does, so failing ones can be fixed by it afterwards.
+    /// \param vretcodes for every RampND the return code of the check, or -1 if it was not checked on the workers
+    void _CheckRampNDsParallel(const RampOptimizer::ParabolicPath& parabolicpath, dReal fTrimEdgesTime, std::vector<int>& vretcodes)
+    {
+        const std::vector<RampOptimizer::RampND>& rampndVect = parabolicpath.GetRampNDVect();
+        vretcodes.assign(rampndVect.size(), -1);
+        std::vector<size_t> vcheckindices;
+        for (size_t irampnd = 0; irampnd < rampndVect.size(); ++irampnd) {
+            if( !rampndVect[irampnd].constraintChecked ) {
+                vcheckindices.push_back(irampnd);
+            }
+        }
+        if( vcheckindices.size() < 2 ) {
+            return;
+        }
+
+        // the final check does not use perturbation
+        FOREACH(itworker, _vshortcutworkers) {
+            (*itworker)->SetUsePerturbation(false);
+        }
+        try {
+            _shortcutpool->Evaluate((int)vcheckindices.size(), [&](int iworker, int icheck) {
+                size_t irampnd = vcheckindices[icheck];
+                RampOptimizer::RampND rampndTrimmed = rampndVect[irampnd], remRampND;
+                bool bTrimmedFront, bTrimmedBack;
+                if( !_TrimRampNDEdges(irampnd, rampndVect.size(), fTrimEdgesTime, rampndTrimmed, remRampND, bTrimmedFront, bTrimmedBack) ) {
+                    vretcodes[irampnd] = 0;
+                    return 0;
+                }
+                std::vector<RampOptimizer::RampND> rampndVectOut;
+                vretcodes[irampnd] = _vshortcutworkers.at(iworker)->_feasibilitychecker.Check2(rampndTrimmed, 0xffff|CFO_FromTrajectorySmoother, rampndVectOut).retcode;
+                return 0; // failing RampNDs are fixed sequentially, so do not cancel the others
+            });
+        }
+        catch (const std::exception& ex) {
+            RAVELOG_WARN_FORMAT("env=%d, failed to check %d RampNDs on the workers, so checking sequentially: %s", _environmentid%vcheckindices.size()%ex.what());
+            vretcodes.assign(rampndVect.size(), -1);
+        }
+        FOREACH(itworker, _vshortcutworkers) {
+            (*itworker)->SetUsePerturbation(_bUsePerturbation);
+        }
+    }
+
+    /// \brief speculative version of _Shortcut that checks several shortcut candidates concurrently on the worker environments.
+    ///
+    /// Every round samples nshortcutcandidates (t0, t1) pairs from rng and interpolates them on the calling thread. The candidates are then checked on the workers and the feasible one saving the most time replaces its segment.
+    /// Each check only depends on its own candidate, so for a given random seed the result does not depend on the number of workers or on the thread timing.
+    /// \return the number of successful shortcuts or -1 if interrupted
+    int _ShortcutParallel(RampOptimizer::ParabolicPath& parabolicpath, int numIters, RampOptimizer::RandomNumberGeneratorBase* rng, dReal minTimeStep)
+    {
+        if( !_PrepareShortcutWorkers() ) {
+            return _Shortcut(parabolicpath, numIters, rng, minTimeStep);
+        }
+
+        int numShortcuts = 0;
+        const int numCandidates = max(1, _parameters->nshortcutcandidates);
+        const size_t ndof = _parameters->GetDOF();
+        std::vector<dReal>& x0Vect = _cacheX0Vect, &x1Vect = _cacheX1Vect, &v0Vect = _cacheV0Vect, &v1Vect = _cacheV1Vect;
+        std::vector<dReal> vsampletimes, vsamplepos, vsamplevel; // t0 and t1 of every sampled candidate and the states at them
+        const dReal tOriginal = parabolicpath.GetDuration();
+        dReal tTotal = tOriginal;
+        size_t nItersFromPrevSuccessful = 0;
+        size_t nCutoffIters = std::max(_parameters->nshortcutcycles, min(100, numIters/2));
+
+        std::vector<ShortcutCandidate> vcandidates;
+        vcandidates.reserve(numCandidates);
+        int iters = 0;
+        while( iters < numIters && tTotal >= minTimeStep && nItersFromPrevSuccessful <= nCutoffIters ) {
+            // sample all the candidates of this round first so that their end states are evaluated with one pass over the path
+            vsampletimes.resize(0);
+            for(int icandidate = 0; icandidate < numCandidates && iters < numIters; ++icandidate, ++iters) {
+                ++nItersFromPrevSuccessful;
+                dReal t0, t1;
+                if( iters == 0 ) {
+                    t0 = 0;
+                    t1 = tTotal;
+                }
+                else {
+                    t0 = rng->Rand()*tTotal;
+                    t1 = rng->Rand()*tTotal;
+                    if( t0 > t1 ) {
+                        RampOptimizer::Swap(t0, t1);
+                    }
+                }
+                if( t1 - t0 < minTimeStep ) {
+                    continue;
+                }
+                vsampletimes.push_back(t0);
+                vsampletimes.push_back(t1);
+            }
+            if( vsampletimes.size() > 0 ) {
+                parabolicpath.EvalPos(vsampletimes, vsamplepos);
+                parabolicpath.EvalVel(vsampletimes, vsamplevel);
+            }
+
+            // interpolate the candidates
+            vcandidates.resize(0);
+            for(size_t isample = 0; isample < vsampletimes.size(); isample += 2) {
+                const dReal t0 = vsampletimes[isample], t1 = vsampletimes[isample + 1];
+                x0Vect.assign(vsamplepos.begin() + isample*ndof, vsamplepos.begin() + (isample + 1)*ndof);
+                if( _parameters->SetStateValues(x0Vect) != 0 ) {
+                    continue;
+                }
+                _parameters->_getstatefn(x0Vect);
+                x1Vect.assign(vsamplepos.begin() + (isample + 1)*ndof, vsamplepos.begin() + (isample + 2)*ndof);
+                if( _parameters->SetStateValues(x1Vect) != 0 ) {
+                    continue;
+                }
+                _parameters->_getstatefn(x1Vect);
+                v0Vect.assign(vsamplevel.begin() + isample*ndof, vsamplevel.begin() + (isample + 1)*ndof);
+                v1Vect.assign(vsamplevel.begin() + (isample + 1)*ndof, vsamplevel.begin() + (isample + 2)*ndof);
+                ++_progress._iteration;
+
+                vcandidates.push_back(ShortcutCandidate());
+                ShortcutCandidate& candidate = vcandidates.back();
+                candidate.t0 = t0;
+                candidate.t1 = t1;
+                if( !_interpolator.ComputeArbitraryVelNDTrajectory(x0Vect, x1Vect, v0Vect, v1Vect, _parameters->_vConfigLowerLimit, _parameters->_vConfigUpperLimit, _parameters->_vConfigVelocityLimit, _parameters->_vConfigAccelerationLimit, candidate.vrampnd, true) ) {
+                    vcandidates.pop_back();
+                    continue;
+                }
+                dReal segmentTime = 0;
+                FOREACHC(itrampnd, candidate.vrampnd) {
+                    segmentTime += itrampnd->GetDuration();
+                }
+                if( segmentTime + minTimeStep > t1 - t0 ) {
+                    vcandidates.pop_back();
+                    continue;
+                }
+            }
+
+            if( _CallCallbacks(_progress) == PA_Interrupt ) {
+                return -1;
+            }
+            if( _parameters->_nMaxPlanningTime > 0 ) {
+                uint32_t elapsedtime = utils::GetMilliTime() - _basetime;
+                if( elapsedtime >= _parameters->_nMaxPlanningTime ) {
+                    RAVELOG_DEBUG_FORMAT("env=%d, shortcut time exceeded (%dms) so breaking. iter=%d < %d", _environmentid%elapsedtime%iters%numIters);
+                    break;
+                }
+            }
+            if( vcandidates.size() == 0 ) {
+                continue;
+            }
+
+            try {
+                _shortcutpool->Evaluate((int)vcandidates.size(), [&](int iworker, int icandidate) {
+                    ShortcutCandidate& candidate = vcandidates.at(icandidate);
+                    RampOptimizer::CheckReturn retcheck = _vshortcutworkers.at(iworker)->_feasibilitychecker.Check2(candidate.vrampnd, 0xffff|CFO_FromTrajectorySmoother, candidate.vrampndOut);
+                    candidate.retcode = retcheck.retcode;
+                    if( candidate.retcode == 0 && retcheck.bDifferentVelocity ) {
+                        candidate.retcode = CFO_FinalValuesNotReached;
+                    }
+                    return 0; // every candidate has to be checked
+                });
+            }
+            catch (const std::exception& ex) {
+                RAVELOG_WARN_FORMAT("env=%d, An exception happened while checking shortcut candidates at iter=%d: %s", _environmentid%iters%ex.what());
+                continue;
+            }
+
+            // ties are broken by the sampling order
+            int ibest = -1;
+            dReal fBestDiff = 0;
+            for(size_t icandidate = 0; icandidate < vcandidates.size(); ++icandidate) {
+                const ShortcutCandidate& candidate = vcandidates[icandidate];
+                if( candidate.retcode != 0 || candidate.vrampndOut.size() == 0 ) {
+                    continue;
+                }
+                dReal segmentTime = 0;
+                FOREACHC(itrampnd, candidate.vrampndOut) {
+                    segmentTime += itrampnd->GetDuration();
+                }
+                dReal diff = (candidate.t1 - candidate.t0) - segmentTime;
+                if( diff > fBestDiff ) {
+                    fBestDiff = diff;
+                    ibest = icandidate;
+                }
+            }
+            if( ibest < 0 ) {
+                continue;
+            }
+
+            const ShortcutCandidate& bestcandidate = vcandidates[ibest];
+            _UpdateZeroVelPointsAfterShortcut(bestcandidate.t0, bestcandidate.t1, fBestDiff);
+            parabolicpath.ReplaceSegment(bestcandidate.t0, bestcandidate.t1, bestcandidate.vrampndOut);
+            tTotal = parabolicpath.GetDuration();
+            ++numShortcuts;
+            nItersFromPrevSuccessful = 0;
+            RAVELOG_DEBUG_FORMAT("env=%d, shortcut iter=%d/%d successful with candidate %d/%d, tTotal=%.15e", _environmentid%iters%numIters%ibest%vcandidates.size()%tTotal);
+        }
+
+        RAVELOG_DEBUG_FORMAT("env=%d, finished parallel shortcutting at iter=%d, successful=%d, workers=%d, candidates=%d, endTime: %.15e -> %.15e; diff = %.15e", _environmentid%iters%numShortcuts%_vshortcutworkers.size()%numCandidates%tOriginal%tTotal%(tOriginal - tTotal));
+        return numShortcuts;
+    }
+
     void _DumpParabolicPath(RampOptimizer::ParabolicPath& parabolicpath, DebugLevel level=Level_Verbose, uint32_t fileindex=10000, int option=-1) const
     {
         if( !IS_DEBUGLEVEL(level) ) {
@@ -3426,6 +4002,12 @@ protected:
                                /// after calling _SetMileStones. this serves as a cap for how far a
                                /// pair of sampled time instants t0, t1 can be.
     uint32_t _basetime; ///< timestamp at the beginning of PlanPath. used for checking computation time.
+    planningutils::PlannerParametersWorkerPoolPtr _shortcutpool; ///< worker environments used by _ShortcutParallel and _CheckRampNDsParallel, kept across plans
+    bool _bShortcutWorkersPrepared; ///< true if _PrepareShortcutWorkers was called during the current plan
+    std::vector<ShortcutWorkerPtr> _vshortcutworkers; ///< one for every worker of _shortcutpool
+    std::string _sShortcutWorkersParameters; ///< serialized parameters _vshortcutworkers were built with
+    RampOptimizer::FeasibilityMemo _feasibilitymemo; ///< feasible configurations and segments verified during the current environment state
+    bool _bUseFeasibilityMemo; ///< true if CheckPathAllConstraints cannot modify the checked segments
 
     // for logging
     SpaceSamplerBasePtr _logginguniformsampler; ///< used for logging, seed is randomly set
@@ -3455,6 +4037,7 @@ protected:
 
     // in _ComputeRampWithZeroVelEndpoints
     std::vector<dReal> _cacheX0Vect1, _cacheX1Vect1; ///< need to have another copies of x0 and x1 vectors. For v0 and v1 vectors, we can reuse to ones above.
+    std::vector<dReal> _cacheBatchPos, _cacheBatchVel; ///< end points of the finalized rampnds, used in PlanPath for inserting them into the trajectory at once
     std::vector<dReal> _cacheVellimits, _cacheAccelLimits; ///< stores current velocity and acceleration limits, also used in _Shortcut
     std::vector<RampOptimizer::RampND> _cacheRampNDVectOut1; ///< stores output from the check function, also used in _Shortcut
 
@@ -14,6 +14,7 @@
 #include "openraveplugindefs.h"
 #include "feasibilitychecker.h"
 #include <algorithm>
+#include <cmath>
 
 namespace OpenRAVE {
 
@@ -79,6 +80,96 @@ int RampNDFeasibilityChecker::Check(const std::vector<RampND>& rampndVect, int o
     }
 }
 
+FeasibilityMemo::FeasibilityMemo(dReal fQuantum, size_t maxentries) : _fQuantum(fQuantum), _maxentries(maxentries), _stamp(0), _nhits(0), _nmisses(0) {
+}
+
+void FeasibilityMemo::SetStamp(size_t stamp)
+{
+    if( stamp != _stamp ) {
+        Clear();
+        _stamp = stamp;
+    }
+}
+
+void FeasibilityMemo::Clear()
+{
+    _setverified.clear();
+    _nhits = 0;
+    _nmisses = 0;
+}
+
+bool FeasibilityMemo::FindConfig(const std::vector<dReal>& q, const std::vector<dReal>& dq, int options)
+{
+    _cachekey.resize(0);
+    _cachekey.push_back(0);
+    _cachekey.push_back(options);
+    _AppendQuantized(q);
+    _AppendQuantized(dq);
+    return _Find();
+}
+
+void FeasibilityMemo::InsertConfig(const std::vector<dReal>& q, const std::vector<dReal>& dq, int options)
+{
+    _cachekey.resize(0);
+    _cachekey.push_back(0);
+    _cachekey.push_back(options);
+    _AppendQuantized(q);
+    _AppendQuantized(dq);
+    _Insert();
+}
+
+bool FeasibilityMemo::FindSegment(const std::vector<dReal>& q0, const std::vector<dReal>& q1, const std::vector<dReal>& dq0, const std::vector<dReal>& dq1, dReal timeElapsed, int options)
+{
+    _cachekey.resize(0);
+    _cachekey.push_back(1);
+    _cachekey.push_back(options);
+    _cachekey.push_back((int64_t)std::floor(timeElapsed/_fQuantum + 0.5));
+    _AppendQuantized(q0);
+    _AppendQuantized(q1);
+    _AppendQuantized(dq0);
+    _AppendQuantized(dq1);
+    return _Find();
+}
+
+void FeasibilityMemo::InsertSegment(const std::vector<dReal>& q0, const std::vector<dReal>& q1, const std::vector<dReal>& dq0, const std::vector<dReal>& dq1, dReal timeElapsed, int options)
+{
+    _cachekey.resize(0);
+    _cachekey.push_back(1);
+    _cachekey.push_back(options);
+    _cachekey.push_back((int64_t)std::floor(timeElapsed/_fQuantum + 0.5));
+    _AppendQuantized(q0);
+    _AppendQuantized(q1);
+    _AppendQuantized(dq0);
+    _AppendQuantized(dq1);
+    _Insert();
+}
+
+void FeasibilityMemo::_AppendQuantized(const std::vector<dReal>& v)
+{
+    _cachekey.push_back((int64_t)v.size());
+    for (size_t i = 0; i < v.size(); ++i) {
+        _cachekey.push_back((int64_t)std::floor(v[i]/_fQuantum + 0.5));
+    }
+}
+
+bool FeasibilityMemo::_Find()
+{
+    if( _setverified.find(_cachekey) != _setverified.end() ) {
+        ++_nhits;
+        return true;
+    }
+    ++_nmisses;
+    return false;
+}
+
+void FeasibilityMemo::_Insert()
+{
+    if( _setverified.size() >= _maxentries ) {
+        _setverified.clear();
+    }
+    _setverified.insert(_cachekey);
+}
+
 } // end namespace RampOptimizerInternal
 
 } // end namespace OpenRAVE
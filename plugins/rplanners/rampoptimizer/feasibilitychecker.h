@@ -14,6 +14,7 @@
 #ifndef RAMP_OPTIM_FEAS_CHECKER_H
 #define RAMP_OPTIM_FEAS_CHECKER_H
 #include "ramp.h"
+#include <set>
 
 namespace OpenRAVE {
 
@@ -101,6 +102,48 @@ public:
     int constraintmask;
 };
 
+/// \brief Remembers configurations and segments that were already verified to be feasible, so that overlapping
+/// checks across shortcut iterations do not call CheckPathAllConstraints again.
+///
+/// All values are quantized with fQuantum before being compared. Only feasible results are stored, and they are
+/// only valid for one environment state: SetStamp clears the memo whenever the stamp changes.
+class FeasibilityMemo {
+public:
+    FeasibilityMemo(dReal fQuantum=g_fRampEpsilon, size_t maxentries=100000);
+
+    /// \brief clears the memo if stamp is different from the current stamp
+    void SetStamp(size_t stamp);
+    void Clear();
+
+    bool FindConfig(const std::vector<dReal>& q, const std::vector<dReal>& dq, int options);
+    void InsertConfig(const std::vector<dReal>& q, const std::vector<dReal>& dq, int options);
+
+    bool FindSegment(const std::vector<dReal>& q0, const std::vector<dReal>& q1, const std::vector<dReal>& dq0, const std::vector<dReal>& dq1, dReal timeElapsed, int options);
+    void InsertSegment(const std::vector<dReal>& q0, const std::vector<dReal>& q1, const std::vector<dReal>& dq0, const std::vector<dReal>& dq1, dReal timeElapsed, int options);
+
+    inline size_t GetNumHits() const {
+        return _nhits;
+    }
+    inline size_t GetNumMisses() const {
+        return _nmisses;
+    }
+    inline size_t GetNumEntries() const {
+        return _setverified.size();
+    }
+
+private:
+    void _AppendQuantized(const std::vector<dReal>& v);
+    bool _Find();
+    void _Insert();
+
+    std::set< std::vector<int64_t> > _setverified; ///< quantized keys of the verified configurations and segments
+    std::vector<int64_t> _cachekey;
+    dReal _fQuantum;
+    size_t _maxentries; ///< the memo is cleared once it grows past this
+    size_t _stamp;
+    size_t _nhits, _nmisses;
+};
+
 class RandomNumberGeneratorBase {
 public:
     virtual dReal Rand()
@@ -1578,6 +1578,21 @@ void ParabolicInterpolator::_ConvertParabolicCurvesToRampNDs(const std::vector<P
         }
     }
 
+    // evaluate every curve at all the switch points in one pass, the accelerations are taken in the middle of the segments
+    std::vector<dReal>& midpointsList = _cacheMidpointsList;
+    midpointsList.resize(switchpointsList.size() - 1);
+    for (size_t iswitch = 1; iswitch < switchpointsList.size(); ++iswitch) {
+        midpointsList[iswitch - 1] = 0.5*(switchpointsList[iswitch] + switchpointsList[iswitch - 1]);
+    }
+    _cacheCurvesPos.resize(_ndof);
+    _cacheCurvesVel.resize(_ndof);
+    _cacheCurvesAcc.resize(_ndof);
+    for (size_t jdof = 0; jdof < _ndof; ++jdof) {
+        curvesVectIn[jdof].EvalPos(switchpointsList, _cacheCurvesPos[jdof]);
+        curvesVectIn[jdof].EvalVel(switchpointsList, _cacheCurvesVel[jdof]);
+        curvesVectIn[jdof].EvalAcc(midpointsList, _cacheCurvesAcc[jdof]);
+    }
+
     rampndVectOut.resize(switchpointsList.size() - 1);
     std::vector<dReal>& x0Vect = _cacheX0Vect, &x1Vect = _cacheX1Vect, &v0Vect = _cacheV0Vect, &v1Vect = _cacheV1Vect, &aVect = _cacheAVect;
     for (size_t jdof = 0; jdof < _ndof; ++jdof) {
@@ -1592,9 +1607,9 @@ void ParabolicInterpolator::_ConvertParabolicCurvesToRampNDs(const std::vector<P
         dReal durSqr = dur*dur, a, temp1, temp2;
         dReal divMult = 1/(dur*(0.5*durSqr + 2));
         for (size_t jdof = 0; jdof < _ndof; ++jdof) {
-            x1Vect[jdof] = curvesVectIn[jdof].EvalPos(switchpointsList[iswitch]);
-            v1Vect[jdof] = curvesVectIn[jdof].EvalVel(switchpointsList[iswitch]);
-            aVect[jdof] = curvesVectIn[jdof].EvalAcc(0.5*(switchpointsList[iswitch] + switchpointsList[iswitch - 1]));
+            x1Vect[jdof] = _cacheCurvesPos[jdof][iswitch];
+            v1Vect[jdof] = _cacheCurvesVel[jdof][iswitch];
+            aVect[jdof] = _cacheCurvesAcc[jdof][iswitch - 1];
             if( bRecomputeAccel ) {
                 temp1 = x0Vect[jdof] - x1Vect[jdof] + v0Vect[jdof]*dur;
                 temp2 = v0Vect[jdof] - v1Vect[jdof];
@@ -195,7 +195,8 @@ private:
     int _envid;
 
     // Caching stuff
-    std::vector<dReal> _cacheVect, _cacheSwitchpointsList;
+    std::vector<dReal> _cacheVect, _cacheSwitchpointsList, _cacheMidpointsList;
+    std::vector< std::vector<dReal> > _cacheCurvesPos, _cacheCurvesVel, _cacheCurvesAcc; // for every dof, the values at the switch points used in _ConvertParabolicCurvesToRampNDs
     std::vector<dReal> _cacheX0Vect, _cacheX1Vect, _cacheV0Vect, _cacheV1Vect, _cacheAVect;
     Ramp _cacheRamp;
     std::vector<Ramp> _cacheRampsVect;
@@ -18,6 +18,32 @@ namespace OpenRAVE {
 
 namespace RampOptimizerInternal {
 
+inline dReal _GetSegmentDuration(const Ramp& ramp)
+{
+    return ramp.duration;
+}
+
+inline dReal _GetSegmentDuration(const RampND& rampnd)
+{
+    return rampnd.GetDuration();
+}
+
+/// \brief Moves index forward to the segment that t falls into, starting from the segment at index that begins at
+/// tstart. Follows the same convention as FindRampIndex: a time exactly at a switch point goes to the later segment.
+/// Starts over from the first segment if t is before tstart, so unsorted times are still handled.
+template <typename T>
+inline void _AdvanceIndex(const std::vector<T>& vsegments, dReal t, size_t& index, dReal& tstart)
+{
+    if( t < tstart ) {
+        index = 0;
+        tstart = 0;
+    }
+    while( index + 1 < vsegments.size() && t >= tstart + _GetSegmentDuration(vsegments[index]) ) {
+        tstart += _GetSegmentDuration(vsegments[index]);
+        ++index;
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // Ramp
 Ramp::Ramp(dReal v0_, dReal a_, dReal duration_, dReal x0_)
@@ -316,6 +342,39 @@ dReal ParabolicCurve::EvalAcc(dReal t) const
     return _ramps[index].a;
 }
 
+void ParabolicCurve::EvalPos(const std::vector<dReal>& vtimes, std::vector<dReal>& xVect) const
+{
+    xVect.resize(vtimes.size());
+    size_t index = 0;
+    dReal tstart = 0;
+    for (size_t itime = 0; itime < vtimes.size(); ++itime) {
+        _AdvanceIndex(_ramps, vtimes[itime], index, tstart);
+        xVect[itime] = vtimes[itime] >= _duration ? _ramps.back().x1 : _ramps[index].EvalPos(vtimes[itime] - tstart);
+    }
+}
+
+void ParabolicCurve::EvalVel(const std::vector<dReal>& vtimes, std::vector<dReal>& vVect) const
+{
+    vVect.resize(vtimes.size());
+    size_t index = 0;
+    dReal tstart = 0;
+    for (size_t itime = 0; itime < vtimes.size(); ++itime) {
+        _AdvanceIndex(_ramps, vtimes[itime], index, tstart);
+        vVect[itime] = vtimes[itime] >= _duration ? _ramps.back().v1 : _ramps[index].EvalVel(vtimes[itime] - tstart);
+    }
+}
+
+void ParabolicCurve::EvalAcc(const std::vector<dReal>& vtimes, std::vector<dReal>& aVect) const
+{
+    aVect.resize(vtimes.size());
+    size_t index = 0;
+    dReal tstart = 0;
+    for (size_t itime = 0; itime < vtimes.size(); ++itime) {
+        _AdvanceIndex(_ramps, vtimes[itime], index, tstart);
+        aVect[itime] = _ramps[index].a;
+    }
+}
+
 void ParabolicCurve::FindRampIndex(dReal t, int& index, dReal& remainder) const
 {
     if( t <= 0 ) {
@@ -752,6 +811,60 @@ void RampND::EvalAcc(std::vector<dReal>& aVect) const
     return;
 }
 
+void RampND::EvalPos(const dReal* ptimes, size_t numtimes, dReal toffset, dReal* pout) const
+{
+    const size_t ndof = _ndof;
+    const dReal* px0 = &_data[DATA_OFFSET_X0*ndof];
+    const dReal* px1 = &_data[DATA_OFFSET_X1*ndof];
+    const dReal* pv0 = &_data[DATA_OFFSET_V0*ndof];
+    const dReal* pa = &_data[DATA_OFFSET_A*ndof];
+    for (size_t itime = 0; itime < numtimes; ++itime, pout += ndof) {
+        dReal t = ptimes[itime] - toffset;
+        if( t <= 0 ) {
+            std::copy(px0, px0 + ndof, pout);
+        }
+        else if( t >= _duration ) {
+            std::copy(px1, px1 + ndof, pout);
+        }
+        else {
+            dReal halft = 0.5*t;
+            for (size_t idof = 0; idof < ndof; ++idof) {
+                pout[idof] = px0[idof] + t*(pv0[idof] + halft*pa[idof]);
+            }
+        }
+    }
+}
+
+void RampND::EvalVel(const dReal* ptimes, size_t numtimes, dReal toffset, dReal* pout) const
+{
+    const size_t ndof = _ndof;
+    const dReal* pv0 = &_data[DATA_OFFSET_V0*ndof];
+    const dReal* pv1 = &_data[DATA_OFFSET_V1*ndof];
+    const dReal* pa = &_data[DATA_OFFSET_A*ndof];
+    for (size_t itime = 0; itime < numtimes; ++itime, pout += ndof) {
+        dReal t = ptimes[itime] - toffset;
+        if( t <= 0 ) {
+            std::copy(pv0, pv0 + ndof, pout);
+        }
+        else if( t >= _duration ) {
+            std::copy(pv1, pv1 + ndof, pout);
+        }
+        else {
+            for (size_t idof = 0; idof < ndof; ++idof) {
+                pout[idof] = pv0[idof] + t*pa[idof];
+            }
+        }
+    }
+}
+
+void RampND::EvalAcc(size_t numtimes, dReal* pout) const
+{
+    const dReal* pa = &_data[DATA_OFFSET_A*_ndof];
+    for (size_t itime = 0; itime < numtimes; ++itime, pout += _ndof) {
+        std::copy(pa, pa + _ndof, pout);
+    }
+}
+
 void RampND::Initialize(size_t ndof)
 {
     constraintChecked = false;
@@ -971,6 +1084,56 @@ void ParabolicPath::EvalAcc(dReal t, std::vector<dReal>& aVect) const
     _rampnds[index].EvalAcc(aVect.begin());
 }
 
+template <typename F>
+void ParabolicPath::_ForEachRampNDRun(const std::vector<dReal>& vtimes, F fn) const
+{
+    size_t index = 0;
+    dReal tstart = 0;
+    size_t itime = 0;
+    while( itime < vtimes.size() ) {
+        _AdvanceIndex(_rampnds, vtimes[itime], index, tstart);
+        // collect the following times that stay in the same rampnd
+        bool bLast = index + 1 == _rampnds.size();
+        dReal tend = tstart + _rampnds[index].GetDuration();
+        size_t itimeend = itime + 1;
+        while( itimeend < vtimes.size() && vtimes[itimeend] >= vtimes[itimeend - 1] && (bLast || vtimes[itimeend] < tend) ) {
+            ++itimeend;
+        }
+        fn(_rampnds[index], itime, itimeend - itime, tstart);
+        itime = itimeend;
+    }
+}
+
+void ParabolicPath::EvalPos(const std::vector<dReal>& vtimes, std::vector<dReal>& xVect) const
+{
+    OPENRAVE_ASSERT_OP(_rampnds.size(), >, 0);
+    const size_t ndof = _rampnds.front().GetDOF();
+    xVect.resize(vtimes.size()*ndof);
+    _ForEachRampNDRun(vtimes, [&](const RampND& rampnd, size_t itime, size_t numtimes, dReal tstart) {
+        rampnd.EvalPos(&vtimes[itime], numtimes, tstart, &xVect[itime*ndof]);
+    });
+}
+
+void ParabolicPath::EvalVel(const std::vector<dReal>& vtimes, std::vector<dReal>& vVect) const
+{
+    OPENRAVE_ASSERT_OP(_rampnds.size(), >, 0);
+    const size_t ndof = _rampnds.front().GetDOF();
+    vVect.resize(vtimes.size()*ndof);
+    _ForEachRampNDRun(vtimes, [&](const RampND& rampnd, size_t itime, size_t numtimes, dReal tstart) {
+        rampnd.EvalVel(&vtimes[itime], numtimes, tstart, &vVect[itime*ndof]);
+    });
+}
+
+void ParabolicPath::EvalAcc(const std::vector<dReal>& vtimes, std::vector<dReal>& aVect) const
+{
+    OPENRAVE_ASSERT_OP(_rampnds.size(), >, 0);
+    const size_t ndof = _rampnds.front().GetDOF();
+    aVect.resize(vtimes.size()*ndof);
+    _ForEachRampNDRun(vtimes, [&](const RampND& rampnd, size_t itime, size_t numtimes, dReal tstart) {
+        rampnd.EvalAcc(numtimes, &aVect[itime*ndof]);
+    });
+}
+
 void ParabolicPath::FindRampNDIndex(dReal t, int& index, dReal& remainder) const
 {
     if( t <= 0 ) {
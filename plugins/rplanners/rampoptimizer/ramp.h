@@ -121,6 +121,16 @@ public:
     /// \brief Evaluate the acceleration at time t
     dReal EvalAcc(dReal t) const;
 
+    /// \brief Evaluate the positions at all the times in vtimes. The ramps are found in a single pass when vtimes is
+    /// sorted in ascending order.
+    void EvalPos(const std::vector<dReal>& vtimes, std::vector<dReal>& xVect) const;
+
+    /// \brief Evaluate the velocities at all the times in vtimes. \see EvalPos
+    void EvalVel(const std::vector<dReal>& vtimes, std::vector<dReal>& vVect) const;
+
+    /// \brief Evaluate the accelerations at all the times in vtimes. \see EvalPos
+    void EvalAcc(const std::vector<dReal>& vtimes, std::vector<dReal>& aVect) const;
+
     /// \brief Find the index of the ramp that t falls into and also compute the remainder.
     void FindRampIndex(dReal t, int& i, dReal& rem) const;
 
@@ -268,6 +278,17 @@ public:
     /// \brief Evaluate the acceleration at time t
     void EvalAcc(std::vector<dReal>& aVect) const;
 
+    /// \brief Evaluate the positions at numtimes times ptimes[i] - toffset and write numtimes*ndof values to pout,
+    /// one configuration after another. The loop over the dofs reads x0, v0, and a from contiguous blocks of _data so
+    /// that it can be vectorized.
+    void EvalPos(const dReal* ptimes, size_t numtimes, dReal toffset, dReal* pout) const;
+
+    /// \brief Evaluate the velocities at numtimes times. \see EvalPos
+    void EvalVel(const dReal* ptimes, size_t numtimes, dReal toffset, dReal* pout) const;
+
+    /// \brief Write the acceleration numtimes times to pout. \see EvalPos
+    void EvalAcc(size_t numtimes, dReal* pout) const;
+
     /// \brief Initialize rampnd for storing ndof segment.
     void Initialize(size_t ndof);
 
@@ -528,6 +549,17 @@ public:
     /// \brief Evaluate the acceleration at time t
     void EvalAcc(dReal t, std::vector<dReal>& aVect) const;
 
+    /// \brief Evaluate the positions at all the times in vtimes. xVect is filled with vtimes.size()*ndof values, one
+    /// configuration after another. Consecutive times falling into the same rampnd are evaluated together and the
+    /// rampnds are found in a single pass when vtimes is sorted in ascending order.
+    void EvalPos(const std::vector<dReal>& vtimes, std::vector<dReal>& xVect) const;
+
+    /// \brief Evaluate the velocities at all the times in vtimes. \see EvalPos
+    void EvalVel(const std::vector<dReal>& vtimes, std::vector<dReal>& vVect) const;
+
+    /// \brief Evaluate the accelerations at all the times in vtimes. \see EvalPos
+    void EvalAcc(const std::vector<dReal>& vtimes, std::vector<dReal>& aVect) const;
+
     /// \brief Find the index of rampnd that t falls into and also compute the remainder
     void FindRampNDIndex(dReal t, int& index, dReal& remainder) const;
 
@@ -563,6 +595,10 @@ public:
     }
 
 private:
+    /// \brief calls fn(rampnd, itime, numtimes, tstart) for every run of consecutive times in vtimes falling into the same rampnd
+    template <typename F>
+    void _ForEachRampNDRun(const std::vector<dReal>& vtimes, F fn) const;
+
     std::vector<RampND> _rampnds;
     dReal _duration;
 }; // end class ParabolicPath
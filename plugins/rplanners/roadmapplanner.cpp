@@ -0,0 +1,1084 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 OpenRAVE
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "rplanners.h"
+
+#include <iomanip>
+#include <list>
+#include <queue>
+#include <set>
+#include <boost/algorithm/string.hpp>
+#include <boost/filesystem/operations.hpp>
+
+static const uint16_t ROADMAP_MAGIC_NUMBER = 0x7072;
+static const uint16_t ROADMAP_VERSION_NUMBER = 0x0001;
+
+/// \brief roadmap shared between all planner instances that plan for the same kinematics in the same static scene.
+///
+/// The validity of nodes and edges is cached per scene state, identified by the hash of the state (body transforms, non-planned dof values,
+/// grabbed bodies) instead of a counter, so the results are found again when the scene returns to a state it was in before. The validity
+/// of the last s_nMaxValidityStates states is kept, the least recently used one is dropped first.
+class Roadmap
+{
+public:
+    struct Edge
+    {
+        Edge() : inode0(0), inode1(0), length(0) {
+        }
+        uint32_t inode0, inode1;
+        dReal length;
+    };
+
+    /// \brief the endpoint configurations of an edge touching a start or goal configuration, ordered so that the key does not depend on the direction
+    typedef std::pair< std::vector<dReal>, std::vector<dReal> > ConfigPair;
+
+    /// \brief collision results computed in one scene state. Validity is 1 if valid, -1 if invalid, 0 if unknown. The vectors can be shorter than the graph, missing entries are unknown.
+    struct ValidityCache
+    {
+        std::string statehash;
+        std::vector<int8_t> vnodevalid;
+        std::vector<int8_t> vedgevalid;
+        std::map<ConfigPair, int8_t> mapQueryEdgeValidity; ///< validity of the edges touching start/goal configurations. Not saved.
+    };
+
+    Roadmap(const std::string& key, int dof) : _key(key), _dof(dof), _generation(0), _bModified(false) {
+        _listValidity.push_back(ValidityCache());
+    }
+
+    inline int GetNumNodes() const {
+        return _dof > 0 ? (int)(_vnodes.size()/_dof) : 0;
+    }
+
+    inline std::vector<dReal>::const_iterator GetNode(uint32_t inode) const {
+        return _vnodes.begin()+inode*_dof;
+    }
+
+    /// \return the cached validity of a node in the current scene state, 0 if unknown
+    inline int GetNodeValidity(uint32_t inode) const {
+        const std::vector<int8_t>& vnodevalid = _listValidity.front().vnodevalid;
+        return inode < vnodevalid.size() ? vnodevalid[inode] : 0;
+    }
+
+    inline void SetNodeValidity(uint32_t inode, bool bvalid) {
+        std::vector<int8_t>& vnodevalid = _listValidity.front().vnodevalid;
+        if( inode >= vnodevalid.size() ) {
+            vnodevalid.resize(GetNumNodes(), 0);
+        }
+        vnodevalid[inode] = bvalid ? 1 : -1;
+    }
+
+    /// \return the cached validity of an edge in the current scene state, 0 if unknown
+    inline int GetEdgeValidity(uint32_t iedge) const {
+        const std::vector<int8_t>& vedgevalid = _listValidity.front().vedgevalid;
+        return iedge < vedgevalid.size() ? vedgevalid[iedge] : 0;
+    }
+
+    inline void SetEdgeValidity(uint32_t iedge, bool bvalid) {
+        std::vector<int8_t>& vedgevalid = _listValidity.front().vedgevalid;
+        if( iedge >= vedgevalid.size() ) {
+            vedgevalid.resize(_vedges.size(), 0);
+        }
+        vedgevalid[iedge] = bvalid ? 1 : -1;
+    }
+
+    /// \return the cached validity of an edge between a query configuration and another configuration in the current scene state, 0 if unknown
+    inline int GetQueryEdgeValidity(const ConfigPair& configs) const {
+        const std::map<ConfigPair, int8_t>& mapQueryEdgeValidity = _listValidity.front().mapQueryEdgeValidity;
+        std::map<ConfigPair, int8_t>::const_iterator it = mapQueryEdgeValidity.find(configs);
+        return it != mapQueryEdgeValidity.end() ? it->second : 0;
+    }
+
+    void SetQueryEdgeValidity(const ConfigPair& configs, bool bvalid)
+    {
+        std::map<ConfigPair, int8_t>& mapQueryEdgeValidity = _listValidity.front().mapQueryEdgeValidity;
+        if( mapQueryEdgeValidity.size() >= s_nMaxQueryEdges ) {
+            mapQueryEdgeValidity.clear();
+        }
+        mapQueryEdgeValidity[configs] = bvalid ? 1 : -1;
+    }
+
+    uint32_t AddNode(std::vector<dReal>::const_iterator itconfig)
+    {
+        uint32_t inode = GetNumNodes();
+        _vnodes.insert(_vnodes.end(), itconfig, itconfig+_dof);
+        _vadjacency.resize(inode+1);
+        _bModified = true;
+        return inode;
+    }
+
+    uint32_t AddEdge(uint32_t inode0, uint32_t inode1, dReal length)
+    {
+        uint32_t iedge = _vedges.size();
+        _vedges.push_back(Edge());
+        _vedges.back().inode0 = inode0;
+        _vedges.back().inode1 = inode1;
+        _vedges.back().length = length;
+        _vadjacency.at(inode0).push_back(iedge);
+        _vadjacency.at(inode1).push_back(iedge);
+        _bModified = true;
+        return iedge;
+    }
+
+    /// \brief called with the hash of the current scene state. Makes the validity cached for that state the current one, or starts an empty one and drops the least recently used state if there are too many.
+    ///
+    /// \return true if nothing was cached for statehash
+    bool UpdateStateHash(const std::string& statehash)
+    {
+        if( _listValidity.front().statehash == statehash ) {
+            return false;
+        }
+        for(std::list<ValidityCache>::iterator it = _listValidity.begin(); it != _listValidity.end(); ++it) {
+            if( it->statehash == statehash ) {
+                _listValidity.splice(_listValidity.begin(), _listValidity, it);
+                return false;
+            }
+        }
+        if( _listValidity.front().statehash.empty() ) {
+            // nothing is computed before the first state hash
+            _listValidity.pop_front();
+        }
+        _listValidity.push_front(ValidityCache());
+        _listValidity.front().statehash = statehash;
+        while( _listValidity.size() > s_nMaxValidityStates ) {
+            _listValidity.pop_back();
+        }
+        return true;
+    }
+
+    /// \return the number of scene states validity is cached for
+    inline size_t GetNumValidityStates() const {
+        return _listValidity.size();
+    }
+
+    void Clear()
+    {
+        _vnodes.clear();
+        _vedges.clear();
+        _vadjacency.clear();
+        _listValidity.clear();
+        _listValidity.push_back(ValidityCache());
+        ++_generation;
+        _bModified = true;
+    }
+
+    void Save(std::ostream& O) const
+    {
+        O.write((const char*)&ROADMAP_MAGIC_NUMBER, sizeof(ROADMAP_MAGIC_NUMBER));
+        O.write((const char*)&ROADMAP_VERSION_NUMBER, sizeof(ROADMAP_VERSION_NUMBER));
+        _WriteString(O, _key);
+        _WriteString(O, _listValidity.front().statehash);
+        int32_t dof = _dof;
+        O.write((const char*)&dof, sizeof(dof));
+        uint32_t numnodes = GetNumNodes();
+        O.write((const char*)&numnodes, sizeof(numnodes));
+        if( numnodes > 0 ) {
+            O.write((const char*)&_vnodes[0], _vnodes.size()*sizeof(dReal));
+        }
+        // only the validity of the current state is saved
+        for(uint32_t inode = 0; inode < numnodes; ++inode) {
+            int8_t valid = GetNodeValidity(inode);
+            O.write((const char*)&valid, sizeof(valid));
+        }
+        uint32_t numedges = _vedges.size();
+        O.write((const char*)&numedges, sizeof(numedges));
+        for(uint32_t iedge = 0; iedge < numedges; ++iedge) {
+            const Edge& edge = _vedges[iedge];
+            int8_t valid = GetEdgeValidity(iedge);
+            O.write((const char*)&edge.inode0, sizeof(edge.inode0));
+            O.write((const char*)&edge.inode1, sizeof(edge.inode1));
+            O.write((const char*)&edge.length, sizeof(edge.length));
+            O.write((const char*)&valid, sizeof(valid));
+        }
+    }
+
+    /// \brief loads a roadmap previously written with Save. Throws if the file is corrupted or was computed for a different key.
+    void Load(std::istream& I)
+    {
+        uint16_t magic = 0, version = 0;
+        I.read((char*)&magic, sizeof(magic));
+        I.read((char*)&version, sizeof(version));
+        if( !I || magic != ROADMAP_MAGIC_NUMBER ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0(_("roadmap stream does not have a valid header"), ORE_InvalidArguments);
+        }
+        if( version != ROADMAP_VERSION_NUMBER ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("roadmap version 0x%x is not supported, expected 0x%x"), version%ROADMAP_VERSION_NUMBER, ORE_InvalidArguments);
+        }
+        std::string key, statehash;
+        _ReadString(I, key);
+        _ReadString(I, statehash);
+        if( key != _key ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("roadmap key %s does not match the current robot/scene key %s"), key%_key, ORE_InvalidArguments);
+        }
+        int32_t dof = 0;
+        uint32_t numnodes = 0, numedges = 0;
+        I.read((char*)&dof, sizeof(dof));
+        I.read((char*)&numnodes, sizeof(numnodes));
+        if( !I || dof != _dof ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("roadmap dof %d does not match %d"), dof%_dof, ORE_InvalidArguments);
+        }
+
+        std::vector<dReal> vnodes(numnodes*_dof);
+        if( numnodes > 0 ) {
+            I.read((char*)&vnodes[0], vnodes.size()*sizeof(dReal));
+        }
+        std::vector<int8_t> vnodevalid(numnodes);
+        if( numnodes > 0 ) {
+            I.read((char*)&vnodevalid[0], numnodes*sizeof(int8_t));
+        }
+        I.read((char*)&numedges, sizeof(numedges));
+        if( !I ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0(_("roadmap stream is truncated"), ORE_InvalidArguments);
+        }
+        std::vector<Edge> vedges(numedges);
+        std::vector<int8_t> vedgevalid(numedges);
+        for(uint32_t iedge = 0; iedge < numedges; ++iedge) {
+            Edge& edge = vedges[iedge];
+            I.read((char*)&edge.inode0, sizeof(edge.inode0));
+            I.read((char*)&edge.inode1, sizeof(edge.inode1));
+            I.read((char*)&edge.length, sizeof(edge.length));
+            I.read((char*)&vedgevalid[iedge], sizeof(int8_t));
+            if( edge.inode0 >= numnodes || edge.inode1 >= numnodes ) {
+                throw OPENRAVE_EXCEPTION_FORMAT(_("roadmap edge %d references invalid nodes"), iedge, ORE_InvalidArguments);
+            }
+        }
+        if( !I ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0(_("roadmap stream is truncated"), ORE_InvalidArguments);
+        }
+
+        // the cached validity belongs to the old graph, only the loaded validity is trusted and only if the scene state matches statehash
+        ++_generation;
+        _listValidity.clear();
+        _listValidity.push_back(ValidityCache());
+        _listValidity.front().statehash = statehash;
+        _listValidity.front().vnodevalid.swap(vnodevalid);
+        _listValidity.front().vedgevalid.swap(vedgevalid);
+        _vnodes.swap(vnodes);
+        _vedges.swap(vedges);
+        _vadjacency.resize(0);
+        _vadjacency.resize(numnodes);
+        for(uint32_t iedge = 0; iedge < _vedges.size(); ++iedge) {
+            _vadjacency[_vedges[iedge].inode0].push_back(iedge);
+            _vadjacency[_vedges[iedge].inode1].push_back(iedge);
+        }
+        _bModified = false;
+    }
+
+    std::string _key; ///< kinematics hash of the planned bodies and static scene hash
+    int _dof;
+    std::vector<dReal> _vnodes; ///< _dof*GetNumNodes() configurations
+    std::vector<Edge> _vedges;
+    std::vector< std::vector<uint32_t> > _vadjacency; ///< for every node, the indices into _vedges touching it
+    std::list<ValidityCache> _listValidity; ///< most recently used scene state first, the front is the current state. Never empty.
+    uint32_t _generation; ///< incremented every time nodes are removed or replaced, so planners know to rebuild their nearest neighbor index
+    bool _bModified; ///< true if the graph changed since the last Load/Save
+    boost::mutex _mutex; ///< held while a planner is querying or modifying the roadmap
+
+private:
+    static const size_t s_nMaxQueryEdges = 10000; ///< max number of cached query edges per scene state before they are flushed
+    static const size_t s_nMaxValidityStates = 8; ///< max number of scene states validity is cached for
+
+    static void _WriteString(std::ostream& O, const std::string& s)
+    {
+        uint16_t length = (uint16_t)s.size();
+        O.write((const char*)&length, sizeof(length));
+        if( length > 0 ) {
+            O.write(s.c_str(), length);
+        }
+    }
+
+    static void _ReadString(std::istream& I, std::string& s)
+    {
+        uint16_t length = 0;
+        I.read((char*)&length, sizeof(length));
+        s.resize(length);
+        if( length > 0 ) {
+            I.read(&s[0], length);
+        }
+    }
+};
+
+typedef boost::shared_ptr<Roadmap> RoadmapPtr;
+
+/// \brief process-wide registry of roadmaps so that they survive across planner instances.
+///
+/// Holds at most s_nMaxRoadmaps roadmaps, the least recently used one is dropped first. Planners keep using a dropped roadmap until they are initialized again.
+static boost::mutex s_mutexRoadmaps;
+static std::list<RoadmapPtr> s_listRoadmaps; ///< most recently used first
+static const size_t s_nMaxRoadmaps = 16;
+
+/// \brief returns the registered roadmap for key and marks it as the most recently used one, registers a new roadmap if there is none
+static RoadmapPtr _GetRegisteredRoadmap(const std::string& key, int dof)
+{
+    boost::mutex::scoped_lock lockroadmaps(s_mutexRoadmaps);
+    for(std::list<RoadmapPtr>::iterator it = s_listRoadmaps.begin(); it != s_listRoadmaps.end(); ++it) {
+        if( (*it)->_key == key && (*it)->_dof == dof ) {
+            s_listRoadmaps.splice(s_listRoadmaps.begin(), s_listRoadmaps, it);
+            return s_listRoadmaps.front();
+        }
+    }
+    s_listRoadmaps.push_front(RoadmapPtr(new Roadmap(key, dof)));
+    while( s_listRoadmaps.size() > s_nMaxRoadmaps ) {
+        s_listRoadmaps.pop_back();
+    }
+    return s_listRoadmaps.front();
+}
+
+class PersistentRoadmapPlanner : public PlannerBase
+{
+public:
+    class PRMParameters : public PlannerBase::PlannerParameters
+    {
+public:
+        PRMParameters() : _nRoadmapSamples(500), _nExpandSamples(100), _nNumNeighbors(10), _nMaxExpansions(10), _bProcessingPRM(false) {
+            _vXMLParameters.push_back("roadmapsamples");
+            _vXMLParameters.push_back("expandsamples");
+            _vXMLParameters.push_back("numneighbors");
+            _vXMLParameters.push_back("maxexpansions");
+            _vXMLParameters.push_back("roadmapfile");
+        }
+
+        int _nRoadmapSamples; ///< number of nodes the roadmap is grown to before the first query
+        int _nExpandSamples; ///< number of nodes added every time a query cannot be answered by the roadmap
+        int _nNumNeighbors; ///< number of nearest neighbors every new node is connected to
+        int _nMaxExpansions; ///< max number of times the roadmap is expanded in one query
+        std::string _roadmapfile; ///< if not empty, the roadmap is loaded from this file on init and saved back when it changes
+protected:
+        bool _bProcessingPRM;
+        virtual bool serialize(std::ostream& O) const
+        {
+            if( !PlannerParameters::serialize(O) ) {
+                return false;
+            }
+            O << "<roadmapsamples>" << _nRoadmapSamples << "</roadmapsamples>" << endl;
+            O << "<expandsamples>" << _nExpandSamples << "</expandsamples>" << endl;
+            O << "<numneighbors>" << _nNumNeighbors << "</numneighbors>" << endl;
+            O << "<maxexpansions>" << _nMaxExpansions << "</maxexpansions>" << endl;
+            O << "<roadmapfile>" << _roadmapfile << "</roadmapfile>" << endl;
+            return !!O;
+        }
+
+        ProcessElement startElement(const std::string& name, const AttributesList& atts)
+        {
+            if( _bProcessingPRM ) {
+                return PE_Ignore;
+            }
+            switch( PlannerBase::PlannerParameters::startElement(name,atts) ) {
+            case PE_Pass: break;
+            case PE_Support: return PE_Support;
+            case PE_Ignore: return PE_Ignore;
+            }
+            _bProcessingPRM = name=="roadmapsamples"||name=="expandsamples"||name=="numneighbors"||name=="maxexpansions"||name=="roadmapfile";
+            return _bProcessingPRM ? PE_Support : PE_Pass;
+        }
+        virtual bool endElement(const string& name)
+        {
+            if( _bProcessingPRM ) {
+                if( name == "roadmapsamples") {
+                    _ss >> _nRoadmapSamples;
+                }
+                else if( name == "expandsamples") {
+                    _ss >> _nExpandSamples;
+                }
+                else if( name == "numneighbors") {
+                    _ss >> _nNumNeighbors;
+                }
+                else if( name == "maxexpansions") {
+                    _ss >> _nMaxExpansions;
+                }
+                else if( name == "roadmapfile") {
+                    _roadmapfile = _ss.str();
+                    boost::trim(_roadmapfile);
+                }
+                else {
+                    RAVELOG_WARN(str(boost::format("unknown tag %s\n")%name));
+                }
+                _bProcessingPRM = false;
+                return false;
+            }
+            // give a chance for the default parameters to get processed
+            return PlannerParameters::endElement(name);
+        }
+    };
+    typedef boost::shared_ptr<PRMParameters> PRMParametersPtr;
+
+    PersistentRoadmapPlanner(EnvironmentBasePtr penv, std::istream& sinput) : PlannerBase(penv), _nodeindex(0)
+    {
+        __description = "Multi-query probabilistic roadmap planner. \
+The roadmap is kept for the lifetime of the process and shared by all planners planning for the same kinematics in the same static scene \
+(the key is the kinematics hash of the planned bodies plus the hash of the names and geometry of all other bodies). \
+Nodes and edges are collision checked lazily only when they are part of a candidate path, and the results are cached per scene state for the last few states, \
+so they are reused when bodies return to where they were. At most 16 roadmaps are kept, the least recently used one is dropped first. \
+The roadmap can be saved to and loaded from a binary file.\n";
+        RegisterCommand("SaveRoadmap",boost::bind(&PersistentRoadmapPlanner::_SaveRoadmapCommand,this,_1,_2),
+                        "saves the current roadmap to the filename given as input");
+        RegisterCommand("LoadRoadmap",boost::bind(&PersistentRoadmapPlanner::_LoadRoadmapCommand,this,_1,_2),
+                        "loads the roadmap from the filename given as input. The planner has to be initialized first and the file has to be computed with the same robot and static scene.");
+        RegisterCommand("ClearRoadmap",boost::bind(&PersistentRoadmapPlanner::_ClearRoadmapCommand,this,_1,_2),
+                        "clears the roadmap the planner is currently using");
+        RegisterCommand("ClearRoadmapCache",boost::bind(&PersistentRoadmapPlanner::_ClearRoadmapCacheCommand,this,_1,_2),
+                        "drops all roadmaps kept for the process, the roadmap the planner is currently using is kept until it is initialized again");
+        RegisterCommand("GetRoadmapStats",boost::bind(&PersistentRoadmapPlanner::_GetRoadmapStatsCommand,this,_1,_2),
+                        "returns the key, number of nodes, number of edges, number of queries answered, number of scene states with cached collision results, and number of roadmaps kept for the process");
+        _filterreturn.reset(new ConstraintFilterReturn());
+        _nNumStarts = 0;
+        _nNumGoals = 0;
+        _nNodeChecks = 0;
+        _nEdgeChecks = 0;
+        _nQueries = 0;
+        _nIndexedNodes = 0;
+        _nIndexedGeneration = -1;
+    }
+
+    virtual ~PersistentRoadmapPlanner() {
+    }
+
+    virtual PlannerParametersConstPtr GetParameters() const {
+        return _parameters;
+    }
+
+    virtual bool InitPlan(RobotBasePtr pbase, PlannerParametersConstPtr pparams)
+    {
+        EnvironmentMutex::scoped_lock lock(GetEnv()->GetMutex());
+        _parameters.reset();
+        _roadmap.reset();
+        _nIndexedNodes = 0;
+        _nIndexedGeneration = -1;
+        _robot = pbase;
+        PRMParametersPtr parameters(new PRMParameters());
+        parameters->copy(pparams);
+        parameters->Validate();
+        FOREACH(it, parameters->_listInternalSamplers) {
+            (*it)->SetSeed(parameters->_nRandomGeneratorSeed);
+        }
+
+        const int dof = parameters->GetDOF();
+        if( dof == 0 || (parameters->vinitialconfig.size() % dof) != 0 || (parameters->vgoalconfig.size() % dof) != 0 ) {
+            RAVELOG_WARN_FORMAT("env=%d, initial or goal configurations are improperly specified for dof=%d", GetEnv()->GetId()%dof);
+            return false;
+        }
+        if( parameters->vinitialconfig.size() == 0 || parameters->vgoalconfig.size() == 0 ) {
+            RAVELOG_WARN_FORMAT("env=%d, prm needs at least one initial and one goal configuration", GetEnv()->GetId());
+            return false;
+        }
+
+        std::string key = _ComputeRoadmapKey(parameters);
+        _roadmap = _GetRegisteredRoadmap(key, dof);
+
+        if( parameters->_roadmapfile.size() > 0 ) {
+            boost::mutex::scoped_lock lockroadmap(_roadmap->_mutex);
+            if( _roadmap->GetNumNodes() == 0 && boost::filesystem::exists(parameters->_roadmapfile) ) {
+                try {
+                    std::ifstream f(parameters->_roadmapfile.c_str(), std::ios::binary);
+                    _roadmap->Load(f);
+                    RAVELOG_DEBUG_FORMAT("env=%d, loaded roadmap with %d nodes from %s", GetEnv()->GetId()%_roadmap->GetNumNodes()%parameters->_roadmapfile);
+                }
+                catch(const openrave_exception& ex) {
+                    RAVELOG_WARN_FORMAT("env=%d, failed to load roadmap %s, building a new one: %s", GetEnv()->GetId()%parameters->_roadmapfile%ex.what());
+                    _roadmap->Clear();
+                }
+            }
+        }
+
+        _parameters = parameters;
+        RAVELOG_DEBUG_FORMAT("env=%d, PRM Planner Initialized, key=%s, nodes=%d, edges=%d", GetEnv()->GetId()%key%_roadmap->GetNumNodes()%_roadmap->_vedges.size());
+        return true;
+    }
+
+    virtual PlannerStatus PlanPath(TrajectoryBasePtr ptraj, int planningoptions) override
+    {
+        if(!_parameters) {
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, PRM::PlanPath - Error, planner not initialized")%GetEnv()->GetId()), PS_Failed);
+        }
+
+        EnvironmentMutex::scoped_lock lock(GetEnv()->GetMutex());
+        uint64_t basetimeus = utils::GetMonotonicTime();
+        PlannerParameters::StateSaver savestate(_parameters);
+        CollisionOptionsStateSaver optionstate(GetEnv()->GetCollisionChecker(),GetEnv()->GetCollisionChecker()->GetCollisionOptions()|CO_ActiveDOFs,false);
+        boost::mutex::scoped_lock lockroadmap(_roadmap->_mutex);
+
+        if( _roadmap->UpdateStateHash(_ComputeStateHash()) ) {
+            RAVELOG_DEBUG_FORMAT("env=%d, no roadmap collision results are cached for the current scene state", GetEnv()->GetId());
+        }
+        _nNodeChecks = 0;
+        _nEdgeChecks = 0;
+        _vqueryconfigs.resize(0);
+        _nNumStarts = 0;
+        _nNumGoals = 0;
+
+        if( _roadmap->GetNumNodes() < _parameters->_nRoadmapSamples ) {
+            _ExpandRoadmap(_parameters->_nRoadmapSamples - _roadmap->GetNumNodes());
+        }
+
+        const int dof = _parameters->GetDOF();
+        _nNumStarts = _AddQueryConfigs(_parameters->vinitialconfig, true);
+        _nNumGoals = _AddQueryConfigs(_parameters->vgoalconfig, false);
+        if( _nNumStarts == 0 ) {
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, no initial configurations satisfy constraints")%GetEnv()->GetId()), PS_Failed);
+        }
+        if( _nNumGoals == 0 ) {
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, no goal configurations satisfy constraints")%GetEnv()->GetId()), PS_Failed);
+        }
+        _ConnectQueryNodes();
+
+        std::vector<uint32_t> vpathnodes;
+        bool bFound = false;
+        PlannerProgress progress;
+        for(int iexpansion = 0; iexpansion <= _parameters->_nMaxExpansions; ++iexpansion) {
+            if( _CallCallbacks(progress) == PA_Interrupt ) {
+                return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, Planning was interrupted")%GetEnv()->GetId()), PS_Interrupted);
+            }
+            if( iexpansion > 0 ) {
+                _ExpandRoadmap(_parameters->_nExpandSamples);
+            }
+            // keep searching until the shortest path that is not known to be invalid is fully validated or there is no path left
+            while(_SearchGraph(vpathnodes)) {
+                if( _ValidatePath(vpathnodes) ) {
+                    bFound = true;
+                    break;
+                }
+            }
+            if( bFound ) {
+                break;
+            }
+            progress._iteration = iexpansion;
+        }
+
+        ++_nQueries;
+        if( !bFound ) {
+            std::string description = str(boost::format(_("env=%d, prm plan failed in %u[us], nodes=%d, edges=%d"))%GetEnv()->GetId()%(utils::GetMonotonicTime()-basetimeus)%_roadmap->GetNumNodes()%_roadmap->_vedges.size());
+            RAVELOG_WARN(description);
+            _SaveIfModified();
+            return OPENRAVE_PLANNER_STATUS(description, PS_Failed);
+        }
+
+        std::vector<dReal> vpath;
+        vpath.reserve(vpathnodes.size()*dof);
+        FOREACH(itnode, vpathnodes) {
+            std::vector<dReal>::const_iterator itconfig = _GetConfig(*itnode);
+            vpath.insert(vpath.end(), itconfig, itconfig+dof);
+        }
+        if( ptraj->GetConfigurationSpecification().GetDOF() == 0 ) {
+            ptraj->Init(_parameters->_configurationspecification);
+        }
+        ptraj->Insert(ptraj->GetNumWaypoints(), vpath, _parameters->_configurationspecification);
+        RAVELOG_DEBUG_FORMAT("env=%d, prm plan success, path=%d points, nodes=%d, edges=%d, nodechecks=%d, edgechecks=%d, computation time=%u[us]", GetEnv()->GetId()%vpathnodes.size()%_roadmap->GetNumNodes()%_roadmap->_vedges.size()%_nNodeChecks%_nEdgeChecks%(utils::GetMonotonicTime()-basetimeus));
+        _SaveIfModified();
+        return _ProcessPostPlanners(_robot,ptraj);
+    }
+
+protected:
+    /// \brief edge of the query graph connecting a start/goal node to the roadmap or to each other. Node indices >= the roadmap size refer to _vqueryconfigs.
+    struct QueryEdge
+    {
+        uint32_t inode0, inode1;
+        dReal length;
+        int8_t valid;
+    };
+
+    /// \brief key that identifies the roadmap: the planned bodies' kinematics and the geometry of everything else in the scene.
+    std::string _ComputeRoadmapKey(PRMParametersPtr parameters)
+    {
+        std::vector<KinBodyPtr> vusedbodies, vbodies;
+        parameters->_configurationspecification.ExtractUsedBodies(GetEnv(), vusedbodies);
+        std::stringstream ss;
+        ss << std::setprecision(std::numeric_limits<dReal>::digits10+1);
+        ss << parameters->_configurationspecification;
+        FOREACH(itbody, vusedbodies) {
+            ss << (*itbody)->GetName() << " " << (*itbody)->GetKinematicsGeometryHash() << " ";
+        }
+        for(int idof = 0; idof < parameters->GetDOF(); ++idof) {
+            ss << parameters->_vConfigLowerLimit.at(idof) << " " << parameters->_vConfigUpperLimit.at(idof) << " ";
+        }
+        std::string robothash = utils::GetMD5HashString(ss.str());
+
+        // static scene: every other body that is not attached to the planned bodies
+        std::set<KinBodyPtr> setattached;
+        FOREACH(itbody, vusedbodies) {
+            std::vector<KinBodyPtr> vgrabbed;
+            (*itbody)->GetGrabbed(vgrabbed);
+            setattached.insert(*itbody);
+            setattached.insert(vgrabbed.begin(), vgrabbed.end());
+        }
+        GetEnv()->GetBodies(vbodies);
+        std::map<std::string, std::string> mapstaticbodies;
+        FOREACH(itbody, vbodies) {
+            if( setattached.find(*itbody) == setattached.end() ) {
+                mapstaticbodies[(*itbody)->GetName()] = (*itbody)->GetKinematicsGeometryHash();
+            }
+        }
+        ss.str("");
+        FOREACH(it, mapstaticbodies) {
+            ss << it->first << " " << it->second << " ";
+        }
+        std::string scenehash = utils::GetMD5HashString(ss.str());
+        return robothash + scenehash;
+    }
+
+    /// \brief hash of everything that affects collision results except the state the planner controls.
+    ///
+    /// The planned dofs, the transforms of bodies whose affine dofs are planned, and the transforms of bodies grabbed by the planned
+    /// bodies are left out since they change with every query. Grabbed bodies are hashed by their grasp instead. Disabled bodies are only hashed by their name.
+    std::string _ComputeStateHash()
+    {
+        std::vector<KinBodyPtr> vbodies, vusedbodies, vgrabbed;
+        std::set<KinBodyPtr> setplannedtransforms;
+        _parameters->_configurationspecification.ExtractUsedBodies(GetEnv(), vusedbodies);
+        FOREACH(itbody, vusedbodies) {
+            (*itbody)->GetGrabbed(vgrabbed);
+            setplannedtransforms.insert(vgrabbed.begin(), vgrabbed.end());
+        }
+        FOREACHC(itgroup, _parameters->_configurationspecification._vgroups) {
+            std::stringstream ssgroup(itgroup->name);
+            std::string grouptype, bodyname;
+            ssgroup >> grouptype >> bodyname;
+            if( grouptype == "affine_transform" ) {
+                KinBodyPtr pbody = GetEnv()->GetKinBody(bodyname);
+                if( !!pbody ) {
+                    setplannedtransforms.insert(pbody);
+                }
+            }
+        }
+
+        GetEnv()->GetBodies(vbodies);
+        std::vector<dReal> vdofvalues;
+        std::vector<int> vuseddofindices, vusedconfigindices;
+        std::vector<KinBody::GrabbedInfoPtr> vgrabbedinfos;
+        std::stringstream ss;
+        ss << std::setprecision(std::numeric_limits<dReal>::digits10+1);
+        FOREACH(itbody, vbodies) {
+            KinBodyPtr pbody = *itbody;
+            ss << pbody->GetName() << " " << pbody->IsEnabled() << " ";
+            if( !pbody->IsEnabled() ) {
+                // disabled bodies do not collide, so where they are does not matter
+                ss << std::endl;
+                continue;
+            }
+            if( setplannedtransforms.find(pbody) == setplannedtransforms.end() ) {
+                ss << pbody->GetTransform() << " ";
+            }
+            pbody->GetDOFValues(vdofvalues);
+            _parameters->_configurationspecification.ExtractUsedIndices(pbody, vuseddofindices, vusedconfigindices);
+            FOREACH(ituseddof, vuseddofindices) {
+                if( *ituseddof >= 0 && *ituseddof < (int)vdofvalues.size() ) {
+                    vdofvalues[*ituseddof] = 0;
+                }
+            }
+            FOREACH(itvalue, vdofvalues) {
+                ss << *itvalue << " ";
+            }
+            pbody->GetGrabbedInfo(vgrabbedinfos);
+            FOREACH(itgrabbedinfo, vgrabbedinfos) {
+                ss << (*itgrabbedinfo)->_grabbedname << " " << (*itgrabbedinfo)->_robotlinkname << " " << (*itgrabbedinfo)->_trelative << " ";
+            }
+            ss << std::endl;
+        }
+        return utils::GetMD5HashString(ss.str());
+    }
+
+    inline std::vector<dReal>::const_iterator _GetConfig(uint32_t inode) const {
+        const int numroadmapnodes = _roadmap->GetNumNodes();
+        if( (int)inode < numroadmapnodes ) {
+            return _roadmap->GetNode(inode);
+        }
+        return _vqueryconfigs.begin() + (inode-numroadmapnodes)*_parameters->GetDOF();
+    }
+
+    /// \brief adds the configurations that satisfy constraints to the query nodes, returns the number added
+    int _AddQueryConfigs(const std::vector<dReal>& vconfigs, bool bInitial)
+    {
+        const int dof = _parameters->GetDOF();
+        std::vector<dReal> vconfig(dof);
+        int numadded = 0;
+        for(size_t index = 0; index < vconfigs.size(); index += dof) {
+            std::copy(vconfigs.begin()+index, vconfigs.begin()+index+dof, vconfig.begin());
+            if( _parameters->CheckPathAllConstraints(vconfig,vconfig,std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart) != 0 ) {
+                RAVELOG_DEBUG_FORMAT("env=%d, %s configuration %d does not satisfy constraints", GetEnv()->GetId()%(bInitial ? "initial" : "goal")%(index/dof));
+                continue;
+            }
+            _vqueryconfigs.insert(_vqueryconfigs.end(), vconfig.begin(), vconfig.end());
+            ++numadded;
+        }
+        return numadded;
+    }
+
+    /// \brief adds the roadmap nodes that are not indexed yet to the nearest neighbor tree, rebuilds it if the roadmap nodes were replaced
+    void _UpdateNodeIndex()
+    {
+        const int dof = _parameters->GetDOF();
+        if( _nIndexedGeneration != (int)_roadmap->_generation ) {
+            _nodeindex.Init(shared_planner(), dof, _parameters->_distmetricfn, _parameters->_fStepLength, _parameters->_distmetricfn(_parameters->_vConfigLowerLimit, _parameters->_vConfigUpperLimit));
+            _nIndexedNodes = 0;
+            _nIndexedGeneration = _roadmap->_generation;
+        }
+        _vtempconfig2.resize(dof);
+        for(; _nIndexedNodes < _roadmap->GetNumNodes(); ++_nIndexedNodes) {
+            std::vector<dReal>::const_iterator itnode = _roadmap->GetNode(_nIndexedNodes);
+            std::copy(itnode, itnode+dof, _vtempconfig2.begin());
+            try {
+                // returns NULL if the node is a duplicate of an indexed node, in which case it is never a neighbor
+                _nodeindex.InsertNode(NodeBasePtr(), _vtempconfig2, _nIndexedNodes);
+            }
+            catch(const openrave_exception& ex) {
+                RAVELOG_WARN_FORMAT("env=%d, failed to index roadmap node %d: %s", GetEnv()->GetId()%_nIndexedNodes%ex.what());
+            }
+        }
+    }
+
+    /// \brief finds the k nearest roadmap nodes of a configuration, skipping nodes known to be invalid and nodes coinciding with the configuration
+    void _GetNearestNodes(std::vector<dReal>::const_iterator itconfig, int k, std::vector< std::pair<dReal, uint32_t> >& vnearest)
+    {
+        const int dof = _parameters->GetDOF();
+        _UpdateNodeIndex();
+        _vtempconfig.resize(dof);
+        std::copy(itconfig, itconfig+dof, _vtempconfig.begin());
+        // one more in case the configuration itself is in the roadmap
+        _nodeindex.FindNearestNodes(_vtempconfig, k+1, _vnearestindexnodes);
+        vnearest.resize(0);
+        FOREACH(itnearest, _vnearestindexnodes) {
+            uint32_t inode = itnearest->first->_userdata;
+            if( (int)vnearest.size() >= k ) {
+                break;
+            }
+            if( itnearest->second <= g_fEpsilon || _roadmap->GetNodeValidity(inode) < 0 ) {
+                continue;
+            }
+            vnearest.push_back(std::make_pair(itnearest->second, inode));
+        }
+    }
+
+    /// \brief samples new configurations and connects them to the existing roadmap
+    void _ExpandRoadmap(int numsamples)
+    {
+        const int dof = _parameters->GetDOF();
+        std::vector<dReal> vsample(dof);
+        std::vector< std::pair<dReal, uint32_t> > vnearest;
+        int numadded = 0;
+        for(int isample = 0; isample < numsamples; ++isample) {
+            if( !_parameters->_samplefn(vsample) ) {
+                continue;
+            }
+            _GetNearestNodes(vsample.begin(), _parameters->_nNumNeighbors, vnearest);
+            uint32_t inode = _roadmap->AddNode(vsample.begin());
+            FOREACH(itnear, vnearest) {
+                _roadmap->AddEdge(itnear->second, inode, itnear->first);
+            }
+            ++numadded;
+        }
+        if( _nNumStarts+_nNumGoals > 0 ) {
+            // query node indices are offset by the roadmap size, so they have to be reconnected
+            _ConnectQueryNodes();
+        }
+        RAVELOG_VERBOSE_FORMAT("env=%d, expanded roadmap by %d nodes to %d", GetEnv()->GetId()%numadded%_roadmap->GetNumNodes());
+    }
+
+    /// \brief connects the start and goal nodes to their nearest roadmap nodes and directly to each other
+    void _ConnectQueryNodes()
+    {
+        const int dof = _parameters->GetDOF();
+        const uint32_t numroadmapnodes = _roadmap->GetNumNodes();
+        const int numquerynodes = _nNumStarts+_nNumGoals;
+        _vqueryedges.resize(0);
+        _vqueryadjacency.resize(0);
+        _vqueryadjacency.resize(numroadmapnodes+numquerynodes);
+        std::vector< std::pair<dReal, uint32_t> > vnearest;
+        std::vector<dReal> vconfig0(dof), vconfig1(dof);
+        for(int iquery = 0; iquery < numquerynodes; ++iquery) {
+            std::vector<dReal>::const_iterator itconfig = _vqueryconfigs.begin()+iquery*dof;
+            _GetNearestNodes(itconfig, _parameters->_nNumNeighbors, vnearest);
+            FOREACH(itnear, vnearest) {
+                _AddQueryEdge(numroadmapnodes+iquery, itnear->second, itnear->first);
+            }
+        }
+        for(int istart = 0; istart < _nNumStarts; ++istart) {
+            std::copy(_vqueryconfigs.begin()+istart*dof, _vqueryconfigs.begin()+(istart+1)*dof, vconfig0.begin());
+            for(int igoal = 0; igoal < _nNumGoals; ++igoal) {
+                std::copy(_vqueryconfigs.begin()+(_nNumStarts+igoal)*dof, _vqueryconfigs.begin()+(_nNumStarts+igoal+1)*dof, vconfig1.begin());
+                _AddQueryEdge(numroadmapnodes+istart, numroadmapnodes+_nNumStarts+igoal, _parameters->_distmetricfn(vconfig0, vconfig1));
+            }
+        }
+    }
+
+    void _AddQueryEdge(uint32_t inode0, uint32_t inode1, dReal length)
+    {
+        QueryEdge edge;
+        edge.inode0 = inode0;
+        edge.inode1 = inode1;
+        edge.length = length;
+        _GetQueryEdgeConfigs(inode0, inode1, _queryedgeconfigs);
+        edge.valid = _roadmap->GetQueryEdgeValidity(_queryedgeconfigs);
+        uint32_t iedge = _roadmap->_vedges.size() + _vqueryedges.size();
+        _vqueryedges.push_back(edge);
+        _vqueryadjacency.at(inode0).push_back(iedge);
+        _vqueryadjacency.at(inode1).push_back(iedge);
+    }
+
+    /// \brief fills the roadmap cache key of a query edge
+    void _GetQueryEdgeConfigs(uint32_t inode0, uint32_t inode1, Roadmap::ConfigPair& configs) const
+    {
+        const int dof = _parameters->GetDOF();
+        configs.first.assign(_GetConfig(inode0), _GetConfig(inode0)+dof);
+        configs.second.assign(_GetConfig(inode1), _GetConfig(inode1)+dof);
+        if( configs.second < configs.first ) {
+            configs.first.swap(configs.second);
+        }
+    }
+
+    inline void _GetEdge(uint32_t iedge, uint32_t& inode0, uint32_t& inode1, dReal& length, int& valid) const
+    {
+        if( iedge < _roadmap->_vedges.size() ) {
+            const Roadmap::Edge& edge = _roadmap->_vedges[iedge];
+            inode0 = edge.inode0; inode1 = edge.inode1; length = edge.length;
+            valid = _roadmap->GetEdgeValidity(iedge);
+        }
+        else {
+            const QueryEdge& edge = _vqueryedges.at(iedge-_roadmap->_vedges.size());
+            inode0 = edge.inode0; inode1 = edge.inode1; length = edge.length;
+            valid = edge.valid;
+        }
+    }
+
+    inline int _GetNodeValidity(uint32_t inode) const {
+        // query nodes were checked when added
+        return (int)inode < _roadmap->GetNumNodes() ? _roadmap->GetNodeValidity(inode) : 1;
+    }
+
+    /// \brief dijkstra search from all start nodes to any goal node skipping nodes and edges known to be invalid
+    ///
+    /// \param vpathnodes filled with the node indices from a start to a goal
+    bool _SearchGraph(std::vector<uint32_t>& vpathnodes)
+    {
+        const uint32_t numroadmapnodes = _roadmap->GetNumNodes();
+        const uint32_t numnodes = numroadmapnodes + _nNumStarts + _nNumGoals;
+        const dReal finf = std::numeric_limits<dReal>::infinity();
+        _vcost.resize(0);
+        _vcost.resize(numnodes, finf);
+        _vparent.resize(0);
+        _vparent.resize(numnodes, -1);
+        typedef std::pair<dReal, uint32_t> QueueItem;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem> > queue;
+        for(int istart = 0; istart < _nNumStarts; ++istart) {
+            _vcost[numroadmapnodes+istart] = 0;
+            queue.push(QueueItem(0, numroadmapnodes+istart));
+        }
+
+        int igoalnode = -1;
+        uint32_t inode0, inode1;
+        dReal length;
+        int valid;
+        while(!queue.empty()) {
+            QueueItem item = queue.top();
+            queue.pop();
+            uint32_t inode = item.second;
+            if( item.first > _vcost[inode] ) {
+                continue;
+            }
+            if( inode >= numroadmapnodes+_nNumStarts ) {
+                igoalnode = inode;
+                break;
+            }
+            for(int ilist = 0; ilist < 2; ++ilist) {
+                if( ilist == 0 && inode >= numroadmapnodes ) {
+                    continue;
+                }
+                const std::vector<uint32_t>& vadjacency = ilist == 0 ? _roadmap->_vadjacency[inode] : _vqueryadjacency[inode];
+                FOREACH(itedge, vadjacency) {
+                    _GetEdge(*itedge, inode0, inode1, length, valid);
+                    if( valid < 0 ) {
+                        continue;
+                    }
+                    uint32_t ichild = inode0 == inode ? inode1 : inode0;
+                    if( _GetNodeValidity(ichild) < 0 ) {
+                        continue;
+                    }
+                    // start nodes are only sources
+                    if( ichild >= numroadmapnodes && ichild < numroadmapnodes+_nNumStarts ) {
+                        continue;
+                    }
+                    dReal newcost = _vcost[inode] + length;
+                    if( newcost < _vcost[ichild] ) {
+                        _vcost[ichild] = newcost;
+                        _vparent[ichild] = *itedge;
+                        queue.push(QueueItem(newcost, ichild));
+                    }
+                }
+            }
+        }
+
+        if( igoalnode < 0 ) {
+            return false;
+        }
+        vpathnodes.resize(0);
+        uint32_t inode = igoalnode;
+        vpathnodes.push_back(inode);
+        while(_vparent[inode] >= 0) {
+            _GetEdge(_vparent[inode], inode0, inode1, length, valid);
+            inode = inode0 == inode ? inode1 : inode0;
+            vpathnodes.push_back(inode);
+        }
+        std::reverse(vpathnodes.begin(), vpathnodes.end());
+        return true;
+    }
+
+    /// \brief collision checks the nodes and edges of a candidate path that have not been checked at the current stamp.
+    ///
+    /// \return true if the entire path is valid
+    bool _ValidatePath(const std::vector<uint32_t>& vpathnodes)
+    {
+        const int dof = _parameters->GetDOF();
+        std::vector<dReal> vconfig0(dof), vconfig1(dof);
+        uint32_t inode0, inode1;
+        dReal length;
+        int valid;
+        // check the nodes first since they are cheaper
+        FOREACH(itnode, vpathnodes) {
+            if( _GetNodeValidity(*itnode) == 0 ) {
+                std::copy(_GetConfig(*itnode), _GetConfig(*itnode)+dof, vconfig0.begin());
+                ++_nNodeChecks;
+                bool bvalid = _parameters->CheckPathAllConstraints(vconfig0,vconfig0,std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart) == 0;
+                _roadmap->SetNodeValidity(*itnode, bvalid);
+                if( !bvalid ) {
+                    return false;
+                }
+            }
+        }
+        for(size_t i = 1; i < vpathnodes.size(); ++i) {
+            int iedge = _vparent.at(vpathnodes[i]);
+            _GetEdge(iedge, inode0, inode1, length, valid);
+            if( valid > 0 ) {
+                continue;
+            }
+            std::copy(_GetConfig(vpathnodes[i-1]), _GetConfig(vpathnodes[i-1])+dof, vconfig0.begin());
+            std::copy(_GetConfig(vpathnodes[i]), _GetConfig(vpathnodes[i])+dof, vconfig1.begin());
+            ++_nEdgeChecks;
+            _filterreturn->Clear();
+            bool bvalid = _parameters->CheckPathAllConstraints(vconfig0,vconfig1,std::vector<dReal>(), std::vector<dReal>(), 0, IT_Open, 0xffff|CFO_FillCheckedConfiguration, _filterreturn) == 0;
+            if( bvalid && _filterreturn->_configurations.size() >= (size_t)dof ) {
+                // the roadmap stores straight edges, so any constraint projection that deviates from the end config makes the edge unusable
+                std::vector<dReal>::const_iterator itlast = _filterreturn->_configurations.end()-dof;
+                dReal fdist = _parameters->_distmetricfn(std::vector<dReal>(itlast, _filterreturn->_configurations.end()), vconfig1);
+                if( fdist > g_fEpsilonLinear ) {
+                    bvalid = false;
+                }
+            }
+            if( iedge < (int)_roadmap->_vedges.size() ) {
+                _roadmap->SetEdgeValidity(iedge, bvalid);
+            }
+            else {
+                // keep the result in the roadmap so that the next query from/to the same configurations does not check it again
+                _vqueryedges.at(iedge-_roadmap->_vedges.size()).valid = bvalid ? 1 : -1;
+                _GetQueryEdgeConfigs(inode0, inode1, _queryedgeconfigs);
+                _roadmap->SetQueryEdgeValidity(_queryedgeconfigs, bvalid);
+            }
+            if( !bvalid ) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void _SaveIfModified()
+    {
+        if( _parameters->_roadmapfile.size() > 0 && _roadmap->_bModified ) {
+            std::ofstream f(_parameters->_roadmapfile.c_str(), std::ios::binary);
+            _roadmap->Save(f);
+            _roadmap->_bModified = false;
+        }
+    }
+
+    bool _SaveRoadmapCommand(std::ostream& sout, std::istream& sinput)
+    {
+        std::string filename;
+        sinput >> filename;
+        if( !_roadmap || filename.size() == 0 ) {
+            return false;
+        }
+        boost::mutex::scoped_lock lockroadmap(_roadmap->_mutex);
+        std::ofstream f(filename.c_str(), std::ios::binary);
+        _roadmap->Save(f);
+        return !!f;
+    }
+
+    bool _LoadRoadmapCommand(std::ostream& sout, std::istream& sinput)
+    {
+        std::string filename;
+        sinput >> filename;
+        if( !_roadmap || filename.size() == 0 ) {
+            return false;
+        }
+        boost::mutex::scoped_lock lockroadmap(_roadmap->_mutex);
+        std::ifstream f(filename.c_str(), std::ios::binary);
+        if( !f ) {
+            return false;
+        }
+        _roadmap->Load(f);
+        return true;
+    }
+
+    bool _ClearRoadmapCommand(std::ostream& sout, std::istream& sinput)
+    {
+        if( !_roadmap ) {
+            return false;
+        }
+        boost::mutex::scoped_lock lockroadmap(_roadmap->_mutex);
+        _roadmap->Clear();
+        return true;
+    }
+
+    bool _ClearRoadmapCacheCommand(std::ostream& sout, std::istream& sinput)
+    {
+        boost::mutex::scoped_lock lockroadmaps(s_mutexRoadmaps);
+        s_listRoadmaps.clear();
+        return true;
+    }
+
+    bool _GetRoadmapStatsCommand(std::ostream& sout, std::istream& sinput)
+    {
+        if( !_roadmap ) {
+            return false;
+        }
+        size_t numroadmaps = 0;
+        {
+            boost::mutex::scoped_lock lockroadmaps(s_mutexRoadmaps);
+            numroadmaps = s_listRoadmaps.size();
+        }
+        boost::mutex::scoped_lock lockroadmap(_roadmap->_mutex);
+        sout << _roadmap->_key << " " << _roadmap->GetNumNodes() << " " << _roadmap->_vedges.size() << " " << _nQueries << " " << _roadmap->GetNumValidityStates() << " " << numroadmaps;
+        return true;
+    }
+
+    RobotBasePtr _robot;
+    PRMParametersPtr _parameters;
+    RoadmapPtr _roadmap;
+    ConstraintFilterReturnPtr _filterreturn;
+    SpatialTree<SimpleNode> _nodeindex; ///< nearest neighbor index of the roadmap nodes, userdata is the roadmap node index
+    int _nIndexedNodes; ///< number of roadmap nodes inserted in _nodeindex
+    int _nIndexedGeneration; ///< Roadmap::_generation _nodeindex was built for, -1 if not built
+    std::vector< std::pair<SimpleNode*, dReal> > _vnearestindexnodes;
+    Roadmap::ConfigPair _queryedgeconfigs;
+
+    std::vector<dReal> _vqueryconfigs; ///< valid start configurations followed by valid goal configurations
+    int _nNumStarts, _nNumGoals;
+    std::vector<QueryEdge> _vqueryedges;
+    std::vector< std::vector<uint32_t> > _vqueryadjacency; ///< query edges of every node, indexed by node
+    std::vector<dReal> _vcost;
+    std::vector<int> _vparent; ///< edge index leading to the node in the last search
+    std::vector<dReal> _vtempconfig, _vtempconfig2;
+    int _nNodeChecks, _nEdgeChecks, _nQueries;
+};
+
+PlannerBasePtr CreatePersistentRoadmapPlanner(EnvironmentBasePtr penv, std::istream& sinput)
+{
+    return PlannerBasePtr(new PersistentRoadmapPlanner(penv, sinput));
+}
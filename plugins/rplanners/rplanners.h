@@ -83,6 +83,7 @@ public:
         _level = 0;
         _hasselfchild = 0;
         _usenn = 1;
+        _edgechecked = 1;
         _userdata = 0;
     }
     SimpleNode(SimpleNode* parent, const dReal* pconfig, int dof) : rrtparent(parent) {
@@ -90,6 +91,7 @@ public:
         _level = 0;
         _hasselfchild = 0;
         _usenn = 1;
+        _edgechecked = 1;
         _userdata = 0;
     }
     ~SimpleNode() {
@@ -100,6 +102,7 @@ public:
     int16_t _level; ///< the level the node belongs to
     uint8_t _hasselfchild; ///< if 1, then _vchildren has contains a clone of this node in the level below it.
     uint8_t _usenn; ///< if 1, then use part of the nearest neighbor search, otherwise ignore
+    uint8_t _edgechecked; ///< if 1, then the path from rrtparent to this node satisfies all constraints. 0 only when the tree is using lazy edge checking.
     uint32_t _userdata; ///< user specified data tagging this node
 
 #ifdef _DEBUG
@@ -159,6 +162,7 @@ public:
         _maxlevel = 0;
         _minlevel = 0;
         _fMaxLevelBound = 0;
+        _bLazyEdgeChecking = false;
     }
 
     ~SpatialTree() {
@@ -234,11 +238,62 @@ public:
         return _FindNearestNode(vquerystate);
     }
 
+    /// \brief returns the k nearest nodes that are used in the nearest neighbor search sorted by increasing distance.
+    ///
+    /// The tree keeps clones of nodes on lower levels, so nodes are identified by their _userdata and every userdata is returned at most once.
+    void FindNearestNodes(const std::vector<dReal>& vquerystate, int k, std::vector< std::pair<NodePtr, dReal> >& vnearest) const
+    {
+        vnearest.resize(0);
+        if( _numnodes == 0 || k <= 0 ) {
+            return;
+        }
+        OPENRAVE_ASSERT_OP((int)vquerystate.size(),==,_dof);
+
+        // vnearest is kept as a max-heap on the distance so that the front is the current k-th nearest node
+        dReal fLevelBound = _fMaxLevelBound;
+        std::vector< std::pair<NodePtr, dReal> > vcurrentlevelnodes(1), vnextlevelnodes;
+        vcurrentlevelnodes[0].first = *_vsetLevelNodes.at(_EncodeLevel(_maxlevel)).begin();
+        vcurrentlevelnodes[0].second = _ComputeDistance(vcurrentlevelnodes[0].first->q, vquerystate);
+        _AddNearestNode(vcurrentlevelnodes[0], k, vnearest);
+        while(vcurrentlevelnodes.size() > 0 ) {
+            vnextlevelnodes.resize(0);
+            FOREACH(itcurrentnode, vcurrentlevelnodes) {
+                FOREACHC(itchild, itcurrentnode->first->_vchildren) {
+                    std::pair<NodePtr, dReal> child(*itchild, _ComputeDistance((*itchild)->q, vquerystate));
+                    _AddNearestNode(child, k, vnearest);
+                    vnextlevelnodes.push_back(child);
+                }
+            }
+
+            // a subtree can only contain a closer node than the current k-th nearest if its root is within the level bound of it
+            dReal ftestbound = (int)vnearest.size() < k ? std::numeric_limits<dReal>::infinity() : vnearest.front().second + fLevelBound;
+            vcurrentlevelnodes.resize(0);
+            FOREACH(itnode, vnextlevelnodes) {
+                if( itnode->second < ftestbound ) {
+                    vcurrentlevelnodes.push_back(*itnode);
+                }
+            }
+            fLevelBound *= _fBaseInv;
+        }
+        std::sort_heap(vnearest.begin(), vnearest.end(), _CompareNodeDistance);
+    }
+
     virtual NodeBasePtr InsertNode(NodeBasePtr parent, const vector<dReal>& config, uint32_t userdata)
     {
         return _InsertNode((NodePtr)parent, config, userdata);
     }
 
+    /// \brief if true, Extend only checks the constraints of the new configurations and marks their edges as unchecked. The edges have to be validated by the caller before being used.
+    virtual void SetLazyEdgeChecking(bool bLazyEdgeChecking)
+    {
+        _bLazyEdgeChecking = bLazyEdgeChecking;
+    }
+
+    virtual bool IsLazyEdgeChecking() const
+    {
+        return _bLazyEdgeChecking;
+    }
+
     virtual void InvalidateNodesWithParent(NodeBasePtr parentbase)
     {
         //BOOST_ASSERT(Validate());
@@ -360,6 +415,25 @@ public:
                 return ET_Failed;
             }
 
+            if( _bLazyEdgeChecking ) {
+                // only check the new configuration, the edge from pnode is checked once it is part of a candidate path
+                if( params->CheckPathAllConstraints(_vNewConfig, _vNewConfig, std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart, constraintFilterOptions|CFO_FromPathSampling, _constraintreturn) != 0 ) {
+                    return bHasAdded ? ET_Sucess : ET_Failed;
+                }
+                NodePtr pnewnode = _InsertNode(pnode, _vNewConfig, 0); ///< set userdata to 0
+                if( !!pnewnode ) {
+                    pnewnode->_edgechecked = 0;
+                    pnode = pnewnode;
+                    lastnode = pnode;
+                    bHasAdded = true;
+                }
+                if( bHasAdded && bOneStep ) {
+                    return ET_Connected;
+                }
+                _vCurConfig.swap(_vNewConfig);
+                continue;
+            }
+
             // necessary to pass in _constraintreturn since _neighstatefn can have constraints and it can change the interpolation. Use _constraintreturn->_bHasRampDeviatedFromInterpolation to figure out if something changed.
             if( _fromgoal ) {
                 if( params->CheckPathAllConstraints(_vNewConfig, _vCurConfig, std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenEnd, constraintFilterOptions|CFO_FromPathSampling, _constraintreturn) != 0 ) {
@@ -685,7 +759,7 @@ private:
                 // only take the children whose distances are within the bound
                 FOREACHC(itchild, itcurrentnode->first->_vchildren) {
                     dReal curdist = _ComputeDistance((*itchild)->q, vquerystate);
-                    if( !bestnode.first || (curdist < bestnode.second && bestnode.first->_usenn)) {
+                    if( (*itchild)->_usenn && (!bestnode.first || curdist < bestnode.second) ) {
                         bestnode = make_pair(*itchild, curdist);
                     }
                     _vNextLevelNodes.emplace_back(*itchild,  curdist);
@@ -709,6 +783,34 @@ private:
         return bestnode;
     }
 
+    static bool _CompareNodeDistance(const std::pair<NodePtr, dReal>& node0, const std::pair<NodePtr, dReal>& node1)
+    {
+        return node0.second < node1.second;
+    }
+
+    /// \brief adds node to the max-heap vnearest of the k nearest nodes if it is closer than the current k-th nearest.
+    static void _AddNearestNode(const std::pair<NodePtr, dReal>& node, int k, std::vector< std::pair<NodePtr, dReal> >& vnearest)
+    {
+        if( !node.first->_usenn ) {
+            return;
+        }
+        if( (int)vnearest.size() >= k && node.second >= vnearest.front().second ) {
+            return;
+        }
+        FOREACH(itnearest, vnearest) {
+            if( itnearest->first->_userdata == node.first->_userdata ) {
+                // clone of a node that is already in the heap, both have the same distance
+                return;
+            }
+        }
+        if( (int)vnearest.size() >= k ) {
+            std::pop_heap(vnearest.begin(), vnearest.end(), _CompareNodeDistance);
+            vnearest.pop_back();
+        }
+        vnearest.push_back(node);
+        std::push_heap(vnearest.begin(), vnearest.end(), _CompareNodeDistance);
+    }
+
     NodePtr _InsertNode(NodePtr parent, const vector<dReal>& config, uint32_t userdata)
     {
         NodePtr newnode = _CreateNode(parent, config, userdata);
@@ -1054,6 +1156,7 @@ private:
     dReal _fStepLength;
     int _dof; ///< the number of values of each state
     int _fromgoal;
+    bool _bLazyEdgeChecking; ///< if true, only check the new configurations in Extend
 
     // cover tree data structures
     boost::shared_ptr< boost::pool<> > _pNodesPool; ///< pool nodes are created from
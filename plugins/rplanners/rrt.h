@@ -482,6 +482,11 @@ Some python code to display data::\n\
                 planningstatus.AddCollisionReport(_treeBackward.GetConstraintReport()->_report);
             }
 
+            if( et == ET_Connected && !_ValidateConnection(TreeA == &_treeForward ? iConnectedA : iConnectedB, TreeA == &_treeBackward ? iConnectedA : iConnectedB) ) {
+                // parts of the candidate path were invalid and were removed from the trees, so keep growing
+                et = ET_Failed;
+            }
+
             if( et == ET_Connected ) {
                 // connected, process goal
                 _vgoalpaths.push_back(GOALPATH());
@@ -549,6 +554,14 @@ Some python code to display data::\n\
         return status;
     }
 
+    /// \brief called once both trees connect, before the path is extracted.
+    ///
+    /// \return true if the path from the start through iConnectedForward and iConnectedBackward to the goal can be used
+    virtual bool _ValidateConnection(NodeBase* iConnectedForward, NodeBase* iConnectedBackward)
+    {
+        return true;
+    }
+
     virtual void _ExtractPath(GOALPATH& goalpath, NodeBase* iConnectedForward, NodeBase* iConnectedBackward)
     {
 //        list< std::vector<dReal> > vecnodes;
@@ -676,6 +689,98 @@ protected:
     std::vector<GOALPATH> _vgoalpaths;
 };
 
+class LazyBirrtPlanner : public BirrtPlanner
+{
+public:
+    LazyBirrtPlanner(EnvironmentBasePtr penv) : BirrtPlanner(penv)
+    {
+        __description += "\n\nLazy variant: while the trees grow only the new configurations are checked. Once the trees connect, the edges of the candidate path are checked starting from the roots and the subtree below the first invalid edge is removed from the tree. See\n\n\
+- R. Bohlin and L.E. Kavraki. Path Planning Using Lazy PRM. In Proc. IEEE Int'l Conf. on Robotics and Automation (ICRA'2000), pages 521-528, San Francisco, CA, April 2000.\n\n\
+Edges whose checked path deviates from the straight line (for example due to constraints in _neighstatefn) are treated as invalid, so this planner is meant for unconstrained configuration spaces.";
+        _nEdgeChecks = 0;
+        _nInvalidEdges = 0;
+    }
+    virtual ~LazyBirrtPlanner() {
+    }
+
+    virtual bool InitPlan(RobotBasePtr pbase, PlannerParametersConstPtr pparams)
+    {
+        if( !BirrtPlanner::InitPlan(pbase, pparams) ) {
+            return false;
+        }
+        _treeForward.SetLazyEdgeChecking(true);
+        _treeBackward.SetLazyEdgeChecking(true);
+        if( !_edgefilterreturn ) {
+            _edgefilterreturn.reset(new ConstraintFilterReturn());
+        }
+        _nEdgeChecks = 0;
+        _nInvalidEdges = 0;
+        return true;
+    }
+
+    virtual PlannerStatus PlanPath(TrajectoryBasePtr ptraj, int planningoptions) override
+    {
+        PlannerStatus status = BirrtPlanner::PlanPath(ptraj, planningoptions);
+        RAVELOG_DEBUG_FORMAT("env=%d, lazy birrt checked %d edges, %d were invalid, forward=%d, backward=%d", GetEnv()->GetId()%_nEdgeChecks%_nInvalidEdges%_treeForward.GetNumNodes()%_treeBackward.GetNumNodes());
+        return status;
+    }
+
+protected:
+    virtual bool _ValidateConnection(NodeBase* iConnectedForward, NodeBase* iConnectedBackward)
+    {
+        if( !_ValidateBranch(_treeForward, (SimpleNode*)iConnectedForward, false) ) {
+            return false;
+        }
+        return _ValidateBranch(_treeBackward, (SimpleNode*)iConnectedBackward, true);
+    }
+
+    /// \brief checks all unchecked edges from the root of the tree to pleaf, starting from the root.
+    ///
+    /// On the first invalid edge the child node and its subtree are deleted from the tree, so they are neither extended from nor connected to anymore.
+    /// \param bFromGoal if true, the tree is grown from the goal so the edges are checked in the opposite direction like in SpatialTree::Extend
+    bool _ValidateBranch(SpatialTree<SimpleNode>& tree, SimpleNode* pleaf, bool bFromGoal)
+    {
+        const int dof = _parameters->GetDOF();
+        _vuncheckednodes.resize(0);
+        for(SimpleNode* pnode = pleaf; !!pnode->rrtparent; pnode = pnode->rrtparent) {
+            if( !pnode->_edgechecked ) {
+                _vuncheckednodes.push_back(pnode);
+            }
+        }
+
+        _vedgeparent.resize(dof);
+        _vedgechild.resize(dof);
+        for(std::vector<SimpleNode*>::reverse_iterator itnode = _vuncheckednodes.rbegin(); itnode != _vuncheckednodes.rend(); ++itnode) {
+            SimpleNode* pnode = *itnode;
+            std::copy(pnode->rrtparent->q, pnode->rrtparent->q+dof, _vedgeparent.begin());
+            std::copy(pnode->q, pnode->q+dof, _vedgechild.begin());
+            _edgefilterreturn->Clear();
+            int ret;
+            if( bFromGoal ) {
+                ret = _parameters->CheckPathAllConstraints(_vedgechild, _vedgeparent, std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenEnd, 0xffff|CFO_FromPathSampling, _edgefilterreturn);
+            }
+            else {
+                ret = _parameters->CheckPathAllConstraints(_vedgeparent, _vedgechild, std::vector<dReal>(), std::vector<dReal>(), 0, IT_OpenStart, 0xffff|CFO_FromPathSampling, _edgefilterreturn);
+            }
+            ++_nEdgeChecks;
+            if( ret != 0 || _edgefilterreturn->_bHasRampDeviatedFromInterpolation ) {
+                ++_nInvalidEdges;
+                RAVELOG_VERBOSE_FORMAT("env=%d, lazy edge check failed with 0x%x, removing subtree", GetEnv()->GetId()%ret);
+                tree._DeleteNodesWithParent(pnode);
+                return false;
+            }
+            pnode->_edgechecked = 1;
+        }
+        return true;
+    }
+
+    ConstraintFilterReturnPtr _edgefilterreturn;
+    std::vector<SimpleNode*> _vuncheckednodes; ///< cache
+    std::vector<dReal> _vedgeparent, _vedgechild; ///< cache
+    int _nEdgeChecks; ///< number of edges checked during the last PlanPath
+    int _nInvalidEdges; ///< number of checked edges that were invalid during the last PlanPath
+};
+
 class BasicRrtPlanner : public RrtPlanner<SimpleNode>
 {
 public:
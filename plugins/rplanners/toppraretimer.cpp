@@ -0,0 +1,749 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 OpenRAVE
+//
+// This program is free software: you can redistribute it and/or modify it under the terms of the
+// GNU Lesser General Public License as published by the Free Software Foundation, either version 3
+// of the License, or at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+// even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License along with this program.
+// If not, see <http://www.gnu.org/licenses/>.
+#include "openraveplugindefs.h"
+
+#define _(msgid) OpenRAVE::RaveGetLocalizedTextForDomain("openrave_plugins_rplanners", msgid)
+
+namespace rplanners {
+
+/// \brief parameters for the reachability analysis retimer
+class TOPPRAParameters : public ConstraintTrajectoryTimingParameters
+{
+public:
+    TOPPRAParameters() : ConstraintTrajectoryTimingParameters(), gridstep(0.01), usetorquelimits(1), blendradius(0), _bTProcessing(false) {
+        _vXMLParameters.push_back("gridstep");
+        _vXMLParameters.push_back("usetorquelimits");
+        _vXMLParameters.push_back("blendradius");
+    }
+
+    dReal gridstep; ///< max distance in configuration space between two consecutive points the path is discretized into
+    int usetorquelimits; ///< if 1, will constrain the joint torques with the torque limits of the joints. Joints with 0 torque limits are ignored.
+    dReal blendradius; ///< if > 0, every corner of the path is replaced by a parabolic blend starting at most this distance before the corner waypoint, so the path does not have to stop there. The blended path does not pass through the corner waypoints. If 0, the path stops at every corner.
+
+protected:
+    bool _bTProcessing;
+    virtual bool serialize(std::ostream& O, int options=0) const
+    {
+        if( !ConstraintTrajectoryTimingParameters::serialize(O, options|1) ) {
+            return false;
+        }
+        O << "<gridstep>" << gridstep << "</gridstep>" << std::endl;
+        O << "<usetorquelimits>" << usetorquelimits << "</usetorquelimits>" << std::endl;
+        O << "<blendradius>" << blendradius << "</blendradius>" << std::endl;
+        if( !(options & 1) ) {
+            O << _sExtraParameters << std::endl;
+        }
+        return !!O;
+    }
+
+    ProcessElement startElement(const std::string& name, const AttributesList& atts)
+    {
+        if( _bTProcessing ) {
+            return PE_Ignore;
+        }
+        switch( ConstraintTrajectoryTimingParameters::startElement(name,atts) ) {
+        case PE_Pass: break;
+        case PE_Support: return PE_Support;
+        case PE_Ignore: return PE_Ignore;
+        }
+        _bTProcessing = name=="gridstep" || name=="usetorquelimits" || name=="blendradius";
+        return _bTProcessing ? PE_Support : PE_Pass;
+    }
+
+    virtual bool endElement(const std::string& name)
+    {
+        if( _bTProcessing ) {
+            if( name == "gridstep" ) {
+                _ss >> gridstep;
+            }
+            else if( name == "usetorquelimits" ) {
+                _ss >> usetorquelimits;
+            }
+            else if( name == "blendradius" ) {
+                _ss >> blendradius;
+            }
+            else {
+                RAVELOG_WARN(str(boost::format("unknown tag %s\n")%name));
+            }
+            _bTProcessing = false;
+            return false;
+        }
+        return ConstraintTrajectoryTimingParameters::endElement(name);
+    }
+};
+
+typedef boost::shared_ptr<TOPPRAParameters> TOPPRAParametersPtr;
+
+/** \brief time-optimal retiming of a piecewise linear path with reachability analysis (TOPP-RA).
+
+    The path through the waypoints is discretized into a grid s_0..s_N. With x = sdot^2 and u = sddot, every constraint at a grid point is
+    linear in (x,u): joint velocities bound x, joint accelerations and the manipulator acceleration bound q' u + q'' x, and joint torques bound
+    M(q) q' u + (M(q) q'' + C(q,q') q') x + g(q). One backward pass computes the controllable sets K_i = [xmin_i, xmax_i] with a two variable linear program
+    per grid point, and one forward pass picks the largest acceleration that stays inside K_{i+1}. Both passes are linear in the number of grid points
+    and no trajectory is ever checked and scaled down afterwards.
+
+    A piecewise linear path cannot be followed with non-zero velocity where its direction changes. If blendradius is set, corners are replaced by
+    parabolic blends q(s) = p + d0 s + (d1-d0) s^2/(4r) that are tangent to both segments, otherwise the path stops at every corner.
+ */
+class TOPPRATrajectoryRetimer : public PlannerBase
+{
+    /// \brief constraint alpha*x + beta*u <= gamma
+    struct LinearConstraint
+    {
+        LinearConstraint() : alpha(0), beta(0), gamma(0) {
+        }
+        LinearConstraint(dReal alpha, dReal beta, dReal gamma) : alpha(alpha), beta(beta), gamma(gamma) {
+        }
+        dReal alpha, beta, gamma;
+    };
+
+public:
+    TOPPRATrajectoryRetimer(EnvironmentBasePtr penv, std::istream& sinput) : PlannerBase(penv)
+    {
+        __description = "Time-optimal retiming of the piecewise linear path through the trajectory waypoints using reachability analysis. \
+Handles joint velocity, acceleration and torque limits along with the manipulator speed and acceleration limits (manipname, maxmanipspeed, maxmanipaccel) in one backward and one forward pass over the discretized path. \
+Corners are either passed at rest or, if blendradius is set, blended with parabolas. The output trajectory has quadratic interpolation.";
+    }
+
+    virtual bool InitPlan(RobotBasePtr pbase, PlannerParametersConstPtr params)
+    {
+        EnvironmentMutex::scoped_lock lock(GetEnv()->GetMutex());
+        params->Validate();
+        _parameters.reset(new TOPPRAParameters());
+        _parameters->copy(params);
+        return _InitPlan();
+    }
+
+    virtual bool InitPlan(RobotBasePtr pbase, std::istream& isParameters)
+    {
+        EnvironmentMutex::scoped_lock lock(GetEnv()->GetMutex());
+        _parameters.reset(new TOPPRAParameters());
+        isParameters >> *_parameters;
+        _parameters->Validate();
+        return _InitPlan();
+    }
+
+    virtual PlannerParametersConstPtr GetParameters() const {
+        return _parameters;
+    }
+
+    virtual PlannerStatus PlanPath(TrajectoryBasePtr ptraj, int planningoptions) override
+    {
+        BOOST_ASSERT(!!_parameters && !!ptraj && ptraj->GetEnv()==GetEnv());
+        EnvironmentMutex::scoped_lock lock(GetEnv()->GetMutex());
+        uint64_t basetimeus = utils::GetMonotonicTime();
+        const int dof = _parameters->GetDOF();
+        size_t numpoints = ptraj->GetNumWaypoints();
+        const bool bStatusDetail = !(planningoptions & PO_NoStatusDetail);
+        if( numpoints == 0 ) {
+            if( !bStatusDetail ) {
+                return PlannerStatus(PS_Failed);
+            }
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, there's nothing to retime")%GetEnv()->GetId()), PS_Failed);
+        }
+
+        const ConfigurationSpecification& posspec = _parameters->_configurationspecification;
+        ConfigurationSpecification velspec = posspec.ConvertToVelocitySpecification();
+        ConfigurationSpecification newspec = posspec;
+        newspec.AddDerivativeGroups(1, false);
+        newspec.AddDeltaTimeGroup();
+        int timeoffset = -1;
+        FOREACH(itgroup, newspec._vgroups) {
+            if( itgroup->name == "deltatime" ) {
+                timeoffset = itgroup->offset;
+            }
+            else if( velspec.FindCompatibleGroup(*itgroup) != velspec._vgroups.end() ) {
+                itgroup->interpolation = "linear";
+            }
+            else if( posspec.FindCompatibleGroup(*itgroup) != posspec._vgroups.end() ) {
+                itgroup->interpolation = "quadratic";
+            }
+        }
+
+        std::vector<dReal> vwaypoints;
+        ptraj->GetWaypoints(0, numpoints, vwaypoints, posspec);
+        if( !_DiscretizePath(vwaypoints) ) {
+            if( !bStatusDetail ) {
+                return PlannerStatus(PS_Failed);
+            }
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, failed to discretize path")%GetEnv()->GetId()), PS_Failed);
+        }
+
+        const int numgrid = (int)_vgrids.size();
+        std::vector<dReal> vdata;
+        if( numgrid <= 1 ) {
+            // path has no length, so just output the first point at rest
+            vdata.resize(newspec.GetDOF(), 0);
+            ConfigurationSpecification::ConvertData(vdata.begin(), newspec, vwaypoints.begin(), posspec, 1, GetEnv(), true);
+            ptraj->Init(newspec);
+            ptraj->Insert(0, vdata);
+            return PlannerStatus(PS_HasSolution);
+        }
+
+        PlannerParameters::StateSaver savestate(_parameters);
+        if( !_ComputeConstraints() ) {
+            if( !bStatusDetail ) {
+                return PlannerStatus(PS_Failed);
+            }
+            return OPENRAVE_PLANNER_STATUS(str(boost::format("env=%d, failed to compute path constraints")%GetEnv()->GetId()), PS_Failed);
+        }
+
+        // backward pass computing the controllable sets
+        _vxmin.resize(numgrid);
+        _vxmax.resize(numgrid);
+        _vxmin[numgrid-1] = 0;
+        _vxmax[numgrid-1] = 0;
+        for(int igrid = numgrid-2; igrid >= 0; --igrid) {
+            _SetupStageConstraints(igrid, _vxmin[igrid+1], _vxmax[igrid+1]);
+            dReal x, u;
+            if( !_SolveLP2(_vstageconstraints, 1, 0, x, u) ) {
+                if( !bStatusDetail ) {
+                    return PlannerStatus(PS_Failed);
+                }
+                std::string description = str(boost::format(_("env=%d, path is not controllable at grid %d/%d (s=%.15e)"))%GetEnv()->GetId()%igrid%numgrid%_vgrids[igrid]);
+                RAVELOG_WARN(description);
+                return OPENRAVE_PLANNER_STATUS(description, PS_Failed);
+            }
+            _vxmax[igrid] = max(dReal(0), x);
+            if( !_SolveLP2(_vstageconstraints, -1, 0, x, u) ) {
+                x = 0;
+            }
+            _vxmin[igrid] = max(dReal(0), min(x, _vxmax[igrid]));
+        }
+        if( _vxmin[0] > g_fEpsilonLinear ) {
+            if( !bStatusDetail ) {
+                return PlannerStatus(PS_Failed);
+            }
+            std::string description = str(boost::format(_("env=%d, path cannot start at rest, min controllable sdot^2=%.15e"))%GetEnv()->GetId()%_vxmin[0]);
+            RAVELOG_WARN(description);
+            return OPENRAVE_PLANNER_STATUS(description, PS_Failed);
+        }
+
+        // forward pass greedily choosing the max acceleration that stays controllable
+        _vx.resize(numgrid);
+        _vu.resize(numgrid-1);
+        _vx[0] = 0;
+        for(int igrid = 0; igrid+1 < numgrid; ++igrid) {
+            dReal x = _vx[igrid];
+            dReal umin = -std::numeric_limits<dReal>::infinity(), umax = std::numeric_limits<dReal>::infinity();
+            FOREACHC(itconstraint, _vgridconstraints[igrid]) {
+                dReal rhs = itconstraint->gamma - itconstraint->alpha*x;
+                if( itconstraint->beta > g_fEpsilon ) {
+                    umax = min(umax, rhs/itconstraint->beta);
+                }
+                else if( itconstraint->beta < -g_fEpsilon ) {
+                    umin = max(umin, rhs/itconstraint->beta);
+                }
+            }
+            // the largest acceleration keeping x_{i+1} <= xmax_{i+1}. x_i is in K_i so it is also >= umin and reaches x_{i+1} >= xmin_{i+1}.
+            // if numerical errors make the intervals inconsistent, the joint limits at this grid point win over staying exactly inside K_{i+1}
+            dReal delta = _vgrids[igrid+1] - _vgrids[igrid];
+            dReal u = min(umax, (_vxmax[igrid+1] - x)/(2*delta));
+            u = max(u, umin);
+            dReal xnext = max(dReal(0), x + 2*delta*u);
+            _vu[igrid] = (xnext - x)/(2*delta);
+            _vx[igrid+1] = xnext;
+        }
+
+        // write the trajectory. within a grid interval sddot is constant, so the positions are exactly quadratic in time on the linear segments
+        vdata.resize(numgrid*newspec.GetDOF());
+        std::fill(vdata.begin(), vdata.end(), 0);
+        std::vector<dReal> vposition(dof), vvelocity(dof);
+        dReal fduration = 0;
+        for(int igrid = 0; igrid < numgrid; ++igrid) {
+            std::vector<dReal>::iterator itdata = vdata.begin() + igrid*newspec.GetDOF();
+            _EvalSegment(_vgridsegments[igrid], _vgrids[igrid], vposition, vvelocity);
+            dReal sd = RaveSqrt(max(dReal(0), _vx[igrid]));
+            for(int j = 0; j < dof; ++j) {
+                vvelocity[j] *= sd;
+            }
+            ConfigurationSpecification::ConvertData(itdata, newspec, vposition.begin(), posspec, 1, GetEnv(), true);
+            ConfigurationSpecification::ConvertData(itdata, newspec, vvelocity.begin(), velspec, 1, GetEnv(), false);
+            if( igrid > 0 ) {
+                dReal delta = _vgrids[igrid] - _vgrids[igrid-1];
+                dReal sdsum = RaveSqrt(max(dReal(0), _vx[igrid-1])) + sd;
+                dReal deltatime;
+                if( sdsum > g_fEpsilon ) {
+                    deltatime = 2*delta/sdsum;
+                }
+                else if( RaveFabs(_vu[igrid-1]) > g_fEpsilon ) {
+                    deltatime = RaveSqrt(2*delta/RaveFabs(_vu[igrid-1]));
+                }
+                else {
+                    if( !bStatusDetail ) {
+                        return PlannerStatus(PS_Failed);
+                    }
+                    std::string description = str(boost::format(_("env=%d, path stalls at grid %d/%d"))%GetEnv()->GetId()%igrid%numgrid);
+                    RAVELOG_WARN(description);
+                    return OPENRAVE_PLANNER_STATUS(description, PS_Failed);
+                }
+                itdata[timeoffset] = deltatime;
+                fduration += deltatime;
+            }
+        }
+
+        ptraj->Init(newspec);
+        ptraj->Insert(0, vdata);
+        RAVELOG_DEBUG_FORMAT("env=%d, toppra retimed %d waypoints with %d grid points, duration=%.15e, computation time=%u[us]", GetEnv()->GetId()%numpoints%numgrid%fduration%(utils::GetMonotonicTime()-basetimeus));
+        return PlannerStatus(PS_HasSolution);
+    }
+
+protected:
+    bool _InitPlan()
+    {
+        if( (int)_parameters->_vConfigVelocityLimit.size() != _parameters->GetDOF() || (int)_parameters->_vConfigAccelerationLimit.size() != _parameters->GetDOF() ) {
+            return false;
+        }
+        if( _parameters->gridstep <= 0 ) {
+            RAVELOG_WARN_FORMAT("env=%d, gridstep %f needs to be positive", GetEnv()->GetId()%_parameters->gridstep);
+            return false;
+        }
+
+        _pmanip.reset();
+        _vtorquebodies.clear();
+        std::vector<KinBodyPtr> vusedbodies;
+        _parameters->_configurationspecification.ExtractUsedBodies(GetEnv(), vusedbodies);
+        FOREACH(itbody, vusedbodies) {
+            KinBodyPtr pbody = *itbody;
+            if( _parameters->manipname.size() > 0 && (_parameters->maxmanipspeed > 0 || _parameters->maxmanipaccel > 0) && pbody->IsRobot() ) {
+                RobotBasePtr probot = RaveInterfaceCast<RobotBase>(pbody);
+                RobotBase::ManipulatorPtr pmanip = probot->GetManipulator(_parameters->manipname);
+                if( !!pmanip ) {
+                    _pmanip = pmanip;
+                }
+            }
+            if( _parameters->usetorquelimits ) {
+                TorqueBodyInfo info;
+                info.pbody = pbody;
+                _parameters->_configurationspecification.ExtractUsedIndices(pbody, info.vuseddofindices, info.vconfigindices);
+                pbody->GetDOFTorqueLimits(info.vtorquelimits);
+                bool bHasLimits = false;
+                FOREACHC(itindex, info.vuseddofindices) {
+                    if( info.vtorquelimits.at(*itindex) > 0 ) {
+                        bHasLimits = true;
+                    }
+                }
+                if( bHasLimits ) {
+                    _vtorquebodies.push_back(info);
+                }
+            }
+        }
+        if( _parameters->manipname.size() > 0 && (_parameters->maxmanipspeed > 0 || _parameters->maxmanipaccel > 0) && !_pmanip ) {
+            RAVELOG_WARN_FORMAT("env=%d, could not find manipulator %s in the planned bodies", GetEnv()->GetId()%_parameters->manipname);
+            return false;
+        }
+        return true;
+    }
+
+    /// \brief splits the path into linear segments and corner blends, and the segments into grid points so that every grid interval lies in one segment
+    bool _DiscretizePath(const std::vector<dReal>& vwaypoints)
+    {
+        const int dof = _parameters->GetDOF();
+        _vsegmentstarts.resize(0);
+        _vsegmentdirs.resize(0);
+        _vsegmentcurvatures.resize(0);
+        _vsegmentlengths.resize(0);
+        _vsegmentoffsets.resize(0);
+        _vgrids.resize(0);
+        _vgridsegments.resize(0);
+        _vgridcorner.resize(0);
+
+        // straight pieces between consecutive distinct waypoints
+        std::vector<dReal> vpiecestarts, vpiecedirs, vpiecelengths;
+        std::vector<dReal> vdiff(dof), vprev(dof);
+        for(size_t ipoint = 0; ipoint+1 < vwaypoints.size()/dof; ++ipoint) {
+            std::copy(vwaypoints.begin()+(ipoint+1)*dof, vwaypoints.begin()+(ipoint+2)*dof, vdiff.begin());
+            std::copy(vwaypoints.begin()+ipoint*dof, vwaypoints.begin()+(ipoint+1)*dof, vprev.begin());
+            _parameters->_diffstatefn(vdiff, vprev);
+            dReal flength = 0;
+            FOREACHC(itdiff, vdiff) {
+                flength += (*itdiff)*(*itdiff);
+            }
+            flength = RaveSqrt(flength);
+            if( flength <= g_fEpsilonLinear ) {
+                continue;
+            }
+            vpiecestarts.insert(vpiecestarts.end(), vprev.begin(), vprev.end());
+            for(int j = 0; j < dof; ++j) {
+                vpiecedirs.push_back(vdiff[j]/flength);
+            }
+            vpiecelengths.push_back(flength);
+        }
+
+        // blend radius at the start of every piece. a corner can only be passed with non-zero velocity if the path does not change direction or is blended
+        const int numpieces = (int)vpiecelengths.size();
+        std::vector<dReal> vblendradii(numpieces+1, 0);
+        std::vector<uint8_t> vstop(numpieces+1, 0);
+        vstop[0] = 1;
+        vstop[numpieces] = 1;
+        for(int ipiece = 1; ipiece < numpieces; ++ipiece) {
+            dReal fdot = 0;
+            for(int j = 0; j < dof; ++j) {
+                fdot += vpiecedirs[(ipiece-1)*dof+j]*vpiecedirs[ipiece*dof+j];
+            }
+            if( fdot >= 1-g_fEpsilonLinear ) {
+                continue;
+            }
+            // reversing the direction has to stop anyway
+            if( _parameters->blendradius > 0 && fdot > -1+g_fEpsilonLinear ) {
+                vblendradii[ipiece] = min(_parameters->blendradius, dReal(0.5)*min(vpiecelengths[ipiece-1], vpiecelengths[ipiece]));
+            }
+            else {
+                vstop[ipiece] = 1;
+            }
+        }
+
+        dReal s = 0;
+        _vgrids.push_back(0);
+        _vgridsegments.push_back(0);
+        _vgridcorner.push_back(1);
+        std::vector<dReal> vstart(dof), vdir(dof), vcurvature(dof);
+        for(int ipiece = 0; ipiece < numpieces; ++ipiece) {
+            dReal fblendradius = vblendradii[ipiece];
+            if( fblendradius > 0 ) {
+                // q(s) = start + d0 s + (d1-d0) s^2/(4r) for s in [0,2r] has direction d0 at the start and d1 at the end
+                for(int j = 0; j < dof; ++j) {
+                    vstart[j] = vpiecestarts[ipiece*dof+j] - vpiecedirs[(ipiece-1)*dof+j]*fblendradius;
+                    vdir[j] = vpiecedirs[(ipiece-1)*dof+j];
+                    vcurvature[j] = (vpiecedirs[ipiece*dof+j] - vpiecedirs[(ipiece-1)*dof+j])/(2*fblendradius);
+                }
+                _AddSegment(vstart, vdir, vcurvature, 2*fblendradius, s);
+            }
+            else {
+                _vgridcorner.back() = vstop[ipiece];
+            }
+            dReal flength = vpiecelengths[ipiece] - fblendradius - vblendradii[ipiece+1];
+            if( flength > g_fEpsilonLinear ) {
+                for(int j = 0; j < dof; ++j) {
+                    vstart[j] = vpiecestarts[ipiece*dof+j] + vpiecedirs[ipiece*dof+j]*fblendradius;
+                    vdir[j] = vpiecedirs[ipiece*dof+j];
+                    vcurvature[j] = 0;
+                }
+                _AddSegment(vstart, vdir, vcurvature, flength, s);
+            }
+        }
+        _vgridcorner.back() = 1;
+        return true;
+    }
+
+    /// \brief adds a segment starting at path parameter s and its grid points, increments s by the segment length
+    void _AddSegment(const std::vector<dReal>& vstart, const std::vector<dReal>& vdir, const std::vector<dReal>& vcurvature, dReal flength, dReal& s)
+    {
+        int isegment = (int)_vsegmentlengths.size();
+        _vsegmentstarts.insert(_vsegmentstarts.end(), vstart.begin(), vstart.end());
+        _vsegmentdirs.insert(_vsegmentdirs.end(), vdir.begin(), vdir.end());
+        _vsegmentcurvatures.insert(_vsegmentcurvatures.end(), vcurvature.begin(), vcurvature.end());
+        _vsegmentlengths.push_back(flength);
+        _vsegmentoffsets.push_back(s);
+        int numsteps = max(1, (int)ceil(flength/_parameters->gridstep - g_fEpsilonLinear));
+        for(int istep = 1; istep <= numsteps; ++istep) {
+            _vgrids.push_back(s + flength*istep/numsteps);
+            _vgridsegments.push_back(isegment);
+            _vgridcorner.push_back(0);
+        }
+        s += flength;
+    }
+
+    /// \brief evaluates the configuration q(s) and its derivative q'(s) of segment isegment at path parameter s. s can be outside of the segment.
+    void _EvalSegment(int isegment, dReal s, std::vector<dReal>& vconfig, std::vector<dReal>& vderiv) const
+    {
+        const int dof = _parameters->GetDOF();
+        vconfig.resize(dof);
+        vderiv.resize(dof);
+        if( _vsegmentlengths.size() == 0 ) {
+            std::fill(vderiv.begin(), vderiv.end(), 0);
+            return;
+        }
+        dReal ds = s - _vsegmentoffsets[isegment];
+        for(int j = 0; j < dof; ++j) {
+            dReal fcurvature = _vsegmentcurvatures[isegment*dof+j];
+            vconfig[j] = _vsegmentstarts[isegment*dof+j] + (_vsegmentdirs[isegment*dof+j] + dReal(0.5)*fcurvature*ds)*ds;
+            vderiv[j] = _vsegmentdirs[isegment*dof+j] + fcurvature*ds;
+        }
+    }
+
+    /// \brief computes the per grid point constraint coefficients that do not depend on the controllable sets
+    bool _ComputeConstraints()
+    {
+        const int dof = _parameters->GetDOF();
+        const int numgrid = (int)_vgrids.size();
+        _vgridxmax.resize(numgrid);
+        _vgridconstraints.resize(numgrid);
+        std::vector<dReal> vconfig(dof), vconfigprev(dof), vconfignext(dof), vderiv(dof), vtempderiv(dof);
+        for(int igrid = 0; igrid < numgrid; ++igrid) {
+            std::vector<LinearConstraint>& vconstraints = _vgridconstraints[igrid];
+            vconstraints.resize(0);
+
+            // velocity limits of the segments touching the grid point
+            dReal xmax = std::numeric_limits<dReal>::infinity();
+            if( _vgridcorner[igrid] ) {
+                xmax = 0;
+            }
+            int isegment = igrid+1 < numgrid ? _vgridsegments[igrid+1] : _vgridsegments[igrid];
+            for(int iseg = max(0, _vgridsegments[igrid]); iseg <= isegment; ++iseg) {
+                _EvalSegment(iseg, _vgrids[igrid], vconfig, vderiv);
+                for(int j = 0; j < dof; ++j) {
+                    dReal fderiv = RaveFabs(vderiv[j]);
+                    if( fderiv > g_fEpsilon ) {
+                        dReal sdmax = _parameters->_vConfigVelocityLimit[j]/fderiv;
+                        xmax = min(xmax, sdmax*sdmax);
+                    }
+                }
+            }
+            if( igrid+1 >= numgrid ) {
+                _vgridxmax[igrid] = 0;
+                continue;
+            }
+
+            // joint accelerations: qdd = q'*u + q''*x
+            _EvalSegment(isegment, _vgrids[igrid], vconfig, vderiv);
+            const dReal* pcurvature = &_vsegmentcurvatures[isegment*dof];
+            bool bCurved = false;
+            for(int j = 0; j < dof; ++j) {
+                if( RaveFabs(vderiv[j]) > g_fEpsilon || RaveFabs(pcurvature[j]) > g_fEpsilon ) {
+                    vconstraints.push_back(LinearConstraint(pcurvature[j], vderiv[j], _parameters->_vConfigAccelerationLimit[j]));
+                    vconstraints.push_back(LinearConstraint(-pcurvature[j], -vderiv[j], _parameters->_vConfigAccelerationLimit[j]));
+                }
+                if( RaveFabs(pcurvature[j]) > g_fEpsilon ) {
+                    bCurved = true;
+                }
+            }
+
+            if( _vtorquebodies.size() > 0 ) {
+                if( _parameters->SetStateValues(vconfig) != 0 ) {
+                    RAVELOG_WARN_FORMAT("env=%d, failed to set state at grid %d", GetEnv()->GetId()%igrid);
+                    return false;
+                }
+                FOREACH(itinfo, _vtorquebodies) {
+                    _AddTorqueConstraints(*itinfo, vderiv, bCurved ? pcurvature : NULL, vconstraints);
+                }
+            }
+
+            if( !!_pmanip ) {
+                // finite differences of the end effector position along the path give p' and p'', so that v = p'*sd and a = p'*u + p''*x
+                dReal h = min(_parameters->gridstep, dReal(1e-3));
+                _EvalSegment(isegment, _vgrids[igrid]-h, vconfigprev, vtempderiv);
+                _EvalSegment(isegment, _vgrids[igrid]+h, vconfignext, vtempderiv);
+                if( _parameters->SetStateValues(vconfigprev) != 0 ) {
+                    return false;
+                }
+                Vector pprev = _pmanip->GetTransform().trans;
+                if( _parameters->SetStateValues(vconfignext) != 0 ) {
+                    return false;
+                }
+                Vector pnext = _pmanip->GetTransform().trans;
+                if( _parameters->SetStateValues(vconfig) != 0 ) {
+                    return false;
+                }
+                Vector pcur = _pmanip->GetTransform().trans;
+                Vector dp = (pnext - pprev)*(0.5/h);
+                Vector ddp = (pnext - 2*pcur + pprev)*(1/(h*h));
+                dReal dplen2 = dp.lengthsqr3();
+                if( _parameters->maxmanipspeed > 0 && dplen2 > g_fEpsilon ) {
+                    xmax = min(xmax, _parameters->maxmanipspeed*_parameters->maxmanipspeed/dplen2);
+                }
+                if( _parameters->maxmanipaccel > 0 ) {
+                    // a lies in the plane spanned by dp and ddp. approximate the circle |a| <= maxmanipaccel in that plane with an inscribed polygon
+                    Vector e1, e2;
+                    if( dplen2 > g_fEpsilon ) {
+                        e1 = dp*(1/RaveSqrt(dplen2));
+                    }
+                    else if( ddp.lengthsqr3() > g_fEpsilon ) {
+                        e1 = ddp*(1/RaveSqrt(ddp.lengthsqr3()));
+                    }
+                    e2 = ddp - e1*e1.dot3(ddp);
+                    if( e2.lengthsqr3() > g_fEpsilon ) {
+                        e2.normalize3();
+                    }
+                    else {
+                        e2 = Vector();
+                    }
+                    const int numdirections = 8;
+                    dReal fbound = _parameters->maxmanipaccel*RaveCos(PI/numdirections);
+                    for(int idir = 0; idir < numdirections; ++idir) {
+                        dReal theta = 2*PI*idir/numdirections;
+                        Vector n = e1*RaveCos(theta) + e2*RaveSin(theta);
+                        vconstraints.push_back(LinearConstraint(n.dot3(ddp), n.dot3(dp), fbound));
+                    }
+                }
+            }
+            _vgridxmax[igrid] = xmax;
+        }
+        return true;
+    }
+
+    struct TorqueBodyInfo
+    {
+        KinBodyPtr pbody;
+        std::vector<int> vuseddofindices, vconfigindices;
+        std::vector<dReal> vtorquelimits;
+    };
+
+    /// \brief torque = M(q)*q'*u + (M(q)*q'' + C(q,q')*q')*x + g(q). The state of the body has to be set to the grid point.
+    ///
+    /// \param pcurvature q'' of the segment, NULL if the segment is linear
+    void _AddTorqueConstraints(const TorqueBodyInfo& info, const std::vector<dReal>& vderiv, const dReal* pcurvature, std::vector<LinearConstraint>& vconstraints)
+    {
+        KinBodyPtr pbody = info.pbody;
+        _vdofdirs.resize(pbody->GetDOF());
+        std::fill(_vdofdirs.begin(), _vdofdirs.end(), 0);
+        for(size_t i = 0; i < info.vuseddofindices.size(); ++i) {
+            _vdofdirs.at(info.vuseddofindices[i]) = vderiv.at(info.vconfigindices[i]);
+        }
+        pbody->GetDOFVelocities(_vsavedvelocities);
+        pbody->SetDOFVelocities(_vdofdirs, KinBody::CLA_Nothing);
+        pbody->ComputeInverseDynamics(_vtorquecomponents, _vdofdirs);
+        if( !!pcurvature ) {
+            for(size_t i = 0; i < info.vuseddofindices.size(); ++i) {
+                _vdofdirs.at(info.vuseddofindices[i]) = pcurvature[info.vconfigindices[i]];
+            }
+            pbody->ComputeInverseDynamics(_vcurvaturetorquecomponents, _vdofdirs);
+        }
+        pbody->SetDOFVelocities(_vsavedvelocities, KinBody::CLA_Nothing);
+        FOREACHC(itindex, info.vuseddofindices) {
+            dReal ftorquelimit = info.vtorquelimits.at(*itindex);
+            if( ftorquelimit <= 0 ) {
+                continue;
+            }
+            dReal a = _vtorquecomponents[0].at(*itindex), b = _vtorquecomponents[1].at(*itindex), c = _vtorquecomponents[2].at(*itindex);
+            if( !!pcurvature ) {
+                b += _vcurvaturetorquecomponents[0].at(*itindex);
+            }
+            vconstraints.push_back(LinearConstraint(b, a, ftorquelimit - c));
+            vconstraints.push_back(LinearConstraint(-b, -a, ftorquelimit + c));
+        }
+    }
+
+    /// \brief fills _vstageconstraints with the constraints on (x_i,u_i) given that x_{i+1} has to be in [xnextmin, xnextmax]
+    ///
+    /// The bounds on x come first since they are the most likely to be active, which keeps _SolveLP2 from revisiting its optimum.
+    void _SetupStageConstraints(int igrid, dReal xnextmin, dReal xnextmax)
+    {
+        dReal delta = _vgrids[igrid+1] - _vgrids[igrid];
+        _vstageconstraints.resize(0);
+        _vstageconstraints.push_back(LinearConstraint(-1, 0, 0));
+        if( _vgridxmax[igrid] < std::numeric_limits<dReal>::infinity() ) {
+            _vstageconstraints.push_back(LinearConstraint(1, 0, _vgridxmax[igrid]));
+        }
+        _vstageconstraints.push_back(LinearConstraint(1, 2*delta, xnextmax));
+        _vstageconstraints.push_back(LinearConstraint(-1, -2*delta, -xnextmin));
+        _vstageconstraints.insert(_vstageconstraints.end(), _vgridconstraints[igrid].begin(), _vgridconstraints[igrid].end());
+    }
+
+    /// \brief solves max cx*x + cu*u subject to the constraints with Seidel's incremental algorithm.
+    ///
+    /// The optimum of the constraints added so far is kept as long as the next constraint does not cut it off. Otherwise the new optimum lies
+    /// on the line of that constraint and is found with a one dimensional program over the previous constraints. This is O(m) per cut instead
+    /// of checking all O(m^2) vertices of the feasible polygon against all m constraints. A large bounding box keeps the program bounded.
+    /// \return false if infeasible
+    static bool _SolveLP2(const std::vector<LinearConstraint>& vconstraints, dReal cx, dReal cu, dReal& xopt, dReal& uopt)
+    {
+        const dReal fbound = 1e8;
+        xopt = cx >= 0 ? fbound : -fbound;
+        uopt = cu > 0 ? fbound : (cu < 0 ? -fbound : 0);
+        for(size_t i = 0; i < vconstraints.size(); ++i) {
+            const LinearConstraint& ci = vconstraints[i];
+            if( ci.alpha*xopt + ci.beta*uopt - ci.gamma <= g_fEpsilonLinear*(1+RaveFabs(ci.gamma)) ) {
+                continue;
+            }
+            dReal fnorm2 = ci.alpha*ci.alpha + ci.beta*ci.beta;
+            if( fnorm2 <= g_fEpsilon*g_fEpsilon ) {
+                // 0 <= gamma does not hold
+                return false;
+            }
+            // points on the line alpha*x + beta*u = gamma are (x0,u0) + t*(dx,du)
+            dReal x0 = ci.alpha*ci.gamma/fnorm2, u0 = ci.beta*ci.gamma/fnorm2;
+            dReal dx = -ci.beta, du = ci.alpha;
+            dReal tmin = -std::numeric_limits<dReal>::infinity(), tmax = std::numeric_limits<dReal>::infinity();
+            bool bfeasible = _ClipLine(LinearConstraint(1, 0, fbound), x0, u0, dx, du, tmin, tmax) && _ClipLine(LinearConstraint(-1, 0, fbound), x0, u0, dx, du, tmin, tmax)
+                             && _ClipLine(LinearConstraint(0, 1, fbound), x0, u0, dx, du, tmin, tmax) && _ClipLine(LinearConstraint(0, -1, fbound), x0, u0, dx, du, tmin, tmax);
+            for(size_t j = 0; j < i && bfeasible; ++j) {
+                bfeasible = _ClipLine(vconstraints[j], x0, u0, dx, du, tmin, tmax);
+            }
+            if( !bfeasible ) {
+                return false;
+            }
+            dReal t;
+            if( tmin > tmax ) {
+                // allow for the same numerical tolerance as the constraints themselves
+                if( (tmin - tmax)*RaveSqrt(fnorm2) > g_fEpsilonLinear*(1+RaveFabs(ci.gamma)) ) {
+                    return false;
+                }
+                t = 0.5*(tmin + tmax);
+            }
+            else {
+                dReal fslope = cx*dx + cu*du;
+                if( fslope > 0 ) {
+                    t = tmax;
+                }
+                else if( fslope < 0 ) {
+                    t = tmin;
+                }
+                else {
+                    t = max(tmin, min(tmax, dReal(0)));
+                }
+            }
+            xopt = x0 + t*dx;
+            uopt = u0 + t*du;
+        }
+        return true;
+    }
+
+    /// \brief intersects [tmin, tmax] with the values of t for which (x0,u0) + t*(dx,du) satisfies the constraint
+    ///
+    /// \return false if the line is parallel to the constraint and outside of it
+    static bool _ClipLine(const LinearConstraint& constraint, dReal x0, dReal u0, dReal dx, dReal du, dReal& tmin, dReal& tmax)
+    {
+        dReal a = constraint.alpha*dx + constraint.beta*du;
+        dReal b = constraint.gamma - constraint.alpha*x0 - constraint.beta*u0;
+        if( RaveFabs(a) <= g_fEpsilon ) {
+            return b >= -g_fEpsilonLinear*(1+RaveFabs(constraint.gamma));
+        }
+        if( a > 0 ) {
+            tmax = min(tmax, b/a);
+        }
+        else {
+            tmin = max(tmin, b/a);
+        }
+        return true;
+    }
+
+    TOPPRAParametersPtr _parameters;
+    RobotBase::ManipulatorPtr _pmanip; ///< if set, constrain the speed and acceleration of the manipulator
+    std::vector<TorqueBodyInfo> _vtorquebodies;
+
+    // path
+    std::vector<dReal> _vsegmentstarts, _vsegmentdirs, _vsegmentlengths, _vsegmentoffsets;
+    std::vector<dReal> _vsegmentcurvatures; ///< q'' of every segment, 0 for the linear segments
+    std::vector<dReal> _vgrids; ///< path parameter of every grid point
+    std::vector<int> _vgridsegments; ///< segment every grid point lies on (the segment ending at it for segment boundaries)
+    std::vector<uint8_t> _vgridcorner; ///< 1 if the path has to stop at the grid point
+
+    // constraints
+    std::vector<dReal> _vgridxmax; ///< upper bound on sdot^2 from velocity limits
+    std::vector< std::vector<LinearConstraint> > _vgridconstraints;
+    std::vector<LinearConstraint> _vstageconstraints;
+    std::vector<dReal> _vxmin, _vxmax, _vx, _vu;
+
+    // cache
+    std::vector<dReal> _vdofdirs, _vsavedvelocities;
+    boost::array< std::vector<dReal>, 3> _vtorquecomponents, _vcurvaturetorquecomponents;
+};
+
+PlannerBasePtr CreateTOPPRATrajectoryRetimer(EnvironmentBasePtr penv, std::istream& sinput)
+{
+    return PlannerBasePtr(new TOPPRATrajectoryRetimer(penv, sinput));
+}
+
+} // end namespace rplanners
@@ -37,11 +37,16 @@ Planner Parameters\n\
 \n\
 - **dReal minimumcompletetime** - specifies the minimum trajectory that must be followed for planner to declare success. If 0, then the entire trajectory has to be followed.\n\
 \n\
+- **bool highratetracking** - if true, track each step with a jacobian solver warm-started from the previous step, and only call the ik solver when it does not converge. Requires the arm chain to consist of non-mimic revolute or prismatic joints.\n\
+\n\
+- **int highratecheckinterval** - in high-rate tracking, check environment collisions every 'highratecheckinterval' steps and bisect down to the first colliding step on failure.\n\
+\n\
 - **TrajectoryBasePtr workspacetraj** - workspace trajectory of the end effector, needs to hold 'ikparam_values' groups\n\
 \n\
 ";
         _report.reset(new CollisionReport());
         _filteroptions = 0;
+        _fFilterStepTime = 0;
     }
     virtual ~WorkspaceTrajectoryTracker() {
     }
@@ -159,7 +164,7 @@ Planner Parameters\n\
         if( minimumcompletetime <= 0 ) {
             minimumcompletetime += workspacetraj->GetDuration();
         }
-        if( _manip->CheckEndEffectorCollision(tlasttrans,_report) ) {
+        if( !_IsEndEffectorCollisionIgnored(workspacetraj->GetDuration()) && _manip->CheckEndEffectorCollision(tlasttrans,_report) ) {
             if( minimumcompletetime >= workspacetraj->GetDuration() ) {
                 std::string description = str(boost::format("final configuration colliding: %s\n")%_report->__str__());
                 RAVELOG_DEBUG(description);
@@ -177,7 +182,7 @@ Planner Parameters\n\
             Transform t = ikparam.GetTransform6D();
             listtransforms.push_back(t);
             // end effector is only fully known given the entire 6D transform!
-            if( _manip->CheckEndEffectorCollision(t,_report) ) {
+            if( !_IsEndEffectorCollisionIgnored(ftime) && _manip->CheckEndEffectorCollision(t,_report) ) {
                 if(( ftime < _parameters->ignorefirstcollision) && bPrevInCollision ) {
                     continue;
                 }
@@ -241,11 +246,29 @@ Planner Parameters\n\
             RAVELOG_ERROR("WorkspaceTrajectoryTracker::PlanPath - do not support non-greedy search\n");
         }
 
-        list<Transform>::iterator ittrans = listtransforms.begin();
         bPrevInCollision = true;
+        bool bHighRate = false;
+        if( _parameters->highratetracking ) {
+            bHighRate = _InitHighRateChain();
+            if( !bHighRate ) {
+                RAVELOG_WARN_FORMAT("env=%d, manipulator %s chain does not support high-rate tracking, using ik solver", GetEnv()->GetId()%_manip->GetName());
+            }
+        }
+        if( bHighRate ) {
+            PlannerStatus status = _TrackHighRate(poutputtraj, listtransforms, fstarttime, minimumcompletetime);
+            if( !(status.GetStatusCode() & PS_HasSolution) ) {
+                return status;
+            }
+            bPrevInCollision = false;
+        }
+
+        list<Transform>::iterator ittrans = bHighRate ? listtransforms.end() : listtransforms.begin();
+        const int numsteps = (int)listtransforms.size();
+        int istep = 0;
         ftime = 0;
-        for(; ittrans != listtransforms.end(); ftime += _parameters->_fStepLength, ++ittrans) {
+        for(; ittrans != listtransforms.end(); ftime += _parameters->_fStepLength, ++ittrans, ++istep) {
             _filteroptions = (ftime >= fstarttime) ? IKFO_CheckEnvCollisions : 0;
+            _fFilterStepTime = _GetStepTime(istep, numsteps);
             IkParameterization ikparam(*ittrans,IKP_Transform6D);
             if( !_manip->FindIKSolution(ikparam,vsolution,_filteroptions) ) {
                 if( _filteroptions == 0 ) {
@@ -324,6 +347,308 @@ protected:
         _vprevsolution = vsolution;
     }
 
+    /// \brief true if the end effector is allowed to be in environment collision at ftime because of ignorefirstcollisionee or ignorelastcollisionee
+    bool _IsEndEffectorCollisionIgnored(dReal ftime) const
+    {
+        if( _parameters->ignorefirstcollisionee > 0 && ftime < _parameters->ignorefirstcollisionee ) {
+            return true;
+        }
+        if( _parameters->ignorelastcollisionee > 0 && ftime > _parameters->workspacetraj->GetDuration() - _parameters->ignorelastcollisionee ) {
+            return true;
+        }
+        return false;
+    }
+
+    /// \brief time of step istep of the tracked transforms, the last step is always at the end of the workspace trajectory
+    dReal _GetStepTime(int istep, int numsteps) const
+    {
+        if( istep+1 >= numsteps ) {
+            return _parameters->workspacetraj->GetDuration();
+        }
+        return istep*_parameters->_fStepLength;
+    }
+
+    /// \brief caches the joints of the arm dofs for computing the jacobian directly. Fails if the chain has joints the jacobian computation cannot handle.
+    bool _InitHighRateChain()
+    {
+        std::vector<KinBody::JointPtr> vchainjoints;
+        if( !_robot->GetChain(_manip->GetBase()->GetIndex(), _manip->GetEndEffector()->GetIndex(), vchainjoints) ) {
+            return false;
+        }
+        FOREACHC(itjoint, vchainjoints) {
+            if( (*itjoint)->IsMimic() ) {
+                return false;
+            }
+        }
+        _vhighratejoints.resize(0);
+        FOREACHC(itindex, _manip->GetArmIndices()) {
+            KinBody::JointPtr pjoint = _robot->GetJointFromDOFIndex(*itindex);
+            if( pjoint->GetDOF() != 1 || !(pjoint->IsRevolute(0) || pjoint->IsPrismatic(0)) ) {
+                return false;
+            }
+            if( find(vchainjoints.begin(), vchainjoints.end(), pjoint) == vchainjoints.end() ) {
+                return false;
+            }
+            _vhighratejoints.push_back(pjoint);
+        }
+        _vhighratejacobian.resize(6*_vhighratejoints.size());
+        return true;
+    }
+
+    /// \brief solves A*x = b in place for a 6x6 symmetric positive definite A using the lower triangle. b is overwritten with x.
+    static bool _SolveCholesky6(boost::array<dReal,36>& A, boost::array<dReal,6>& b)
+    {
+        for(int j = 0; j < 6; ++j) {
+            dReal d = A[j*6+j];
+            for(int k = 0; k < j; ++k) {
+                d -= A[j*6+k]*A[j*6+k];
+            }
+            if( d <= 0 ) {
+                return false;
+            }
+            d = RaveSqrt(d);
+            A[j*6+j] = d;
+            for(int i = j+1; i < 6; ++i) {
+                dReal f = A[i*6+j];
+                for(int k = 0; k < j; ++k) {
+                    f -= A[i*6+k]*A[j*6+k];
+                }
+                A[i*6+j] = f/d;
+            }
+        }
+        for(int i = 0; i < 6; ++i) {
+            for(int k = 0; k < i; ++k) {
+                b[i] -= A[i*6+k]*b[k];
+            }
+            b[i] /= A[i*6+i];
+        }
+        for(int i = 5; i >= 0; --i) {
+            for(int k = i+1; k < 6; ++k) {
+                b[i] -= A[k*6+i]*b[k];
+            }
+            b[i] /= A[i*6+i];
+        }
+        return true;
+    }
+
+    /// \brief moves vsolution to reach ttarget with damped least squares, starting from vsolution itself.
+    ///
+    /// \return false if did not converge, left the joint limits, or jumped too far from the starting configuration. vsolution is undefined in that case.
+    bool _SolveHighRateStep(const Transform& ttarget, std::vector<dReal>& vsolution)
+    {
+        const dReal fdamping2 = 1e-6;
+        const int nmaxiterations = 20;
+        _vhighratestart = vsolution;
+        for(int iter = 0; iter < nmaxiterations; ++iter) {
+            _robot->SetActiveDOFValues(vsolution, KinBody::CLA_Nothing);
+            Transform tcur = _manip->GetTransform();
+            Vector errortrans = ttarget.trans - tcur.trans;
+            Vector errorrot = axisAngleFromQuat(quatMultiply(ttarget.rot, quatInverse(tcur.rot)));
+            if( errortrans.lengthsqr3() + errorrot.lengthsqr3() <= g_fEpsilonWorkSpaceLimitSqr ) {
+                // same continuity threshold as _ValidateSolution uses without a jacobian
+                for(size_t j = 0; j < vsolution.size(); ++j) {
+                    if( RaveFabs(vsolution[j] - _vhighratestart[j]) > 0.1f ) {
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // columns are [translation; rotation] in world coordinates
+            for(size_t j = 0; j < _vhighratejoints.size(); ++j) {
+                const KinBody::JointPtr& pjoint = _vhighratejoints[j];
+                Vector vaxis = pjoint->GetAxis(0);
+                Vector vtrans, vrot;
+                if( pjoint->IsRevolute(0) ) {
+                    vtrans = vaxis.cross(tcur.trans - pjoint->GetAnchor());
+                    vrot = vaxis;
+                }
+                else {
+                    vtrans = vaxis;
+                }
+                dReal* pcolumn = &_vhighratejacobian[6*j];
+                pcolumn[0] = vtrans.x; pcolumn[1] = vtrans.y; pcolumn[2] = vtrans.z;
+                pcolumn[3] = vrot.x; pcolumn[4] = vrot.y; pcolumn[5] = vrot.z;
+            }
+
+            // dq = J^T (J J^T + damping*I)^-1 error
+            boost::array<dReal,36> A;
+            for(int i = 0; i < 6; ++i) {
+                for(int k = 0; k <= i; ++k) {
+                    dReal f = 0;
+                    for(size_t j = 0; j < _vhighratejoints.size(); ++j) {
+                        f += _vhighratejacobian[6*j+i]*_vhighratejacobian[6*j+k];
+                    }
+                    A[i*6+k] = f;
+                }
+                A[i*6+i] += fdamping2;
+            }
+            boost::array<dReal,6> y = {{errortrans.x, errortrans.y, errortrans.z, errorrot.x, errorrot.y, errorrot.z}};
+            if( !_SolveCholesky6(A, y) ) {
+                return false;
+            }
+            for(size_t j = 0; j < vsolution.size(); ++j) {
+                const dReal* pcolumn = &_vhighratejacobian[6*j];
+                dReal dq = 0;
+                for(int i = 0; i < 6; ++i) {
+                    dq += pcolumn[i]*y[i];
+                }
+                vsolution[j] += dq;
+                if( vsolution[j] < _parameters->_vConfigLowerLimit[j] || vsolution[j] > _parameters->_vConfigUpperLimit[j] ) {
+                    return false;
+                }
+            }
+        }
+        return false;
+    }
+
+    /// \brief copies the tracked configuration of step istep into vconfig. -1 is the initial configuration, or step 0 if there is none.
+    void _GetTrackedConfig(int istep, std::vector<dReal>& vconfig)
+    {
+        if( istep < 0 ) {
+            if( (int)_parameters->vinitialconfig.size() == _parameters->GetDOF() ) {
+                vconfig = _parameters->vinitialconfig;
+                return;
+            }
+            istep = 0;
+        }
+        std::vector<dReal>::const_iterator itconfig = _vtrackedconfigs.begin() + istep*_parameters->GetDOF();
+        vconfig.assign(itconfig, itconfig+_parameters->GetDOF());
+    }
+
+    /// \brief checks all constraints on the segment between two tracked steps.
+    ///
+    /// The environment collisions of the end effector are also checked unless bcheckendeffector is false, _TrackHighRate never lets a segment span steps where this differs.
+    bool _CheckTrackedSegment(int istart, int iend, bool bcheckendeffector)
+    {
+        _GetTrackedConfig(istart, _vhighratecheck0);
+        _GetTrackedConfig(iend, _vhighratecheck1);
+        if( bcheckendeffector ) {
+            FOREACH(it,_vchildlinks) {
+                (*it)->Enable(true);
+            }
+        }
+        bool bsuccess = _parameters->CheckPathAllConstraints(_vhighratecheck0, _vhighratecheck1, _vhighratenovelocities, _vhighratenovelocities, 0, IT_OpenStart) == 0;
+        if( bcheckendeffector ) {
+            FOREACH(it,_vchildlinks) {
+                (*it)->Enable(false);
+            }
+        }
+        return bsuccess;
+    }
+
+    /// \brief checks the steps (ivalid, iend] with one segment check and bisects down to the first colliding step if it fails.
+    ///
+    /// \param ivalid the last valid step, set to the last step known to be valid
+    /// \return the first colliding step or -1 if all are valid
+    int _FindFirstCollidingStep(int& ivalid, int iend, bool bcheckendeffector)
+    {
+        if( _CheckTrackedSegment(ivalid, iend, bcheckendeffector) ) {
+            ivalid = iend;
+            return -1;
+        }
+        int ilow = ivalid, ihigh = iend;
+        while( ihigh - ilow > 1 ) {
+            int imid = (ilow + ihigh)/2;
+            if( _CheckTrackedSegment(ilow, imid, bcheckendeffector) ) {
+                ilow = imid;
+            }
+            else {
+                ihigh = imid;
+            }
+        }
+        ivalid = ilow;
+        return ihigh;
+    }
+
+    /// \brief tracks listtransforms with _SolveHighRateStep and inserts the result into poutputtraj.
+    ///
+    /// Collisions are checked every highratecheckinterval steps by one segment in configuration space, so the checked path is the linear interpolation of the tracked steps of each interval. Segments also end where ignorefirstcollisionee or ignorelastcollisionee start or stop applying, so the end effector is checked on exactly the steps outside of those windows.
+    PlannerStatus _TrackHighRate(TrajectoryBasePtr poutputtraj, const list<Transform>& listtransforms, dReal fstarttime, dReal minimumcompletetime)
+    {
+        const int ndof = _parameters->GetDOF();
+        const int ncheckinterval = max(1, _parameters->highratecheckinterval);
+        const int numsteps = (int)listtransforms.size();
+        _vtrackedconfigs.resize(numsteps*ndof);
+        bool bHasPrevious = (int)_parameters->vinitialconfig.size() == ndof;
+        if( bHasPrevious ) {
+            _vhighratesolution = _parameters->vinitialconfig;
+        }
+
+        bool bPrevInCollision = true;
+        int ivalid = -1; // last step that is known to be valid, -1 is the initial configuration
+        int numaccepted = numsteps;
+        int nfallbacks = 0;
+        int istep = 0;
+        dReal ftime = 0;
+        for(list<Transform>::const_iterator ittrans = listtransforms.begin(); ittrans != listtransforms.end(); ++ittrans, ++istep, ftime += _parameters->_fStepLength) {
+            if( !bHasPrevious || !_SolveHighRateStep(*ittrans, _vhighratesolution) ) {
+                // use the ik solver with the continuity filter
+                ++nfallbacks;
+                if( bHasPrevious ) {
+                    _GetTrackedConfig(istep-1, _vhighratesolution);
+                    if( _parameters->SetStateValues(_vhighratesolution) != 0 ) {
+                        return PlannerStatus("failed to set state\n", PS_Failed);
+                    }
+                    _SetPreviousSolution(_vhighratesolution);
+                }
+                _filteroptions = 0; // collisions are checked by _FindFirstCollidingStep
+                if( !_manip->FindIKSolution(IkParameterization(*ittrans,IKP_Transform6D), _vhighratesolution, _filteroptions) ) {
+                    return PlannerStatus(str(boost::format("env=%d, failed to find ik solution at time %f/%f")%GetEnv()->GetId()%ftime%_parameters->workspacetraj->GetDuration()), PS_Failed);
+                }
+                bHasPrevious = true;
+            }
+            std::copy(_vhighratesolution.begin(), _vhighratesolution.end(), _vtrackedconfigs.begin()+istep*ndof);
+
+            if( ftime < fstarttime ) {
+                // end effector is still in collision, so do not check the environment
+                ivalid = istep;
+                bPrevInCollision = false;
+                continue;
+            }
+            bool bcheckendeffector = !_IsEndEffectorCollisionIgnored(_GetStepTime(istep, numsteps));
+            if( istep - ivalid < ncheckinterval && istep+1 < numsteps && bcheckendeffector == !_IsEndEffectorCollisionIgnored(_GetStepTime(istep+1, numsteps)) ) {
+                continue;
+            }
+
+            bool bDone = false;
+            while( ivalid < istep ) {
+                int iprevvalid = ivalid;
+                int icolliding = _FindFirstCollidingStep(ivalid, istep, bcheckendeffector);
+                if( ivalid > iprevvalid ) {
+                    bPrevInCollision = false;
+                }
+                if( icolliding < 0 ) {
+                    break;
+                }
+                dReal fcollidingtime = icolliding*_parameters->_fStepLength;
+                if( fcollidingtime < _parameters->ignorefirstcollision && bPrevInCollision ) {
+                    ivalid = icolliding;
+                    continue;
+                }
+                if( !bPrevInCollision && fcollidingtime >= minimumcompletetime ) {
+                    numaccepted = icolliding;
+                    bDone = true;
+                    break;
+                }
+                return PlannerStatus(str(boost::format("env=%d, collision at time %f/%f")%GetEnv()->GetId()%fcollidingtime%_parameters->workspacetraj->GetDuration()), PS_Failed);
+            }
+            if( bDone ) {
+                break;
+            }
+        }
+
+        if( bPrevInCollision ) {
+            return PlannerStatus("bPrevInCollision" ,PS_Failed);
+        }
+        RAVELOG_DEBUG_FORMAT("env=%d, high-rate tracking accepted %d/%d steps with %d ik solver fallbacks", GetEnv()->GetId()%numaccepted%numsteps%nfallbacks);
+        if( numaccepted > 0 ) {
+            _vtrackedconfigs.resize(numaccepted*ndof);
+            poutputtraj->Insert(poutputtraj->GetNumWaypoints(), _vtrackedconfigs, _parameters->_configurationspecification);
+        }
+        return PlannerStatus(PS_HasSolution);
+    }
+
     IkReturnAction _ValidateSolution(std::vector<dReal>& vsolution, RobotBase::ManipulatorConstPtr pmanip, const IkParameterization& ikp)
     {
         RobotBase::RobotStateSaver saver(_robot);
@@ -407,15 +732,22 @@ protected:
         }
 
         if( _filteroptions & IKFO_CheckEnvCollisions ) {
-            // check rest of environment collisions
-            FOREACH(it,_vchildlinks) {
-                (*it)->Enable(true);
+            // check rest of environment collisions. like the end effector prescan and _TrackHighRate, the child links are only
+            // checked outside of the ignorefirstcollisionee and ignorelastcollisionee windows
+            bool bcheckendeffector = !_IsEndEffectorCollisionIgnored(_fFilterStepTime);
+            if( bcheckendeffector ) {
+                FOREACH(it,_vchildlinks) {
+                    (*it)->Enable(true);
+                }
             }
-            if( _parameters->CheckPathAllConstraints((_vprevsolution.size() > 0) ? _vprevsolution : vsolution, vsolution, std::vector<dReal>(), std::vector<dReal>(), 0, IT_Open) != 0 ) {
-                return IKRA_Reject;
+            int ret = _parameters->CheckPathAllConstraints((_vprevsolution.size() > 0) ? _vprevsolution : vsolution, vsolution, std::vector<dReal>(), std::vector<dReal>(), 0, IT_Open);
+            if( bcheckendeffector ) {
+                FOREACH(it,_vchildlinks) {
+                    (*it)->Enable(false);
+                }
             }
-            FOREACH(it,_vchildlinks) {
-                (*it)->Enable(false);
+            if( ret != 0 ) {
+                return IKRA_Reject;
             }
         }
         return IKRA_Success;
@@ -427,6 +759,7 @@ protected:
     boost::shared_ptr<WorkspaceTrajectoryParameters> _parameters;
     dReal _fMaxCosDeviationAngle;
     int _filteroptions;
+    dReal _fFilterStepTime; ///< time of the step whose ik solutions _ValidateSolution checks
     vector<KinBody::LinkPtr> _vchildlinks;
 
     // planning state
@@ -435,6 +768,13 @@ protected:
     IkParameterization _ikprev;
     vector<dReal> _vprevsolution;
     PlannerBasePtr _retimerplanner;
+
+    // high-rate tracking state, kept across calls to avoid allocations
+    std::vector<KinBody::JointPtr> _vhighratejoints; ///< joint of each arm dof
+    std::vector<dReal> _vhighratejacobian; ///< 6 x dof, column major
+    std::vector<dReal> _vhighratesolution, _vhighratestart, _vhighratecheck0, _vhighratecheck1;
+    std::vector<dReal> _vhighratenovelocities; ///< always empty, passed as the velocities of the checked segments
+    std::vector<dReal> _vtrackedconfigs; ///< dof values of every tracked step
 };
 
 PlannerBasePtr CreateWorkspaceTrajectoryTracker(EnvironmentBasePtr penv, std::istream& sinput) {
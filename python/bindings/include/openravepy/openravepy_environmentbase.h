@@ -244,6 +244,12 @@ public:
 
     object GetBodies();
 
+    void AddLazyBody(object oinfo);
+
+    object GetLazyBodies();
+
+    int MaterializeLazyBodies(object oaabb);
+
     object GetRobots();
 
     object GetSensors();
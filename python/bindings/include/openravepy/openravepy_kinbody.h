@@ -156,6 +156,7 @@ public:
 #endif
         py::object _transform = ReturnTransform(Transform());
         bool _isRobot = false;
+        int _revision = 0;
         py::object _dofValues = py::none_();
         py::object _readableInterfaces = py::none_();
         virtual std::string __str__();
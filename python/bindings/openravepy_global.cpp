@@ -948,6 +948,20 @@ object pyRaveInvertFileLookup(const std::string& filename)
     return py::none_();
 }
 
+void pyRaveClearLoaderCaches(int types=0xffff)
+{
+    OpenRAVE::RaveClearLoaderCaches(types);
+}
+
+/// returns (nhits, nmisses, nentries)
+object pyRaveGetLoaderCacheStats(int type)
+{
+    uint64_t nhits = 0, nmisses = 0;
+    size_t nentries = 0;
+    OpenRAVE::RaveGetLoaderCacheStats((LoaderCacheType)type, nhits, nmisses, nentries);
+    return py::make_tuple(nhits, nmisses, nentries);
+}
+
 object RaveGetPluginInfo()
 {
     py::list plugins;
@@ -1283,6 +1297,7 @@ BOOST_PYTHON_FUNCTION_OVERLOADS(ComputePoseDistSqr_overloads, openravepy::Comput
 BOOST_PYTHON_FUNCTION_OVERLOADS(pyRaveGetAffineConfigurationSpecification_overloads, openravepy::pyRaveGetAffineConfigurationSpecification, 1, 3)
 BOOST_PYTHON_FUNCTION_OVERLOADS(pyRaveGetAffineDOFValuesFromTransform_overloads, openravepy::pyRaveGetAffineDOFValuesFromTransform, 2, 3)
 BOOST_PYTHON_FUNCTION_OVERLOADS(RaveClone_overloads, pyRaveClone, 2, 3)
+BOOST_PYTHON_FUNCTION_OVERLOADS(RaveClearLoaderCaches_overloads, pyRaveClearLoaderCaches, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ExtractTransform_overloads, PyConfigurationSpecification::ExtractTransform, 3, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ExtractIkParameterization_overloads, PyConfigurationSpecification::ExtractIkParameterization, 1, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(ExtractAffineValues_overloads, PyConfigurationSpecification::ExtractAffineValues, 3, 4)
@@ -1331,6 +1346,14 @@ void init_openravepy_global()
     .value("Verbose",Level_Verbose)
     .value("VerifyPlans",Level_VerifyPlans)
     ;
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+    enum_<LoaderCacheType>(m, "LoaderCacheType", py::arithmetic() DOXY_ENUM(LoaderCacheType))
+#else
+    enum_<LoaderCacheType>("LoaderCacheType" DOXY_ENUM(LoaderCacheType))
+#endif
+    .value("MeshImport",LCT_MeshImport)
+    .value("JSONDocument",LCT_JSONDocument)
+    ;
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
     enum_<SerializationOptions>(m, "SerializationOptions", py::arithmetic() DOXY_ENUM(SerializationOptions))
 #else
@@ -1871,6 +1894,16 @@ void init_openravepy_global()
 #else
     def("RaveInvertFileLookup",openravepy::pyRaveInvertFileLookup, PY_ARGS("filename") DOXY_FN1(RaveInvertFileLookup));
 #endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+    m.def("RaveClearLoaderCaches",openravepy::pyRaveClearLoaderCaches, "types"_a = 0xffff, DOXY_FN1(RaveClearLoaderCaches));
+#else
+    def("RaveClearLoaderCaches",openravepy::pyRaveClearLoaderCaches,RaveClearLoaderCaches_overloads(PY_ARGS("types") DOXY_FN1(RaveClearLoaderCaches)));
+#endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+    m.def("RaveGetLoaderCacheStats",openravepy::pyRaveGetLoaderCacheStats, PY_ARGS("type") DOXY_FN1(RaveGetLoaderCacheStats));
+#else
+    def("RaveGetLoaderCacheStats",openravepy::pyRaveGetLoaderCacheStats, PY_ARGS("type") DOXY_FN1(RaveGetLoaderCacheStats));
+#endif
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
     m.def("RaveGetHomeDirectory",OpenRAVE::RaveGetHomeDirectory,DOXY_FN1(RaveGetHomeDirectory));
 #else
@@ -2228,6 +2228,31 @@ object PyEnvironmentBase::GetBodies()
     return bodies;
 }
 
+void PyEnvironmentBase::AddLazyBody(object oinfo)
+{
+    extract_<OPENRAVE_SHARED_PTR<PyKinBody::PyKinBodyInfo> > pykinbodyinfo(oinfo);
+    if (!pykinbodyinfo.check()) {
+        throw openrave_exception(_("Bad BodyInfo"));
+    }
+    _penv->AddLazyBody(((OPENRAVE_SHARED_PTR<PyKinBody::PyKinBodyInfo>)pykinbodyinfo)->GetKinBodyInfo());
+}
+
+object PyEnvironmentBase::GetLazyBodies()
+{
+    std::vector< std::pair<std::string, AABB> > vLazyBodies;
+    _penv->GetLazyBodies(vLazyBodies);
+    py::list lazybodies;
+    FOREACHC(itlazybody, vLazyBodies) {
+        lazybodies.append(py::make_tuple(itlazybody->first, toPyAABB(itlazybody->second)));
+    }
+    return lazybodies;
+}
+
+int PyEnvironmentBase::MaterializeLazyBodies(object oaabb)
+{
+    return _penv->MaterializeLazyBodies(ExtractAABB(oaabb));
+}
+
 object PyEnvironmentBase::GetRobots()
 {
     std::vector<RobotBasePtr> vrobots;
@@ -3121,6 +3146,9 @@ Because race conditions can pop up when trying to lock the openrave environment
 #endif
                      .def("GetRobots",&PyEnvironmentBase::GetRobots, DOXY_FN(EnvironmentBase,GetRobots))
                      .def("GetBodies",&PyEnvironmentBase::GetBodies, DOXY_FN(EnvironmentBase,GetBodies))
+                     .def("AddLazyBody",&PyEnvironmentBase::AddLazyBody, PY_ARGS("info") DOXY_FN(EnvironmentBase,AddLazyBody))
+                     .def("GetLazyBodies",&PyEnvironmentBase::GetLazyBodies, DOXY_FN(EnvironmentBase,GetLazyBodies))
+                     .def("MaterializeLazyBodies",&PyEnvironmentBase::MaterializeLazyBodies, PY_ARGS("aabb") DOXY_FN(EnvironmentBase,MaterializeLazyBodies))
                      .def("GetSensors",&PyEnvironmentBase::GetSensors, DOXY_FN(EnvironmentBase,GetSensors))
                      .def("UpdatePublishedBodies",&PyEnvironmentBase::UpdatePublishedBodies, DOXY_FN(EnvironmentBase,UpdatePublishedBodies))
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
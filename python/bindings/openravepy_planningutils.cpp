@@ -95,6 +95,11 @@ void pyVerifyTrajectory(object pyparameters, PyTrajectoryBasePtr pytraj, dReal s
     OpenRAVE::planningutils::VerifyTrajectory(openravepy::GetPlannerParametersConst(pyparameters), openravepy::GetTrajectory(pytraj),samplingstep);
 }
 
+void pyVerifyTrajectoryParallel(object pyparameters, PyTrajectoryBasePtr pytraj, dReal samplingstep, int nsegmentsperchunk)
+{
+    OpenRAVE::planningutils::VerifyTrajectoryParallel(openravepy::GetPlannerParametersConst(pyparameters), openravepy::GetTrajectory(pytraj), OpenRAVE::planningutils::PlannerParametersWorkerPoolPtr(), samplingstep, nsegmentsperchunk);
+}
+
 // GIL is assumed locked
 object pySmoothActiveDOFTrajectory(PyTrajectoryBasePtr pytraj, PyRobotBasePtr pyrobot, dReal fmaxvelmult=1.0, dReal fmaxaccelmult=1.0, const std::string& plannername="", const std::string& plannerparameters="")
 {
@@ -196,6 +201,48 @@ public:
 
 typedef OPENRAVE_SHARED_PTR<PyAffineTrajectoryRetimer> PyAffineTrajectoryRetimerPtr;
 
+class PyTrajectoryRetimerBatch
+{
+public:
+    PyTrajectoryRetimerBatch(const std::string& plannername, const std::string& plannerparameters, int nthreads=0) : _retimer(plannername, plannerparameters, nthreads) {
+    }
+    virtual ~PyTrajectoryRetimerBatch() {
+    }
+
+    object PlanPaths(object otrajs, bool hastimestamps=false, dReal fmaxvelmult=1, dReal fmaxaccelmult=1, bool releasegil=true)
+    {
+        openravepy::PythonThreadSaverPtr statesaver;
+        std::vector<TrajectoryBasePtr> vtrajs(len(otrajs));
+        for(size_t i = 0; i < vtrajs.size(); ++i) {
+            extract_<PyTrajectoryBasePtr> epytrajectory(otrajs[i]);
+            vtrajs[i] = openravepy::GetTrajectory((PyTrajectoryBasePtr)epytrajectory);
+        }
+        std::vector<PlannerStatus> vstatuses;
+        if( releasegil ) {
+            statesaver.reset(new openravepy::PythonThreadSaver());
+        }
+        _retimer.PlanPaths(vtrajs, vstatuses, hastimestamps, fmaxvelmult, fmaxaccelmult);
+        statesaver.reset(); // to re-lock the GIL
+        py::list ostatuses;
+        FOREACH(itstatus, vstatuses) {
+            ostatuses.append(openravepy::toPyPlannerStatus(*itstatus));
+        }
+        return ostatuses;
+    }
+
+    void Reset() {
+        _retimer.Reset();
+    }
+
+    int GetNumThreads() const {
+        return _retimer.GetNumThreads();
+    }
+
+    OpenRAVE::planningutils::TrajectoryRetimerBatch _retimer;
+};
+
+typedef OPENRAVE_SHARED_PTR<PyTrajectoryRetimerBatch> PyTrajectoryRetimerBatchPtr;
+
 class PyDynamicsCollisionConstraint
 {
 public:
@@ -451,6 +498,20 @@ public:
         return _sampler->GetIkParameterizationIndex(index);
     }
 
+    void SetParallel(int numworkers, int numcandidates)
+    {
+        OpenRAVE::planningutils::PlannerParametersWorkerPoolPtr pool;
+        if( numworkers != 1 ) {
+            pool.reset(new OpenRAVE::planningutils::PlannerParametersWorkerPool(_sampler->GetManipulator()->GetRobot()->GetEnv(), PlannerBase::PlannerParametersConstPtr(), numworkers));
+        }
+        _sampler->SetParallel(pool, numcandidates);
+    }
+
+    void SetDeadline(uint64_t deadline)
+    {
+        _sampler->SetDeadline(deadline);
+    }
+
     OpenRAVE::planningutils::ManipulatorIKGoalSamplerPtr _sampler;
 };
 
@@ -479,6 +540,7 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(Check_overloads, Check, 5, 8)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PlanPath_overloads, PlanPath, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PlanPath_overloads2, PlanPath, 3, 5)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PlanPath_overloads3, PlanPath, 1, 3)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(PlanPaths_overloads, PlanPaths, 1, 5)
 #endif // USE_PYBIND11_PYTHON_BINDINGS
 
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
@@ -543,6 +605,12 @@ void InitPlanningUtils()
                                .def("VerifyTrajectory",planningutils::pyVerifyTrajectory, PY_ARGS("parameters","trajectory","samplingstep") DOXY_FN1(VerifyTrajectory))
                                .staticmethod("VerifyTrajectory")
 #endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+                               .def_static("VerifyTrajectoryParallel",planningutils::pyVerifyTrajectoryParallel, PY_ARGS("parameters","trajectory","samplingstep","nsegmentsperchunk") DOXY_FN1(VerifyTrajectoryParallel))
+#else
+                               .def("VerifyTrajectoryParallel",planningutils::pyVerifyTrajectoryParallel, PY_ARGS("parameters","trajectory","samplingstep","nsegmentsperchunk") DOXY_FN1(VerifyTrajectoryParallel))
+                               .staticmethod("VerifyTrajectoryParallel")
+#endif
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
                                .def_static("SmoothActiveDOFTrajectory", planningutils::pySmoothActiveDOFTrajectory,
                                            "trajectory"_a,
@@ -793,6 +861,8 @@ void InitPlanningUtils()
 
 #endif
         .def("GetIkParameterizationIndex", &planningutils::PyManipulatorIKGoalSampler::GetIkParameterizationIndex, PY_ARGS("index") DOXY_FN(planningutils::ManipulatorIKGoalSampler, GetIkParameterizationIndex))
+        .def("SetParallel", &planningutils::PyManipulatorIKGoalSampler::SetParallel, PY_ARGS("numworkers", "numcandidates") DOXY_FN(planningutils::ManipulatorIKGoalSampler, SetParallel))
+        .def("SetDeadline", &planningutils::PyManipulatorIKGoalSampler::SetDeadline, PY_ARGS("deadline") DOXY_FN(planningutils::ManipulatorIKGoalSampler, SetDeadline))
         ;
 
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
@@ -852,6 +922,29 @@ void InitPlanningUtils()
 #endif
         ;
 
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        class_<planningutils::PyTrajectoryRetimerBatch, planningutils::PyTrajectoryRetimerBatchPtr >(planningutils, "TrajectoryRetimerBatch", DOXY_CLASS(planningutils::TrajectoryRetimerBatch))
+        .def(init<const std::string&, const std::string&, int>(), "plannername"_a = "", "plannerparameters"_a = "", "nthreads"_a = 0)
+#else
+        class_<planningutils::PyTrajectoryRetimerBatch, planningutils::PyTrajectoryRetimerBatchPtr >("TrajectoryRetimerBatch", DOXY_CLASS(planningutils::TrajectoryRetimerBatch), no_init)
+        .def(init<const std::string&, const std::string&, optional<int> >(py::args("plannername", "plannerparameters", "nthreads")))
+#endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        .def("PlanPaths", &planningutils::PyTrajectoryRetimerBatch::PlanPaths,
+             "trajs"_a,
+             "hastimestamps"_a = false,
+             "maxvelmult"_a = 1.0,
+             "maxaccelmult"_a = 1.0,
+             "releasegil"_a = true,
+             DOXY_FN(planningutils::TrajectoryRetimerBatch, PlanPaths)
+             )
+#else
+        .def("PlanPaths",&planningutils::PyTrajectoryRetimerBatch::PlanPaths,PlanPaths_overloads(PY_ARGS("trajs","hastimestamps", "maxvelmult", "maxaccelmult", "releasegil") DOXY_FN(planningutils::TrajectoryRetimerBatch,PlanPaths)))
+#endif
+        .def("Reset",&planningutils::PyTrajectoryRetimerBatch::Reset, DOXY_FN(planningutils::TrajectoryRetimerBatch,Reset))
+        .def("GetNumThreads",&planningutils::PyTrajectoryRetimerBatch::GetNumThreads, DOXY_FN(planningutils::TrajectoryRetimerBatch,GetNumThreads))
+        ;
+
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
         class_<planningutils::PyDynamicsCollisionConstraint, planningutils::PyDynamicsCollisionConstraintPtr >(planningutils, "DynamicsCollisionConstraint", DOXY_CLASS(planningutils::DynamicsCollisionConstraint))
         .def(init<object, object, uint32_t>(),
@@ -614,6 +614,7 @@ RobotBase::RobotBaseInfoPtr PyRobotBase::PyRobotBaseInfo::GetRobotBaseInfo() con
 #endif
     pInfo->_transform = ExtractTransform(_transform);
     pInfo->_dofValues = ExtractDOFValuesArray(_dofValues);
+    pInfo->_revision = _revision;
     pInfo->_mReadableInterfaces = ExtractReadableInterfaces(_readableInterfaces);
     return pInfo;
 }
@@ -1084,6 +1085,65 @@ object PyRobotBase::PyManipulator::FindIKSolutions(object oparam, object freepar
     }
 }
 
+object PyRobotBase::PyManipulator::FindIKSolutionsBatch(object oparams, int filteroptions, bool ikreturn, bool releasegil) const
+{
+    std::vector<IkParameterization> vikparams(len(oparams));
+    for(size_t i = 0; i < vikparams.size(); ++i) {
+        if( !ExtractIkParameterization(oparams[i],vikparams[i]) ) {
+            // assume transformation matrix
+            vikparams[i].SetTransform6D(ExtractTransform(oparams[i]));
+        }
+    }
+    std::vector< std::vector<IkReturnPtr> > vikreturns;
+    EnvironmentMutex::scoped_lock lock(openravepy::GetEnvironment(_pyenv)->GetMutex()); // lock just in case since many users call this without locking...
+    {
+        openravepy::PythonThreadSaverPtr statesaver;
+        if( releasegil ) {
+            statesaver.reset(new openravepy::PythonThreadSaver());
+        }
+        _pmanip->FindIKSolutionsBatch(vikparams,filteroptions,vikreturns);
+    }
+
+    py::list oallsolutions;
+    const size_t nArmIndices = _pmanip->GetArmIndices().size();
+    FOREACHC(itikreturns, vikreturns) {
+        if( ikreturn ) {
+            py::list oikreturns;
+            FOREACHC(it,*itikreturns) {
+                oikreturns.append(openravepy::toPyIkReturn(**it));
+            }
+            oallsolutions.append(oikreturns);
+            continue;
+        }
+        if( itikreturns->size() == 0 ) {
+            oallsolutions.append(py::empty_array_astype<dReal>());
+            continue;
+        }
+        const size_t nSolutions = itikreturns->size();
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        py::array_t<dReal> pysolutions({nSolutions, nArmIndices});
+        py::buffer_info buf = pysolutions.request();
+        dReal* ppos = (dReal*) buf.ptr;
+#else // USE_PYBIND11_PYTHON_BINDINGS
+        npy_intp dims[] = { npy_intp(nSolutions), npy_intp(nArmIndices) };
+        PyObject *pysolutions = PyArray_SimpleNew(2,dims, sizeof(dReal)==8 ? PyArray_DOUBLE : PyArray_FLOAT);
+        dReal* ppos = (dReal*)PyArray_DATA(pysolutions);
+#endif // USE_PYBIND11_PYTHON_BINDINGS
+        FOREACHC(it,*itikreturns) {
+            const std::vector<dReal>& solution = (*it)->_vsolution;
+            BOOST_ASSERT(solution.size() == nArmIndices);
+            std::copy(begin(solution), end(solution), ppos);
+            ppos += nArmIndices;
+        }
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        oallsolutions.append(pysolutions);
+#else // USE_PYBIND11_PYTHON_BINDINGS
+        oallsolutions.append(py::to_array_astype<dReal>(pysolutions));
+#endif // USE_PYBIND11_PYTHON_BINDINGS
+    }
+    return oallsolutions;
+}
+
 object PyRobotBase::PyManipulator::GetIkParameterization(object oparam, bool inworld)
 {
     IkParameterization ikparam;
@@ -2262,6 +2322,7 @@ BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(FindIKSolution_overloads, FindIKSolution,
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(FindIKSolutionFree_overloads, FindIKSolution, 3, 5)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(FindIKSolutions_overloads, FindIKSolutions, 2, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(FindIKSolutionsFree_overloads, FindIKSolutions, 3, 5)
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(FindIKSolutionsBatch_overloads, FindIKSolutionsBatch, 2, 4)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(GetArmConfigurationSpecification_overloads, GetArmConfigurationSpecification, 0, 1)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(GetIkConfigurationSpecification_overloads, GetIkConfigurationSpecification, 1, 2)
 BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(CreateRobotStateSaver_overloads, CreateRobotStateSaver, 0,1)
@@ -2759,6 +2820,17 @@ void init_openravepy_robot()
 #else
         .def("FindIKSolutions",pmanipiksf,FindIKSolutionsFree_overloads(PY_ARGS("param","freevalues","filteroptions","ikreturn","releasegil") DOXY_FN(RobotBase::Manipulator,FindIKSolutions "const IkParameterization; const std::vector; std::vector; int")))
 #endif
+#ifdef USE_PYBIND11_PYTHON_BINDINGS
+        .def("FindIKSolutionsBatch", &PyRobotBase::PyManipulator::FindIKSolutionsBatch,
+             "params"_a,
+             "filteroptions"_a,
+             "ikreturn"_a = false,
+             "releasegil"_a = false,
+             DOXY_FN(RobotBase::Manipulator, FindIKSolutionsBatch)
+             )
+#else
+        .def("FindIKSolutionsBatch",&PyRobotBase::PyManipulator::FindIKSolutionsBatch,FindIKSolutionsBatch_overloads(PY_ARGS("params","filteroptions","ikreturn","releasegil") DOXY_FN(RobotBase::Manipulator,FindIKSolutionsBatch)))
+#endif
 #ifdef USE_PYBIND11_PYTHON_BINDINGS
         .def("GetIkParameterization", &PyRobotBase::PyManipulator::GetIkParameterization,
              "iktype"_a,
@@ -702,11 +702,12 @@ class InverseKinematicsModel(DatabaseGenerator):
         print 'getIndicesFromJointNames',freeindices,freejoints
         return freeindices
 
-    def generate(self,iktype=None, freejoints=None, freeinc=None, freeindices=None, precision=None, forceikbuild=True, outputlang=None, avoidPrismaticAsFree=False, ipython=False, ikfastoptions=0, ikfastmaxcasedepth=3):
+    def generate(self,iktype=None, freejoints=None, freeinc=None, freeindices=None, precision=None, forceikbuild=True, outputlang=None, avoidPrismaticAsFree=False, ipython=False, ikfastoptions=0, ikfastmaxcasedepth=3, batch=False):
         """
         :param ikfastoptions: see IKFastSolver.generateIkSolver
         :param ikfastmaxcasedepth: the max level of degenerate cases to solve for
         :param avoidPrismaticAsFree: if True for redundant manipulators, will attempt to avoid setting prismatic joints as free joints.
+        :param batch: if True, the c++ solver also exports ComputeIkBatch, which FindIKSolutionsBatch uses to solve all the poses with one library call. The poses are still solved one after the other.
         """
         self.iksolver = None
         if iktype is not None:
@@ -927,7 +928,7 @@ class InverseKinematicsModel(DatabaseGenerator):
                 generationstart = time.time()
                 chaintree = solver.generateIkSolver(baselink=baselink,eelink=eelink,freeindices=self.freeindices,solvefn=solvefn)
                 self.ikfeasibility = None
-                code = solver.writeIkSolver(chaintree,lang=outputlang)
+                code = solver.writeIkSolver(chaintree,lang=outputlang,batch=batch)
                 if len(code) == 0:
                     raise InverseKinematicsError(u'failed to generate ik solver for robot %s:%s'%(self.robot.GetName(),self.manip.GetName()))
                 
@@ -34,6 +34,7 @@
 #include <array>
 #include <vector>
 #include <list>
+#include <deque>
 #include <stdexcept>
 #include <cmath>
 #include <iostream>
@@ -46,6 +47,11 @@
 /// if 0x10000000 bit is set, then the iksolver assumes 6D transforms are done without the manipulator offset taken into account (allows to reuse IK when manipulator offset changes)
 #define IKFAST_VERSION 0x1000004b
 
+/// revision of the \ref ikfast::IkSolutionListBase interface. Only appended to so that solvers compiled against older headers keep working.
+/// - 1: IkSolutionListBase::AddSolutionArray that does not require the solver to allocate std::vectors for every solution.
+/// Generated solvers check it at compile time and only use the new functions if it is defined.
+#define IKFAST_SOLUTIONLIST_ABI 1
+
 #define IKSINGLEDOFSOLUTIONBASE_INDICES_SIZE 5
 
 namespace ikfast {
@@ -131,6 +137,16 @@ public:
     /// \brief clears all current solutions, note that any memory addresses returned from \ref GetSolution will be invalidated.
     virtual void Clear() = 0;
     virtual void Print() const = 0;
+
+    /// \brief array version of \ref AddSolution, called by solvers generated with IKFAST_SOLUTIONLIST_ABI >= 1
+    ///
+    /// Has to be declared after all the other virtual functions and cannot overload AddSolution in order to keep the vtable compatible with solvers compiled against older headers,
+    /// since some compilers (MSVC) group overloaded virtual functions together. The default implementation copies into std::vectors.
+    /// \param pinfos numinfos solution data for each degree of freedom of the manipulator
+    /// \param pfree numfree free parameters of the solution, can be NULL if numfree is 0
+    virtual size_t AddSolutionArray(const IkSingleDOFSolutionBase<T>* pinfos, size_t numinfos, const int* pfree, size_t numfree) {
+        return AddSolution(std::vector<IkSingleDOFSolutionBase<T> >(pinfos, pinfos+numinfos), std::vector<int>(pfree, pfree+numfree));
+    }
 };
 
 /// \brief holds function pointers for all the exported functions of ikfast
@@ -138,7 +154,7 @@ template <typename T>
 class IkFastFunctions
 {
 public:
-    IkFastFunctions() : _ComputeIk(NULL), _ComputeIk2(NULL), _ComputeFk(NULL), _GetNumFreeParameters(NULL), _GetFreeIndices(NULL), _GetNumJoints(NULL), _GetIkRealSize(NULL), _GetIkFastVersion(NULL), _GetIkType(NULL), _GetKinematicsHash(NULL) {
+    IkFastFunctions() : _ComputeIk(NULL), _ComputeIk2(NULL), _ComputeFk(NULL), _GetNumFreeParameters(NULL), _GetFreeIndices(NULL), _GetNumJoints(NULL), _GetIkRealSize(NULL), _GetIkFastVersion(NULL), _GetIkType(NULL), _GetKinematicsHash(NULL), _ComputeIkBatch(NULL) {
     }
     virtual ~IkFastFunctions() {
     }
@@ -162,6 +178,8 @@ public:
     GetIkTypeFn _GetIkType;
     typedef const char* (*GetKinematicsHashFn)();
     GetKinematicsHashFn _GetKinematicsHash;
+    typedef int (*ComputeIkBatchFn)(int, const T*, const T*, const T*, IkSolutionListBase<T>* const*, bool*, void*);
+    ComputeIkBatchFn _ComputeIkBatch; ///< optional, only exported by solvers generated in batch mode
 };
 
 template <typename T>
@@ -194,6 +212,12 @@ public:
     //   this->SetSolution(v, nvars);
     // }
 
+    /// \brief sets the solution while reusing the memory already allocated
+    void Assign(const IkSingleDOFSolutionBase<T>* pinfos, size_t numinfos, const int* pfree, size_t numfree) {
+        _vbasesol.assign(pinfos, pinfos+numinfos);
+        _vfree.assign(pfree, pfree+numfree);
+    }
+
     void SetSolution(const T v[], uint32_t nvars) {
         _vbasesol.clear();
         _vbasesol.resize(nvars);
@@ -368,6 +392,62 @@ protected:
     std::list< IkSolution<T> > _listsolutions;
 };
 
+/// \brief \ref IkSolutionListBase that keeps the memory of its solutions when cleared.
+///
+/// Once warmed up, adding solutions does not allocate anymore, so it is meant to be reused across ik calls.
+/// Memory addresses returned from \ref GetSolution stay valid until \ref Clear is called.
+template <typename T>
+class IkSolutionPool : public IkSolutionListBase<T>
+{
+public:
+    IkSolutionPool() : _nsolutions(0) {
+    }
+
+    virtual size_t AddSolution(const std::vector<IkSingleDOFSolutionBase<T> >& vinfos, const std::vector<int>& vfree)
+    {
+        return AddSolutionArray(vinfos.size() > 0 ? &vinfos[0] : NULL, vinfos.size(), vfree.size() > 0 ? &vfree[0] : NULL, vfree.size());
+    }
+
+    virtual size_t AddSolutionArray(const IkSingleDOFSolutionBase<T>* pinfos, size_t numinfos, const int* pfree, size_t numfree)
+    {
+        if( _nsolutions >= _dequesolutions.size() ) {
+            // deque does not move the existing elements
+            _dequesolutions.push_back(IkSolution<T>());
+        }
+        _dequesolutions[_nsolutions].Assign(pinfos, numinfos, pfree, numfree);
+        return _nsolutions++;
+    }
+
+    virtual const IkSolutionBase<T>& GetSolution(size_t index) const
+    {
+        if( index >= _nsolutions ) {
+            throw std::runtime_error("GetSolution index is invalid");
+        }
+        return _dequesolutions[index];
+    }
+
+    virtual size_t GetNumSolutions() const {
+        return _nsolutions;
+    }
+
+    /// \brief resets the number of solutions, the memory is kept for the next solutions
+    virtual void Clear() {
+        _nsolutions = 0;
+    }
+
+    virtual void Print() const {
+        for (size_t i = 0; i < _nsolutions; ++i) {
+            std::cout << "Solution " << i << ":" << std::endl;
+            std::cout << "===========" << std::endl;
+            _dequesolutions[i].Print();
+        }
+    }
+
+protected:
+    std::deque< IkSolution<T> > _dequesolutions; ///< the first _nsolutions are valid
+    size_t _nsolutions;
+};
+
 /// \brief Contains information of a solution where two axes align.
 ///
 /// \param freejoint  Index of the  free joint jy in SolutionArray = std::array<T, N>.
@@ -569,6 +649,22 @@ IKFAST_API bool ComputeIk(const IkReal* eetrans, const IkReal* eerot, const IkRe
  */
 IKFAST_API bool ComputeIk2(const IkReal* eetrans, const IkReal* eerot, const IkReal* pfree, ikfast::IkSolutionListBase<IkReal>& solutions, void* pOpenRAVEManip);
 
+/** \brief Computes the IK solutions of several end effector coordinates in one call by calling \ref ComputeIk2 for each of them. Only exported by solvers generated in batch mode.
+
+   The poses are solved one after the other, so this saves the per call overhead of the caller but is not faster per pose.
+
+   - ``numposes`` - number of end effector coordinates to solve.
+   - ``eetrans``, ``eerot`` - values of all poses one after the other using the same layout as \ref ComputeIk, so 3*numposes and 9*numposes values. Can be NULL if the ik type does not use them.
+   - ``pfree`` - GetNumFreeParameters() values for every pose.
+   - ``solutions`` - numposes solution lists, the ith one receives the solutions of the ith pose.
+   - ``psuccess`` - if not NULL, numposes values set to what \ref ComputeIk2 returns for every pose.
+   - ``pOpenRAVEManip`` - passed to every pose like the last argument of \ref ComputeIk2
+
+   The result of every pose is the same as calling \ref ComputeIk2 with its values.
+   \return the number of poses that were successfully solved
+ */
+IKFAST_API int ComputeIkBatch(int numposes, const IkReal* eetrans, const IkReal* eerot, const IkReal* pfree, ikfast::IkSolutionListBase<IkReal>* const* solutions, bool* psuccess, void* pOpenRAVEManip);
+
 /// \brief Computes the end effector coordinates given the joint values. This function is used to double check ik.
 IKFAST_API void ComputeFk(const IkReal* joints, IkReal* eetrans, IkReal* eerot);
 
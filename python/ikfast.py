@@ -2148,8 +2148,10 @@ class IKFastSolver(AutoReloader):
         if not found:
             raise self.IKFeasibilityError(AllEquations,checkvars)
         
-    def writeIkSolver(self,chaintree,lang=None):
+    def writeIkSolver(self,chaintree,lang=None,batch=False):
         """write the ast into a specific langauge, prioritize c++
+
+        :param batch: if True, the c++ solver also exports ComputeIkBatch, which calls ComputeIk2 for many poses in one call
         """
         self._CheckPreemptFn(progress=0.5)
         if lang is None:
@@ -2166,7 +2168,11 @@ class IKFastSolver(AutoReloader):
                 weakself._checkpreemptfn(u'CodeGen %s'%msg, 0.5+0.5*progress)
         else:
             _CheckPreemtCodeGen = None
-        return CodeGenerators[lang](kinematicshash=self.kinematicshash,version=__version__,iktypestr=self._iktype, checkpreemptfn=_CheckPreemtCodeGen).generate(chaintree)
+        if batch:
+            generator = CodeGenerators[lang](kinematicshash=self.kinematicshash,version=__version__,iktypestr=self._iktype, checkpreemptfn=_CheckPreemtCodeGen, batch=True)
+        else:
+            generator = CodeGenerators[lang](kinematicshash=self.kinematicshash,version=__version__,iktypestr=self._iktype, checkpreemptfn=_CheckPreemtCodeGen)
+        return generator.generate(chaintree)
     
     def generateIkSolver(self, baselink, eelink, freeindices=None, solvefn=None, ikfastoptions=0):
         """
@@ -9594,6 +9600,8 @@ python ikfast.py --robot=robots/barrettwam.robot.xml --baselink=0 --eelink=7 --s
                       help='The max depth to go into degenerate cases. If ikfast file is too big, try reducing this, (default=%default).')
     parser.add_option('--lang', action='store',type='string',dest='lang',default='cpp',
                       help='The language to generate the code in (default=%default), available=('+','.join(name for name,value in CodeGenerators.iteritems())+')')
+    parser.add_option('--batch', action='store_true',dest='batch',default=False,
+                      help='If set, the c++ code also exports ComputeIkBatch, which calls ComputeIk2 for many poses in one call.')
     parser.add_option('--debug','-d', action='store', type='int',dest='debug',default=logging.INFO,
                       help='Debug level for python nose (smaller values allow more text).')
     
@@ -9617,7 +9625,7 @@ python ikfast.py --robot=robots/barrettwam.robot.xml --baselink=0 --eelink=7 --s
             solver = IKFastSolver(kinbody,kinbody)
             solver.maxcasedepth = options.maxcasedepth
             chaintree = solver.generateIkSolver(options.baselink,options.eelink,options.freeindices,solvefn=solvefn)
-            code=solver.writeIkSolver(chaintree,lang=options.lang)
+            code=solver.writeIkSolver(chaintree,lang=options.lang,batch=options.batch)
         finally:
             openravepy.RaveDestroy()
 
@@ -198,9 +198,10 @@ class CodeGenerator(AutoReloader):
     """Generates C++ code from an AST generated by IKFastSolver.
     """
     _checkpreemptfn = None
-    def __init__(self,kinematicshash='',version='0',iktypestr='',checkpreemptfn=None):
+    def __init__(self,kinematicshash='',version='0',iktypestr='',checkpreemptfn=None,batch=False):
         """
         :param checkpreemptfn: checkpreemptfn(msg, progress) called periodically at various points in ikfast. Takes in two arguments to notify user how far the process has completed.
+        :param batch: if True, also exports ComputeIkBatch, a loop that calls ComputeIk2 for many poses in one library call
         """
         self.symbolgen = cse_main.numbered_symbols('x')
         self.strprinter = printing.StrPrinter({'full_prec':False})
@@ -214,6 +215,7 @@ class CodeGenerator(AutoReloader):
         self._solutioncounter = 0
         self.version=version
         self._checkpreemptfn = checkpreemptfn
+        self.batch = batch
     
     def resetequations(self):
         self.dictequations = [[],[]]
@@ -276,6 +278,13 @@ IKFAST_COMPILE_ASSERT(IKFAST_VERSION==%s);
 
 #endif
 
+// adds a solution stored in stack arrays. older ikfast.h headers only have the std::vector interface
+#if defined(IKFAST_SOLUTIONLIST_ABI) && IKFAST_SOLUTIONLIST_ABI >= 1
+#define IKFAST_ADD_SOLUTION(solutions, pinfos, numinfos, pfree, numfree) solutions.AddSolutionArray(pinfos, numinfos, pfree, numfree)
+#else
+#define IKFAST_ADD_SOLUTION(solutions, pinfos, numinfos, pfree, numfree) solutions.AddSolution(std::vector<IkSingleDOFSolutionBase<IkReal> >(pinfos, pinfos+(numinfos)), std::vector<int>(pfree, pfree+(numfree)))
+#endif
+
 #if defined(_MSC_VER)
 #define IKFAST_ALIGNED16(x) __declspec(align(16)) x
 #else
@@ -552,6 +561,10 @@ IKSolver solver;
 return solver.ComputeIk(eetrans,eerot,pfree,solutions);
 }
 
+"""
+        if self.batch:
+            code += self.getIkBatchFunction()
+        code += """
 IKFAST_API const char* GetKinematicsHash() { return "%s"; }
 
 IKFAST_API const char* GetIkFastVersion() { return "%s"; }
@@ -672,6 +685,38 @@ int main(int argc, char** argv)
         code += "    solutions.Clear();\n"
         return code
 
+    def getIkBatchFunction(self):
+        """ComputeIkBatch is a convenience loop that calls ComputeIk2 for every pose, so that a caller needs only one library call for many poses.
+        Every pose goes through its own branches of the solution tree, so the poses are not evaluated together and the loop does not solve faster than calling ComputeIk2 per pose.
+        """
+        code = """
+/// solves the inverse kinematics equations of numposes poses by calling ComputeIk2 for each of them, see ComputeIk for the layout of the values of each pose.
+/// \\param psuccess if not NULL, filled with the return value of ComputeIk2 for every pose
+/// \\return the number of poses that were solved
+IKFAST_API int ComputeIkBatch(int numposes, const IkReal* eetrans, const IkReal* eerot, const IkReal* pfree, IkSolutionListBase<IkReal>* const* solutions, bool* psuccess, void* pOpenRAVEManip) {
+const int numfree = GetNumFreeParameters();
+int numsolved = 0;
+for(int ipose = 0; ipose < numposes; ++ipose) {
+    bool bsuccess = false;
+    try {
+        bsuccess = ComputeIk2(eetrans != NULL ? eetrans+3*ipose : NULL, eerot != NULL ? eerot+9*ipose : NULL, numfree > 0 ? pfree+numfree*ipose : NULL, *solutions[ipose], pOpenRAVEManip);
+    }
+    catch(const std::exception&) {
+        // do not let one degenerate pose fail the rest of the batch
+        solutions[ipose]->Clear();
+    }
+    if( bsuccess ) {
+        ++numsolved;
+    }
+    if( psuccess != NULL ) {
+        psuccess[ipose] = bsuccess;
+    }
+}
+return numsolved;
+}
+"""
+        return code
+
     def getFKFunctionPreamble(self):
         code = "/// solves the forward kinematics equations.\n"
         code += "/// \\param pfree is an array specifying the free joints of the chain.\n"
@@ -1737,7 +1782,7 @@ IkReal r00 = 0, r11 = 0, r22 = 0;
             code.write(' )\n')
             self.dictequations = origequations
         code.write('{\n')
-        code.write('std::vector<IkSingleDOFSolutionBase<IkReal> > vinfos(%d);\n'%len(node.alljointvars))
+        code.write('IkSingleDOFSolutionBase<IkReal> vinfos[%d];\n'%len(node.alljointvars))
         for i,var in enumerate(node.alljointvars):
             offsetvalue = '+%.15e'%node.offsetvalues[i] if node.offsetvalues is not None else ''
             code.write('vinfos[%d].jointtype = %d;\n'%(i,0x01 if node.isHinge[i] else 0x11))
@@ -1753,11 +1798,14 @@ IkReal r00 = 0, r11 = 0, r22 = 0;
                 code.write('vinfos[%d].indices[0] = _i%s[0];\n'%(i,var))
                 code.write('vinfos[%d].indices[1] = _i%s[1];\n'%(i,var))
                 code.write('vinfos[%d].maxsolutions = _n%s;\n'%(i,var))
-        code.write('std::vector<int> vfree(%d);\n'%len(self.freevars))
+        if len(self.freevars) > 0:
+            code.write('int vfree[%d];\n'%len(self.freevars))
+        else:
+            code.write('const int* vfree = NULL;\n')
         for i,varname in enumerate(self.freevars):
             ind = [j for j in range(len(node.alljointvars)) if varname==node.alljointvars[j].name]
             code.write('vfree[%d] = %d;\n'%(i,ind[0]))
-        code.write('solutions.AddSolution(vinfos,vfree);\n')
+        code.write('IKFAST_ADD_SOLUTION(solutions, vinfos, %d, vfree, %d);\n'%(len(node.alljointvars),len(self.freevars)))
         code.write('}\n')
         return code.getvalue()
     
@@ -255,9 +255,176 @@ public:
         }
     };
 
+    /// \brief converts one triangles, trifans, tristrips, or polylist element into a trimesh
+    ///
+    /// All DOM lookups are done when the job is created, Convert only reads the index and float arrays, so jobs can run on any thread.
+    class MeshConversionJob
+    {
+public:
+        enum PrimitiveType
+        {
+            PT_Triangles=0,
+            PT_Trifans=1,
+            PT_Tristrips=2,
+            PT_Polylist=3,
+        };
+
+        MeshConversionJob() : _type(PT_Triangles), _plistFloats(NULL), _pvcounts(NULL), _primitivecount(0), _triangleIndexStride(1), _vertexoffset(0), _fUnitScale(1), _ptrimesh(NULL) {
+        }
+
+        void Convert() const
+        {
+            TriMesh& trimesh = *_ptrimesh;
+            if( _type == PT_Triangles ) {
+                trimesh.indices.reserve(size_t(_primitivecount)*3);
+                trimesh.vertices.reserve(size_t(_primitivecount)*3);
+            }
+            if( !!_plistFloats ) {
+                switch(_type) {
+                case PT_Triangles: {
+                    const domList_of_uints& indexArray = *_vindexarrays.at(0);
+                    domUint k = _vertexoffset;
+                    for(size_t itri = 0; itri < _primitivecount; ++itri) {
+                        if(k+2*_triangleIndexStride < indexArray.getCount() ) {
+                            for (int j=0; j<3; j++) {
+                                trimesh.indices.push_back(trimesh.vertices.size());
+                                trimesh.vertices.push_back(_GetVertex(indexArray, k));
+                                k+=_triangleIndexStride;
+                            }
+                        }
+                    }
+                    break;
+                }
+                case PT_Trifans:
+                case PT_Tristrips:
+                    FOREACHC(itindexarray, _vindexarrays) {
+                        const domList_of_uints& indexArray = **itindexarray;
+                        domUint k=_vertexoffset;
+                        size_t usedindices = 3*(size_t(indexArray.getCount())-2);
+                        if( trimesh.indices.capacity() < trimesh.indices.size()+usedindices ) {
+                            trimesh.indices.reserve(trimesh.indices.size()+usedindices);
+                        }
+                        if( trimesh.vertices.capacity() < trimesh.vertices.size()+indexArray.getCount() ) {
+                            trimesh.vertices.reserve(trimesh.vertices.size()+indexArray.getCount());
+                        }
+                        size_t startoffset = trimesh.vertices.size();
+                        while(k < indexArray.getCount() ) {
+                            trimesh.vertices.push_back(_GetVertex(indexArray, k));
+                            k+=_triangleIndexStride;
+                        }
+                        if( _type == PT_Trifans ) {
+                            for(size_t ivert = startoffset+2; ivert < trimesh.vertices.size(); ++ivert) {
+                                trimesh.indices.push_back(startoffset);
+                                trimesh.indices.push_back(ivert-1);
+                                trimesh.indices.push_back(ivert);
+                            }
+                        }
+                        else {
+                            bool bFlip = false;
+                            for(size_t ivert = startoffset+2; ivert < trimesh.vertices.size(); ++ivert) {
+                                trimesh.indices.push_back(ivert-2);
+                                trimesh.indices.push_back(bFlip ? ivert : ivert-1);
+                                trimesh.indices.push_back(bFlip ? ivert-1 : ivert);
+                                bFlip = !bFlip;
+                            }
+                        }
+                    }
+                    break;
+                case PT_Polylist: {
+                    const domList_of_uints& indexArray = *_vindexarrays.at(0);
+                    domUint k=_vertexoffset;
+                    for(size_t ipoly = 0; ipoly < _pvcounts->getCount(); ++ipoly) {
+                        domUint numverts = _pvcounts->get(ipoly);
+                        if(( numverts > 0) &&( k+(numverts-1)*_triangleIndexStride < indexArray.getCount()) ) {
+                            size_t startoffset = trimesh.vertices.size();
+                            for (size_t j=0; j<numverts; j++) {
+                                trimesh.vertices.push_back(_GetVertex(indexArray, k));
+                                k+=_triangleIndexStride;
+                            }
+                            for(size_t ivert = startoffset+2; ivert < trimesh.vertices.size(); ++ivert) {
+                                trimesh.indices.push_back(startoffset);
+                                trimesh.indices.push_back(ivert-1);
+                                trimesh.indices.push_back(ivert);
+                            }
+                        }
+                    }
+                    break;
+                }
+                }
+            }
+            if( _type == PT_Triangles && trimesh.indices.size() != 3*_primitivecount ) {
+                RAVELOG_WARN("triangles declares wrong count!\n");
+            }
+        }
+
+        PrimitiveType _type;
+        std::vector<const domList_of_uints*> _vindexarrays; ///< the <p> arrays, trifans and tristrips have one per primitive
+        const domList_of_floats* _plistFloats; ///< floats of the POSITION source, if NULL then the mesh is left empty
+        const domList_of_uints* _pvcounts; ///< number of vertices of each polygon, only used by polylist
+        domUint _primitivecount; ///< the declared number of triangles, only used by triangles
+        domUint _triangleIndexStride, _vertexoffset;
+        dReal _fUnitScale;
+        Transform _transgeom; ///< transform all vertices before storing
+        TriMesh* _ptrimesh; ///< points inside a GeometryInfo that is kept alive until the job is converted
+
+private:
+        inline Vector _GetVertex(const domList_of_uints& indexArray, domUint k) const
+        {
+            domUint vertexStride = 3; //instead of hardcoded stride, should use the 'accessor'
+            domUint index0 = indexArray.get(size_t(k))*vertexStride;
+            domFloat fl0 = _plistFloats->get(size_t(index0));
+            domFloat fl1 = _plistFloats->get(size_t(index0+1));
+            domFloat fl2 = _plistFloats->get(size_t(index0+2));
+            return _transgeom*Vector(fl0*_fUnitScale,fl1*_fUnitScale,fl2*_fUnitScale);
+        }
+    };
+
+    /// \brief geometries of one node that are attached to their link once their meshes are converted
+    class DeferredLinkGeometries
+    {
+public:
+        KinBody::LinkPtr _plink;
+        std::list<KinBody::GeometryInfo> _listGeometryInfos;
+        std::vector<TriMesh> _vcollisionmeshes; ///< the collision mesh of each geometry in link coordinates
+        TransformMatrix _tmnodegeom;
+        Transform _tnodegeom;
+        Vector _vscale;
+    };
+    typedef boost::shared_ptr<DeferredLinkGeometries> DeferredLinkGeometriesPtr;
+
+    /// \brief while a scope is alive, ExtractGeometries only queues the link geometries. The outermost scope converts all queued meshes in parallel and attaches them to their links.
+    class DeferredGeometryScope
+    {
+public:
+        DeferredGeometryScope(ColladaReader& reader) : _reader(reader), _bFlushed(false) {
+            ++_reader._nDeferGeometryDepth;
+        }
+        ~DeferredGeometryScope() {
+            if( !_bFlushed ) {
+                // exiting from an exception, so drop everything that was queued
+                if( --_reader._nDeferGeometryDepth == 0 ) {
+                    _reader._vMeshConversionJobs.clear();
+                    _reader._vDeferredLinkGeometries.clear();
+                }
+            }
+        }
+
+        /// \brief if this is the outermost scope, converts and attaches all the queued geometries
+        void Flush() {
+            _bFlushed = true;
+            if( --_reader._nDeferGeometryDepth == 0 ) {
+                _reader._FlushDeferredGeometries();
+            }
+        }
+
+private:
+        ColladaReader& _reader;
+        bool _bFlushed;
+    };
+
 public:
     ColladaReader(EnvironmentBasePtr penv, bool bResetGlobalDae=true, bool bExtractConnectedBodies=true) : _dom(NULL), _penv(penv), _nGlobalSensorId(0), _nGlobalManipulatorId(0), _nGlobalIndex(0), _nGlobalGripperInfoId(0),
-        _bResetGlobalDae(bResetGlobalDae)
+        _bResetGlobalDae(bResetGlobalDae), _nDeferGeometryDepth(0), _nNumThreads(0)
     {
         daeErrorHandler::setErrorHandler(this);
         _bOpeningZAE = false;
@@ -365,11 +532,15 @@ public:
         _bSkipGeometry = false;
         _bReadGeometryGroups = false;
         _bMustResolveURI = false;
+        _nNumThreads = 0;
         _vOpenRAVESchemeAliases.resize(0);
         FOREACHC(itatt,atts) {
             if( itatt->first == "skipgeometry" ) {
                 _bSkipGeometry = _stricmp(itatt->second.c_str(), "true") == 0 || itatt->second=="1";
             }
+            else if( itatt->first == "numthreads" ) {
+                _nNumThreads = boost::lexical_cast<int>(itatt->second);
+            }
             else if( itatt->first == "prefix" ) {
                 _prefix = itatt->second;
             }
@@ -1558,12 +1729,17 @@ public:
         }
 
         RAVELOG_VERBOSE(str(boost::format("Number of root links in kmodel %s: %d\n")%kmodel->getId()%ktec->getLink_array().getCount()));
-        for (size_t ilink = 0; ilink < ktec->getLink_array().getCount(); ++ilink) {
-            Transform tnode;
-            if( !!pnode && ilink == 0 ) {
-                tnode = getNodeParentTransform(pnode);
+        {
+            // read the DOM of all links first, then convert the meshes of the whole model in parallel
+            DeferredGeometryScope deferredscope(*this);
+            for (size_t ilink = 0; ilink < ktec->getLink_array().getCount(); ++ilink) {
+                Transform tnode;
+                if( !!pnode && ilink == 0 ) {
+                    tnode = getNodeParentTransform(pnode);
+                }
+                ExtractLink(pkinbody, ktec->getLink_array()[ilink], ilink == 0 ? pnode : domNodeRef(), tnode, vdomjoints, bindings);
             }
-            ExtractLink(pkinbody, ktec->getLink_array()[ilink], ilink == 0 ? pnode : domNodeRef(), tnode, vdomjoints, bindings);
+            deferredscope.Flush();
         }
 
         for (size_t iform = 0; iform < ktec->getFormula_array().getCount(); ++iform) {
@@ -2386,6 +2562,8 @@ public:
 
         RAVELOG_VERBOSE(str(boost::format("ExtractGeometries(node,link) of %s\n")%pdomnode->getName()));
 
+        // the meshes of all child nodes are converted together when the outermost scope is flushed
+        DeferredGeometryScope deferredscope(*this);
         bool bhasgeometry = false;
         // For all child nodes of pdomnode
         for (size_t i = 0; i < pdomnode->getNode_array().getCount(); i++) {
@@ -2409,7 +2587,11 @@ public:
             // put everything in a subroutine in order to process pdomnode too!
         }
 
-        std::list<KinBody::GeometryInfo> listGeometryInfos;
+        // geometry infos are kept in pdeferred so that the queued mesh conversions can write into them
+        DeferredLinkGeometriesPtr pdeferred(new DeferredLinkGeometries());
+        pdeferred->_plink = plink;
+        std::list<KinBody::GeometryInfo>& listGeometryInfos = pdeferred->_listGeometryInfos;
+        size_t nPrevMeshConversionJobs = _vMeshConversionJobs.size();
 
         // get the geometry
         for (size_t igeom = 0; igeom < pdomnode->getInstance_geometry_array().getCount(); ++igeom) {
@@ -2437,6 +2619,9 @@ public:
         }
 
         if( !bhasgeometry ) {
+            // pdeferred is discarded, so cannot convert into it
+            _vMeshConversionJobs.resize(nPrevMeshConversionJobs);
+            deferredscope.Flush();
             return false;
         }
 
@@ -2448,9 +2633,78 @@ public:
         Vector vscale;
         decompose(tmnodegeom, tnodegeom, vscale);
         vscale *= _GetUnitScale(pdomnode, _fGlobalScale); // TODO should track the scale per each listGeometryInfos
+        pdeferred->_tmnodegeom = tmnodegeom;
+        pdeferred->_tnodegeom = tnodegeom;
+        pdeferred->_vscale = vscale;
+        _vDeferredLinkGeometries.push_back(pdeferred);
+        deferredscope.Flush();
+
+        return bhasgeometry || listGeometryInfos.size() > 0;
+    }
+
+    /// \brief calls fn for every index in [0, count) with _nNumThreads threads
+    void _ParallelFor(size_t count, const boost::function<void(size_t)>& fn)
+    {
+        try {
+            utils::ParallelFor(count, fn, _nNumThreads);
+        }
+        catch(const std::exception& ex) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to extract collada geometry: %s", ex.what(), ORE_Failed);
+        }
+    }
+
+    /// \brief converts the queued meshes starting at istart in parallel and removes them from the queue
+    void _ConvertMeshes(size_t istart=0)
+    {
+        if( istart >= _vMeshConversionJobs.size() ) {
+            return;
+        }
+        _ParallelFor(_vMeshConversionJobs.size()-istart, boost::bind(&ColladaReader::_ConvertMesh, this, istart, _1));
+        _vMeshConversionJobs.resize(istart);
+    }
+
+    void _ConvertMesh(size_t istart, size_t index)
+    {
+        _vMeshConversionJobs.at(istart+index).Convert();
+    }
 
+    /// \brief converts all queued meshes and attaches the queued geometries to their links
+    ///
+    /// Transforming the geometries into link coordinates is also done in parallel, only adding them to the links is sequential so that the geometry ids follow the extraction order.
+    void _FlushDeferredGeometries()
+    {
+        _ConvertMeshes();
+        if( _vDeferredLinkGeometries.size() == 0 ) {
+            return;
+        }
+        _ParallelFor(_vDeferredLinkGeometries.size(), boost::bind(&ColladaReader::_TransformDeferredGeometries, this, _1));
+
+        FOREACH(itdeferred, _vDeferredLinkGeometries) {
+            DeferredLinkGeometries& deferred = **itdeferred;
+            KinBody::LinkPtr plink = deferred._plink;
+            std::vector<TriMesh>::const_iterator itcollision = deferred._vcollisionmeshes.begin();
+            FOREACH(itgeominfo, deferred._listGeometryInfos) {
+                KinBody::Link::GeometryPtr pgeom(new KinBody::Link::Geometry(plink,*itgeominfo));
+                pgeom->_info._id = str(boost::format("geom%d")%plink->_vGeometries.size());
+                plink->_vGeometries.push_back(pgeom);
+                //  Append the collision mesh
+                plink->_collision.Append(*itcollision);
+                ++itcollision;
+            }
+        }
+        _vDeferredLinkGeometries.clear();
+    }
 
-        FOREACH(itgeominfo, listGeometryInfos) {
+    /// \brief applies the node transform and scale to the geometries of _vDeferredLinkGeometries[index] and computes their collision meshes in link coordinates
+    void _TransformDeferredGeometries(size_t index)
+    {
+        DeferredLinkGeometries& deferred = *_vDeferredLinkGeometries.at(index);
+        const TransformMatrix& tmnodegeom = deferred._tmnodegeom;
+        const Transform& tnodegeom = deferred._tnodegeom;
+        const Vector& vscale = deferred._vscale;
+        deferred._vcollisionmeshes.resize(deferred._listGeometryInfos.size());
+        std::vector<TriMesh>::iterator itcollision = deferred._vcollisionmeshes.begin();
+        FOREACH(itgeominfo, deferred._listGeometryInfos) {
             //  Switch between different type of geometry PRIMITIVES
             Transform toriginal = itgeominfo->_t;
             itgeominfo->_t = tnodegeom * itgeominfo->_t;
@@ -2490,17 +2744,11 @@ public:
                 RAVELOG_WARN(str(boost::format("unknown geometry type: 0x%x")%itgeominfo->_type));
             }
 
-            KinBody::Link::GeometryPtr pgeom(new KinBody::Link::Geometry(plink,*itgeominfo));
-            pgeom->_info._id = str(boost::format("geom%d")%plink->_vGeometries.size());
-            pgeom->_info.InitCollisionMesh();
-            plink->_vGeometries.push_back(pgeom);
-            //  Append the collision mesh
-            TriMesh trimesh = pgeom->GetCollisionMesh();
-            trimesh.ApplyTransform(pgeom->_info._t);
-            plink->_collision.Append(trimesh);
+            itgeominfo->InitCollisionMesh();
+            *itcollision = itgeominfo->_meshcollision;
+            itcollision->ApplyTransform(itgeominfo->_t);
+            ++itcollision;
         }
-
-        return bhasgeometry || listGeometryInfos.size() > 0;
     }
 
     /// Paint the Geometry with the color material
@@ -2552,74 +2800,11 @@ public:
         if( !triRef ) {
             return false;
         }
-
-        TriMesh& trimesh = geom._meshcollision;
-        geom._type = GT_TriMesh;
-
-        // resolve the material and assign correct colors to the geometry
-        if( !!triRef->getMaterial() ) {
-            map<string,domMaterialRef>::const_iterator itmat = mapmaterials.find(triRef->getMaterial());
-            if( itmat != mapmaterials.end() ) {
-                FillGeometryColor(itmat->second,geom);
-            }
-        }
-
-        domUint triangleIndexStride = 0, vertexoffset = -1;
-        domInput_local_offsetRef indexOffsetRef;
-
-        for (unsigned int w=0; w<triRef->getInput_array().getCount(); w++) {
-            domUint offset = triRef->getInput_array()[w]->getOffset();
-            daeString str = triRef->getInput_array()[w]->getSemantic();
-            if (!strcmp(str,"VERTEX")) {
-                indexOffsetRef = triRef->getInput_array()[w];
-                vertexoffset = offset;
-            }
-            if (offset> triangleIndexStride) {
-                triangleIndexStride = offset;
-            }
-        }
-        triangleIndexStride++;
-
-        const domList_of_uints& indexArray =triRef->getP()->getValue();
-        trimesh.indices.reserve(size_t(triRef->getCount())*3);
-        trimesh.vertices.reserve(size_t(triRef->getCount())*3);
-        for (size_t i=0; i<vertsRef->getInput_array().getCount(); ++i) {
-            domInput_localRef localRef = vertsRef->getInput_array()[i];
-            daeString str = localRef->getSemantic();
-            if ( strcmp(str,"POSITION") == 0 ) {
-                const domSourceRef node = daeSafeCast<domSource>(localRef->getSource().getElement());
-                if( !node ) {
-                    continue;
-                }
-                dReal fUnitScale = _GetUnitScale(node,_fGlobalScale);
-                const domFloat_arrayRef flArray = node->getFloat_array();
-                if (!!flArray) {
-                    const domList_of_floats& listFloats = flArray->getValue();
-                    domUint k = vertexoffset;
-                    domUint vertexStride = 3;     //instead of hardcoded stride, should use the 'accessor'
-                    for(size_t itri = 0; itri < triRef->getCount(); ++itri) {
-                        if(k+2*triangleIndexStride < indexArray.getCount() ) {
-                            for (int j=0; j<3; j++) {
-                                domUint index0 = indexArray.get(size_t(k))*vertexStride;
-                                domFloat fl0 = listFloats.get(size_t(index0));
-                                domFloat fl1 = listFloats.get(size_t(index0+1));
-                                domFloat fl2 = listFloats.get(size_t(index0+2));
-                                k+=triangleIndexStride;
-                                trimesh.indices.push_back(trimesh.vertices.size());
-                                trimesh.vertices.push_back(transgeom*Vector(fl0*fUnitScale,fl1*fUnitScale,fl2*fUnitScale));
-                            }
-                        }
-                    }
-                }
-                else {
-                    RAVELOG_WARN("float array not defined!\n");
-                }
-                break;
-            }
-        }
-        if( trimesh.indices.size() != 3*triRef->getCount() ) {
-            RAVELOG_WARN("triangles declares wrong count!\n");
-        }
+        MeshConversionJob job;
+        job._type = MeshConversionJob::PT_Triangles;
+        job._primitivecount = triRef->getCount();
+        job._vindexarrays.push_back(&triRef->getP()->getValue());
+        _QueueMeshConversion(triRef, vertsRef, mapmaterials, geom, transgeom, job);
         return true;
     }
 
@@ -2634,82 +2819,17 @@ public:
         if( !triRef ) {
             return false;
         }
-        TriMesh& trimesh = geom._meshcollision;
-        geom._type = GT_TriMesh;
-
-        // resolve the material and assign correct colors to the geometry
-        if( !!triRef->getMaterial() ) {
-            map<string,domMaterialRef>::const_iterator itmat = mapmaterials.find(triRef->getMaterial());
-            if( itmat != mapmaterials.end() ) {
-                FillGeometryColor(itmat->second,geom);
-            }
-        }
-
-        domUint triangleIndexStride = 0, vertexoffset = -1;
-        domInput_local_offsetRef indexOffsetRef;
-
-        for (unsigned int w=0; w<triRef->getInput_array().getCount(); w++) {
-            domUint offset = triRef->getInput_array()[w]->getOffset();
-            daeString str = triRef->getInput_array()[w]->getSemantic();
-            if (!strcmp(str,"VERTEX")) {
-                indexOffsetRef = triRef->getInput_array()[w];
-                vertexoffset = offset;
-            }
-            if (offset> triangleIndexStride) {
-                triangleIndexStride = offset;
-            }
-        }
-        triangleIndexStride++;
+        MeshConversionJob job;
+        job._type = MeshConversionJob::PT_Trifans;
         domUint primitivecount = triRef->getCount();
         if( primitivecount > triRef->getP_array().getCount() ) {
             RAVELOG_WARN("trifans has incorrect count\n");
             primitivecount = triRef->getP_array().getCount();
         }
         for(size_t ip = 0; ip < primitivecount; ++ip) {
-            domList_of_uints indexArray = triRef->getP_array()[ip]->getValue();
-            for (size_t i=0; i<vertsRef->getInput_array().getCount(); ++i) {
-                domInput_localRef localRef = vertsRef->getInput_array()[i];
-                daeString str = localRef->getSemantic();
-                if ( strcmp(str,"POSITION") == 0 ) {
-                    const domSourceRef node = daeSafeCast<domSource>(localRef->getSource().getElement());
-                    if( !node ) {
-                        continue;
-                    }
-                    dReal fUnitScale = _GetUnitScale(node,_fGlobalScale);
-                    const domFloat_arrayRef flArray = node->getFloat_array();
-                    if (!!flArray) {
-                        const domList_of_floats& listFloats = flArray->getValue();
-                        domUint k=vertexoffset;
-                        domUint vertexStride = 3;     //instead of hardcoded stride, should use the 'accessor'
-                        size_t usedindices = 3*(indexArray.getCount()-2);
-                        if( trimesh.indices.capacity() < trimesh.indices.size()+usedindices ) {
-                            trimesh.indices.reserve(trimesh.indices.size()+usedindices);
-                        }
-                        if( trimesh.vertices.capacity() < trimesh.vertices.size()+indexArray.getCount() ) {
-                            trimesh.vertices.reserve(trimesh.vertices.size()+indexArray.getCount());
-                        }
-                        size_t startoffset = trimesh.vertices.size();
-                        while(k < indexArray.getCount() ) {
-                            domUint index0 = indexArray.get(size_t(k))*vertexStride;
-                            domFloat fl0 = listFloats.get(size_t(index0));
-                            domFloat fl1 = listFloats.get(size_t(index0+1));
-                            domFloat fl2 = listFloats.get(size_t(index0+2));
-                            k+=triangleIndexStride;
-                            trimesh.vertices.push_back(transgeom*Vector(fl0*fUnitScale,fl1*fUnitScale,fl2*fUnitScale));
-                        }
-                        for(size_t ivert = startoffset+2; ivert < trimesh.vertices.size(); ++ivert) {
-                            trimesh.indices.push_back(startoffset);
-                            trimesh.indices.push_back(ivert-1);
-                            trimesh.indices.push_back(ivert);
-                        }
-                    }
-                    else {
-                        RAVELOG_WARN("float array not defined!\n");
-                    }
-                    break;
-                }
-            }
+            job._vindexarrays.push_back(&triRef->getP_array()[ip]->getValue());
         }
+        _QueueMeshConversion(triRef, vertsRef, mapmaterials, geom, transgeom, job);
         return true;
     }
 
@@ -2724,85 +2844,17 @@ public:
         if( !triRef ) {
             return false;
         }
-        TriMesh& trimesh = geom._meshcollision;
-        geom._type = GT_TriMesh;
-
-        // resolve the material and assign correct colors to the geometry
-        if( !!triRef->getMaterial() ) {
-            map<string,domMaterialRef>::const_iterator itmat = mapmaterials.find(triRef->getMaterial());
-            if( itmat != mapmaterials.end() ) {
-                FillGeometryColor(itmat->second,geom);
-            }
-        }
-        domUint triangleIndexStride = 0, vertexoffset = -1;
-        domInput_local_offsetRef indexOffsetRef;
-
-        for (size_t w=0; w<triRef->getInput_array().getCount(); w++) {
-            domUint offset = triRef->getInput_array()[w]->getOffset();
-            daeString str = triRef->getInput_array()[w]->getSemantic();
-            if (!strcmp(str,"VERTEX")) {
-                indexOffsetRef = triRef->getInput_array()[w];
-                vertexoffset = offset;
-            }
-            if (offset> triangleIndexStride) {
-                triangleIndexStride = offset;
-            }
-        }
-        triangleIndexStride++;
+        MeshConversionJob job;
+        job._type = MeshConversionJob::PT_Tristrips;
         domUint primitivecount = triRef->getCount();
         if( primitivecount > triRef->getP_array().getCount() ) {
             RAVELOG_WARN("tristrips has incorrect count\n");
             primitivecount = triRef->getP_array().getCount();
         }
         for(size_t ip = 0; ip < primitivecount; ++ip) {
-            domList_of_uints indexArray = triRef->getP_array()[ip]->getValue();
-            for (size_t i=0; i<vertsRef->getInput_array().getCount(); ++i) {
-                domInput_localRef localRef = vertsRef->getInput_array()[i];
-                daeString str = localRef->getSemantic();
-                if ( strcmp(str,"POSITION") == 0 ) {
-                    const domSourceRef node = daeSafeCast<domSource>(localRef->getSource().getElement());
-                    if( !node ) {
-                        continue;
-                    }
-                    dReal fUnitScale = _GetUnitScale(node,_fGlobalScale);
-                    const domFloat_arrayRef flArray = node->getFloat_array();
-                    if (!!flArray) {
-                        const domList_of_floats& listFloats = flArray->getValue();
-                        domUint k=vertexoffset;
-                        domUint vertexStride = 3;     //instead of hardcoded stride, should use the 'accessor'
-                        size_t usedindices = 3*(size_t(indexArray.getCount())-2);
-                        if( trimesh.indices.capacity() < trimesh.indices.size()+usedindices ) {
-                            trimesh.indices.reserve(trimesh.indices.size()+usedindices);
-                        }
-                        if( trimesh.vertices.capacity() < trimesh.vertices.size()+indexArray.getCount() ) {
-                            trimesh.vertices.reserve(trimesh.vertices.size()+indexArray.getCount());
-                        }
-
-                        size_t startoffset = trimesh.vertices.size();
-                        while(k < indexArray.getCount() ) {
-                            domUint index0 = indexArray.get(size_t(k))*vertexStride;
-                            domFloat fl0 = listFloats.get(size_t(index0));
-                            domFloat fl1 = listFloats.get(size_t(index0+1));
-                            domFloat fl2 = listFloats.get(size_t(index0+2));
-                            k+=triangleIndexStride;
-                            trimesh.vertices.push_back(transgeom*Vector(fl0*fUnitScale,fl1*fUnitScale,fl2*fUnitScale));
-                        }
-
-                        bool bFlip = false;
-                        for(size_t ivert = startoffset+2; ivert < trimesh.vertices.size(); ++ivert) {
-                            trimesh.indices.push_back(ivert-2);
-                            trimesh.indices.push_back(bFlip ? ivert : ivert-1);
-                            trimesh.indices.push_back(bFlip ? ivert-1 : ivert);
-                            bFlip = !bFlip;
-                        }
-                    }
-                    else {
-                        RAVELOG_WARN("float array not defined!\n");
-                    }
-                    break;
-                }
-            }
+            job._vindexarrays.push_back(&triRef->getP_array()[ip]->getValue());
         }
+        _QueueMeshConversion(triRef, vertsRef, mapmaterials, geom, transgeom, job);
         return true;
     }
 
@@ -2817,7 +2869,20 @@ public:
         if( !triRef ) {
             return false;
         }
-        TriMesh& trimesh = geom._meshcollision;
+        MeshConversionJob job;
+        job._type = MeshConversionJob::PT_Polylist;
+        job._vindexarrays.push_back(&triRef->getP()->getValue());
+        job._pvcounts = &triRef->getVcount()->getValue();
+        _QueueMeshConversion(triRef, vertsRef, mapmaterials, geom, transgeom, job);
+        return true;
+    }
+
+    /// \brief resolves the material, the input offsets, and the POSITION source of a primitive element from the DOM, and queues the conversion of its indices and vertices
+    ///
+    /// The conversion writes into geom._meshcollision when _ConvertMeshes or _FlushDeferredGeometries is called.
+    template <typename T>
+    void _QueueMeshConversion(const T& triRef, const domVerticesRef vertsRef, const map<string,domMaterialRef>& mapmaterials, KinBody::GeometryInfo& geom, const Transform& transgeom, MeshConversionJob& job)
+    {
         geom._type = GT_TriMesh;
 
         // resolve the material and assign correct colors to the geometry
@@ -2828,21 +2893,22 @@ public:
             }
         }
 
-        domUint triangleIndexStride = 0,vertexoffset = -1;
-        domInput_local_offsetRef indexOffsetRef;
-        for (unsigned int w=0; w<triRef->getInput_array().getCount(); w++) {
+        domUint triangleIndexStride = 0, vertexoffset = -1;
+        for (size_t w=0; w<triRef->getInput_array().getCount(); w++) {
             domUint offset = triRef->getInput_array()[w]->getOffset();
             daeString str = triRef->getInput_array()[w]->getSemantic();
             if (!strcmp(str,"VERTEX")) {
-                indexOffsetRef = triRef->getInput_array()[w];
                 vertexoffset = offset;
             }
             if (offset> triangleIndexStride) {
                 triangleIndexStride = offset;
             }
         }
-        triangleIndexStride++;
-        const domList_of_uints& indexArray = triRef->getP()->getValue();
+        job._triangleIndexStride = triangleIndexStride+1;
+        job._vertexoffset = vertexoffset;
+        job._transgeom = transgeom;
+        job._ptrimesh = &geom._meshcollision;
+
         for (size_t i=0; i<vertsRef->getInput_array().getCount(); ++i) {
             domInput_localRef localRef = vertsRef->getInput_array()[i];
             daeString str = localRef->getSemantic();
@@ -2851,31 +2917,10 @@ public:
                 if( !node ) {
                     continue;
                 }
-                dReal fUnitScale = _GetUnitScale(node,_fGlobalScale);
+                job._fUnitScale = _GetUnitScale(node,_fGlobalScale);
                 const domFloat_arrayRef flArray = node->getFloat_array();
                 if (!!flArray) {
-                    const domList_of_floats& listFloats = flArray->getValue();
-                    domUint k=vertexoffset;
-                    domUint vertexStride = 3;     //instead of hardcoded stride, should use the 'accessor'
-                    for(size_t ipoly = 0; ipoly < triRef->getVcount()->getValue().getCount(); ++ipoly) {
-                        domUint numverts = triRef->getVcount()->getValue()[ipoly];
-                        if(( numverts > 0) &&( k+(numverts-1)*triangleIndexStride < indexArray.getCount()) ) {
-                            size_t startoffset = trimesh.vertices.size();
-                            for (size_t j=0; j<numverts; j++) {
-                                domUint index0 = indexArray.get(size_t(k))*vertexStride;
-                                domFloat fl0 = listFloats.get(size_t(index0));
-                                domFloat fl1 = listFloats.get(size_t(index0+1));
-                                domFloat fl2 = listFloats.get(size_t(index0+2));
-                                k+=triangleIndexStride;
-                                trimesh.vertices.push_back(transgeom*Vector(fl0*fUnitScale,fl1*fUnitScale,fl2*fUnitScale));
-                            }
-                            for(size_t ivert = startoffset+2; ivert < trimesh.vertices.size(); ++ivert) {
-                                trimesh.indices.push_back(startoffset);
-                                trimesh.indices.push_back(ivert-1);
-                                trimesh.indices.push_back(ivert);
-                            }
-                        }
-                    }
+                    job._plistFloats = &flArray->getValue();
                 }
                 else {
                     RAVELOG_WARN("float array not defined!\n");
@@ -2883,7 +2928,7 @@ public:
                 break;
             }
         }
-        return true;
+        _vMeshConversionJobs.push_back(job);
     }
 
     domMaterialRef _ExtractFirstMaterial(const domGeometryRef domgeom, const map<string,domMaterialRef>& mapmaterials)
@@ -3318,7 +3363,9 @@ public:
                 }
 
                 std::list<KinBody::GeometryInfo> listNewGeometryInfos;
+                size_t nPrevMeshConversionJobs = _vMeshConversionJobs.size();
                 ExtractGeometry(linkedGeom, mapmaterials, listNewGeometryInfos);
+                _ConvertMeshes(nPrevMeshConversionJobs);
                 // need to get the convex hull of listNewGeometryInfos, quickest way is to use Geometry to compute the geometry vertices
                 FOREACH(itgeominfo,listNewGeometryInfos) {
                     itgeominfo->InitCollisionMesh();
@@ -4968,7 +5015,10 @@ private:
 
 
                                 // TODO : There seems to be scaling factors and transforms that might be forgotten here (c.f.: ExtractGeometries)
-                                if( !ExtractGeometry(domgeom, mapmaterials, mapGeometryGroups[plink][groupname]) ) {
+                                DeferredGeometryScope deferredscope(*this);
+                                bool bextracted = ExtractGeometry(domgeom, mapmaterials, mapGeometryGroups[plink][groupname]);
+                                deferredscope.Flush(); // converts the queued meshes
+                                if( !bextracted ) {
                                     RAVELOG_WARN_FORMAT("failed to add geometry to geometry group %s, link %s\n", groupname%plink->GetName());
                                     continue;
                                 }
@@ -5847,6 +5897,11 @@ private:
     bool _bBackCompatValuesInRadians; ///< if true, will assume the speed, acceleration, and dofvalues are in radians instead of degrees (for back compat)
     bool _bExtractConnectedBodies; ///< if true, calls ExtractRobotConnectedBodies and initializes the connected bodies.
     bool _bMustResolveURI; ///< if true, throw exception if uri does not resolve
+
+    int _nDeferGeometryDepth; ///< number of alive DeferredGeometryScope
+    int _nNumThreads; ///< number of threads for converting meshes, if 0 uses the number of hardware threads
+    std::vector<MeshConversionJob> _vMeshConversionJobs; ///< meshes whose DOM elements are resolved, but are not converted yet
+    std::vector<DeferredLinkGeometriesPtr> _vDeferredLinkGeometries; ///< geometries waiting to be attached to their links, in extraction order
 };
 
 bool RaveParseColladaURI(EnvironmentBasePtr penv, const std::string& uri,const AttributesList& atts)
@@ -0,0 +1,717 @@
+// -*- coding: utf-8 -*-
+// Copyright (C) 2026 OpenRAVE
+//
+// This file is part of OpenRAVE.
+// OpenRAVE is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#include "ravep.h"
+
+#ifdef HAVE_BOOST_FILESYSTEM
+#include <boost/filesystem.hpp>
+#endif
+
+#include <boost/lexical_cast.hpp>
+#include <cstring>
+
+#ifdef QHULL_FOUND
+
+extern "C"
+{
+#ifdef QHULL_USE_REENTRANT
+
+#include <libqhull_r/libqhull_r.h>
+#include <libqhull_r/mem_r.h>
+#include <libqhull_r/qset_r.h>
+#include <libqhull_r/geom_r.h>
+#include <libqhull_r/merge_r.h>
+#include <libqhull_r/poly_r.h>
+#include <libqhull_r/io_r.h>
+#include <libqhull_r/stat_r.h>
+
+#else
+
+#include <qhull/qhull.h>
+#include <qhull/mem.h>
+#include <qhull/qset.h>
+#include <qhull/geom.h>
+#include <qhull/merge.h>
+#include <qhull/poly.h>
+#include <qhull/io.h>
+#include <qhull/stat.h>
+
+#endif
+}
+
+#endif
+
+#ifdef OPENRAVE_CONVEXDECOMPOSITION
+#include "NvConvexDecomposition.h"
+#endif
+
+namespace OpenRAVE {
+
+static const char s_collisionProxyCacheMagic[] = { 'O', 'R', 'C', 'P', 0 }; ///< last byte is the version
+static const uint8_t s_collisionProxyCacheVersion = 3; ///< 3 inflates the decimated meshes by the distance to the original surface
+static const dReal s_fMinInflationNormalDot = 0.2; ///< smallest dot product between a vertex normal and the normal of an adjacent face used to inflate decimated meshes
+
+#ifdef QHULL_FOUND
+static boost::mutex s_QhullMutex; ///< non-reentrant qhull has global state
+#endif
+#ifdef OPENRAVE_CONVEXDECOMPOSITION
+static boost::mutex s_ConvexDecompositionMutex;
+#endif
+
+/// \brief generates simplified collision meshes for the trimesh geometries of bodies, see RaveGenerateCollisionProxies
+class CollisionProxyGenerator
+{
+public:
+    enum ProxyType
+    {
+        CPT_None = 0,
+        CPT_Decimate = 1, ///< vertex clustering on a uniform grid, inflated to contain the original surface
+        CPT_ConvexHull = 2, ///< convex hull of the vertices with qhull
+        CPT_ConvexDecomposition = 3, ///< several convex hulls with convexdecomposition
+    };
+
+    CollisionProxyGenerator(int environmentid, const AttributesList& atts) : _environmentid(environmentid), _type(CPT_None), _groupname("collisionproxy"), _nMaxTriangles(2000), _fCellSize(0), _nDecompositionDepth(8), _nMaxHullVertices(64), _nNumThreads(0)
+    {
+        _cachedirectory = RaveGetHomeDirectory() + s_filesep + std::string("collisionproxies");
+        FOREACHC(itatt, atts) {
+            if( itatt->first == "collisionproxy" ) {
+                if( itatt->second == "decimate" ) {
+                    _type = CPT_Decimate;
+                }
+                else if( itatt->second == "convexhull" ) {
+                    _type = CPT_ConvexHull;
+                }
+                else if( itatt->second == "convexdecomposition" ) {
+                    _type = CPT_ConvexDecomposition;
+                }
+                else if( itatt->second.size() > 0 && itatt->second != "none" ) {
+                    throw OPENRAVE_EXCEPTION_FORMAT(_("unknown collisionproxy type %s, supported types are decimate, convexhull, and convexdecomposition"), itatt->second, ORE_InvalidArguments);
+                }
+            }
+            else if( itatt->first == "collisionproxygroup" ) {
+                _groupname = itatt->second;
+            }
+            else if( itatt->first == "collisionproxymaxtriangles" ) {
+                _nMaxTriangles = boost::lexical_cast<int>(itatt->second);
+            }
+            else if( itatt->first == "collisionproxycellsize" ) {
+                _fCellSize = boost::lexical_cast<dReal>(itatt->second);
+            }
+            else if( itatt->first == "collisionproxydepth" ) {
+                _nDecompositionDepth = boost::lexical_cast<int>(itatt->second);
+            }
+            else if( itatt->first == "collisionproxymaxhullvertices" ) {
+                _nMaxHullVertices = boost::lexical_cast<int>(itatt->second);
+            }
+            else if( itatt->first == "collisionproxycachedir" ) {
+                _cachedirectory = itatt->second;
+            }
+            else if( itatt->first == "numthreads" ) {
+                _nNumThreads = boost::lexical_cast<int>(itatt->second);
+            }
+        }
+        if( _type != CPT_None && _groupname.size() == 0 ) {
+            throw OPENRAVE_EXCEPTION_FORMAT0(_("collisionproxygroup cannot be empty"), ORE_InvalidArguments);
+        }
+
+        // the parameters that change the generated meshes, used in the cache key
+        switch(_type) {
+        case CPT_Decimate: _sparameters = str(boost::format("decimate %d %.15e")%_nMaxTriangles%_fCellSize); break;
+        case CPT_ConvexHull: _sparameters = "convexhull"; break;
+        case CPT_ConvexDecomposition: _sparameters = str(boost::format("convexdecomposition %d %d")%_nDecompositionDepth%_nMaxHullVertices); break;
+        default: break;
+        }
+    }
+
+    bool IsEnabled() const {
+        return _type != CPT_None;
+    }
+
+    const std::string& GetGroupName() const {
+        return _groupname;
+    }
+
+    /// \brief sets the collision proxies of the bodies as the group geometries of their links
+    ///
+    /// Links that do not have trimesh geometries or that already have the group are skipped.
+    /// \param vproxybodies filled with the bodies that have at least one link with the group
+    void Generate(const std::vector<KinBodyPtr>& vbodies, std::vector<KinBodyPtr>& vproxybodies)
+    {
+        vproxybodies.resize(0);
+        _vjobs.resize(0);
+        std::vector<LinkGeometries> vlinkgeometries;
+        FOREACHC(itbody, vbodies) {
+            FOREACHC(itlink, (*itbody)->GetLinks()) {
+                if( (*itlink)->GetGroupNumGeometries(_groupname) >= 0 ) {
+                    // generated by a previous load, for example when the body was read before being added
+                    if( find(vproxybodies.begin(), vproxybodies.end(), *itbody) == vproxybodies.end() ) {
+                        vproxybodies.push_back(*itbody);
+                    }
+                    continue;
+                }
+                LinkGeometries linkgeometries;
+                linkgeometries._plink = *itlink;
+                bool bHasTriMesh = false;
+                FOREACHC(itgeom, (*itlink)->GetGeometries()) {
+                    KinBody::GeometryInfoPtr pinfo(new KinBody::GeometryInfo((*itgeom)->GetInfo()));
+                    int jobindex = -1;
+                    if( pinfo->_type == GT_TriMesh && pinfo->_meshcollision.indices.size() >= 3 ) {
+                        jobindex = (int)_vjobs.size();
+                        _vjobs.push_back(Job());
+                        _vjobs.back()._pmesh = &pinfo->_meshcollision;
+                        bHasTriMesh = true;
+                    }
+                    linkgeometries._vgeometries.push_back(std::make_pair(pinfo, jobindex));
+                }
+                if( bHasTriMesh ) {
+                    vlinkgeometries.push_back(linkgeometries);
+                }
+            }
+        }
+        if( _vjobs.size() == 0 ) {
+            return;
+        }
+
+        uint64_t starttime = utils::GetMicroTime();
+        _InitializeCacheDirectory();
+        _Run();
+
+        size_t numcached = 0, numtriangles = 0, numproxytriangles = 0;
+        FOREACHC(itjob, _vjobs) {
+            numtriangles += itjob->_pmesh->indices.size()/3;
+            if( itjob->_vproxies.size() == 0 ) {
+                numproxytriangles += itjob->_pmesh->indices.size()/3;
+            }
+            FOREACHC(itproxy, itjob->_vproxies) {
+                numproxytriangles += itproxy->indices.size()/3;
+            }
+            if( itjob->_bCached ) {
+                ++numcached;
+            }
+        }
+
+        // link geometries are only changed after all the proxies are generated, since the jobs point into the geometry infos
+        FOREACH(itlinkgeometries, vlinkgeometries) {
+            std::vector<KinBody::GeometryInfoPtr> vproxyinfos;
+            FOREACH(itgeometry, itlinkgeometries->_vgeometries) {
+                KinBody::GeometryInfoPtr pinfo = itgeometry->first;
+                if( itgeometry->second < 0 || _vjobs.at(itgeometry->second)._vproxies.size() == 0 ) {
+                    vproxyinfos.push_back(pinfo);
+                    continue;
+                }
+                const std::vector<TriMesh>& vproxies = _vjobs.at(itgeometry->second)._vproxies;
+                for(size_t iproxy = 0; iproxy < vproxies.size(); ++iproxy) {
+                    KinBody::GeometryInfoPtr pproxyinfo(new KinBody::GeometryInfo(*pinfo));
+                    pproxyinfo->_meshcollision = vproxies[iproxy];
+                    pproxyinfo->_filenamecollision.clear();
+                    if( vproxies.size() > 1 ) {
+                        pproxyinfo->_name = str(boost::format("%s_hull%d")%pinfo->_name%iproxy);
+                        if( pinfo->_id.size() > 0 ) {
+                            pproxyinfo->_id = str(boost::format("%s_hull%d")%pinfo->_id%iproxy);
+                        }
+                    }
+                    vproxyinfos.push_back(pproxyinfo);
+                }
+            }
+            itlinkgeometries->_plink->SetGroupGeometries(_groupname, vproxyinfos);
+            KinBodyPtr pbody = itlinkgeometries->_plink->GetParent();
+            if( find(vproxybodies.begin(), vproxybodies.end(), pbody) == vproxybodies.end() ) {
+                vproxybodies.push_back(pbody);
+            }
+        }
+        RAVELOG_DEBUG_FORMAT("env=%d, generated %d collision proxies (%d cached) for group %s in %fs, triangles %d -> %d", _environmentid%_vjobs.size()%numcached%_groupname%(1e-6*(utils::GetMicroTime()-starttime))%numtriangles%numproxytriangles);
+    }
+
+protected:
+    struct Job
+    {
+        Job() : _pmesh(NULL), _bCached(false) {
+        }
+        const TriMesh* _pmesh; ///< points into the copied geometry info
+        std::vector<TriMesh> _vproxies; ///< the generated meshes, if empty then the original mesh is kept
+        bool _bCached; ///< true if _vproxies was read from the cache
+    };
+
+    struct LinkGeometries
+    {
+        KinBody::LinkPtr _plink;
+        std::vector< std::pair<KinBody::GeometryInfoPtr, int> > _vgeometries; ///< copies of the link geometries and their index into _vjobs, or -1
+    };
+
+    void _InitializeCacheDirectory()
+    {
+        if( _cachedirectory.size() == 0 ) {
+            return;
+        }
+#ifdef HAVE_BOOST_FILESYSTEM
+        try {
+            boost::filesystem::create_directories(boost::filesystem::path(_cachedirectory));
+        }
+        catch(const boost::filesystem::filesystem_error& ex) {
+            RAVELOG_WARN_FORMAT("env=%d, cannot create collision proxy cache %s, not caching: %s", _environmentid%_cachedirectory%ex.what());
+            _cachedirectory.clear();
+        }
+#endif
+    }
+
+    void _Run()
+    {
+        utils::ParallelFor(_vjobs.size(), boost::bind(&CollisionProxyGenerator::_GenerateIndex, this, _1), _nNumThreads);
+    }
+
+    void _GenerateIndex(size_t index)
+    {
+        Job& job = _vjobs[index];
+        try {
+            _GenerateJob(job);
+        }
+        catch(const std::exception& ex) {
+            RAVELOG_WARN_FORMAT("env=%d, failed to generate collision proxy, keeping the original mesh: %s", _environmentid%ex.what());
+            job._vproxies.clear();
+        }
+    }
+
+    void _GenerateJob(Job& job)
+    {
+        const TriMesh& mesh = *job._pmesh;
+        if( _type == CPT_Decimate && _fCellSize <= 0 && (int)mesh.indices.size()/3 <= _nMaxTriangles ) {
+            // already coarse enough
+            return;
+        }
+
+        std::string cachefilename;
+        if( _cachedirectory.size() > 0 ) {
+            cachefilename = _GetCacheFilename(mesh);
+            if( _ReadCacheFile(cachefilename, job._vproxies) ) {
+                job._bCached = true;
+                return;
+            }
+            job._vproxies.clear();
+        }
+
+        switch(_type) {
+        case CPT_Decimate: {
+            job._vproxies.resize(1);
+            _Decimate(mesh, job._vproxies[0]);
+            break;
+        }
+        case CPT_ConvexHull: {
+            job._vproxies.resize(1);
+            if( !_ComputeConvexHull(mesh, job._vproxies[0]) ) {
+                job._vproxies.clear();
+            }
+            break;
+        }
+        case CPT_ConvexDecomposition: {
+            if( !_ComputeConvexDecomposition(mesh, job._vproxies) ) {
+                job._vproxies.clear();
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        if( job._vproxies.size() > 0 && cachefilename.size() > 0 ) {
+            _WriteCacheFile(cachefilename, job._vproxies);
+        }
+    }
+
+    /// \brief clusters the vertices on a uniform grid. If no cell size is given, grows the cell size until the mesh has at most _nMaxTriangles.
+    void _Decimate(const TriMesh& mesh, TriMesh& decimated)
+    {
+        if( _fCellSize > 0 ) {
+            _ClusterVertices(mesh, _fCellSize, decimated);
+            return;
+        }
+        AABB ab = mesh.ComputeAABB();
+        dReal fextent = 2*max(ab.extents.x, max(ab.extents.y, ab.extents.z));
+        if( fextent <= 0 ) {
+            decimated = mesh;
+            return;
+        }
+        // a closed surface with n cells along each side has roughly 12*n^2 triangles
+        dReal fcellsize = fextent / max(dReal(1), RaveSqrt(dReal(_nMaxTriangles)/dReal(12)));
+        for(int iter = 0; iter < 32; ++iter) {
+            _ClusterVertices(mesh, fcellsize, decimated);
+            if( (int)decimated.indices.size()/3 <= _nMaxTriangles ) {
+                return;
+            }
+            fcellsize *= 1.25;
+        }
+    }
+
+    static void _ClusterVertices(const TriMesh& mesh, dReal fcellsize, TriMesh& clustered)
+    {
+        AABB ab = mesh.ComputeAABB();
+        Vector vmin = ab.pos - ab.extents;
+        dReal finvcellsize = 1/fcellsize;
+        std::map<boost::array<int, 3>, int> mapcellindices;
+        std::vector<Vector> vsums;
+        std::vector<int> vcounts;
+        std::vector<int> vremap(mesh.vertices.size());
+        for(size_t ivertex = 0; ivertex < mesh.vertices.size(); ++ivertex) {
+            Vector v = (mesh.vertices[ivertex] - vmin)*finvcellsize;
+            boost::array<int, 3> cell = {{ (int)std::floor(v.x), (int)std::floor(v.y), (int)std::floor(v.z) }};
+            std::map<boost::array<int, 3>, int>::iterator it = mapcellindices.find(cell);
+            if( it == mapcellindices.end() ) {
+                it = mapcellindices.insert(std::make_pair(cell, (int)vsums.size())).first;
+                vsums.push_back(Vector(0,0,0));
+                vcounts.push_back(0);
+            }
+            vsums[it->second] += mesh.vertices[ivertex];
+            vcounts[it->second] += 1;
+            vremap[ivertex] = it->second;
+        }
+
+        clustered.vertices.resize(vsums.size());
+        for(size_t icluster = 0; icluster < vsums.size(); ++icluster) {
+            clustered.vertices[icluster] = vsums[icluster]*(dReal(1)/dReal(vcounts[icluster]));
+        }
+        clustered.indices.resize(0);
+        std::set<boost::array<int, 3> > settriangles;
+        for(size_t i = 0; i+2 < mesh.indices.size(); i += 3) {
+            int i0 = vremap.at(mesh.indices[i]), i1 = vremap.at(mesh.indices[i+1]), i2 = vremap.at(mesh.indices[i+2]);
+            if( i0 == i1 || i1 == i2 || i0 == i2 ) {
+                continue;
+            }
+            boost::array<int, 3> triangle = {{ i0, i1, i2 }};
+            std::sort(triangle.begin(), triangle.end());
+            if( !settriangles.insert(triangle).second ) {
+                continue;
+            }
+            clustered.indices.push_back(i0);
+            clustered.indices.push_back(i1);
+            clustered.indices.push_back(i2);
+        }
+
+        // every point of an original triangle is a weighted sum of its vertices, so it is at most as far from the same weighted sum of
+        // their cluster centers, which lies on the decimated triangle, as the farthest of its vertices is from its cluster center. Moving
+        // every decimated triangle out along its normal by that distance makes the proxy contain the original surface.
+        std::vector<dReal> vradii(clustered.vertices.size(), 0);
+        for(size_t ivertex = 0; ivertex < mesh.vertices.size(); ++ivertex) {
+            int icluster = vremap[ivertex];
+            vradii[icluster] = max(vradii[icluster], RaveSqrt((mesh.vertices[ivertex]-clustered.vertices[icluster]).lengthsqr3()));
+        }
+        std::vector<Vector> vfacenormals(clustered.indices.size()/3);
+        std::vector<Vector> vnormals(clustered.vertices.size(), Vector(0,0,0));
+        for(size_t i = 0; i+2 < clustered.indices.size(); i += 3) {
+            const Vector& v0 = clustered.vertices[clustered.indices[i]];
+            Vector vnormal = (clustered.vertices[clustered.indices[i+1]]-v0).cross(clustered.vertices[clustered.indices[i+2]]-v0);
+            vnormals[clustered.indices[i]] += vnormal;
+            vnormals[clustered.indices[i+1]] += vnormal;
+            vnormals[clustered.indices[i+2]] += vnormal;
+            dReal flength = RaveSqrt(vnormal.lengthsqr3());
+            vfacenormals[i/3] = flength > g_fEpsilon ? vnormal*(1/flength) : Vector(0,0,0);
+        }
+        FOREACH(itnormal, vnormals) {
+            dReal flength = RaveSqrt(itnormal->lengthsqr3());
+            *itnormal = flength > g_fEpsilon ? *itnormal*(1/flength) : Vector(0,0,0);
+        }
+        // a vertex moved by d along its normal moves the plane of an adjacent face by d*dot(vertex normal, face normal), so divide by
+        // the dot product. It is clamped where the faces of a vertex point in nearly opposite directions, like at the rim of a thin
+        // plate, and only there the faces can move out less than the distance.
+        std::vector<dReal> voffsets(clustered.vertices.size(), 0);
+        for(size_t i = 0; i+2 < clustered.indices.size(); i += 3) {
+            dReal fradius = max(vradii[clustered.indices[i]], max(vradii[clustered.indices[i+1]], vradii[clustered.indices[i+2]]));
+            for(int j = 0; j < 3; ++j) {
+                int icluster = clustered.indices[i+j];
+                dReal fdot = max(s_fMinInflationNormalDot, vnormals[icluster].dot3(vfacenormals[i/3]));
+                voffsets[icluster] = max(voffsets[icluster], fradius/fdot);
+            }
+        }
+        for(size_t icluster = 0; icluster < clustered.vertices.size(); ++icluster) {
+            clustered.vertices[icluster] += vnormals[icluster]*voffsets[icluster];
+        }
+    }
+
+    bool _ComputeConvexHull(const TriMesh& mesh, TriMesh& hull)
+    {
+#ifdef QHULL_FOUND
+        if( mesh.vertices.size() < 4 ) {
+            return false;
+        }
+        std::vector<coordT> qpoints(3*mesh.vertices.size());
+        for(size_t ivertex = 0; ivertex < mesh.vertices.size(); ++ivertex) {
+            qpoints[3*ivertex+0] = mesh.vertices[ivertex].x;
+            qpoints[3*ivertex+1] = mesh.vertices[ivertex].y;
+            qpoints[3*ivertex+2] = mesh.vertices[ivertex].z;
+        }
+
+        boolT ismalloc = 0;
+        char flags[] = "qhull Qt"; // triangulated output
+
+        boost::mutex::scoped_lock lock(s_QhullMutex);
+        FILE* errfile = tmpfile(); // error messages from qhull code
+
+#ifdef QHULL_USE_REENTRANT
+        qhT qh_qh;
+        qhT *qh= &qh_qh;
+        qh_zero(qh, errfile);
+        int exitcode = qh_new_qhull(qh, 3, (int)mesh.vertices.size(), &qpoints[0], ismalloc, flags, NULL, errfile);
+#else
+        int exitcode = qh_new_qhull(3, (int)mesh.vertices.size(), &qpoints[0], ismalloc, flags, NULL, errfile);
+#endif
+        if( !exitcode ) {
+            // qhull only triangulates the merged facets when producing output
+#ifdef QHULL_USE_REENTRANT
+            qh_triangulate(qh);
+#else
+            qh_triangulate();
+#endif
+            hull.vertices.resize(0);
+            hull.indices.resize(0);
+            std::map<int, int> mapvertexindices; // qhull point id -> hull vertex
+            facetT *facet;
+            vertexT *vertex, **vertexp;
+            FORALLfacets {
+                if( !facet->vertices || !facet->normal ) {
+                    continue;
+                }
+                int vindices[3], numvertices = 0;
+                FOREACHvertex_(facet->vertices) {
+                    if( numvertices >= 3 ) {
+                        break;
+                    }
+#ifdef QHULL_USE_REENTRANT
+                    int id = qh_pointid(qh, vertex->point);
+#else
+                    int id = qh_pointid(vertex->point);
+#endif
+                    if( id < 0 || id >= (int)mesh.vertices.size() ) {
+                        numvertices = 0;
+                        break;
+                    }
+                    std::map<int, int>::iterator it = mapvertexindices.find(id);
+                    if( it == mapvertexindices.end() ) {
+                        it = mapvertexindices.insert(std::make_pair(id, (int)hull.vertices.size())).first;
+                        hull.vertices.push_back(mesh.vertices[id]);
+                    }
+                    vindices[numvertices++] = it->second;
+                }
+                if( numvertices < 3 ) {
+                    continue;
+                }
+                // qhull does not order the facet vertices, so orient the triangle with the outward normal
+                Vector vnormal(facet->normal[0], facet->normal[1], facet->normal[2]);
+                Vector v0 = hull.vertices[vindices[0]], v1 = hull.vertices[vindices[1]], v2 = hull.vertices[vindices[2]];
+                if( (v1-v0).cross(v2-v0).dot3(vnormal) < 0 ) {
+                    std::swap(vindices[1], vindices[2]);
+                }
+                hull.indices.push_back(vindices[0]);
+                hull.indices.push_back(vindices[1]);
+                hull.indices.push_back(vindices[2]);
+            }
+        }
+
+        int curlong, totlong;
+#ifdef QHULL_USE_REENTRANT
+        qh_freeqhull(qh, !qh_ALL);
+        qh_memfreeshort(qh, &curlong, &totlong);
+#else
+        qh_freeqhull(!qh_ALL);
+        qh_memfreeshort(&curlong, &totlong);
+#endif
+        if( !!errfile ) {
+            fclose(errfile);
+        }
+        if( exitcode ) {
+            RAVELOG_WARN_FORMAT("env=%d, qhull failed with error %d, keeping the original mesh", _environmentid%exitcode);
+            return false;
+        }
+        return hull.indices.size() > 0;
+#else
+        RAVELOG_WARN_FORMAT("env=%d, not compiled with qhull, cannot compute convex hull", _environmentid);
+        return false;
+#endif
+    }
+
+    bool _ComputeConvexDecomposition(const TriMesh& mesh, std::vector<TriMesh>& vhulls)
+    {
+#ifdef OPENRAVE_CONVEXDECOMPOSITION
+        boost::mutex::scoped_lock lock(s_ConvexDecompositionMutex);
+        boost::shared_ptr<CONVEX_DECOMPOSITION::iConvexDecomposition> ic(CONVEX_DECOMPOSITION::createConvexDecomposition(), CONVEX_DECOMPOSITION::releaseConvexDecomposition);
+        for(size_t i = 0; i+2 < mesh.indices.size(); i += 3) {
+            NxF32 vpoints[3][3];
+            for(int j = 0; j < 3; ++j) {
+                const Vector& v = mesh.vertices.at(mesh.indices[i+j]);
+                vpoints[j][0] = v.x; vpoints[j][1] = v.y; vpoints[j][2] = v.z;
+            }
+            ic->addTriangle(vpoints[0], vpoints[1], vpoints[2]);
+        }
+        ic->computeConvexDecomposition(0, _nDecompositionDepth, _nMaxHullVertices, 0.1f, 30.0f, 0.1f, true, false, false);
+        NxU32 hullcount = ic->getHullCount();
+        vhulls.resize(0);
+        vhulls.reserve(hullcount);
+        CONVEX_DECOMPOSITION::ConvexHullResult result;
+        for(NxU32 ihull = 0; ihull < hullcount; ++ihull) {
+            if( !ic->getConvexHullResult(ihull, result) || result.mTcount == 0 ) {
+                continue;
+            }
+            vhulls.push_back(TriMesh());
+            TriMesh& hull = vhulls.back();
+            hull.vertices.resize(result.mVcount);
+            for(NxU32 ivertex = 0; ivertex < result.mVcount; ++ivertex) {
+                hull.vertices[ivertex] = Vector(result.mVertices[3*ivertex], result.mVertices[3*ivertex+1], result.mVertices[3*ivertex+2]);
+            }
+            hull.indices.resize(3*result.mTcount);
+            std::copy(result.mIndices, result.mIndices + 3*result.mTcount, hull.indices.begin());
+        }
+        return vhulls.size() > 0;
+#else
+        RAVELOG_WARN_FORMAT("env=%d, not compiled with convexdecomposition, cannot compute convex decomposition", _environmentid);
+        return false;
+#endif
+    }
+
+    /// \brief the cache file is keyed by the proxy parameters and the mesh data
+    std::string _GetCacheFilename(const TriMesh& mesh) const
+    {
+        std::string key = str(boost::format("%s %d %s\n")%OPENRAVE_VERSION_STRING%(int)s_collisionProxyCacheVersion%_sparameters);
+        size_t keysize = key.size();
+        key.resize(keysize + 3*sizeof(double)*mesh.vertices.size() + sizeof(int32_t)*mesh.indices.size());
+        char* pkey = &key[keysize];
+        FOREACHC(itvertex, mesh.vertices) {
+            double v[3] = { itvertex->x, itvertex->y, itvertex->z };
+            memcpy(pkey, v, sizeof(v));
+            pkey += sizeof(v);
+        }
+        if( mesh.indices.size() > 0 ) {
+            memcpy(pkey, &mesh.indices[0], sizeof(int32_t)*mesh.indices.size());
+        }
+        std::string cachefilename = _cachedirectory;
+        if( cachefilename.size() > 0 && cachefilename[cachefilename.size()-1] != s_filesep ) {
+            cachefilename += s_filesep;
+        }
+        cachefilename += utils::GetMD5HashString(key);
+        cachefilename += ".orproxy";
+        return cachefilename;
+    }
+
+    static bool _ReadCacheFile(const std::string& cachefilename, std::vector<TriMesh>& vproxies)
+    {
+        std::ifstream ifs(cachefilename.c_str(), std::ios::binary);
+        if( !ifs ) {
+            return false;
+        }
+        char magic[sizeof(s_collisionProxyCacheMagic)];
+        ifs.read(magic, sizeof(magic));
+        if( !ifs || memcmp(magic, s_collisionProxyCacheMagic, sizeof(magic)-1) != 0 || (uint8_t)magic[sizeof(magic)-1] != s_collisionProxyCacheVersion ) {
+            return false;
+        }
+        uint32_t numproxies = 0;
+        ifs.read((char*)&numproxies, sizeof(numproxies));
+        if( !ifs || numproxies == 0 ) {
+            return false;
+        }
+        vproxies.resize(numproxies);
+        FOREACH(itproxy, vproxies) {
+            uint32_t numvertices = 0, numindices = 0;
+            ifs.read((char*)&numvertices, sizeof(numvertices));
+            if( !ifs ) {
+                return false;
+            }
+            std::vector<double> vvertices(3*numvertices);
+            if( numvertices > 0 ) {
+                ifs.read((char*)&vvertices[0], sizeof(double)*vvertices.size());
+            }
+            ifs.read((char*)&numindices, sizeof(numindices));
+            if( !ifs ) {
+                return false;
+            }
+            itproxy->indices.resize(numindices);
+            if( numindices > 0 ) {
+                ifs.read((char*)&itproxy->indices[0], sizeof(int32_t)*numindices);
+            }
+            if( !ifs ) {
+                return false;
+            }
+            itproxy->vertices.resize(numvertices);
+            for(uint32_t ivertex = 0; ivertex < numvertices; ++ivertex) {
+                itproxy->vertices[ivertex] = Vector(vvertices[3*ivertex], vvertices[3*ivertex+1], vvertices[3*ivertex+2]);
+            }
+            FOREACHC(itindex, itproxy->indices) {
+                if( *itindex < 0 || *itindex >= (int32_t)numvertices ) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void _WriteCacheFile(const std::string& cachefilename, const std::vector<TriMesh>& vproxies) const
+    {
+        std::vector<char> output(s_collisionProxyCacheMagic, s_collisionProxyCacheMagic+sizeof(s_collisionProxyCacheMagic));
+        output.back() = (char)s_collisionProxyCacheVersion;
+        uint32_t numproxies = vproxies.size();
+        output.insert(output.end(), (const char*)&numproxies, (const char*)&numproxies + sizeof(numproxies));
+        FOREACHC(itproxy, vproxies) {
+            uint32_t numvertices = itproxy->vertices.size();
+            output.insert(output.end(), (const char*)&numvertices, (const char*)&numvertices + sizeof(numvertices));
+            FOREACHC(itvertex, itproxy->vertices) {
+                double v[3] = { itvertex->x, itvertex->y, itvertex->z };
+                output.insert(output.end(), (const char*)v, (const char*)v + sizeof(v));
+            }
+            uint32_t numindices = itproxy->indices.size();
+            output.insert(output.end(), (const char*)&numindices, (const char*)&numindices + sizeof(numindices));
+            if( numindices > 0 ) {
+                output.insert(output.end(), (const char*)&itproxy->indices[0], (const char*)&itproxy->indices[0] + sizeof(int32_t)*numindices);
+            }
+        }
+
+        // several processes can write the same cache, so write into a unique file and rename it
+        std::string tempfilename = str(boost::format("%s.%s.tmp")%cachefilename%utils::GetMicroTime());
+        {
+            std::ofstream ofs(tempfilename.c_str(), std::ios::binary);
+            ofs.write(output.data(), output.size());
+            if( !ofs ) {
+                RAVELOG_WARN_FORMAT("env=%d, failed to write collision proxy cache %s", _environmentid%tempfilename);
+                ofs.close();
+                std::remove(tempfilename.c_str());
+                return;
+            }
+        }
+        if( std::rename(tempfilename.c_str(), cachefilename.c_str()) != 0 ) {
+            RAVELOG_WARN_FORMAT("env=%d, failed to rename collision proxy cache %s to %s", _environmentid%tempfilename%cachefilename);
+            std::remove(tempfilename.c_str());
+        }
+    }
+
+    int _environmentid;
+    ProxyType _type;
+    std::string _groupname;
+    int _nMaxTriangles; ///< for CPT_Decimate, the maximum number of triangles of a mesh when _fCellSize is 0
+    dReal _fCellSize; ///< for CPT_Decimate, if > 0, the clustering cell size
+    int _nDecompositionDepth, _nMaxHullVertices; ///< for CPT_ConvexDecomposition
+    std::string _cachedirectory; ///< if empty, do not cache
+    std::string _sparameters;
+    int _nNumThreads;
+
+    std::vector<Job> _vjobs;
+};
+
+}
+
+std::string RaveGenerateCollisionProxies(int environmentid, const std::vector<KinBodyPtr>& vbodies, const AttributesList& atts, std::vector<KinBodyPtr>& vproxybodies)
+{
+    vproxybodies.resize(0);
+    CollisionProxyGenerator generator(environmentid, atts);
+    if( !generator.IsEnabled() ) {
+        return std::string();
+    }
+    generator.Generate(vbodies, vproxybodies);
+    return generator.GetGroupName();
+}
@@ -354,6 +354,7 @@ public:
             }
             _vecrobots.clear();
             _vPublishedBodies.clear();
+            _mapLazyBodies.clear();
             _nBodiesModifiedStamp++;
 
             _mapBodies.clear();
@@ -462,6 +463,18 @@ public:
     }
 
     virtual bool LoadURI(const std::string& uri, const AttributesList& atts)
+    {
+        EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        std::vector<KinBodyPtr> vprevbodies;
+        _CopyBodies(vprevbodies);
+        if( !_LoadURI(uri, atts) ) {
+            return false;
+        }
+        _GenerateCollisionProxies(_GetNewBodies(vprevbodies), atts);
+        return true;
+    }
+
+    virtual bool _LoadURI(const std::string& uri, const AttributesList& atts)
     {
         if ( _IsColladaURI(uri) ) {
             return RaveParseColladaURI(shared_from_this(), uri, atts);
@@ -479,9 +492,96 @@ public:
         return false;
     }
 
+    /// \brief loads the file. If the OPENRAVE_SCENE_CACHE_DIR environment variable is set, uses a .orbin scene cache keyed by the contents of the file and its dependencies.
     virtual bool Load(const std::string& filename, const AttributesList& atts)
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        std::vector<KinBodyPtr> vprevbodies;
+        _CopyBodies(vprevbodies);
+        if( !_LoadWithSceneCache(filename, atts) ) {
+            return false;
+        }
+        // geometry groups are not part of the scene cache, so always generate the collision proxies after loading
+        _GenerateCollisionProxies(_GetNewBodies(vprevbodies), atts);
+        return true;
+    }
+
+    virtual bool _LoadWithSceneCache(const std::string& filename, const AttributesList& atts)
+    {
+        std::string cachefilename = _GetSceneCacheFilename(filename, atts);
+        if( cachefilename.size() == 0 ) {
+            return _Load(filename, atts);
+        }
+
+        // the xml reader adds bodies with strict name checking while the other loaders rename conflicting bodies, add the cached bodies the same way
+        bool bAnonymous = _IsColladaFile(filename) || (!_IsOpenRAVEFile(filename) && _IsRigidModelFile(filename));
+        std::vector<KinBodyPtr> vcachedbodies;
+        _ClearRapidJsonBuffer();
+        if( RaveParseSceneCacheFile(shared_from_this(), cachefilename, vcachedbodies, *_prLoadEnvAlloc) ) {
+            RAVELOG_DEBUG_FORMAT("env=%d, loading %s from scene cache %s", GetId()%filename%cachefilename);
+            try {
+                FOREACH(itbody, vcachedbodies) {
+                    Add(*itbody, bAnonymous, std::string());
+                }
+            }
+            catch(const std::exception& ex) {
+                // same as a failing xml parse, the bodies added so far stay in the environment
+                RAVELOG_WARN_FORMAT("env=%d, failed to add the bodies of %s: %s", GetId()%filename%ex.what());
+                UpdatePublishedBodies();
+                return false;
+            }
+            UpdatePublishedBodies();
+            return true;
+        }
+
+        std::vector<KinBodyPtr> vprevbodies;
+        size_t nprevmodules, nprevsensors, nprevviewers;
+        {
+            boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+            vprevbodies = _vecbodies;
+            nprevmodules = _listModules.size();
+            nprevsensors = _listSensors.size();
+            nprevviewers = _listViewers.size();
+        }
+        CollisionCheckerBasePtr pprevchecker = _pCurrentChecker;
+        PhysicsEngineBasePtr pprevphysics = _pPhysicsEngine;
+        if( !_Load(filename, atts) ) {
+            return false;
+        }
+
+        // only the bodies are cached, so do not cache files that also set up other parts of the environment
+        std::list<KinBodyPtr> listnewbodies;
+        {
+            boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+            if( _listModules.size() != nprevmodules || _listSensors.size() != nprevsensors || _listViewers.size() != nprevviewers || _pCurrentChecker != pprevchecker || _pPhysicsEngine != pprevphysics ) {
+                RAVELOG_DEBUG_FORMAT("env=%d, %s modifies more than the bodies, so not writing scene cache", GetId()%filename);
+                return true;
+            }
+            if( bAnonymous && vprevbodies.size() > 0 ) {
+                // the new bodies could have been renamed to avoid the existing ones
+                RAVELOG_DEBUG_FORMAT("env=%d, environment is not empty, so not writing scene cache of %s", GetId()%filename);
+                return true;
+            }
+            FOREACHC(itbody, _vecbodies) {
+                if( find(vprevbodies.begin(), vprevbodies.end(), *itbody) == vprevbodies.end() ) {
+                    listnewbodies.push_back(*itbody);
+                }
+            }
+        }
+        if( listnewbodies.size() > 0 ) {
+            try {
+                _ClearRapidJsonBuffer();
+                RaveWriteSceneCacheFile(listnewbodies, cachefilename, *_prLoadEnvAlloc);
+            }
+            catch(const std::exception& ex) {
+                RAVELOG_WARN_FORMAT("env=%d, failed to write scene cache %s: %s", GetId()%cachefilename%ex.what());
+            }
+        }
+        return true;
+    }
+
+    virtual bool _Load(const std::string& filename, const AttributesList& atts)
+    {
         OpenRAVEXMLParser::GetXMLErrorCount() = 0;
         if( _IsColladaURI(filename) ) {
             if( RaveParseColladaURI(shared_from_this(), filename, atts) ) {
@@ -539,6 +639,17 @@ public:
     virtual bool LoadData(const std::string& data, const AttributesList& atts)
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        std::vector<KinBodyPtr> vprevbodies;
+        _CopyBodies(vprevbodies);
+        if( !_LoadData(data, atts) ) {
+            return false;
+        }
+        _GenerateCollisionProxies(_GetNewBodies(vprevbodies), atts);
+        return true;
+    }
+
+    virtual bool _LoadData(const std::string& data, const AttributesList& atts)
+    {
         if( _IsColladaData(data) ) {
             return RaveParseColladaData(shared_from_this(), data, atts);
         }
@@ -562,6 +673,7 @@ public:
     virtual void Save(const std::string& filename, SelectionOptions options, const AttributesList& atts)
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        _MaterializeLazyBodiesForSelection(options);
         std::list<KinBodyPtr> listbodies;
         switch(options) {
         case SO_Everything:
@@ -654,6 +766,7 @@ public:
     virtual void SerializeJSON(rapidjson::Value& rEnvironment, rapidjson::Document::AllocatorType& allocator, SelectionOptions options, const AttributesList& atts)
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        _MaterializeLazyBodiesForSelection(options);
         std::list<KinBodyPtr> listbodies;
         switch(options) {
         case SO_Everything:
@@ -718,6 +831,7 @@ public:
         }
 
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        _MaterializeLazyBodiesForSelection(options);
         std::list<KinBodyPtr> listbodies;
         switch(options) {
         case SO_Everything:
@@ -846,6 +960,7 @@ public:
             _vecbodies.push_back(pbody);
             SetEnvironmentId(pbody);
             _nBodiesModifiedStamp++;
+            _mapLazyBodies.erase(pbody->GetName());
         }
         pbody->_ComputeInternalInformation();
         _pCurrentChecker->InitKinBody(pbody);
@@ -886,6 +1001,7 @@ public:
             _vecrobots.push_back(robot);
             SetEnvironmentId(robot);
             _nBodiesModifiedStamp++;
+            _mapLazyBodies.erase(robot->GetName());
         }
         robot->_ComputeInternalInformation(); // have to do this after _vecrobots is added since SensorBase::SetName can call EnvironmentBase::GetSensor to initialize itself
         _pCurrentChecker->InitKinBody(robot);
@@ -996,7 +1112,8 @@ public:
                 }
             }
             if( it == _vecbodies.end() ) {
-                return false;
+                // a lazy body is removed without ever being created
+                return _mapLazyBodies.erase(name) > 0;
             }
             pbody = *it;
             _RemoveKinBodyFromIterator(it);
@@ -1016,13 +1133,100 @@ public:
 
     virtual KinBodyPtr GetKinBody(const std::string& pname) const
     {
+        {
+            boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+            FOREACHC(it, _vecbodies) {
+                if((*it)->GetName()==pname) {
+                    return *it;
+                }
+            }
+            if( _mapLazyBodies.find(pname) == _mapLazyBodies.end() ) {
+                return KinBodyPtr();
+            }
+        }
+        // materializing adds the body, so have to release _mutexInterfaces and lock the environment first
+        return const_cast<Environment*>(this)->_MaterializeLazyBody(pname);
+    }
+
+    virtual void AddLazyBody(KinBody::KinBodyInfoConstPtr pinfo)
+    {
+        OPENRAVE_ASSERT_FORMAT0(!!pinfo, "lazy body info is null", ORE_InvalidArguments);
+        if( !utils::IsValidName(pinfo->_name) ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("lazy body name: \"%s\" is not valid"), pinfo->_name, ORE_InvalidArguments);
+        }
+        if( pinfo->_isRobot || pinfo->_vJointInfos.size() > 0 || pinfo->_vGrabbedInfos.size() > 0 ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("env=%d, body %s has joints or grabbed bodies, so cannot be lazy"), GetId()%pinfo->_name, ORE_InvalidArguments);
+        }
+        LazyBody lazybody;
+        lazybody._pinfo = pinfo;
+        bool bInitialized = false;
+        FOREACHC(itlinkinfo, pinfo->_vLinkInfos) {
+            Transform tlink = pinfo->_transform * (*itlinkinfo)->_t;
+            FOREACHC(itgeominfo, (*itlinkinfo)->_vgeometryinfos) {
+                AABB abgeom = (*itgeominfo)->ComputeAABB(tlink);
+                if( !bInitialized ) {
+                    lazybody._ab = abgeom;
+                    bInitialized = true;
+                    continue;
+                }
+                Vector vmin = lazybody._ab.pos - lazybody._ab.extents, vmax = lazybody._ab.pos + lazybody._ab.extents;
+                for(int i = 0; i < 3; ++i) {
+                    vmin[i] = min(vmin[i], abgeom.pos[i] - abgeom.extents[i]);
+                    vmax[i] = max(vmax[i], abgeom.pos[i] + abgeom.extents[i]);
+                }
+                lazybody._ab.pos = 0.5*(vmin+vmax);
+                lazybody._ab.extents = 0.5*(vmax-vmin);
+            }
+        }
+        if( !bInitialized ) {
+            lazybody._ab.pos = pinfo->_transform.trans;
+            lazybody._ab.extents = Vector(0,0,0);
+        }
         boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
-        FOREACHC(it, _vecbodies) {
-            if((*it)->GetName()==pname) {
-                return *it;
+        // same as _CheckUniqueName, lazy bodies are not renamed since other bodies can refer to them by name
+        FOREACHC(itbody, _vecbodies) {
+            if( (*itbody)->GetName() == pinfo->_name ) {
+                throw OPENRAVE_EXCEPTION_FORMAT(_("env=%d, lazy body %s does not have unique name"), GetId()%pinfo->_name, ORE_InvalidArguments);
             }
         }
-        return KinBodyPtr();
+        if( _mapLazyBodies.find(pinfo->_name) != _mapLazyBodies.end() ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("env=%d, lazy body %s is already registered"), GetId()%pinfo->_name, ORE_InvalidArguments);
+        }
+        _mapLazyBodies[pinfo->_name] = lazybody;
+    }
+
+    virtual void GetLazyBodies(std::vector< std::pair<std::string, AABB> >& vLazyBodies) const
+    {
+        boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+        vLazyBodies.resize(0);
+        vLazyBodies.reserve(_mapLazyBodies.size());
+        FOREACHC(it, _mapLazyBodies) {
+            vLazyBodies.push_back(std::make_pair(it->first, it->second._ab));
+        }
+    }
+
+    virtual int MaterializeLazyBodies(const AABB& ab)
+    {
+        EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        std::vector<std::string> vnames;
+        {
+            boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+            FOREACHC(it, _mapLazyBodies) {
+                const AABB& ablazy = it->second._ab;
+                if( RaveFabs(ablazy.pos.x - ab.pos.x) <= ablazy.extents.x + ab.extents.x
+                    && RaveFabs(ablazy.pos.y - ab.pos.y) <= ablazy.extents.y + ab.extents.y
+                    && RaveFabs(ablazy.pos.z - ab.pos.z) <= ablazy.extents.z + ab.extents.z ) {
+                    vnames.push_back(it->first);
+                }
+            }
+        }
+        int nmaterialized = 0;
+        FOREACH(itname, vnames) {
+            if( !!_MaterializeLazyBody(*itname) ) {
+                ++nmaterialized;
+            }
+        }
+        return nmaterialized;
     }
 
     virtual RobotBasePtr GetRobot(const std::string& pname) const
@@ -1058,6 +1262,8 @@ public:
     virtual bool SetPhysicsEngine(PhysicsEngineBasePtr pengine)
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        // the new engine is initialized with the bodies of the environment, so it has to see the lazy bodies too
+        _MaterializeAllLazyBodies();
         if( !!_pPhysicsEngine ) {
             _pPhysicsEngine->DestroyEnvironment();
         }
@@ -1107,6 +1313,8 @@ public:
         if( _pCurrentChecker == pchecker ) {
             return true;
         }
+        // the new checker is initialized with the bodies of the environment, so it has to see the lazy bodies too
+        _MaterializeAllLazyBodies();
         if( !!_pCurrentChecker ) {
             _pCurrentChecker->DestroyEnvironment();     // delete all resources
         }
@@ -1132,6 +1340,7 @@ public:
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
         CHECK_COLLISION_BODY(pbody1);
+        _MaterializeLazyBodiesNear(pbody1);
         return _pCurrentChecker->CheckCollision(pbody1,report);
     }
 
@@ -1147,6 +1356,7 @@ public:
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
         CHECK_COLLISION_BODY(plink->GetParent());
+        _MaterializeLazyBodiesNear(plink);
         return _pCurrentChecker->CheckCollision(plink,report);
     }
 
@@ -1170,6 +1380,7 @@ public:
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
         CHECK_COLLISION_BODY(plink->GetParent());
+        _MaterializeLazyBodiesNear(plink);
         return _pCurrentChecker->CheckCollision(plink,vbodyexcluded,vlinkexcluded,report);
     }
 
@@ -1177,6 +1388,7 @@ public:
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
         CHECK_COLLISION_BODY(pbody);
+        _MaterializeLazyBodiesNear(pbody);
         return _pCurrentChecker->CheckCollision(pbody,vbodyexcluded,vlinkexcluded,report);
     }
 
@@ -1194,6 +1406,12 @@ public:
     }
     virtual bool CheckCollision(const RAY& ray, CollisionReportPtr report)
     {
+        if( _HasLazyBodies() ) {
+            AABB ab;
+            ab.pos = ray.pos + 0.5*ray.dir;
+            ab.extents = Vector(RaveFabs(ray.dir.x), RaveFabs(ray.dir.y), RaveFabs(ray.dir.z))*0.5;
+            MaterializeLazyBodies(ab);
+        }
         return _pCurrentChecker->CheckCollision(ray,report);
     }
 
@@ -1487,6 +1705,7 @@ public:
         // have to set the URI to the passed in one rather than the resolved one, otherwise external components won't be able to compare if a URI is equivalent or not
         if( !!robot ) {
             robot->__struri = filename;
+            _GenerateCollisionProxies(std::vector<KinBodyPtr>(1, robot), atts);
         }
 
         return robot;
@@ -1556,6 +1775,7 @@ public:
                     robot->__struri = itatt->second;
                 }
             }
+            _GenerateCollisionProxies(std::vector<KinBodyPtr>(1, robot), atts);
         }
 
         return robot;
@@ -1675,6 +1895,7 @@ public:
         // have to set the URI to the passed in one rather than the resolved one, otherwise external components won't be able to compare if a URI is equivalent or not
         if( !!body ) {
             body->__struri = filename;
+            _GenerateCollisionProxies(std::vector<KinBodyPtr>(1, body), atts);
         }
 
         return body;
@@ -1744,6 +1965,7 @@ public:
                     body->__struri = itatt->second;
                 }
             }
+            _GenerateCollisionProxies(std::vector<KinBodyPtr>(1, body), atts);
         }
         return body;
     }
@@ -2032,6 +2254,8 @@ public:
     {
         CHECK_INTERFACE(pnewviewer);
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        // viewers display all the bodies
+        _MaterializeAllLazyBodies();
         boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
         BOOST_ASSERT(find(_listViewers.begin(),_listViewers.end(),pnewviewer) == _listViewers.end() );
         _CheckUniqueName(ViewerBaseConstPtr(pnewviewer),true);
@@ -2433,6 +2657,18 @@ public:
                 vBodies[i]->ExtractInfo(*info._vBodyInfos[i]);
             }
         }
+        // lazy bodies are part of the scene even though they were not created yet
+        std::vector<KinBody::KinBodyInfoConstPtr> vLazyBodyInfos;
+        {
+            boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+            vLazyBodyInfos.reserve(_mapLazyBodies.size());
+            FOREACHC(itlazybody, _mapLazyBodies) {
+                vLazyBodyInfos.push_back(itlazybody->second._pinfo);
+            }
+        }
+        FOREACHC(itlazyinfo, vLazyBodyInfos) {
+            info._vBodyInfos.push_back(_CopyLazyBodyInfo(**itlazyinfo));
+        }
         info._name = _name;
         info._keywords = _keywords;
         info._description = _description;
@@ -2473,6 +2709,7 @@ public:
             boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
             vBodies = _vecbodies;
         }
+        BodyIdNameIndexer bodyIndexer(vBodies);
 
         // internally manipulates _vecbodies using _AddKinBody/_AddRobot/_RemoveKinBodyFromIterator
         for(int bodyIndex = 0; bodyIndex < (int)info._vBodyInfos.size(); ++bodyIndex) {
@@ -2483,45 +2720,23 @@ public:
             KinBodyPtr pMatchExistingBody; // matches to pKinBodyInfo
             {
                 // find existing body in the env
-                std::vector<KinBodyPtr>::iterator itExistingSameId = vBodies.end();
-                std::vector<KinBodyPtr>::iterator itExistingSameName = vBodies.end();
-                std::vector<KinBodyPtr>::iterator itExistingSameIdName = vBodies.end();
-
-                // search only in the unprocessed part of vBodies
-                if( (int)vBodies.size() > bodyIndex ) {
-                    for (std::vector<KinBodyPtr>::iterator itBody = vBodies.begin() + bodyIndex; itBody != vBodies.end(); ++itBody) {
-                        bool bIdMatch = !(*itBody)->_id.empty() && (*itBody)->_id == kinBodyInfo._id;
-                        bool bNameMatch = !(*itBody)->_name.empty() && (*itBody)->_name == kinBodyInfo._name;
-                        if( bIdMatch && bNameMatch ) {
-                            itExistingSameIdName = itBody;
-                            itExistingSameId = itBody;
-                            itExistingSameName = itBody;
-                            break;
-                        }
-                        if( bIdMatch && itExistingSameId == vBodies.end() ) {
-                            itExistingSameId = itBody;
-                        }
-                        if( bNameMatch && itExistingSameName == vBodies.end() ) {
-                            itExistingSameName = itBody;
-                        }
-                    }
-                }
-
-                std::vector<KinBodyPtr>::iterator itExisting = itExistingSameIdName;
-                if( itExisting == vBodies.end() ) {
-                    itExisting = itExistingSameId;
+                int iExistingSameIdName = -1, iExistingSameId = -1, iExistingSameName = -1;
+                bodyIndexer.Find(kinBodyInfo, iExistingSameIdName, iExistingSameId, iExistingSameName);
+                int iExisting = iExistingSameIdName;
+                if( iExisting < 0 ) {
+                    iExisting = iExistingSameId;
                 }
-                if( itExisting == vBodies.end() ) {
-                    itExisting = itExistingSameName;
+                if( iExisting < 0 ) {
+                    iExisting = iExistingSameName;
                 }
 
                 // check if interface type changed, if so, remove the body and treat it as a new body
-                if (itExisting != vBodies.end()) {
-                    KinBodyPtr pBody = *itExisting;
+                if (iExisting >= 0) {
+                    KinBodyPtr pBody = vBodies[iExisting];
                     bool bInterfaceMatches = pBody->GetXMLId() == pKinBodyInfo->_interfaceType;
                     if( !bInterfaceMatches || pBody->IsRobot() != pKinBodyInfo->_isRobot ) {
                         RAVELOG_VERBOSE_FORMAT("env=%d, body %s interface is changed, remove old body from environment. xmlid=%s, _interfaceType=%s, isRobot %d != %d", GetId()%pBody->_id%pBody->GetXMLId()%pKinBodyInfo->_interfaceType%pBody->IsRobot()%pKinBodyInfo->_isRobot);
-                        itExisting = vBodies.end();
+                        iExisting = -1;
                         vRemovedBodies.push_back(pBody);
 
                         boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
@@ -2532,22 +2747,31 @@ public:
                     }
                 }
 
-                if( itExisting != vBodies.end() ) {
-                    if( itExisting != itExistingSameName && itExistingSameName != vBodies.end() ) {
-                        // new name will conflict with *itExistingSameName, so should change the names to something temporarily
+                if( iExisting >= 0 ) {
+                    if( iExisting != iExistingSameName && iExistingSameName >= 0 ) {
+                        // new name will conflict with vBodies[iExistingSameName], so should change the names to something temporarily
                         // for now, clear since the body should be processed later again
-                        (*itExistingSameName)->_name.clear();
+                        bodyIndexer.Erase(iExistingSameName);
+                        vBodies[iExistingSameName]->_name.clear();
+                        bodyIndexer.Insert(iExistingSameName);
                     }
-                    pMatchExistingBody = *itExisting;
-                    if (bodyIndex != itExisting-vBodies.begin()) {
+                    pMatchExistingBody = vBodies[iExisting];
+                    bodyIndexer.Erase(iExisting);
+                    if (bodyIndex != iExisting) {
                         // re-arrange vBodies according to the order of infos
-                        KinBodyPtr pTempBody = vBodies[bodyIndex];
+                        bodyIndexer.Erase(bodyIndex);
+                        vBodies[iExisting] = vBodies[bodyIndex];
                         vBodies[bodyIndex] = pMatchExistingBody;
-                        *itExisting = pTempBody;
+                        bodyIndexer.Insert(iExisting);
                     }
                 }
             }
 
+            if( !!pMatchExistingBody && kinBodyInfo._revision != 0 && pMatchExistingBody->_infoRevision == kinBodyInfo._revision && pMatchExistingBody->GetUpdateStamp() == pMatchExistingBody->_infoRevisionUpdateStamp && pMatchExistingBody->_name == kinBodyInfo._name ) {
+                RAVELOG_VERBOSE_FORMAT("env=%d, body %s revision %d is unchanged, skipping", GetId()%pMatchExistingBody->_id%kinBodyInfo._revision);
+                continue;
+            }
+
             KinBodyPtr pInitBody; // body that has to be Init() again
             if( !!pMatchExistingBody ) {
                 RAVELOG_VERBOSE_FORMAT("env=%d, update existing body %s", GetId()%pMatchExistingBody->_id);
@@ -2567,10 +2791,12 @@ public:
                 }
                 RAVELOG_VERBOSE_FORMAT("env=%d, update body %s from info result %d", GetId()%pMatchExistingBody->_id%updateFromInfoResult);
                 if (updateFromInfoResult == UFIR_NoChange) {
+                    _SetBodyInfoRevision(pMatchExistingBody, kinBodyInfo);
                     continue;
                 }
                 vModifiedBodies.push_back(pMatchExistingBody);
                 if (updateFromInfoResult == UFIR_Success) {
+                    _SetBodyInfoRevision(pMatchExistingBody, kinBodyInfo);
                     continue;
                 }
 
@@ -2650,6 +2876,7 @@ public:
                     _AddKinBody(pNewBody, true);
                 }
                 vBodies.insert(vBodies.begin()+bodyIndex, pNewBody);
+                bodyIndexer.InsertedBody();
                 vCreatedBodies.push_back(pNewBody);
             }
 
@@ -2669,6 +2896,7 @@ public:
                 }
                 pInitBody->SetDOFValues(vDOFValues, pKinBodyInfo->_transform, KinBody::CLA_Nothing);
             }
+            _SetBodyInfoRevision(vBodies[bodyIndex], kinBodyInfo);
         }
 
         // remove extra bodies at the end of vBodies
@@ -2689,20 +2917,17 @@ public:
         }
 
         // after all bodies are added, update the grab states
+        std::map<std::string, KinBodyPtr> mapNameBodies; // first body of every name in vBodies
+        FOREACHC(itBody, vBodies) {
+            mapNameBodies.insert(std::make_pair((*itBody)->_name, *itBody));
+        }
         std::vector<KinBody::GrabbedInfoConstPtr> vGrabbedInfos;
         for(const KinBody::KinBodyInfoPtr& pKinBodyInfo : info._vBodyInfos) {
             const std::string& bodyName = pKinBodyInfo->_name;
 
             // find existing body in the env, use name since that is more guaranteed to be unique
-            std::vector<KinBodyPtr>::iterator itExistingBody = vBodies.end();
-            FOREACH(itBody, vBodies) {
-                if ((*itBody)->_name == bodyName) {
-                    itExistingBody = itBody;
-                    break;
-                }
-            }
-
-            if (itExistingBody != vBodies.end()) {
+            std::map<std::string, KinBodyPtr>::const_iterator itExistingBody = mapNameBodies.find(bodyName);
+            if (itExistingBody != mapNameBodies.end()) {
                 // grabbed infos
                 vGrabbedInfos.clear();
                 vGrabbedInfos.reserve(pKinBodyInfo->_vGrabbedInfos.size());
@@ -2714,7 +2939,7 @@ public:
                         RAVELOG_WARN_FORMAT("env=%d, body %s grabbed by %s is gone, ignoring grabbed info %s", GetId()%(*itGrabbedInfo)->_grabbedname%pKinBodyInfo->_name%(*itGrabbedInfo)->_id);
                     }
                 }
-                (*itExistingBody)->ResetGrabbed(vGrabbedInfos);
+                itExistingBody->second->ResetGrabbed(vGrabbedInfos);
             }
             else {
                 RAVELOG_WARN_FORMAT("env=%d, could not find body with name='%s'", GetId()%bodyName);
@@ -2775,6 +3000,7 @@ protected:
     virtual bool _ParseXMLFile(BaseXMLReaderPtr preader, const std::string& filename)
     {
         EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        OpenRAVEXMLParser::PrefetchXMLFileGeometries(shared_from_this(), filename);
         return OpenRAVEXMLParser::ParseXMLFile(preader, filename);
     }
 
@@ -2826,6 +3052,7 @@ protected:
                 }
                 _vecrobots.clear();
                 _vPublishedBodies.clear();
+                _mapLazyBodies.clear();
             }
             // a little tricky due to a deadlocking situation
             std::map<int, KinBodyWeakPtr> mapBodies;
@@ -2862,6 +3089,12 @@ protected:
         EnvironmentMutex::scoped_lock lock(GetMutex());
         //boost::mutex::scoped_lock locknetworkid(_mutexEnvironmentIds); // why is this here? if locked, then KinBody::_ComputeInternalInformation freezes on GetBodyFromEnvironmentId call
 
+        if( options & Clone_Bodies ) {
+            // the lazy bodies are copied from r below, so setting the checker and physics engine should not materialize the old ones
+            boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+            _mapLazyBodies.clear();
+        }
+
         bool bCollisionCheckerChanged = false;
         if( !!r->GetCollisionChecker() ) {
             if( !bCheckSharedResources || (!!_pCurrentChecker && _pCurrentChecker->GetXMLId() != r->GetCollisionChecker()->GetXMLId()) ) {
@@ -2904,6 +3137,7 @@ protected:
             std::vector<KinBodyPtr> vecbodies;
             std::vector<std::pair<Vector,Vector> > linkvelocities;
             _mapBodies.clear();
+            _mapLazyBodies = r->_mapLazyBodies; // infos are never modified, so can be shared
             if( bCheckSharedResources ) {
                 // delete any bodies/robots from mapBodies that are not in r->_vecrobots and r->_vecbodies
                 vecrobots.swap(_vecrobots);
@@ -3484,6 +3718,318 @@ protected:
         return data.size() > 0 && !std::isprint(data[0]);
     }
 
+    /// \brief index of the unprocessed bodies of UpdateFromInfo by id and name, gives the same matches as scanning the unprocessed part of the bodies in order
+    ///
+    /// New bodies are inserted before all unprocessed bodies, so positions are stored relative to the number of inserted bodies and do not have to be shifted.
+    class BodyIdNameIndexer
+    {
+public:
+        BodyIdNameIndexer(const std::vector<KinBodyPtr>& vBodies) : _vBodies(vBodies), _nInsertedBodies(0) {
+            for(int bodyIndex = 0; bodyIndex < (int)vBodies.size(); ++bodyIndex) {
+                Insert(bodyIndex);
+            }
+        }
+
+        /// \brief adds the body currently at bodyIndex
+        void Insert(int bodyIndex) {
+            const KinBodyPtr& pBody = _vBodies[bodyIndex];
+            if( !pBody->_id.empty() ) {
+                _mapIdIndices[pBody->_id].insert(bodyIndex - _nInsertedBodies);
+            }
+            if( !pBody->_name.empty() ) {
+                _mapNameIndices[pBody->_name].insert(bodyIndex - _nInsertedBodies);
+            }
+        }
+
+        /// \brief removes the body currently at bodyIndex, has to be called before its id or name changes
+        void Erase(int bodyIndex) {
+            const KinBodyPtr& pBody = _vBodies[bodyIndex];
+            if( !pBody->_id.empty() ) {
+                _Erase(_mapIdIndices, pBody->_id, bodyIndex - _nInsertedBodies);
+            }
+            if( !pBody->_name.empty() ) {
+                _Erase(_mapNameIndices, pBody->_name, bodyIndex - _nInsertedBodies);
+            }
+        }
+
+        /// \brief has to be called after a new body is inserted in front of the unprocessed bodies
+        void InsertedBody() {
+            ++_nInsertedBodies;
+        }
+
+        /// \brief finds the first unprocessed bodies matching the id and name, the id, and the name of the info. Indices are -1 if there is no match.
+        ///
+        /// If a body matches both, all indices are set to it.
+        void Find(const KinBody::KinBodyInfo& info, int& iSameIdName, int& iSameId, int& iSameName) const {
+            iSameIdName = iSameId = iSameName = -1;
+            if( !info._id.empty() ) {
+                std::map<std::string, std::set<int> >::const_iterator itId = _mapIdIndices.find(info._id);
+                if( itId != _mapIdIndices.end() ) {
+                    iSameId = *itId->second.begin() + _nInsertedBodies;
+                    if( !info._name.empty() ) {
+                        FOREACHC(itIndex, itId->second) {
+                            if( _vBodies[*itIndex + _nInsertedBodies]->_name == info._name ) {
+                                iSameIdName = iSameId = iSameName = *itIndex + _nInsertedBodies;
+                                return;
+                            }
+                        }
+                    }
+                }
+            }
+            if( !info._name.empty() ) {
+                std::map<std::string, std::set<int> >::const_iterator itName = _mapNameIndices.find(info._name);
+                if( itName != _mapNameIndices.end() ) {
+                    iSameName = *itName->second.begin() + _nInsertedBodies;
+                }
+            }
+        }
+
+private:
+        static void _Erase(std::map<std::string, std::set<int> >& mapIndices, const std::string& key, int index) {
+            std::map<std::string, std::set<int> >::iterator it = mapIndices.find(key);
+            if( it != mapIndices.end() ) {
+                it->second.erase(index);
+                if( it->second.empty() ) {
+                    mapIndices.erase(it);
+                }
+            }
+        }
+
+        const std::vector<KinBodyPtr>& _vBodies;
+        std::map<std::string, std::set<int> > _mapIdIndices, _mapNameIndices; ///< positions of the unprocessed bodies minus _nInsertedBodies
+        int _nInsertedBodies;
+    };
+
+    /// \brief records that pBody is up to date with info, see KinBodyInfo::_revision
+    static void _SetBodyInfoRevision(KinBodyPtr pBody, const KinBody::KinBodyInfo& info)
+    {
+        pBody->_infoRevision = info._revision;
+        pBody->_infoRevisionUpdateStamp = pBody->GetUpdateStamp();
+    }
+
+    /// \brief copies the bodies of the environment
+    void _CopyBodies(std::vector<KinBodyPtr>& vbodies)
+    {
+        boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+        vbodies = _vecbodies;
+    }
+
+    /// \brief gets the bodies of the environment that are not in vprevbodies
+    std::vector<KinBodyPtr> _GetNewBodies(const std::vector<KinBodyPtr>& vprevbodies)
+    {
+        std::vector<KinBodyPtr> vnewbodies;
+        boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+        FOREACHC(itbody, _vecbodies) {
+            if( find(vprevbodies.begin(), vprevbodies.end(), *itbody) == vprevbodies.end() ) {
+                vnewbodies.push_back(*itbody);
+            }
+        }
+        return vnewbodies;
+    }
+
+    /// \brief generates the collision proxies requested by the "collisionproxy" load attribute, see RaveGenerateCollisionProxies
+    ///
+    /// Bodies that are in the environment are switched to the proxy geometry group in the current collision checker.
+    void _GenerateCollisionProxies(const std::vector<KinBodyPtr>& vbodies, const AttributesList& atts)
+    {
+        if( vbodies.size() == 0 ) {
+            return;
+        }
+        std::vector<KinBodyPtr> vproxybodies;
+        std::string groupname = RaveGenerateCollisionProxies(GetId(), vbodies, atts, vproxybodies);
+        if( groupname.size() == 0 || !_pCurrentChecker ) {
+            return;
+        }
+        FOREACHC(itbody, vproxybodies) {
+            if( (*itbody)->GetEnvironmentId() == 0 ) {
+                // not added yet, the user selects the group after adding the body
+                continue;
+            }
+            // only switch the loaded bodies, the other bodies of the environment keep their geometry groups
+            try {
+                if( !_pCurrentChecker->SetBodyGeometryGroup(*itbody, groupname) ) {
+                    RAVELOG_WARN_FORMAT("env=%d, collision checker %s cannot use geometry group %s for body %s, keeping its current geometries", GetId()%_pCurrentChecker->GetXMLId()%groupname%(*itbody)->GetName());
+                }
+            }
+            catch(const std::exception& ex) {
+                RAVELOG_WARN_FORMAT("env=%d, collision checker %s cannot use geometry group %s for body %s, keeping its current geometries: %s", GetId()%_pCurrentChecker->GetXMLId()%groupname%(*itbody)->GetName()%ex.what());
+            }
+        }
+    }
+
+    /// \brief gets the .orbin scene cache file of filename, or empty if the scene cache is disabled or the file type is not cached
+    std::string _GetSceneCacheFilename(const std::string& filename, const AttributesList& atts)
+    {
+        const char* pOPENRAVE_SCENE_CACHE_DIR = std::getenv("OPENRAVE_SCENE_CACHE_DIR");
+        if( !pOPENRAVE_SCENE_CACHE_DIR || pOPENRAVE_SCENE_CACHE_DIR[0] == 0 ) {
+            return std::string();
+        }
+        if( _IsColladaURI(filename) || _IsJSONFile(filename) || _IsMsgPackFile(filename) || _IsXFile(filename) ) {
+            return std::string();
+        }
+        std::vector<std::string> vsourcefiles;
+        if( _IsColladaFile(filename) || (!_IsOpenRAVEFile(filename) && _IsRigidModelFile(filename)) ) {
+            std::string fullfilename = RaveFindLocalFile(filename);
+            if( fullfilename.size() == 0 ) {
+                return std::string();
+            }
+            if( _IsColladaFile(filename) && _HasColladaExternalReferences(fullfilename) ) {
+                // the referenced files are not tracked, so a modification of them would not invalidate the cache
+                RAVELOG_VERBOSE_FORMAT("env=%d, %s has external references, not using scene cache", GetId()%fullfilename);
+                return std::string();
+            }
+            vsourcefiles.push_back(fullfilename);
+        }
+        else if( !OpenRAVEXMLParser::GetXMLFileDependencies(filename, vsourcefiles) ) {
+            return std::string();
+        }
+        return RaveGetSceneCacheFilename(pOPENRAVE_SCENE_CACHE_DIR, vsourcefiles, atts);
+    }
+
+    /// \brief returns true if the collada file can reference other files. Zipped files are not examined and always return true.
+    ///
+    /// The result is kept along with the modification time and size of the file, so an unchanged file is only read once.
+    static bool _HasColladaExternalReferences(const std::string& fullfilename)
+    {
+        size_t len = fullfilename.size();
+        if( len >= 4 && ::tolower(fullfilename[len-3]) == 'z' ) {
+            return true;
+        }
+        std::pair<int64_t, uint64_t> stamp(0,0);
+        if( !RaveGetFileStamp(fullfilename, stamp.first, stamp.second) ) {
+            return true;
+        }
+        static boost::mutex s_mutexscans;
+        static std::map<std::string, std::pair<std::pair<int64_t, uint64_t>, bool> > s_mapscans; // protected by s_mutexscans
+        {
+            boost::mutex::scoped_lock lock(s_mutexscans);
+            std::map<std::string, std::pair<std::pair<int64_t, uint64_t>, bool> >::const_iterator it = s_mapscans.find(fullfilename);
+            if( it != s_mapscans.end() && it->second.first == stamp ) {
+                return it->second.second;
+            }
+        }
+
+        std::ifstream ifs(fullfilename.c_str(), std::ios::binary);
+        if( !ifs ) {
+            return true;
+        }
+        std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        // every reference to another document is an url attribute that does not start with a fragment
+        bool bHasExternalReferences = false;
+        size_t pos = 0;
+        while( !bHasExternalReferences && (pos = content.find("url=", pos)) != std::string::npos ) {
+            pos += 4;
+            bHasExternalReferences = pos+1 < content.size() && (content[pos] == '"' || content[pos] == '\'') && content[pos+1] != '#';
+        }
+        boost::mutex::scoped_lock lock(s_mutexscans);
+        if( s_mapscans.size() >= 1024 ) {
+            s_mapscans.clear();
+        }
+        s_mapscans[fullfilename] = std::make_pair(stamp, bHasExternalReferences);
+        return bHasExternalReferences;
+    }
+
+    inline bool _HasLazyBodies() const
+    {
+        boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+        return _mapLazyBodies.size() > 0;
+    }
+
+    /// \brief creates the lazy bodies that can collide with a body, so that collision queries against the environment see them
+    void _MaterializeLazyBodiesNear(KinBodyConstPtr pbody)
+    {
+        if( _HasLazyBodies() ) {
+            MaterializeLazyBodies(pbody->ComputeAABB());
+        }
+    }
+
+    void _MaterializeLazyBodiesNear(KinBody::LinkConstPtr plink)
+    {
+        if( _HasLazyBodies() ) {
+            MaterializeLazyBodies(plink->ComputeAABB());
+        }
+    }
+
+    /// \brief creates all lazy bodies. Has to be called before initializing interfaces that use every body of the environment.
+    void _MaterializeAllLazyBodies()
+    {
+        EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        std::vector<std::string> vnames;
+        {
+            boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+            FOREACHC(it, _mapLazyBodies) {
+                vnames.push_back(it->first);
+            }
+        }
+        FOREACH(itname, vnames) {
+            _MaterializeLazyBody(*itname);
+        }
+    }
+
+    /// \brief creates the lazy bodies that are written when saving the bodies selected by options
+    void _MaterializeLazyBodiesForSelection(SelectionOptions options)
+    {
+        // robots cannot be lazy and SO_Body already materializes the target bodies with GetKinBody
+        if( options != SO_Robots && options != SO_Body ) {
+            _MaterializeAllLazyBodies();
+        }
+    }
+
+    /// \brief copies the info of a lazy body along with its links and geometries, since the info is shared with clones of the environment
+    static KinBody::KinBodyInfoPtr _CopyLazyBodyInfo(const KinBody::KinBodyInfo& lazyinfo)
+    {
+        KinBody::KinBodyInfoPtr pinfo(new KinBody::KinBodyInfo(lazyinfo));
+        FOREACH(itlinkinfo, pinfo->_vLinkInfos) {
+            *itlinkinfo = KinBody::LinkInfoPtr(new KinBody::LinkInfo(**itlinkinfo));
+            FOREACH(itgeominfo, (*itlinkinfo)->_vgeometryinfos) {
+                *itgeominfo = KinBody::GeometryInfoPtr(new KinBody::GeometryInfo(**itgeominfo));
+            }
+            FOREACH(itextra, (*itlinkinfo)->_mapExtraGeometries) {
+                FOREACH(itgeominfo, itextra->second) {
+                    *itgeominfo = KinBody::GeometryInfoPtr(new KinBody::GeometryInfo(**itgeominfo));
+                }
+            }
+        }
+        return pinfo;
+    }
+
+    /// \brief creates the lazy body from its info and adds it to the environment
+    ///
+    /// \return the new body, or null if there is no lazy body with that name or it failed to initialize
+    KinBodyPtr _MaterializeLazyBody(const std::string& name)
+    {
+        EnvironmentMutex::scoped_lock lockenv(GetMutex());
+        KinBody::KinBodyInfoConstPtr pinfo;
+        {
+            boost::timed_mutex::scoped_lock lock(_mutexInterfaces);
+            std::map<std::string, LazyBody>::iterator it = _mapLazyBodies.find(name);
+            if( it == _mapLazyBodies.end() ) {
+                // could have been materialized by another thread while waiting for the environment lock
+                FOREACHC(itbody, _vecbodies) {
+                    if( (*itbody)->GetName() == name ) {
+                        return *itbody;
+                    }
+                }
+                return KinBodyPtr();
+            }
+            pinfo = it->second._pinfo;
+            _mapLazyBodies.erase(it);
+        }
+
+        RAVELOG_VERBOSE_FORMAT("env=%d, materializing lazy body %s", GetId()%name);
+        KinBodyPtr pbody = RaveCreateKinBody(shared_from_this(), pinfo->_interfaceType);
+        if( !pbody ) {
+            pbody = RaveCreateKinBody(shared_from_this(), "");
+        }
+        if( !pbody || !pbody->InitFromKinBodyInfo(*pinfo) ) {
+            RAVELOG_WARN_FORMAT("env=%d, failed to initialize lazy body %s", GetId()%name);
+            return KinBodyPtr();
+        }
+        _AddKinBody(pbody, false);
+        pbody->SetTransform(pinfo->_transform);
+        return pbody;
+    }
+
     void _ClearRapidJsonBuffer()
     {
         // TODO resize smartly
@@ -3493,6 +4039,14 @@ protected:
     std::vector<RobotBasePtr> _vecrobots;      ///< robots (possibly controlled). protected by _mutexInterfaces
     std::vector<KinBodyPtr> _vecbodies;     ///< all objects that are collidable (includes robots). protected by _mutexInterfaces
 
+    /// \brief a body registered with AddLazyBody that has not been created yet
+    struct LazyBody
+    {
+        KinBody::KinBodyInfoConstPtr _pinfo;
+        AABB _ab; ///< world bounding box of the body computed from its info
+    };
+    std::map<std::string, LazyBody> _mapLazyBodies; ///< lazy bodies indexed by name. protected by _mutexInterfaces
+
     list< std::pair<ModuleBasePtr, std::string> > _listModules;     ///< modules loaded in the environment and the strings they were intialized with. Initialization strings are used for cloning.
     list<SensorBasePtr> _listSensors;     ///< sensors loaded in the environment
     list<ViewerBasePtr> _listViewers;     ///< viewers loaded in the environment
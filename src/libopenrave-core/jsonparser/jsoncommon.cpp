@@ -14,4 +14,76 @@
 //
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
-#include "jsoncommon.h"
\ No newline at end of file
+#include "jsoncommon.h"
+
+namespace OpenRAVE {
+
+/// \brief md5 of the content of a file along with the file stamp it was computed at
+struct FileContentHash
+{
+    int64_t mtimens;
+    uint64_t filesize;
+    std::string md5;
+};
+
+static boost::mutex s_mutexFileContentHashes;
+static std::map<std::string, FileContentHash> s_mapFileContentHashes; ///< protected by s_mutexFileContentHashes
+
+/// \brief gets the md5 of the content of a file. The file is only read again when its modification time or size changes.
+///
+/// \return false if the file cannot be read
+static bool _GetFileContentHash(const std::string& filename, std::string& md5)
+{
+    FileContentHash hash;
+    bool bHasStamp = RaveGetFileStamp(filename, hash.mtimens, hash.filesize);
+    if( bHasStamp ) {
+        boost::mutex::scoped_lock lock(s_mutexFileContentHashes);
+        std::map<std::string, FileContentHash>::const_iterator it = s_mapFileContentHashes.find(filename);
+        if( it != s_mapFileContentHashes.end() && it->second.mtimens == hash.mtimens && it->second.filesize == hash.filesize ) {
+            md5 = it->second.md5;
+            return true;
+        }
+    }
+
+    std::ifstream ifs(filename.c_str(), std::ios::binary);
+    if( !ifs ) {
+        return false;
+    }
+    std::string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    md5 = utils::GetMD5HashString(content);
+    if( bHasStamp ) {
+        hash.md5 = md5;
+        boost::mutex::scoped_lock lock(s_mutexFileContentHashes);
+        if( s_mapFileContentHashes.size() >= 4096 ) {
+            s_mapFileContentHashes.clear();
+        }
+        s_mapFileContentHashes[filename] = hash;
+    }
+    return true;
+}
+
+std::string RaveGetSceneCacheFilename(const std::string& cachedirectory, const std::vector<std::string>& vsourcefiles, const AttributesList& atts)
+{
+    std::stringstream sskey;
+    sskey << OPENRAVE_VERSION_STRING << " " << (int)s_sceneCacheVersion << std::endl;
+    std::string md5;
+    FOREACHC(itfilename, vsourcefiles) {
+        if( !_GetFileContentHash(*itfilename, md5) ) {
+            RAVELOG_VERBOSE_FORMAT("cannot read %s, not using scene cache", *itfilename);
+            return std::string();
+        }
+        sskey << *itfilename << " " << md5 << std::endl;
+    }
+    FOREACHC(itatt, atts) {
+        sskey << itatt->first << "=" << itatt->second << std::endl;
+    }
+    std::string cachefilename = cachedirectory;
+    if( cachefilename.size() > 0 && cachefilename[cachefilename.size()-1] != s_filesep ) {
+        cachefilename += s_filesep;
+    }
+    cachefilename += utils::GetMD5HashString(sskey.str());
+    cachefilename += ".orbin";
+    return cachefilename;
+}
+
+}
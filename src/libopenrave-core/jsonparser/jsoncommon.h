@@ -73,5 +73,31 @@ void RaveWriteMsgPackMemory(EnvironmentBasePtr penv, std::vector<char>& output,
 void RaveWriteMsgPackMemory(KinBodyPtr pbody, std::vector<char>& output, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc);
 void RaveWriteMsgPackMemory(const std::list<KinBodyPtr>& listbodies, std::vector<char>& output, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc);
 
+/// \brief releases the parsed json and msgpack documents, see RaveClearLoaderCaches
+void ClearJSONDocumentCache();
+
+/// \brief see RaveGetLoaderCacheStats
+void GetJSONDocumentCacheStats(uint64_t& nhits, uint64_t& nmisses, size_t& nentries);
+
+/// \brief magic bytes at the start of .orbin scene cache files, followed by the format version byte and the msgpack encoded bodies
+static const char s_sceneCacheMagic[] = "ORBIN";
+static const uint8_t s_sceneCacheVersion = 3; ///< 2 stores the meshes as raw binary blobs, 3 no longer packs numeric arrays into msgpack ext blocks
+
+/// \brief gets the path of the .orbin scene cache file of a set of source files
+///
+/// The name is a hash of the contents of all the source files, the load attributes, and the openrave and cache format versions, so any modification of a source file maps to a new cache file.
+/// The content hashes are kept in memory along with the modification time and size of the files, so unchanged files are not read again.
+/// \param vsourcefiles the scene file followed by all the files it depends on
+/// \return empty if one of the source files cannot be read
+std::string RaveGetSceneCacheFilename(const std::string& cachedirectory, const std::vector<std::string>& vsourcefiles, const AttributesList& atts);
+
+/// \brief creates the bodies stored in a .orbin scene cache file. The bodies are not added to the environment, so the caller can add them the same way the original file loader does.
+///
+/// \return false if the file does not exist or is not a valid scene cache
+bool RaveParseSceneCacheFile(EnvironmentBasePtr penv, const std::string& cachefilename, std::vector<KinBodyPtr>& vbodies, rapidjson::Document::AllocatorType& alloc);
+
+/// \brief writes the resolved bodies into a .orbin scene cache file. The file is written to a temporary file first, so readers never see a partially written cache.
+void RaveWriteSceneCacheFile(const std::list<KinBodyPtr>& listbodies, const std::string& cachefilename, rapidjson::Document::AllocatorType& alloc);
+
 }
 #endif
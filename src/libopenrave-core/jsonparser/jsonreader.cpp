@@ -21,6 +21,7 @@
 #include <openrave/openrave.h>
 #include <rapidjson/istreamwrapper.h>
 #include <string>
+#include <cstring>
 #include <fstream>
 
 namespace OpenRAVE {
@@ -44,22 +45,156 @@ static void _ReplaceFilenameSuffix(std::string& filename, const std::string& old
     }
 }
 
-/// \brief open and cache a msgpack document
-static void OpenMsgPackDocument(const std::string& filename, rapidjson::Document& doc)
+/// \brief process-wide cache of the json and msgpack documents read from files, shared by all readers and environments
+///
+/// Documents are validated with the nanosecond modification time and size of their file, so a modified file is read again.
+/// Cached documents are never modified, so several threads can read the same document at the same time. When the cache
+/// is full, the least recently used documents are released.
+class JSONDocumentCache
 {
-    std::ifstream ifs(filename.c_str());
-    MsgPack::ParseMsgPack(doc, ifs);
+public:
+    typedef boost::shared_ptr<const rapidjson::Document> DocumentConstPtr;
+
+    static JSONDocumentCache& GetInstance()
+    {
+        static JSONDocumentCache s_cache;
+        return s_cache;
+    }
+
+    /// \brief returns the parsed document of a json or msgpack file, reading it only if it is not cached yet
+    ///
+    /// \param bMsgPack if true, file is msgpack, otherwise json
+    /// \throw openrave_exception if the file cannot be parsed
+    DocumentConstPtr Get(const std::string& filename, bool bMsgPack)
+    {
+        Key key(filename, bMsgPack);
+        std::pair<int64_t, uint64_t> stamp(0,0);
+        if( !RaveGetFileStamp(filename, stamp.first, stamp.second) ) {
+            RAVELOG_VERBOSE_FORMAT("not caching json document %s since it cannot be examined", filename);
+            return _Read(filename, bMsgPack);
+        }
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            std::map<Key, Entry>::iterator it = _mapDocuments.find(key);
+            if( it != _mapDocuments.end() && it->second.stamp == stamp ) {
+                ++_nhits;
+                _listLRU.splice(_listLRU.begin(), _listLRU, it->second.itlru);
+                return it->second.pdoc;
+            }
+            ++_nmisses;
+        }
+
+        // read without holding the lock, at worst two threads read the same file at once
+        DocumentConstPtr pdoc = _Read(filename, bMsgPack);
+        boost::mutex::scoped_lock lock(_mutex);
+        std::map<Key, Entry>::iterator it = _mapDocuments.find(key);
+        if( it != _mapDocuments.end() ) {
+            _Erase(it);
+        }
+        if( stamp.second > s_nMaxTotalFileSize ) {
+            return pdoc;
+        }
+        while( _mapDocuments.size() > 0 && (_mapDocuments.size() >= s_nMaxEntries || _totalFileSize + stamp.second > s_nMaxTotalFileSize) ) {
+            _Erase(_mapDocuments.find(_listLRU.back()));
+        }
+        Entry& entry = _mapDocuments[key];
+        entry.stamp = stamp;
+        entry.pdoc = pdoc;
+        entry.itlru = _listLRU.insert(_listLRU.begin(), key);
+        _totalFileSize += stamp.second;
+        return pdoc;
+    }
+
+    /// \brief releases all documents, the readers that still use a document keep it alive
+    void Clear()
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _mapDocuments.clear();
+        _listLRU.clear();
+        _totalFileSize = 0;
+    }
+
+    void GetStats(uint64_t& nhits, uint64_t& nmisses, size_t& nentries)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        nhits = _nhits;
+        nmisses = _nmisses;
+        nentries = _mapDocuments.size();
+    }
+
+private:
+    typedef std::pair<std::string, bool> Key; ///< full filename and if the file is msgpack
+
+    struct Entry
+    {
+        std::pair<int64_t, uint64_t> stamp; ///< RaveGetFileStamp of the file when it was read
+        DocumentConstPtr pdoc;
+        std::list<Key>::iterator itlru; ///< position in _listLRU
+    };
+
+    /// \brief removes an entry, has to be called with _mutex locked
+    void _Erase(std::map<Key, Entry>::iterator it)
+    {
+        _totalFileSize -= it->second.stamp.second;
+        _listLRU.erase(it->second.itlru);
+        _mapDocuments.erase(it);
+    }
+
+    /// \brief a document parsed in place, its strings point into the buffer
+    struct InSituDocument
+    {
+        std::vector<char> buffer;
+        rapidjson::Document doc; ///< declared after buffer so that it is destroyed first
+    };
+
+    static DocumentConstPtr _Read(const std::string& filename, bool bMsgPack)
+    {
+        // read the whole file at once, parsing from memory is much faster than through a stream
+        std::ifstream ifs(filename.c_str(), std::ios::binary);
+        if( !ifs ) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to open document \"%s\"", filename, ORE_InvalidArguments);
+        }
+        ifs.seekg(0, std::ios::end);
+        std::streamoff size = std::max(std::streamoff(0), std::streamoff(ifs.tellg()));
+        ifs.seekg(0, std::ios::beg);
+        if( bMsgPack ) {
+            std::vector<char> data(size);
+            ifs.read(data.data(), data.size());
+            boost::shared_ptr<rapidjson::Document> pdoc(new rapidjson::Document());
+            MsgPack::ParseMsgPack(*pdoc, data.data(), data.size());
+            return pdoc;
+        }
+
+        boost::shared_ptr<InSituDocument> pinsitu(new InSituDocument());
+        pinsitu->buffer.resize(size+1);
+        ifs.read(pinsitu->buffer.data(), size);
+        pinsitu->buffer[size] = 0;
+        rapidjson::ParseResult ok = pinsitu->doc.ParseInsitu<rapidjson::kParseFullPrecisionFlag>(pinsitu->buffer.data());
+        if (!ok) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to parse json document \"%s\"", filename, ORE_InvalidArguments);
+        }
+        // share ownership of the buffer with the document
+        return DocumentConstPtr(pinsitu, &pinsitu->doc);
+    }
+
+    static const size_t s_nMaxEntries = 1024;
+    static const uint64_t s_nMaxTotalFileSize = 1024*1024*1024; ///< documents take several times their file size in memory
+
+    boost::mutex _mutex;
+    std::map<Key, Entry> _mapDocuments; ///< protected by _mutex
+    std::list<Key> _listLRU; ///< keys of _mapDocuments, most recently used first. protected by _mutex
+    uint64_t _totalFileSize = 0; ///< sum of the file sizes of _mapDocuments
+    uint64_t _nhits = 0, _nmisses = 0; ///< protected by _mutex
+};
+
+void ClearJSONDocumentCache()
+{
+    JSONDocumentCache::GetInstance().Clear();
 }
 
-/// \brief open and cache a json document
-static void OpenRapidJsonDocument(const std::string& filename, rapidjson::Document& doc)
+void GetJSONDocumentCacheStats(uint64_t& nhits, uint64_t& nmisses, size_t& nentries)
 {
-    std::ifstream ifs(filename.c_str());
-    rapidjson::IStreamWrapper isw(ifs);
-    rapidjson::ParseResult ok = doc.ParseStream<rapidjson::kParseFullPrecisionFlag>(isw);
-    if (!ok) {
-        throw OPENRAVE_EXCEPTION_FORMAT("failed to parse json document \"%s\"", filename, ORE_InvalidArguments);
-    }
+    JSONDocumentCache::GetInstance().GetStats(nhits, nmisses, nentries);
 }
 
 /// \brief get the scheme of the uri, e.g. file: or openrave:
@@ -118,6 +253,9 @@ public:
             else if (itatt->first == "mustresolveuri") {
                 _bMustResolveURI = _stricmp(itatt->second.c_str(), "true") == 0 || itatt->second=="1";
             }
+            else if (itatt->first == "lazyload") {
+                _bLazyLoad = _stricmp(itatt->second.c_str(), "true") == 0 || itatt->second=="1";
+            }
         }
         if (_vOpenRAVESchemeAliases.size() == 0) {
             _vOpenRAVESchemeAliases.push_back("openrave");
@@ -142,6 +280,13 @@ public:
         EnvironmentBase::EnvironmentBaseInfo envInfo;
         dReal fUnitScale = _GetUnitScale(doc);
         _penv->ExtractInfo(envInfo);
+        std::set<std::string> setExistingBodyIds, setExistingBodyNames;
+        if (_bLazyLoad) {
+            FOREACHC(itBodyInfo, envInfo._vBodyInfos) {
+                setExistingBodyIds.insert((*itBodyInfo)->_id);
+                setExistingBodyNames.insert((*itBodyInfo)->_name);
+            }
+        }
 
         if (doc.HasMember("bodies")) {
             for (rapidjson::Value::ConstValueIterator it = doc["bodies"].Begin(); it != doc["bodies"].End(); it++) {
@@ -169,6 +314,9 @@ public:
                     _ProcessURIsInRobotBaseInfo(*pRobotBaseInfo, doc, fUnitScale, alloc);
                 }
             }
+            if (_bLazyLoad) {
+                _RegisterLazyBodies(envInfo, setExistingBodyIds, setExistingBodyNames);
+            }
             std::vector<KinBodyPtr> vCreatedBodies, vModifiedBodies, vRemovedBodies;
             _penv->UpdateFromInfo(envInfo, vCreatedBodies, vModifiedBodies, vRemovedBodies);
         }
@@ -243,6 +391,38 @@ public:
         return false;
     }
 
+    /// \brief creates all the bodies of doc with their names, transforms and dof values, without adding them to the environment
+    bool ExtractBodies(const rapidjson::Value& doc, std::vector<KinBodyPtr>& vbodies, rapidjson::Document::AllocatorType& alloc)
+    {
+        vbodies.resize(0);
+        if (!doc.HasMember("bodies") || !doc["bodies"].IsArray()) {
+            return false;
+        }
+        dReal fUnitScale = _GetUnitScale(doc);
+        std::vector<dReal> vDOFValues;
+        for (rapidjson::Value::ConstValueIterator itr = doc["bodies"].Begin(); itr != doc["bodies"].End(); ++itr) {
+            KinBodyPtr pBody;
+            if (!_Extract(*itr, pBody, doc, fUnitScale, alloc)) {
+                vbodies.resize(0);
+                return false;
+            }
+            if (itr->HasMember("dofValues") && (*itr)["dofValues"].IsArray() && pBody->GetDOF() > 0) {
+                pBody->GetDOFValues(vDOFValues);
+                for (rapidjson::Value::ConstValueIterator itDOFValue = (*itr)["dofValues"].Begin(); itDOFValue != (*itr)["dofValues"].End(); ++itDOFValue) {
+                    std::string jointName = orjson::GetJsonValueByKey<std::string>(*itDOFValue, "jointName", "");
+                    int jointAxis = orjson::GetJsonValueByKey<int>(*itDOFValue, "jointAxis", 0);
+                    KinBody::JointPtr pJoint = pBody->GetJoint(jointName);
+                    if (!!pJoint && pJoint->GetDOFIndex() >= 0 && jointAxis < pJoint->GetDOF() && itDOFValue->HasMember("value")) {
+                        orjson::LoadJsonValueByKey(*itDOFValue, "value", vDOFValues.at(pJoint->GetDOFIndex()+jointAxis));
+                    }
+                }
+                pBody->SetDOFValues(vDOFValues, KinBody::CLA_Nothing);
+            }
+            vbodies.push_back(pBody);
+        }
+        return true;
+    }
+
     void SetURI(const std::string& uri) {
         _uri = uri;
     }
@@ -285,17 +465,13 @@ protected:
             doc = _rapidJSONDocuments[fullFilename];
         }
         else {
-            boost::shared_ptr<rapidjson::Document> newDoc;
             if (_EndsWith(fullFilename, ".json")) {
-                newDoc.reset(new rapidjson::Document(&alloc));
-                OpenRapidJsonDocument(fullFilename, *newDoc);
+                doc = JSONDocumentCache::GetInstance().Get(fullFilename, false);
             }
             else if (_EndsWith(fullFilename, ".msgpack")) {
-                newDoc.reset(new rapidjson::Document(&alloc));
-                OpenMsgPackDocument(fullFilename, *newDoc);
+                doc = JSONDocumentCache::GetInstance().Get(fullFilename, true);
             }
-            if (!!newDoc) {
-                doc = newDoc;
+            if (!!doc) {
                 _rapidJSONDocuments[fullFilename] = doc;
             }
         }
@@ -401,6 +577,40 @@ protected:
         return true;
     }
 
+    /// \brief moves the infos of new static bodies out of envInfo and registers them as lazy bodies of the environment
+    ///
+    /// \param setExistingBodyIds ids of the bodies in the environment before loading, these are always updated
+    /// \param setExistingBodyNames names of the bodies in the environment before loading
+    void _RegisterLazyBodies(EnvironmentBase::EnvironmentBaseInfo& envInfo, const std::set<std::string>& setExistingBodyIds, const std::set<std::string>& setExistingBodyNames)
+    {
+        // grabbed bodies have to exist when the grabbing bodies are updated
+        std::set<std::string> setGrabbedBodyNames;
+        FOREACHC(itBodyInfo, envInfo._vBodyInfos) {
+            FOREACHC(itGrabbedInfo, (*itBodyInfo)->_vGrabbedInfos) {
+                setGrabbedBodyNames.insert((*itGrabbedInfo)->_grabbedname);
+            }
+        }
+
+        size_t numLazyBodies = 0;
+        std::vector<KinBody::KinBodyInfoPtr>::iterator itWrite = envInfo._vBodyInfos.begin();
+        FOREACH(itBodyInfo, envInfo._vBodyInfos) {
+            const KinBody::KinBodyInfoPtr& pKinBodyInfo = *itBodyInfo;
+            if (!pKinBodyInfo->_isRobot && pKinBodyInfo->_vJointInfos.empty() && pKinBodyInfo->_vGrabbedInfos.empty() && utils::IsValidName(pKinBodyInfo->_name)
+                && setExistingBodyIds.find(pKinBodyInfo->_id) == setExistingBodyIds.end() && setExistingBodyNames.find(pKinBodyInfo->_name) == setExistingBodyNames.end()
+                && setGrabbedBodyNames.find(pKinBodyInfo->_name) == setGrabbedBodyNames.end()) {
+                _penv->AddLazyBody(pKinBodyInfo);
+                ++numLazyBodies;
+                continue;
+            }
+            if (itWrite != itBodyInfo) {
+                *itWrite = pKinBodyInfo;
+            }
+            ++itWrite;
+        }
+        envInfo._vBodyInfos.erase(itWrite, envInfo._vBodyInfos.end());
+        RAVELOG_DEBUG_FORMAT("env=%d, registered %d lazy bodies", _penv->GetId()%numLazyBodies);
+    }
+
     inline dReal _GetUnitScale(const rapidjson::Value& doc)
     {
         std::pair<std::string, dReal> unit = {"meter", 1};
@@ -575,6 +785,7 @@ protected:
     std::string _defaultSuffix; ///< defaultSuffix of the main document, either ".json" or ".msgpack"
     std::vector<std::string> _vOpenRAVESchemeAliases;
     bool _bMustResolveURI = false; ///< if true, throw exception if uri does not resolve
+    bool _bLazyLoad = false; ///< if true, new bodies without joints are registered as lazy bodies of the environment instead of being created
 
     std::map<std::string, boost::shared_ptr<const rapidjson::Document> > _rapidJSONDocuments; ///< cache for opened rapidjson Documents
 };
@@ -605,8 +816,8 @@ bool RaveParseJSONFile(EnvironmentBasePtr penv, const std::string& filename, con
     }
     JSONReader reader(atts, penv, ".json");
     reader.SetFilename(fullFilename);
-    rapidjson::Document doc(&alloc);
-    OpenRapidJsonDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, false);
+    const rapidjson::Document& doc = *pdoc;
     return reader.ExtractAll(doc, alloc);
 }
 
@@ -616,8 +827,8 @@ bool RaveParseJSONFile(EnvironmentBasePtr penv, KinBodyPtr& ppbody, const std::s
     if (fullFilename.size() == 0 ) {
         return false;
     }
-    rapidjson::Document doc(&alloc);
-    OpenRapidJsonDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, false);
+    const rapidjson::Document& doc = *pdoc;
     JSONReader reader(atts, penv, ".json");
     reader.SetFilename(fullFilename);
     return reader.ExtractFirst(doc, ppbody, alloc);
@@ -629,8 +840,8 @@ bool RaveParseJSONFile(EnvironmentBasePtr penv, RobotBasePtr& pprobot, const std
     if (fullFilename.size() == 0 ) {
         return false;
     }
-    rapidjson::Document doc(&alloc);
-    OpenRapidJsonDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, false);
+    const rapidjson::Document& doc = *pdoc;
     JSONReader reader(atts, penv, ".json");
     reader.SetFilename(fullFilename);
     return reader.ExtractFirst(doc, pprobot, alloc);
@@ -644,8 +855,8 @@ bool RaveParseJSONURI(EnvironmentBasePtr penv, const std::string& uri, const Att
         return false;
     }
     reader.SetURI(uri);
-    rapidjson::Document doc(&alloc);
-    OpenRapidJsonDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, false);
+    const rapidjson::Document& doc = *pdoc;
     return reader.ExtractAll(doc, alloc);
 }
 
@@ -657,8 +868,8 @@ bool RaveParseJSONURI(EnvironmentBasePtr penv, KinBodyPtr& ppbody, const std::st
         return false;
     }
     reader.SetURI(uri);
-    rapidjson::Document doc(&alloc);
-    OpenRapidJsonDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, false);
+    const rapidjson::Document& doc = *pdoc;
     return reader.ExtractOne(doc, ppbody, uri, alloc);
 }
 
@@ -670,8 +881,8 @@ bool RaveParseJSONURI(EnvironmentBasePtr penv, RobotBasePtr& pprobot, const std:
         return false;
     }
     reader.SetURI(uri);
-    rapidjson::Document doc(&alloc);
-    OpenRapidJsonDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, false);
+    const rapidjson::Document& doc = *pdoc;
     return reader.ExtractOne(doc, pprobot, uri, alloc);
 }
 
@@ -705,8 +916,8 @@ bool RaveParseMsgPackFile(EnvironmentBasePtr penv, const std::string& filename,
     if (fullFilename.size() == 0 ) {
         return false;
     }
-    rapidjson::Document doc(&alloc);
-    OpenMsgPackDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, true);
+    const rapidjson::Document& doc = *pdoc;
     JSONReader reader(atts, penv, ".msgpack");
     reader.SetFilename(fullFilename);
     return reader.ExtractAll(doc, alloc);
@@ -718,8 +929,8 @@ bool RaveParseMsgPackFile(EnvironmentBasePtr penv, KinBodyPtr& ppbody, const std
     if (fullFilename.size() == 0 ) {
         return false;
     }
-    rapidjson::Document doc(&alloc);
-    OpenMsgPackDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, true);
+    const rapidjson::Document& doc = *pdoc;
     JSONReader reader(atts, penv, ".msgpack");
     reader.SetFilename(fullFilename);
     return reader.ExtractFirst(doc, ppbody, alloc);
@@ -731,8 +942,8 @@ bool RaveParseMsgPackFile(EnvironmentBasePtr penv, RobotBasePtr& pprobot, const
     if (fullFilename.size() == 0 ) {
         return false;
     }
-    rapidjson::Document doc(&alloc);
-    OpenMsgPackDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, true);
+    const rapidjson::Document& doc = *pdoc;
     JSONReader reader(atts, penv, ".msgpack");
     reader.SetFilename(fullFilename);
     return reader.ExtractFirst(doc, pprobot, alloc);
@@ -746,8 +957,8 @@ bool RaveParseMsgPackURI(EnvironmentBasePtr penv, const std::string& uri, const
         return false;
     }
     reader.SetURI(uri);
-    rapidjson::Document doc(&alloc);
-    OpenMsgPackDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, true);
+    const rapidjson::Document& doc = *pdoc;
     return reader.ExtractAll(doc, alloc);
 }
 
@@ -759,8 +970,8 @@ bool RaveParseMsgPackURI(EnvironmentBasePtr penv, KinBodyPtr& ppbody, const std:
         return false;
     }
     reader.SetURI(uri);
-    rapidjson::Document doc(&alloc);
-    OpenMsgPackDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, true);
+    const rapidjson::Document& doc = *pdoc;
     return reader.ExtractOne(doc, ppbody, uri, alloc);
 }
 
@@ -772,11 +983,37 @@ bool RaveParseMsgPackURI(EnvironmentBasePtr penv, RobotBasePtr& pprobot, const s
         return false;
     }
     reader.SetURI(uri);
-    rapidjson::Document doc(&alloc);
-    OpenMsgPackDocument(fullFilename, doc);
+    JSONDocumentCache::DocumentConstPtr pdoc = JSONDocumentCache::GetInstance().Get(fullFilename, true);
+    const rapidjson::Document& doc = *pdoc;
     return reader.ExtractOne(doc, pprobot, uri, alloc);
 }
 
+bool RaveParseSceneCacheFile(EnvironmentBasePtr penv, const std::string& cachefilename, std::vector<KinBodyPtr>& vbodies, rapidjson::Document::AllocatorType& alloc)
+{
+    std::ifstream ifs(cachefilename.c_str(), std::ios::binary);
+    if( !ifs ) {
+        return false;
+    }
+    std::vector<char> data((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    const size_t headersize = sizeof(s_sceneCacheMagic);
+    if( data.size() <= headersize || memcmp(data.data(), s_sceneCacheMagic, headersize-1) != 0 || (uint8_t)data[headersize-1] != s_sceneCacheVersion ) {
+        RAVELOG_WARN_FORMAT("env=%d, %s is not a valid scene cache, ignoring", penv->GetId()%cachefilename);
+        return false;
+    }
+
+    rapidjson::Document doc(&alloc);
+    try {
+        MsgPack::ParseMsgPack(doc, data.data()+headersize, data.size()-headersize);
+    }
+    catch(const std::exception& ex) {
+        RAVELOG_WARN_FORMAT("env=%d, failed to parse scene cache %s: %s", penv->GetId()%cachefilename%ex.what());
+        return false;
+    }
+    // the attributes were already applied when the cache was written
+    JSONReader reader(AttributesList(), penv, ".msgpack");
+    return reader.ExtractBodies(doc, vbodies, alloc);
+}
+
 bool RaveParseMsgPackData(EnvironmentBasePtr penv, const std::string& data, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
     rapidjson::Document doc(&alloc);
@@ -27,7 +27,8 @@ namespace OpenRAVE {
 class EnvironmentJSONWriter
 {
 public:
-    EnvironmentJSONWriter(const AttributesList& atts, rapidjson::Value& rEnvironment, rapidjson::Document::AllocatorType& allocator) : _rEnvironment(rEnvironment), _allocator(allocator) {
+    /// \param bMsgPack if true, the output is msgpack, so binary meshes can store raw bytes
+    EnvironmentJSONWriter(const AttributesList& atts, rapidjson::Value& rEnvironment, rapidjson::Document::AllocatorType& allocator, bool bMsgPack=false) : _rEnvironment(rEnvironment), _allocator(allocator) {
         _serializeOptions = 0;
         FOREACHC(itatt,atts) {
             if( itatt->first == "openravescheme" ) {
@@ -35,7 +36,15 @@ public:
             }
             else if( itatt->first == "uriHint" ) {
                 if( itatt->second == "1" ) {
-                    _serializeOptions = ISO_ReferenceUriHint;
+                    _serializeOptions |= ISO_ReferenceUriHint;
+                }
+            }
+            else if( itatt->first == "binaryMesh" ) {
+                if( itatt->second == "1" ) {
+                    _serializeOptions |= ISO_BinaryMesh;
+                    if( bMsgPack ) {
+                        _serializeOptions |= ISO_BinaryMeshRaw;
+                    }
                 }
             }
         }
@@ -62,6 +71,84 @@ public:
         _Write(listbodies);
     }
 
+    /// \brief extracts the info of a body at zero dof values and identity transform, with its uris canonicalized
+    KinBody::KinBodyInfoPtr ExtractCanonicalBodyInfo(KinBodyPtr pBody)
+    {
+        KinBody::KinBodyStateSaver saver(pBody);
+        vector<dReal> vZeros(pBody->GetDOF(), 0);
+        pBody->SetDOFValues(vZeros, KinBody::CLA_Nothing);
+        pBody->SetTransform(Transform()); // TODO: is this necessary
+
+        if (!pBody->IsRobot()) {
+            KinBody::KinBodyInfoPtr pInfo(new KinBody::KinBodyInfo());
+            pBody->ExtractInfo(*pInfo);
+            pInfo->_referenceUri = _CanonicalizeURI(pInfo->_referenceUri);
+            return pInfo;
+        }
+        RobotBasePtr pRobot = RaveInterfaceCast<RobotBase>(pBody);
+        RobotBase::RobotBaseInfoPtr pInfo(new RobotBase::RobotBaseInfo());
+        pRobot->ExtractInfo(*pInfo);
+        pInfo->_referenceUri = _CanonicalizeURI(pInfo->_referenceUri);
+        FOREACH(itConnectedBodyInfo, pInfo->_vConnectedBodyInfos) {
+            (*itConnectedBodyInfo)->_uri = _CanonicalizeURI((*itConnectedBodyInfo)->_uri);
+        }
+        return pInfo;
+    }
+
+    /// \brief writes the current dof values, transform and grabbed bodies of pBody into bodyValue
+    void SerializeBodyState(KinBodyPtr pBody, rapidjson::Value& bodyValue, rapidjson::Document::AllocatorType& allocator)
+    {
+        dReal fUnitScale = 1.0;
+        if (!bodyValue.IsObject()) {
+            bodyValue.SetObject();
+        }
+
+        // dof value
+        std::vector<dReal> vDOFValues;
+        pBody->GetDOFValues(vDOFValues);
+        if (vDOFValues.size() > 0) {
+            rapidjson::Value dofValues;
+            dofValues.SetArray();
+            dofValues.Reserve(vDOFValues.size(), allocator);
+            for(size_t iDOF=0; iDOF<vDOFValues.size(); iDOF++) {
+                rapidjson::Value jointDOFValue;
+                KinBody::JointPtr pJoint = pBody->GetJointFromDOFIndex(iDOF);
+                std::string jointName = pJoint->GetName();
+                int jointAxis = iDOF - pJoint->GetDOFIndex();
+                OpenRAVE::orjson::SetJsonValueByKey(jointDOFValue, "jointName", jointName, allocator);
+                OpenRAVE::orjson::SetJsonValueByKey(jointDOFValue, "jointAxis", jointAxis, allocator);
+                OpenRAVE::orjson::SetJsonValueByKey(jointDOFValue, "value", vDOFValues[iDOF], allocator);
+                dofValues.PushBack(jointDOFValue, allocator);
+            }
+            OpenRAVE::orjson::SetJsonValueByKey(bodyValue, "dofValues", dofValues, allocator);
+        }
+
+        OpenRAVE::orjson::SetJsonValueByKey(bodyValue, "transform", pBody->GetTransform(), allocator);
+
+        // grabbed info
+        std::vector<KinBody::GrabbedInfoPtr> vGrabbedInfo;
+        pBody->GetGrabbedInfo(vGrabbedInfo);
+        if (vGrabbedInfo.size() > 0) {
+            rapidjson::Value grabbedsValue;
+            grabbedsValue.SetArray();
+            FOREACHC(itgrabbedinfo, vGrabbedInfo) {
+                rapidjson::Value grabbedValue;
+                (*itgrabbedinfo)->SerializeJSON(grabbedValue, allocator, fUnitScale, _serializeOptions);
+                grabbedsValue.PushBack(grabbedValue, allocator);
+            }
+            bodyValue.AddMember("grabbed", grabbedsValue, allocator);
+        }
+    }
+
+    inline int GetSerializeOptions() const {
+        return _serializeOptions;
+    }
+
+    /// \brief options for serializing pBody as part of a list of bodies, only robots save their referenceUri as a hint
+    inline int GetBodySerializeOptions(KinBodyConstPtr pBody) const {
+        return pBody->IsRobot() ? _serializeOptions : (_serializeOptions & ~ISO_ReferenceUriHint);
+    }
+
 protected:
 
     virtual void _Write(const std::list<KinBodyPtr>& listbodies) {
@@ -83,63 +170,8 @@ protected:
                 rapidjson::Value bodyValue;
 
                 // set dofvalues before serializing body info
-                {
-                    KinBody::KinBodyStateSaver saver(pBody);
-                    vector<dReal> vZeros(pBody->GetDOF(), 0);
-                    pBody->SetDOFValues(vZeros, KinBody::CLA_Nothing);
-                    pBody->SetTransform(Transform()); // TODO: is this necessary
-
-                    if (!pBody->IsRobot()) {
-                        KinBody::KinBodyInfo info;
-                        pBody->ExtractInfo(info);
-                        info._referenceUri = _CanonicalizeURI(info._referenceUri);
-                        info.SerializeJSON(bodyValue, _allocator, fUnitScale);
-                    } else {
-                        RobotBasePtr pRobot = RaveInterfaceCast<RobotBase>(pBody);
-                        RobotBase::RobotBaseInfo info;
-                        pRobot->ExtractInfo(info);
-                        info._referenceUri = _CanonicalizeURI(info._referenceUri);
-                        FOREACH(itConnectedBodyInfo, info._vConnectedBodyInfos) {
-                            (*itConnectedBodyInfo)->_uri = _CanonicalizeURI((*itConnectedBodyInfo)->_uri);
-                        }
-                        info.SerializeJSON(bodyValue, _allocator, fUnitScale, _serializeOptions);
-                    }
-                }
-                // dof value
-                std::vector<dReal> vDOFValues;
-                pBody->GetDOFValues(vDOFValues);
-                if (vDOFValues.size() > 0) {
-                    rapidjson::Value dofValues;
-                    dofValues.SetArray();
-                    dofValues.Reserve(vDOFValues.size(), _allocator);
-                    for(size_t iDOF=0; iDOF<vDOFValues.size(); iDOF++) {
-                        rapidjson::Value jointDOFValue;
-                        KinBody::JointPtr pJoint = pBody->GetJointFromDOFIndex(iDOF);
-                        std::string jointName = pJoint->GetName();
-                        int jointAxis = iDOF - pJoint->GetDOFIndex();
-                        OpenRAVE::orjson::SetJsonValueByKey(jointDOFValue, "jointName", jointName, _allocator);
-                        OpenRAVE::orjson::SetJsonValueByKey(jointDOFValue, "jointAxis", jointAxis, _allocator);
-                        OpenRAVE::orjson::SetJsonValueByKey(jointDOFValue, "value", vDOFValues[iDOF], _allocator);
-                        dofValues.PushBack(jointDOFValue, _allocator);
-                    }
-                    OpenRAVE::orjson::SetJsonValueByKey(bodyValue, "dofValues", dofValues, _allocator);
-                }
-
-                OpenRAVE::orjson::SetJsonValueByKey(bodyValue, "transform", pBody->GetTransform(), _allocator);
-
-                // grabbed info
-                std::vector<KinBody::GrabbedInfoPtr> vGrabbedInfo;
-                pBody->GetGrabbedInfo(vGrabbedInfo);
-                if (vGrabbedInfo.size() > 0) {
-                    rapidjson::Value grabbedsValue;
-                    grabbedsValue.SetArray();
-                    FOREACHC(itgrabbedinfo, vGrabbedInfo) {
-                        rapidjson::Value grabbedValue;
-                        (*itgrabbedinfo)->SerializeJSON(grabbedValue, _allocator, fUnitScale, _serializeOptions);
-                        grabbedsValue.PushBack(grabbedValue, _allocator);
-                    }
-                    bodyValue.AddMember("grabbed", grabbedsValue, _allocator);
-                }
+                ExtractCanonicalBodyInfo(pBody)->SerializeJSON(bodyValue, _allocator, fUnitScale, GetBodySerializeOptions(pBody));
+                SerializeBodyState(pBody, bodyValue, _allocator);
 
                 // finally push to the bodiesValue array if bodyValue is not empty
                 if (bodyValue.MemberCount() > 0) {
@@ -213,82 +245,251 @@ protected:
     rapidjson::Document::AllocatorType& _allocator;
 };
 
+static inline void _AppendJSONOutput(std::ostream& os, const char* pdata, size_t size)
+{
+    os.write(pdata, size);
+}
+
+static inline void _AppendJSONOutput(std::vector<char>& output, const char* pdata, size_t size)
+{
+    output.insert(output.end(), pdata, pdata+size);
+}
+
+/// \brief writes the json text of an environment or a list of bodies directly to an output without building the DOM of the whole scene
+///
+/// Bodies are processed in chunks. The infos of a chunk are extracted on the calling thread, serialized into per-body buffers by several threads, and appended to the output in order. Only one chunk of bodies is held in memory at a time.
+class EnvironmentJSONStreamWriter
+{
+public:
+    EnvironmentJSONStreamWriter(const AttributesList& atts) : _writer(atts, _rScratch, _rScratch.GetAllocator()), _nthreads(0), _chunksize(0)
+    {
+        FOREACHC(itatt,atts) {
+            if( itatt->first == "numThreads" ) {
+                _nthreads = boost::lexical_cast<int>(itatt->second);
+            }
+        }
+        _nthreads = utils::GetNumParallelThreads(_nthreads);
+        _chunksize = 8*_nthreads;
+    }
+
+    template <typename OutputT>
+    void Write(EnvironmentBasePtr penv, OutputT& output)
+    {
+        EnvironmentMutex::scoped_lock lockenv(penv->GetMutex());
+        EnvironmentBase::EnvironmentBaseInfo info;
+        info._name = penv->GetName();
+        info._keywords = penv->GetKeywords();
+        info._description = penv->GetDescription();
+        PhysicsEngineBasePtr pPhysicsEngine = penv->GetPhysicsEngine();
+        if( !!pPhysicsEngine ) {
+            info._gravity = pPhysicsEngine->GetGravity();
+        }
+        rapidjson::Document rEnvironment;
+        info.SerializeJSON(rEnvironment, rEnvironment.GetAllocator(), 1.0, _writer.GetSerializeOptions());
+
+        std::vector<KinBodyPtr> vBodies;
+        penv->GetBodies(vBodies);
+        _WriteScene(rEnvironment, vBodies, false, output);
+    }
+
+    template <typename OutputT>
+    void Write(KinBodyPtr pbody, OutputT& output)
+    {
+        std::list<KinBodyPtr> listbodies;
+        listbodies.push_back(pbody);
+        Write(listbodies, output);
+    }
+
+    template <typename OutputT>
+    void Write(const std::list<KinBodyPtr>& listbodies, OutputT& output)
+    {
+        rapidjson::Document rEnvironment;
+        rEnvironment.SetObject();
+        if( listbodies.size() > 0 ) {
+            EnvironmentBaseConstPtr penv = listbodies.front()->GetEnv();
+            FOREACHC(itbody, listbodies) {
+                BOOST_ASSERT((*itbody)->GetEnv() == penv);
+            }
+            OpenRAVE::orjson::SetJsonValueByKey(rEnvironment, "unit", penv->GetUnit(), rEnvironment.GetAllocator());
+        }
+        std::vector<KinBodyPtr> vBodies(listbodies.begin(), listbodies.end());
+        _WriteScene(rEnvironment, vBodies, true, output);
+    }
+
+protected:
+    /// \brief everything needed to serialize one body without touching the body itself
+    struct BodyData
+    {
+        KinBody::KinBodyInfoPtr _pInfo;
+        int _options;
+        boost::shared_ptr<rapidjson::Document> _pState; ///< dof values, transform and grabbed bodies set on top of the info, null if the info is written as is
+        std::string _json; ///< the serialized body
+    };
+
+    /// \brief writes rEnvironment with the bodies appended as its "bodies" member
+    ///
+    /// \param bCanonicalBodies if true, writes the bodies the way EnvironmentJSONWriter writes a list of bodies, otherwise the way it writes an environment
+    template <typename OutputT>
+    void _WriteScene(const rapidjson::Value& rEnvironment, const std::vector<KinBodyPtr>& vBodies, bool bCanonicalBodies, OutputT& output)
+    {
+        std::string header = OpenRAVE::orjson::DumpJson(rEnvironment);
+        BOOST_ASSERT(header.size() >= 2 && header[header.size()-1] == '}');
+        _AppendJSONOutput(output, header.c_str(), header.size()-1);
+
+        bool bFirstBody = true;
+        std::vector<BodyData> vBodyData;
+        for(size_t ibody = 0; ibody < vBodies.size(); ibody += _chunksize) {
+            vBodyData.resize(min(_chunksize, vBodies.size()-ibody));
+            for(size_t ichunk = 0; ichunk < vBodyData.size(); ++ichunk) {
+                KinBodyPtr pBody = vBodies[ibody+ichunk];
+                BodyData& bodyData = vBodyData[ichunk];
+                bodyData._json.clear();
+                bodyData._pState.reset();
+                if( bCanonicalBodies ) {
+                    bodyData._pInfo = _writer.ExtractCanonicalBodyInfo(pBody);
+                    bodyData._options = _writer.GetBodySerializeOptions(pBody);
+                    bodyData._pState.reset(new rapidjson::Document());
+                    _writer.SerializeBodyState(pBody, *bodyData._pState, bodyData._pState->GetAllocator());
+                }
+                else {
+                    if( pBody->IsRobot() ) {
+                        RobotBase::RobotBaseInfoPtr pInfo(new RobotBase::RobotBaseInfo());
+                        RaveInterfaceCast<RobotBase>(pBody)->ExtractInfo(*pInfo);
+                        bodyData._pInfo = pInfo;
+                    }
+                    else {
+                        bodyData._pInfo.reset(new KinBody::KinBodyInfo());
+                        pBody->ExtractInfo(*bodyData._pInfo);
+                    }
+                    bodyData._options = _writer.GetSerializeOptions();
+                }
+            }
+
+            _SerializeBodies(vBodyData);
+
+            FOREACH(itBodyData, vBodyData) {
+                // skip empty bodies when writing a list of bodies
+                if( bCanonicalBodies && itBodyData->_json.size() <= 2 ) {
+                    continue;
+                }
+                if( bFirstBody ) {
+                    static const char s_bodiesKey[] = "\"bodies\":[";
+                    if( rEnvironment.MemberCount() > 0 ) {
+                        _AppendJSONOutput(output, ",", 1);
+                    }
+                    _AppendJSONOutput(output, s_bodiesKey, sizeof(s_bodiesKey)-1);
+                    bFirstBody = false;
+                }
+                else {
+                    _AppendJSONOutput(output, ",", 1);
+                }
+                _AppendJSONOutput(output, itBodyData->_json.c_str(), itBodyData->_json.size());
+                // release the chunk as soon as it is written
+                itBodyData->_pInfo.reset();
+                itBodyData->_pState.reset();
+                std::string().swap(itBodyData->_json);
+            }
+        }
+        if( !bFirstBody ) {
+            _AppendJSONOutput(output, "]", 1);
+        }
+        _AppendJSONOutput(output, "}", 1);
+    }
+
+    /// \brief serializes all bodies of the chunk, in parallel when there is more than one thread
+    void _SerializeBodies(std::vector<BodyData>& vBodyData)
+    {
+        try {
+            utils::ParallelFor(vBodyData.size(), boost::bind(&EnvironmentJSONStreamWriter::_SerializeBodyIndex, boost::ref(vBodyData), _1), _nthreads);
+        }
+        catch(const std::exception& ex) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to serialize body: %s", ex.what(), ORE_Failed);
+        }
+    }
+
+    static void _SerializeBodyIndex(std::vector<BodyData>& vBodyData, size_t index)
+    {
+        _SerializeBody(vBodyData[index]);
+    }
+
+    /// \brief serializes one body into its own buffer. only touches bodyData, so several bodies can be serialized at the same time
+    static void _SerializeBody(BodyData& bodyData)
+    {
+        rapidjson::Document rBody;
+        bodyData._pInfo->SerializeJSON(rBody, rBody.GetAllocator(), 1.0, bodyData._options);
+        if( !!bodyData._pState ) {
+            for(rapidjson::Value::ConstMemberIterator it = bodyData._pState->MemberBegin(); it != bodyData._pState->MemberEnd(); ++it) {
+                OpenRAVE::orjson::SetJsonValueByKey(rBody, it->name.GetString(), it->value, rBody.GetAllocator());
+            }
+        }
+        rapidjson::StringBuffer buffer;
+        rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+        rBody.Accept(writer);
+        bodyData._json.assign(buffer.GetString(), buffer.GetSize());
+    }
+
+    rapidjson::Document _rScratch; ///< unused output of _writer, which is only used for its extraction helpers
+    EnvironmentJSONWriter _writer;
+    int _nthreads; ///< number of threads serializing bodies
+    size_t _chunksize; ///< number of bodies held in memory at a time
+
+};
+
 void RaveWriteJSONFile(EnvironmentBasePtr penv, const std::string& filename, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
     std::ofstream ofstream(filename.c_str());
-    rapidjson::Document doc(&alloc);
-
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(penv);
-    OpenRAVE::orjson::DumpJson(doc, ofstream);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(penv, ofstream);
 }
 
 void RaveWriteJSONFile(KinBodyPtr pbody, const std::string& filename, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
     std::ofstream ofstream(filename.c_str());
-    rapidjson::Document doc(&alloc);
-
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(pbody);
-    OpenRAVE::orjson::DumpJson(doc, ofstream);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(pbody, ofstream);
 }
 
 void RaveWriteJSONFile(const std::list<KinBodyPtr>& listbodies, const std::string& filename, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
     std::ofstream ofstream(filename.c_str());
-    rapidjson::Document doc(&alloc);
-
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(listbodies);
-    OpenRAVE::orjson::DumpJson(doc, ofstream);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(listbodies, ofstream);
 }
 
 void RaveWriteJSONStream(EnvironmentBasePtr penv, ostream& os, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
-    rapidjson::Document doc(&alloc);
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(penv);
-    OpenRAVE::orjson::DumpJson(doc, os);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(penv, os);
 }
 
 void RaveWriteJSONStream(KinBodyPtr pbody, ostream& os, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
-    rapidjson::Document doc(&alloc);
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(pbody);
-    OpenRAVE::orjson::DumpJson(doc, os);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(pbody, os);
 }
 
 void RaveWriteJSONStream(const std::list<KinBodyPtr>& listbodies, ostream& os, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
-    rapidjson::Document doc(&alloc);
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(listbodies);
-    OpenRAVE::orjson::DumpJson(doc, os);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(listbodies, os);
 }
 
 void RaveWriteJSONMemory(EnvironmentBasePtr penv, std::vector<char>& output, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
-    rapidjson::Document doc(&alloc);
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(penv);
-    OpenRAVE::orjson::DumpJson(doc, output);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(penv, output);
 }
 
 void RaveWriteJSONMemory(KinBodyPtr pbody, std::vector<char>& output, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
-    rapidjson::Document doc(&alloc);
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(pbody);
-    OpenRAVE::orjson::DumpJson(doc, output);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(pbody, output);
 }
 
 void RaveWriteJSONMemory(const std::list<KinBodyPtr>& listbodies, std::vector<char>& output, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
-    rapidjson::Document doc(&alloc);
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
-    jsonwriter.Write(listbodies);
-    OpenRAVE::orjson::DumpJson(doc, output);
+    EnvironmentJSONStreamWriter jsonwriter(atts);
+    jsonwriter.Write(listbodies, output);
 }
 
 void RaveWriteJSON(EnvironmentBasePtr penv, rapidjson::Value& rEnvironment, rapidjson::Document::AllocatorType& allocator, const AttributesList& atts)
@@ -314,7 +515,7 @@ void RaveWriteMsgPackFile(EnvironmentBasePtr penv, const std::string& filename,
     std::ofstream ofstream(filename.c_str());
     rapidjson::Document doc(&alloc);
 
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(penv);
     OpenRAVE::MsgPack::DumpMsgPack(doc, ofstream);
 }
@@ -324,7 +525,7 @@ void RaveWriteMsgPackFile(KinBodyPtr pbody, const std::string& filename, const A
     std::ofstream ofstream(filename.c_str());
     rapidjson::Document doc(&alloc);
 
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(pbody);
     OpenRAVE::MsgPack::DumpMsgPack(doc, ofstream);
 }
@@ -334,7 +535,7 @@ void RaveWriteMsgPackFile(const std::list<KinBodyPtr>& listbodies, const std::st
     std::ofstream ofstream(filename.c_str());
     rapidjson::Document doc(&alloc);
 
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(listbodies);
     OpenRAVE::MsgPack::DumpMsgPack(doc, ofstream);
 }
@@ -343,7 +544,7 @@ void RaveWriteMsgPackStream(EnvironmentBasePtr penv, ostream& os, const Attribut
 {
     rapidjson::Document doc(&alloc);
 
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(penv);
     OpenRAVE::MsgPack::DumpMsgPack(doc, os);
 }
@@ -352,7 +553,7 @@ void RaveWriteMsgPackStream(KinBodyPtr pbody, ostream& os, const AttributesList&
 {
     rapidjson::Document doc(&alloc);
 
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(pbody);
     OpenRAVE::MsgPack::DumpMsgPack(doc, os);
 }
@@ -361,7 +562,7 @@ void RaveWriteMsgPackStream(const std::list<KinBodyPtr>& listbodies, ostream& os
 {
     rapidjson::Document doc(&alloc);
 
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(listbodies);
     OpenRAVE::MsgPack::DumpMsgPack(doc, os);
 }
@@ -369,7 +570,7 @@ void RaveWriteMsgPackStream(const std::list<KinBodyPtr>& listbodies, ostream& os
 void RaveWriteMsgPackMemory(EnvironmentBasePtr penv, std::vector<char>& output, const AttributesList& atts, rapidjson::Document::AllocatorType& alloc)
 {
     rapidjson::Document doc(&alloc);
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(penv);
     OpenRAVE::MsgPack::DumpMsgPack(doc, output);
 }
@@ -378,7 +579,7 @@ void RaveWriteMsgPackMemory(KinBodyPtr pbody, std::vector<char>& output, const A
 {
     rapidjson::Document doc(&alloc);
 
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(pbody);
     OpenRAVE::MsgPack::DumpMsgPack(doc, output);
 }
@@ -387,9 +588,39 @@ void RaveWriteMsgPackMemory(const std::list<KinBodyPtr>& listbodies, std::vector
 {
     rapidjson::Document doc(&alloc);
 
-    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator());
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
+    jsonwriter.Write(listbodies);
+    OpenRAVE::MsgPack::DumpMsgPack(doc, output);
+}
+
+void RaveWriteSceneCacheFile(const std::list<KinBodyPtr>& listbodies, const std::string& cachefilename, rapidjson::Document::AllocatorType& alloc)
+{
+    rapidjson::Document doc(&alloc);
+    AttributesList atts;
+    atts.push_back(std::make_pair(std::string("binaryMesh"), std::string("1")));
+    EnvironmentJSONWriter jsonwriter(atts, doc, doc.GetAllocator(), true);
     jsonwriter.Write(listbodies);
+
+    std::vector<char> output(s_sceneCacheMagic, s_sceneCacheMagic+sizeof(s_sceneCacheMagic));
+    output.back() = (char)s_sceneCacheVersion;
     OpenRAVE::MsgPack::DumpMsgPack(doc, output);
+
+    // several processes can write the same cache, so write into a unique file and rename it
+    std::string tempfilename = str(boost::format("%s.%s.tmp")%cachefilename%utils::GetMicroTime());
+    {
+        std::ofstream ofs(tempfilename.c_str(), std::ios::binary);
+        ofs.write(output.data(), output.size());
+        if( !ofs ) {
+            RAVELOG_WARN_FORMAT("failed to write scene cache %s", tempfilename);
+            ofs.close();
+            std::remove(tempfilename.c_str());
+            return;
+        }
+    }
+    if( std::rename(tempfilename.c_str(), cachefilename.c_str()) != 0 ) {
+        RAVELOG_WARN_FORMAT("failed to rename scene cache %s to %s", tempfilename%cachefilename);
+        std::remove(tempfilename.c_str());
+    }
 }
 
 }
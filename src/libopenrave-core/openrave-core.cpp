@@ -16,6 +16,9 @@
 #include "ravep.h"
 #include "environment-core.h"
 
+#include <sys/types.h>
+#include <sys/stat.h>
+
 namespace OpenRAVE {
 EnvironmentBasePtr RaveCreateEnvironment(int options) {
     boost::shared_ptr<Environment> p(new Environment());
@@ -26,6 +29,55 @@ EnvironmentBasePtr RaveCreateEnvironment(int options) {
 EnvironmentBasePtr CreateEnvironment(bool bLoadAllPlugins) {
     return RaveCreateEnvironment();
 }
+
+void RaveClearLoaderCaches(int types)
+{
+    if( types & LCT_MeshImport ) {
+        OpenRAVEXMLParser::ClearMeshImportCache();
+    }
+    if( types & LCT_JSONDocument ) {
+        ClearJSONDocumentCache();
+    }
+}
+
+void RaveGetLoaderCacheStats(LoaderCacheType type, uint64_t& nhits, uint64_t& nmisses, size_t& nentries)
+{
+    nhits = nmisses = 0;
+    nentries = 0;
+    switch(type) {
+    case LCT_MeshImport:
+        OpenRAVEXMLParser::GetMeshImportCacheStats(nhits, nmisses, nentries);
+        break;
+    case LCT_JSONDocument:
+        GetJSONDocumentCacheStats(nhits, nmisses, nentries);
+        break;
+    default:
+        throw OPENRAVE_EXCEPTION_FORMAT(_("unknown loader cache type %d"), (int)type, ORE_InvalidArguments);
+    }
+}
+}
+
+bool RaveGetFileStamp(const std::string& filename, int64_t& mtimens, uint64_t& filesize)
+{
+#ifdef _WIN32
+    struct _stat64 st;
+    if( _stat64(filename.c_str(), &st) != 0 ) {
+        return false;
+    }
+    mtimens = static_cast<int64_t>(st.st_mtime)*1000000000LL;
+#else
+    struct stat st;
+    if( stat(filename.c_str(), &st) != 0 ) {
+        return false;
+    }
+#if defined(__APPLE__)
+    mtimens = static_cast<int64_t>(st.st_mtimespec.tv_sec)*1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+    mtimens = static_cast<int64_t>(st.st_mtim.tv_sec)*1000000000LL + st.st_mtim.tv_nsec;
+#endif
+#endif
+    filesize = static_cast<uint64_t>(st.st_size);
+    return true;
 }
 
 #if !defined(OPENRAVE_IS_ASSIMP3) && !defined(OPENRAVE_ASSIMP)
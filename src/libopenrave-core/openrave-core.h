@@ -49,6 +49,25 @@ OPENRAVE_CORE_API EnvironmentBasePtr RaveCreateEnvironment(int options=ECO_Start
 /// \deprecated (10/09/23) see \ref RaveCreateEnvironment
 OPENRAVE_CORE_API EnvironmentBasePtr CreateEnvironment(bool bLoadAllPlugins=true) RAVE_DEPRECATED;
 
+/// \brief process-wide caches kept by the environment loaders across all environments
+enum LoaderCacheType
+{
+    LCT_MeshImport=1, ///< mesh files imported by the xml reader, including failed imports, and the prescans of xml scene files
+    LCT_JSONDocument=2, ///< parsed json and msgpack files, including the files referenced by other json files
+};
+
+/// \brief releases the entries of the loader caches so that the next loads read the files again. <b>[multi-thread safe]</b>
+///
+/// \param types combination of \ref LoaderCacheType
+OPENRAVE_CORE_API void RaveClearLoaderCaches(int types=0xffff);
+
+/// \brief gets the usage of a loader cache since the process started. <b>[multi-thread safe]</b>
+///
+/// \param nhits number of lookups that were served from the cache
+/// \param nmisses number of lookups that had to read the file
+/// \param nentries number of entries currently stored
+OPENRAVE_CORE_API void RaveGetLoaderCacheStats(LoaderCacheType type, uint64_t& nhits, uint64_t& nmisses, size_t& nentries);
+
 } // end namespace OpenRAVE
 
 #endif
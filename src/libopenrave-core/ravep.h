@@ -293,6 +293,29 @@ bool CreateTriMeshFromFile(EnvironmentBasePtr, const std::string& filename, cons
 bool CreateTriMeshFromData(const std::string& data, const std::string& formathint, const Vector &vscale, TriMesh& trimesh, RaveVector<float>&diffuseColor, RaveVector<float>&ambientColor, float &ftransparency);
 
 bool CreateGeometries(EnvironmentBasePtr penv, const std::string& filename, const Vector& vscale, std::list<KinBody::GeometryInfo>& listGeometries);
+
+/// \brief imports the mesh files into the process-wide mesh cache using several threads, so that later calls to CreateGeometries only copy the cached geometries
+///
+/// Files that are already cached or that can only be loaded through inventor are skipped.
+/// \param vfilenamescales the full paths of the mesh files and their import scales
+/// \param nthreads the number of import threads, if 0 uses the number of hardware threads
+void PrefetchGeometryFiles(EnvironmentBasePtr penv, const std::vector< std::pair<std::string, Vector> >& vfilenamescales, int nthreads=0);
+
+/// \brief scans an xml scene file and the xml files it includes for trimesh geometry files and prefetches them with PrefetchGeometryFiles
+///
+/// Does nothing when called while another xml file is being parsed, since the outermost file has already been scanned.
+void PrefetchXMLFileGeometries(EnvironmentBasePtr penv, const std::string& filename, int nthreads=0);
+
+/// \brief gets the full paths of an xml file, the xml files it includes, and the mesh files its trimesh geometries import
+///
+/// \return false if filename cannot be found
+bool GetXMLFileDependencies(const std::string& filename, std::vector<std::string>& vdependencies);
+
+/// \brief releases all imported meshes, cached failures and cached xml prescans, see RaveClearLoaderCaches
+void ClearMeshImportCache();
+
+/// \brief see RaveGetLoaderCacheStats
+void GetMeshImportCacheStats(uint64_t& nhits, uint64_t& nmisses, size_t& nentries);
 }
 
 #ifdef _WIN32
@@ -321,5 +344,18 @@ bool RaveParseXFile(EnvironmentBasePtr penv, RobotBasePtr& pprobot, const std::s
 bool RaveParseXData(EnvironmentBasePtr penv, KinBodyPtr& ppbody, const std::vector<char>& data,const AttributesList& atts);
 bool RaveParseXData(EnvironmentBasePtr penv, RobotBasePtr& pprobot, const std::vector<char>& data,const AttributesList& atts);
 
+/// \brief generates the collision proxies requested by the "collisionproxy" load attribute for the trimesh geometries of the bodies and stores them in a geometry group of their links
+///
+/// The proxy meshes are cached on disk by the hash of the source mesh and the proxy parameters.
+/// \param vproxybodies filled with the bodies that had their links' geometry group set
+/// \return the geometry group name, or empty if atts do not request collision proxies
+std::string RaveGenerateCollisionProxies(int environmentid, const std::vector<KinBodyPtr>& vbodies, const AttributesList& atts, std::vector<KinBodyPtr>& vproxybodies);
+
+/// \brief gets the modification time of a file in nanoseconds and its size, so that caches notice a file rewritten within the same second
+///
+/// On Windows the modification time only has a resolution of one second.
+/// \return false if the file cannot be examined
+bool RaveGetFileStamp(const std::string& filename, int64_t& mtimens, uint64_t& filesize);
+
 #define _(msgid) OpenRAVE::RaveGetLocalizedTextForDomain("openrave", msgid)
 #endif
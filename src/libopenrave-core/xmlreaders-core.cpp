@@ -373,8 +373,142 @@ static bool _ParseSpecialSTLFile(EnvironmentBasePtr penv, const std::string& fil
 
 #endif
 
-bool CreateTriMeshFromFile(EnvironmentBasePtr penv, const std::string& filename, const Vector& vscale, TriMesh& trimesh, RaveVector<float>& diffuseColor, RaveVector<float>& ambientColor, float& ftransparency)
+/// \brief process-wide cache of imported mesh files, so that a file referenced by several bodies or environments is only imported once. <b>[multi-thread safe]</b>
+///
+/// Entries are keyed by the filename, its modification time in nanoseconds and size, the import scale and the kind of import. The stored geometries are never modified after insertion, callers copy them out. Failed imports are stored as empty entries so that a missing or broken file is not imported again until it changes.
+class MeshImportCache
 {
+public:
+    enum ImportKind
+    {
+        IK_Geometries = 0, ///< one geometry per mesh of the file, see CreateGeometries
+        IK_TriMesh = 1, ///< the merged trimesh and its colors stored in one geometry, see CreateTriMeshFromFile
+    };
+
+    /// \brief the imported geometries of a file
+    struct Entry
+    {
+        Entry() : bReplaceTriMesh(false), bReadColors(false) {
+        }
+        std::list<KinBody::GeometryInfo> geometries;
+        bool bReplaceTriMesh; ///< IK_TriMesh only, the importer overwrites the trimesh of the caller instead of appending to it
+        bool bReadColors; ///< IK_TriMesh only, the importer read the colors and transparency from the file
+    };
+    typedef boost::shared_ptr<const Entry> EntryConstPtr;
+
+    struct Key
+    {
+        bool operator<(const Key& r) const {
+            if( kind != r.kind ) {
+                return kind < r.kind;
+            }
+            if( mtime != r.mtime ) {
+                return mtime < r.mtime;
+            }
+            if( filesize != r.filesize ) {
+                return filesize < r.filesize;
+            }
+            for(int i = 0; i < 3; ++i) {
+                if( scale[i] != r.scale[i] ) {
+                    return scale[i] < r.scale[i];
+                }
+            }
+            return filename < r.filename;
+        }
+
+        std::string filename;
+        int64_t mtime; ///< nanoseconds
+        uint64_t filesize;
+        dReal scale[3];
+        int kind;
+    };
+
+    MeshImportCache() : _nhits(0), _nmisses(0) {
+    }
+
+    static MeshImportCache& GetInstance()
+    {
+        static MeshImportCache s_cache;
+        return s_cache;
+    }
+
+    /// \brief fills the key of a file. Returns false if the file cannot be examined, in which case the import should not be cached.
+    static bool GetKey(const std::string& filename, const Vector& vscale, int kind, Key& key)
+    {
+        if( !RaveGetFileStamp(filename, key.mtime, key.filesize) ) {
+            RAVELOG_VERBOSE_FORMAT("not caching mesh %s since it cannot be examined", filename);
+            return false;
+        }
+        key.filename = filename;
+        key.scale[0] = vscale.x; key.scale[1] = vscale.y; key.scale[2] = vscale.z;
+        key.kind = kind;
+        return true;
+    }
+
+    /// \brief looks up key and counts the lookup as a hit or miss
+    ///
+    /// \param pentry set to the cached geometries, or empty if the import of the file failed before
+    /// \return true if key is cached
+    bool Find(const Key& key, EntryConstPtr& pentry)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        std::map<Key, EntryConstPtr>::const_iterator it = _mapGeometries.find(key);
+        if( it == _mapGeometries.end() ) {
+            ++_nmisses;
+            pentry.reset();
+            return false;
+        }
+        ++_nhits;
+        pentry = it->second;
+        return true;
+    }
+
+    /// \brief returns true if key is cached, without counting it as a lookup
+    bool Contains(const Key& key)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        return _mapGeometries.find(key) != _mapGeometries.end();
+    }
+
+    /// \param pentry the imported geometries, or empty to record that the import failed
+    void Insert(const Key& key, EntryConstPtr pentry)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        if( _mapGeometries.size() >= s_nMaxEntries ) {
+            RAVELOG_DEBUG_FORMAT("mesh import cache reached %d entries, clearing", _mapGeometries.size());
+            _mapGeometries.clear();
+        }
+        _mapGeometries[key] = pentry;
+    }
+
+    void Clear()
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _mapGeometries.clear();
+    }
+
+    void GetStats(uint64_t& nhits, uint64_t& nmisses, size_t& nentries)
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        nhits = _nhits;
+        nmisses = _nmisses;
+        nentries = _mapGeometries.size();
+    }
+
+private:
+    static const size_t s_nMaxEntries = 4096;
+
+    boost::mutex _mutex;
+    std::map<Key, EntryConstPtr> _mapGeometries;
+    uint64_t _nhits, _nmisses;
+};
+
+/// \param bReplaceTriMesh set to true if the importer overwrote trimesh instead of appending to it
+/// \param bReadColors set to true if the importer read the colors and transparency from the file
+static bool _ImportTriMeshFromFile(EnvironmentBasePtr penv, const std::string& filename, const Vector& vscale, TriMesh& trimesh, RaveVector<float>& diffuseColor, RaveVector<float>& ambientColor, float& ftransparency, bool& bReplaceTriMesh, bool& bReadColors)
+{
+    bReplaceTriMesh = false;
+    bReadColors = false;
     string extension;
     if( filename.find_last_of('.') != string::npos ) {
         extension = filename.substr(filename.find_last_of('.')+1);
@@ -432,6 +566,7 @@ bool CreateTriMeshFromFile(EnvironmentBasePtr penv, const std::string& filename,
                     FOREACH(itgeom, listGeometries) {
                         trimesh.Append(itgeom->_meshcollision, itgeom->_t);
                     }
+                    bReplaceTriMesh = true;
                     return true;
                 }
 #endif
@@ -456,6 +591,8 @@ bool CreateTriMeshFromFile(EnvironmentBasePtr penv, const std::string& filename,
                     it->y *= vscale.y;
                     it->z *= vscale.z;
                 }
+                bReplaceTriMesh = true;
+                bReadColors = true;
                 return true;
             }
         }
@@ -469,12 +606,59 @@ bool CreateTriMeshFromFile(EnvironmentBasePtr penv, const std::string& filename,
         for(size_t i = 0; i < vertices.size(); i += 3) {
             trimesh.vertices[i/3] = Vector(vscale.x*vertices[i],vscale.y*vertices[i+1],vscale.z*vertices[i+2]);
         }
+        bReplaceTriMesh = true;
         return true;
     }
 #endif
     return false;
 }
 
+bool CreateTriMeshFromFile(EnvironmentBasePtr penv, const std::string& filename, const Vector& vscale, TriMesh& trimesh, RaveVector<float>& diffuseColor, RaveVector<float>& ambientColor, float& ftransparency)
+{
+    MeshImportCache::Key key;
+    bool bCache = MeshImportCache::GetKey(filename, vscale, MeshImportCache::IK_TriMesh, key);
+    MeshImportCache::EntryConstPtr pentry;
+    if( bCache && MeshImportCache::GetInstance().Find(key, pentry) ) {
+        if( !pentry ) {
+            // failed before and the file did not change since
+            return false;
+        }
+    }
+    else {
+        // import into an empty mesh with the caller's colors, and record how the importer applies them so a cache hit
+        // gives every caller the same result as importing again
+        boost::shared_ptr<MeshImportCache::Entry> pnewentry(new MeshImportCache::Entry());
+        pnewentry->geometries.resize(1);
+        KinBody::GeometryInfo& g = pnewentry->geometries.front();
+        g._vDiffuseColor = diffuseColor;
+        g._vAmbientColor = ambientColor;
+        g._fTransparency = ftransparency;
+        if( !_ImportTriMeshFromFile(penv, filename, vscale, g._meshcollision, g._vDiffuseColor, g._vAmbientColor, g._fTransparency, pnewentry->bReplaceTriMesh, pnewentry->bReadColors) ) {
+            if( bCache ) {
+                MeshImportCache::GetInstance().Insert(key, MeshImportCache::EntryConstPtr());
+            }
+            return false;
+        }
+        if( bCache ) {
+            MeshImportCache::GetInstance().Insert(key, pnewentry);
+        }
+        pentry = pnewentry;
+    }
+    const KinBody::GeometryInfo& g = pentry->geometries.front();
+    if( pentry->bReplaceTriMesh ) {
+        trimesh = g._meshcollision;
+    }
+    else {
+        trimesh.Append(g._meshcollision);
+    }
+    if( pentry->bReadColors ) {
+        diffuseColor = g._vDiffuseColor;
+        ambientColor = g._vAmbientColor;
+        ftransparency = g._fTransparency;
+    }
+    return true;
+}
+
 bool CreateTriMeshFromData(const std::string& data, const std::string& formathint, const Vector& vscale, TriMesh& trimesh, RaveVector<float>& diffuseColor, RaveVector<float>& ambientColor, float& ftransparency)
 {
 #ifdef OPENRAVE_ASSIMP
@@ -677,6 +861,24 @@ static int raveXmlSAXUserParseMemory(xmlSAXHandlerPtr sax, BaseXMLReaderPtr prea
     return ret;
 }
 
+/// \brief number of ParseXMLFile calls currently on the stack, protected by GetXMLMutex
+static int& GetXMLFileParseDepth()
+{
+    static int depth = 0;
+    return depth;
+}
+
+class XMLFileParseDepthScope
+{
+public:
+    XMLFileParseDepthScope() {
+        ++GetXMLFileParseDepth();
+    }
+    ~XMLFileParseDepthScope() {
+        --GetXMLFileParseDepth();
+    }
+};
+
 bool ParseXMLFile(BaseXMLReaderPtr preader, const string& filename)
 {
     string filedata = RaveFindLocalFile(filename,GetParseDirectory());
@@ -684,6 +886,7 @@ bool ParseXMLFile(BaseXMLReaderPtr preader, const string& filename)
         return false;
     }
     EnvironmentMutex::scoped_lock lock(*GetXMLMutex());
+    XMLFileParseDepthScope depthscope;
 
 #ifdef HAVE_BOOST_FILESYSTEM
     SetParseDirectoryScope scope(boost::filesystem::path(filedata).parent_path().string());
@@ -768,7 +971,38 @@ class LinkXMLReader : public StreamXMLReader
 {
 public:
 
-    static bool CreateGeometries(EnvironmentBasePtr penv, const std::string& filename, const Vector& vscale, std::list<KinBody::GeometryInfo>& listGeometries)
+    /// \brief appends the geometries of a mesh file to listGeometries, importing the file only if it is not in the MeshImportCache
+    ///
+    /// \param bAssimpOnly if true, only imports through assimp and does not record failures in the cache. Used by the prefetch threads since the ivmodelloader module and ivcon are not thread safe.
+    static bool CreateGeometries(EnvironmentBasePtr penv, const std::string& filename, const Vector& vscale, std::list<KinBody::GeometryInfo>& listGeometries, bool bAssimpOnly=false)
+    {
+        MeshImportCache::Key key;
+        bool bCache = MeshImportCache::GetKey(filename, vscale, MeshImportCache::IK_Geometries, key);
+        MeshImportCache::EntryConstPtr pentry;
+        if( bCache && MeshImportCache::GetInstance().Find(key, pentry) ) {
+            if( !pentry ) {
+                // failed before and the file did not change since
+                return false;
+            }
+        }
+        else {
+            boost::shared_ptr<MeshImportCache::Entry> pnewentry(new MeshImportCache::Entry());
+            if( !_ImportGeometries(penv, filename, vscale, pnewentry->geometries, bAssimpOnly) ) {
+                if( bCache && !bAssimpOnly ) {
+                    MeshImportCache::GetInstance().Insert(key, MeshImportCache::EntryConstPtr());
+                }
+                return false;
+            }
+            if( bCache ) {
+                MeshImportCache::GetInstance().Insert(key, pnewentry);
+            }
+            pentry = pnewentry;
+        }
+        listGeometries.insert(listGeometries.end(), pentry->geometries.begin(), pentry->geometries.end());
+        return true;
+    }
+
+    static bool _ImportGeometries(EnvironmentBasePtr penv, const std::string& filename, const Vector& vscale, std::list<KinBody::GeometryInfo>& listGeometries, bool bAssimpOnly)
     {
         string extension;
         if( filename.find_last_of('.') != string::npos ) {
@@ -800,6 +1034,10 @@ public:
         }
 #endif
 
+        if( bAssimpOnly ) {
+            return false;
+        }
+
         // for other importers, just convert into one big trimesh
         listGeometries.push_back(KinBody::GeometryInfo());
         KinBody::GeometryInfo& g = listGeometries.back();
@@ -807,7 +1045,7 @@ public:
         g._vDiffuseColor=Vector(1,0.5f,0.5f,1);
         g._vAmbientColor=Vector(0.1,0.0f,0.0f,0);
         g._vRenderScale = vscale;
-        if( !CreateTriMeshFromFile(penv,filename,vscale,g._meshcollision,g._vDiffuseColor,g._vAmbientColor,g._fTransparency) ) {
+        if( !_ImportTriMeshFromFile(penv,filename,vscale,g._meshcollision,g._vDiffuseColor,g._vAmbientColor,g._fTransparency) ) {
             return false;
         }
         return true;
@@ -1333,6 +1571,387 @@ bool CreateGeometries(EnvironmentBasePtr penv, const std::string& filename, cons
     return LinkXMLReader::CreateGeometries(penv,filename,vscale,listGeometries);
 }
 
+/// \brief imports a set of mesh files into the MeshImportCache from several threads
+class GeometryFilesPrefetcher
+{
+public:
+    GeometryFilesPrefetcher(EnvironmentBasePtr penv, const std::vector< std::pair<std::string, Vector> >& vfilenamescales) : _penv(penv), _vfilenamescales(vfilenamescales), _nimported(0) {
+    }
+
+    void Run(int nthreads)
+    {
+        utils::ParallelFor(_vfilenamescales.size(), boost::bind(&GeometryFilesPrefetcher::_Import, this, _1), nthreads);
+    }
+
+    int GetNumImported() const {
+        return _nimported;
+    }
+
+protected:
+    void _Import(size_t index)
+    {
+        const std::pair<std::string, Vector>& filenamescale = _vfilenamescales[index];
+        std::list<KinBody::GeometryInfo> listGeometries;
+        try {
+            if( LinkXMLReader::CreateGeometries(_penv, filenamescale.first, filenamescale.second, listGeometries, true) ) {
+                boost::mutex::scoped_lock lock(_mutex);
+                ++_nimported;
+            }
+        }
+        catch(const std::exception& ex) {
+            // the regular load will import the file again on the main thread and report the error
+            RAVELOG_DEBUG_FORMAT("env=%d, failed to prefetch %s: %s", _penv->GetId()%filenamescale.first%ex.what());
+        }
+    }
+
+    EnvironmentBasePtr _penv;
+    const std::vector< std::pair<std::string, Vector> >& _vfilenamescales;
+    boost::mutex _mutex;
+    int _nimported; ///< protected by _mutex
+};
+
+/// \brief returns the number of threads PrefetchGeometryFiles would use, 0 if prefetching cannot help
+static int _GetNumPrefetchThreads(int nthreads)
+{
+#ifdef OPENRAVE_ASSIMP
+    nthreads = utils::GetNumParallelThreads(nthreads);
+    // a single thread only imports earlier what the regular load imports anyway
+    return nthreads > 1 ? nthreads : 0;
+#else
+    // without assimp every file goes through the ivmodelloader module or ivcon, which have to run on the loading thread
+    return 0;
+#endif
+}
+
+void PrefetchGeometryFiles(EnvironmentBasePtr penv, const std::vector< std::pair<std::string, Vector> >& vfilenamescales, int nthreads)
+{
+    nthreads = _GetNumPrefetchThreads(nthreads);
+    if( nthreads == 0 ) {
+        return;
+    }
+    std::vector< std::pair<std::string, Vector> > vtoimport;
+    vtoimport.reserve(vfilenamescales.size());
+    FOREACHC(itfilenamescale, vfilenamescales) {
+        string extension;
+        if( itfilenamescale->first.find_last_of('.') != string::npos ) {
+            extension = itfilenamescale->first.substr(itfilenamescale->first.find_last_of('.')+1);
+            std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        }
+        if( extension == "iv" || extension == "wrl" || extension == "vrml" ) {
+            // not supported by assimp, loaded through the ivmodelloader module on the loading thread
+            continue;
+        }
+        MeshImportCache::Key key;
+        if( !MeshImportCache::GetKey(itfilenamescale->first, itfilenamescale->second, MeshImportCache::IK_Geometries, key) ) {
+            continue;
+        }
+        if( MeshImportCache::GetInstance().Contains(key) ) {
+            continue;
+        }
+        bool bduplicate = false;
+        FOREACHC(itadded, vtoimport) {
+            if( itadded->first == itfilenamescale->first && itadded->second == itfilenamescale->second ) {
+                bduplicate = true;
+                break;
+            }
+        }
+        if( !bduplicate ) {
+            vtoimport.push_back(*itfilenamescale);
+        }
+    }
+    if( vtoimport.size() == 0 ) {
+        return;
+    }
+
+    uint64_t starttime = utils::GetMicroTime();
+    GeometryFilesPrefetcher prefetcher(penv, vtoimport);
+    prefetcher.Run(nthreads);
+    RAVELOG_DEBUG_FORMAT("env=%d, prefetched %d/%d mesh files in %fs", penv->GetId()%prefetcher.GetNumImported()%vtoimport.size()%(1e-6*(utils::GetMicroTime()-starttime)));
+}
+
+/// \brief collects the mesh files referenced by trimesh geometries of an xml file and the xml files it includes, without creating any interfaces
+class GeometryFilesXMLReader : public BaseXMLReader
+{
+public:
+    GeometryFilesXMLReader(std::vector< std::pair<std::string, Vector> >& vfilenamescales, std::set<std::string>& setvisited, std::vector<std::string>& vincludedfiles) : _vfilenamescales(vfilenamescales), _setvisited(setvisited), _vincludedfiles(vincludedfiles), _bInTriMesh(false), _bHasCollision(false) {
+    }
+
+    virtual ProcessElement startElement(const std::string& xmlname, const AttributesList& atts)
+    {
+        _ss.str("");
+        _ss.clear();
+        if( xmlname == "geom" || xmlname == "geometry" ) {
+            _bInTriMesh = false;
+            _bHasCollision = false;
+            _renderfilename.clear();
+            FOREACHC(itatt, atts) {
+                if( itatt->first == "type" ) {
+                    _bInTriMesh = _stricmp(itatt->second.c_str(), "trimesh") == 0;
+                }
+            }
+        }
+        else if( _bInTriMesh && (xmlname == "render" || xmlname == "collision") ) {
+            std::string filename;
+            Vector vscale(1,1,1);
+            FOREACHC(itatt, atts) {
+                if( itatt->first == "file" ) {
+                    filename = itatt->second;
+                }
+                else if( itatt->first == "scale" ) {
+                    stringstream sslocal(itatt->second);
+                    sslocal >> vscale.x; vscale.y = vscale.z = vscale.x;
+                    sslocal >> vscale.y >> vscale.z;
+                }
+            }
+            if( filename.size() > 0 ) {
+                _AddGeometryFile(xmlname, filename, vscale);
+            }
+        }
+
+        FOREACHC(itatt, atts) {
+            if( itatt->first == "file" && xmlname != "render" && xmlname != "collision" ) {
+                std::string extension;
+                if( itatt->second.find_last_of('.') != string::npos ) {
+                    extension = itatt->second.substr(itatt->second.find_last_of('.')+1);
+                    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+                }
+                if( extension == "xml" ) {
+                    std::string fullfilename = RaveFindLocalFile(itatt->second, GetParseDirectory());
+                    if( fullfilename.size() > 0 && _setvisited.insert(fullfilename).second ) {
+                        _vincludedfiles.push_back(fullfilename);
+                    }
+                }
+            }
+        }
+        // have to look at every element since trimesh geometries can be at any depth
+        return PE_Support;
+    }
+
+    virtual bool endElement(const std::string& xmlname)
+    {
+        if( xmlname == "modelsdir" ) {
+            _modelsdir = _ss.str();
+            boost::trim(_modelsdir);
+            _modelsdir += "/";
+        }
+        else if( _bInTriMesh ) {
+            if( xmlname == "data" || xmlname == "collision" || xmlname == "render" ) {
+                std::string filename;
+                Vector vscale(1,1,1);
+                _ss >> filename;
+                _ss >> vscale.x; vscale.y = vscale.z = vscale.x;
+                _ss >> vscale.y >> vscale.z;
+                if( filename.size() > 0 ) {
+                    _AddGeometryFile(xmlname == "render" ? xmlname : std::string("collision"), filename, vscale);
+                }
+            }
+            else if( xmlname == "geom" || xmlname == "geometry" ) {
+                if( !_bHasCollision && _renderfilename.size() > 0 ) {
+                    // render file is only imported when there is no collision file
+                    _vfilenamescales.push_back(std::make_pair(_renderfilename, _renderscale));
+                }
+                _bInTriMesh = false;
+            }
+        }
+        _ss.str("");
+        _ss.clear();
+        return false;
+    }
+
+    virtual void characters(const std::string& ch)
+    {
+        _ss << ch;
+    }
+
+protected:
+    void _AddGeometryFile(const std::string& xmlname, const std::string& filename, const Vector& vscale)
+    {
+        std::string fullfilename = _GetModelsDir(filename);
+        if( fullfilename.size() == 0 ) {
+            return;
+        }
+        if( xmlname == "render" ) {
+            if( _renderfilename.size() == 0 ) {
+                _renderfilename = fullfilename;
+                _renderscale = vscale;
+            }
+        }
+        else if( !_bHasCollision ) {
+            _bHasCollision = true;
+            _vfilenamescales.push_back(std::make_pair(fullfilename, vscale));
+        }
+    }
+
+    /// \brief resolves the filename the same way as KinBodyXMLReader::GetModelsDir
+    std::string _GetModelsDir(const std::string& filename) const
+    {
+#ifdef _WIN32
+        if( filename.find_first_of(':') != string::npos ) {
+            return filename;
+        }
+#else
+        if( filename[0] == '/' ) {
+            return filename;
+        }
+#endif
+        if( _modelsdir.size() > 0 ) {
+            string s = GetParseDirectory();
+            if( s.size() > 0 ) {
+                s += s_filesep;
+            }
+            s += _modelsdir;
+            std::string fullfilename = RaveFindLocalFile(filename, s);
+            if( fullfilename.size() > 0 ) {
+                return fullfilename;
+            }
+        }
+        return RaveFindLocalFile(filename, GetParseDirectory());
+    }
+
+    std::vector< std::pair<std::string, Vector> >& _vfilenamescales;
+    std::set<std::string>& _setvisited;
+    std::vector<std::string>& _vincludedfiles;
+    std::stringstream _ss;
+    std::string _modelsdir;
+    std::string _renderfilename;
+    Vector _renderscale;
+    bool _bInTriMesh, _bHasCollision;
+};
+
+/// \brief parses filedata and the xml files it includes for _ScanXMLFileGeometries
+static void _ScanXMLFileGeometriesNoCache(const std::string& filedata, std::vector< std::pair<std::string, Vector> >& vfilenamescales, std::vector<std::string>& vfiles)
+{
+    std::set<std::string> setvisited;
+    setvisited.insert(filedata);
+    vfiles.push_back(filedata);
+    // the prescan should not affect the error count of the actual parsing
+    int nerrorcount = GetXMLErrorCount();
+    for(size_t ifile = 0; ifile < vfiles.size(); ++ifile) {
+        // copy since vfiles can be resized by the reader
+        std::string curfilename = vfiles[ifile];
+        try {
+#ifdef HAVE_BOOST_FILESYSTEM
+            SetParseDirectoryScope scope(boost::filesystem::path(curfilename).parent_path().string());
+#endif
+            BaseXMLReaderPtr preader(new GeometryFilesXMLReader(vfilenamescales, setvisited, vfiles));
+            raveXmlSAXUserParseFile(GetSAXHandler(), preader, curfilename);
+        }
+        catch(const std::exception& ex) {
+            RAVELOG_DEBUG_FORMAT("failed to prescan %s: %s", curfilename%ex.what());
+        }
+    }
+    GetXMLErrorCount() = nerrorcount;
+}
+
+/// \brief result of _ScanXMLFileGeometries for one file, valid while none of the scanned xml files changed
+struct XMLFileScan
+{
+    std::vector<std::string> vfiles; ///< the scanned file and all the xml files it includes
+    std::vector< std::pair<int64_t, uint64_t> > vstamps; ///< RaveGetFileStamp of every file in vfiles when it was scanned
+    std::vector< std::pair<std::string, Vector> > vfilenamescales;
+};
+
+/// \brief cached prescans indexed by the full filename, protected by GetXMLMutex
+static std::map<std::string, XMLFileScan>& _GetXMLFileScans()
+{
+    static std::map<std::string, XMLFileScan> s_mapscans;
+    return s_mapscans;
+}
+
+/// \brief collects the trimesh geometry files of filedata and the xml files it includes. Has to be called with GetXMLMutex locked.
+///
+/// The prescan is reused without parsing anything as long as the modification time and size of all the scanned xml files are the same.
+/// \param vfiles filled with filedata and all the xml files it includes
+static void _ScanXMLFileGeometries(const std::string& filedata, std::vector< std::pair<std::string, Vector> >& vfilenamescales, std::vector<std::string>& vfiles)
+{
+    std::map<std::string, XMLFileScan>& mapscans = _GetXMLFileScans();
+    std::map<std::string, XMLFileScan>::const_iterator itscan = mapscans.find(filedata);
+    if( itscan != mapscans.end() ) {
+        bool bvalid = true;
+        for(size_t ifile = 0; ifile < itscan->second.vfiles.size() && bvalid; ++ifile) {
+            std::pair<int64_t, uint64_t> stamp(0,0);
+            bvalid = RaveGetFileStamp(itscan->second.vfiles[ifile], stamp.first, stamp.second) && stamp == itscan->second.vstamps.at(ifile);
+        }
+        if( bvalid ) {
+            vfilenamescales.insert(vfilenamescales.end(), itscan->second.vfilenamescales.begin(), itscan->second.vfilenamescales.end());
+            vfiles.insert(vfiles.end(), itscan->second.vfiles.begin(), itscan->second.vfiles.end());
+            return;
+        }
+    }
+
+    XMLFileScan scan;
+    _ScanXMLFileGeometriesNoCache(filedata, scan.vfilenamescales, scan.vfiles);
+    scan.vstamps.resize(scan.vfiles.size());
+    for(size_t ifile = 0; ifile < scan.vfiles.size(); ++ifile) {
+        if( !RaveGetFileStamp(scan.vfiles[ifile], scan.vstamps[ifile].first, scan.vstamps[ifile].second) ) {
+            // cannot tell when it changes, so always scan again
+            scan.vstamps.clear();
+            break;
+        }
+    }
+    vfilenamescales.insert(vfilenamescales.end(), scan.vfilenamescales.begin(), scan.vfilenamescales.end());
+    vfiles.insert(vfiles.end(), scan.vfiles.begin(), scan.vfiles.end());
+    if( scan.vstamps.size() == scan.vfiles.size() ) {
+        if( mapscans.size() >= 1024 ) {
+            mapscans.clear();
+        }
+        mapscans[filedata] = scan;
+    }
+}
+
+void PrefetchXMLFileGeometries(EnvironmentBasePtr penv, const std::string& filename, int nthreads)
+{
+    nthreads = _GetNumPrefetchThreads(nthreads);
+    if( nthreads == 0 ) {
+        // nothing would be prefetched, so do not even scan
+        return;
+    }
+    EnvironmentMutex::scoped_lock lock(*GetXMLMutex());
+    if( GetXMLFileParseDepth() > 0 ) {
+        // called from an include of a file whose geometries were already prefetched
+        return;
+    }
+    std::string filedata = RaveFindLocalFile(filename,GetParseDirectory());
+    if( filedata.size() == 0 ) {
+        return;
+    }
+
+    std::vector< std::pair<std::string, Vector> > vfilenamescales;
+    std::vector<std::string> vfiles;
+    _ScanXMLFileGeometries(filedata, vfilenamescales, vfiles);
+    PrefetchGeometryFiles(penv, vfilenamescales, nthreads);
+}
+
+bool GetXMLFileDependencies(const std::string& filename, std::vector<std::string>& vdependencies)
+{
+    vdependencies.resize(0);
+    EnvironmentMutex::scoped_lock lock(*GetXMLMutex());
+    std::string filedata = RaveFindLocalFile(filename,GetParseDirectory());
+    if( filedata.size() == 0 ) {
+        return false;
+    }
+    std::vector< std::pair<std::string, Vector> > vfilenamescales;
+    _ScanXMLFileGeometries(filedata, vfilenamescales, vdependencies);
+    FOREACHC(itfilenamescale, vfilenamescales) {
+        if( find(vdependencies.begin(), vdependencies.end(), itfilenamescale->first) == vdependencies.end() ) {
+            vdependencies.push_back(itfilenamescale->first);
+        }
+    }
+    return true;
+}
+
+void ClearMeshImportCache()
+{
+    MeshImportCache::GetInstance().Clear();
+    EnvironmentMutex::scoped_lock lock(*GetXMLMutex());
+    _GetXMLFileScans().clear();
+}
+
+void GetMeshImportCacheStats(uint64_t& nhits, uint64_t& nmisses, size_t& nentries)
+{
+    MeshImportCache::GetInstance().GetStats(nhits, nmisses, nentries);
+}
+
 // Joint Reader
 class JointXMLReader : public StreamXMLReader
 {
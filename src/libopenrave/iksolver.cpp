@@ -164,6 +164,18 @@ bool IkSolverBase::SolveAll(const IkParameterization& param, const std::vector<d
     return vsolutions.size() > 0;
 }
 
+int IkSolverBase::SolveAllBatch(const std::vector<IkParameterization>& params, int filteroptions, std::vector< std::vector<IkReturnPtr> >& vikreturns)
+{
+    vikreturns.resize(params.size());
+    int nsolved = 0;
+    for(size_t i = 0; i < params.size(); ++i) {
+        if( SolveAll(params[i],filteroptions,vikreturns[i]) ) {
+            ++nsolved;
+        }
+    }
+    return nsolved;
+}
+
 UserDataPtr IkSolverBase::RegisterCustomFilter(int32_t priority, const IkSolverBase::IkFilterCallbackFn &filterfn)
 {
     CustomIkSolverFilterDataPtr pdata(new CustomIkSolverFilterData(priority,filterfn,shared_iksolver()));
@@ -148,6 +148,7 @@ bool KinBody::KinBodyInfo::operator==(const KinBodyInfo& other) const {
            && _dofValues == other._dofValues
            && _transform == other._transform
            && _isRobot == other._isRobot
+           && _revision == other._revision
            && AreVectorsDeepEqual(_vLinkInfos, other._vLinkInfos)
            && AreVectorsDeepEqual(_vJointInfos, other._vJointInfos)
            && AreVectorsDeepEqual(_vGrabbedInfos, other._vGrabbedInfos)
@@ -166,6 +167,7 @@ void KinBody::KinBodyInfo::Reset()
     _vLinkInfos.clear();
     _vJointInfos.clear();
     _mReadableInterfaces.clear();
+    _revision = 0;
 }
 
 void KinBody::KinBodyInfo::SerializeJSON(rapidjson::Value& rKinBodyInfo, rapidjson::Document::AllocatorType& allocator, dReal fUnitScale, int options) const
@@ -184,6 +186,9 @@ void KinBody::KinBodyInfo::SerializeJSON(rapidjson::Value& rKinBodyInfo, rapidjs
     orjson::SetJsonValueByKey(rKinBodyInfo, "interfaceType", _interfaceType, allocator);
     orjson::SetJsonValueByKey(rKinBodyInfo, "transform", _transform, allocator);
     orjson::SetJsonValueByKey(rKinBodyInfo, "isRobot", _isRobot, allocator);
+    if (_revision != 0) {
+        orjson::SetJsonValueByKey(rKinBodyInfo, "revision", _revision, allocator);
+    }
 
     if (_dofValues.size() > 0) {
         rapidjson::Value dofValues;
@@ -258,6 +263,7 @@ void KinBody::KinBodyInfo::DeserializeJSON(const rapidjson::Value& value, dReal
 
     orjson::LoadJsonValueByKey(value, "interfaceType", _interfaceType);
     orjson::LoadJsonValueByKey(value, "isRobot", _isRobot);
+    orjson::LoadJsonValueByKey(value, "revision", _revision);
 
     if (value.HasMember("grabbed")) {
         _vGrabbedInfos.reserve(value["grabbed"].Size() + _vGrabbedInfos.size());
@@ -335,6 +341,8 @@ KinBody::KinBody(InterfaceType type, EnvironmentBasePtr penv) : InterfaceBase(ty
     _environmentid = 0;
     _nNonAdjacentLinkCache = 0x80000000;
     _nUpdateStampId = 0;
+    _infoRevision = 0;
+    _infoRevisionUpdateStamp = 0;
     _bAreAllJoints1DOFAndNonCircular = false;
 }
 
@@ -645,6 +653,7 @@ bool KinBody::InitFromKinBodyInfo(const KinBodyInfo& info)
     _id = info._id;
     _name = info._name;
     _referenceUri = info._referenceUri;
+    _infoRevision = 0; // set by the environment once the update is done
 
     FOREACH(it, info._mReadableInterfaces) {
         SetReadableInterface(it->first, it->second);
@@ -4816,6 +4825,25 @@ int8_t KinBody::DoesDOFAffectLink(int dofindex, int linkindex ) const
     return _vJointsAffectingLinks.at(jointindex*_veclinks.size()+linkindex);
 }
 
+ReadablePtr KinBody::SetReadableInterface(const std::string& id, ReadablePtr readable)
+{
+    ReadablePtr pprev = InterfaceBase::SetReadableInterface(id, readable);
+    _nUpdateStampId++; // readable interfaces are part of the info
+    return pprev;
+}
+
+void KinBody::ClearReadableInterfaces()
+{
+    InterfaceBase::ClearReadableInterfaces();
+    _nUpdateStampId++;
+}
+
+void KinBody::ClearReadableInterface(const std::string& id)
+{
+    InterfaceBase::ClearReadableInterface(id);
+    _nUpdateStampId++;
+}
+
 void KinBody::SetNonCollidingConfiguration()
 {
     _ResetInternalCollisionCache();
@@ -4825,6 +4853,7 @@ void KinBody::SetNonCollidingConfiguration()
 
 void KinBody::_ResetInternalCollisionCache()
 {
+    _nUpdateStampId++; // adjacency information changed
     _nNonAdjacentLinkCache = 0x80000000;
     FOREACH(it,_vNonAdjacentLinks) {
         it->resize(0);
@@ -5429,6 +5458,10 @@ void KinBody::ExtractInfo(KinBodyInfo& info)
     info._vGrabbedInfos.resize(0);
     GetGrabbedInfo(info._vGrabbedInfos);
 
+    // only report the revision if nothing changed since the body was last updated from the info
+    const bool bRevisionUpToDate = _infoRevision != 0 && GetUpdateStamp() == _infoRevisionUpdateStamp;
+    info._revision = bRevisionUpToDate ? _infoRevision : 0;
+
     KinBody::KinBodyStateSaver saver(shared_kinbody());
     vector<dReal> vZeros(GetDOF(), 0);
     SetDOFValues(vZeros, KinBody::CLA_Nothing);
@@ -5504,11 +5537,18 @@ void KinBody::ExtractInfo(KinBodyInfo& info)
             info._mReadableInterfaces[it->first] = pReadable;
         }
     }
+
+    saver.Restore();
+    saver.Release();
+    if( bRevisionUpToDate ) {
+        _infoRevisionUpdateStamp = GetUpdateStamp(); // restoring the state bumped the stamp, but the body is the same
+    }
 }
 
 UpdateFromInfoResult KinBody::UpdateFromKinBodyInfo(const KinBodyInfo& info)
 {
     UpdateFromInfoResult updateFromInfoResult = UFIR_NoChange;
+    _infoRevision = 0; // body might be partially updated if this fails
     if(info._id != _id) {
         RAVELOG_WARN_FORMAT("body %s update info ids do not match %s != %s", GetName()%_id%info._id);
     }
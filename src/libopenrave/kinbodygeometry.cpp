@@ -886,6 +886,11 @@ void KinBody::GeometryInfo::SerializeJSON(rapidjson::Value& rGeometryInfo, rapid
     case GT_TriMesh: {
         // has to be scaled correctly
         rapidjson::Value rTriMesh;
+        if( options & ISO_BinaryMesh ) {
+            orjson::SaveJsonBinaryTriMesh(rTriMesh, _meshcollision, fUnitScale, !!(options & ISO_BinaryMeshRaw), allocator);
+            rGeometryInfo.AddMember(rapidjson::Document::StringRefType("mesh"), rTriMesh, allocator);
+            break;
+        }
         rTriMesh.SetObject();
         rapidjson::Value rVertices;
         rVertices.SetArray();
@@ -525,66 +525,162 @@ void UpdateOrCreateInfo(const rapidjson::Value& value, std::vector<boost::shared
     vInfos.push_back(pNewInfo);
 }
 
+/// \brief finds the pointer in the unprocessed part [index, end) of vPointers that should be updated with pInfo by scanning
+///
+/// Prefers a pointer with both the same id and name, then the same id, then the same name. If pInfo has no id or name, matches the next pointer without id and name.
+/// \return the index of the pointer in vPointers or -1 if there is none
+template<typename InfoPtrType, typename PtrType>
+int FindExistingChildFromInfo(const InfoPtrType& pInfo, const std::vector<PtrType>& vPointers, int index)
+{
+    int iExistingSameId = -1, iExistingSameName = -1;
+    for (int iPointer = index; iPointer < (int)vPointers.size(); ++iPointer) {
+        const PtrType& pPointer = vPointers[iPointer];
+        // special case: no id or name, find next existing one that has no id or name
+        if (pInfo->GetId().empty() && pInfo->GetName().empty()) {
+            if (pPointer->GetId().empty() && pPointer->GetName().empty()) {
+                return iPointer;
+            }
+            continue;
+        }
+
+        bool bIdMatch = !pPointer->GetId().empty() && pPointer->GetId() == pInfo->GetId();
+        bool bNameMatch = !pPointer->GetName().empty() && pPointer->GetName() == pInfo->GetName();
+        if( bIdMatch && bNameMatch ) {
+            return iPointer;
+        }
+        if( bIdMatch && iExistingSameId < 0 ) {
+            iExistingSameId = iPointer;
+        }
+        if( bNameMatch && iExistingSameName < 0 ) {
+            iExistingSameName = iPointer;
+        }
+    }
+    return iExistingSameId >= 0 ? iExistingSameId : iExistingSameName;
+}
+
+/// \brief index of the unprocessed pointers of a vector by id and name, so that UpdateChildrenFromInfo does not have to scan the vector for every info.
+///
+/// Gives the same matches as FindExistingChildFromInfo as long as every processed or moved pointer is erased/inserted again.
+template<typename PtrType>
+class ChildrenIdNameIndex
+{
+public:
+    ChildrenIdNameIndex(const std::vector<PtrType>& vPointers) : _vPointers(vPointers) {
+        for (int iPointer = 0; iPointer < (int)vPointers.size(); ++iPointer) {
+            Insert(iPointer);
+        }
+    }
+
+    /// \brief adds the pointer currently at iPointer
+    void Insert(int iPointer) {
+        const std::string& id = _vPointers[iPointer]->GetId();
+        const std::string& name = _vPointers[iPointer]->GetName();
+        if (id.empty() && name.empty()) {
+            _setNoIdNameIndices.insert(iPointer);
+            return;
+        }
+        if (!id.empty()) {
+            _mapIdIndices[id].insert(iPointer);
+        }
+        if (!name.empty()) {
+            _mapNameIndices[name].insert(iPointer);
+        }
+    }
+
+    /// \brief removes the pointer currently at iPointer, has to be called before its id or name changes
+    void Erase(int iPointer) {
+        const std::string& id = _vPointers[iPointer]->GetId();
+        const std::string& name = _vPointers[iPointer]->GetName();
+        if (id.empty() && name.empty()) {
+            _setNoIdNameIndices.erase(iPointer);
+            return;
+        }
+        if (!id.empty()) {
+            _Erase(_mapIdIndices, id, iPointer);
+        }
+        if (!name.empty()) {
+            _Erase(_mapNameIndices, name, iPointer);
+        }
+    }
+
+    /// \brief same as FindExistingChildFromInfo
+    template<typename InfoPtrType>
+    int Find(const InfoPtrType& pInfo) const {
+        const std::string& id = pInfo->GetId();
+        const std::string& name = pInfo->GetName();
+        if (id.empty() && name.empty()) {
+            return _setNoIdNameIndices.empty() ? -1 : *_setNoIdNameIndices.begin();
+        }
+        if (!id.empty()) {
+            std::map<std::string, std::set<int> >::const_iterator itId = _mapIdIndices.find(id);
+            if (itId != _mapIdIndices.end()) {
+                if (!name.empty()) {
+                    FOREACHC(itIndex, itId->second) {
+                        if (_vPointers[*itIndex]->GetName() == name) {
+                            return *itIndex;
+                        }
+                    }
+                }
+                return *itId->second.begin();
+            }
+        }
+        if (!name.empty()) {
+            std::map<std::string, std::set<int> >::const_iterator itName = _mapNameIndices.find(name);
+            if (itName != _mapNameIndices.end()) {
+                return *itName->second.begin();
+            }
+        }
+        return -1;
+    }
+
+private:
+    static void _Erase(std::map<std::string, std::set<int> >& mapIndices, const std::string& key, int iPointer) {
+        std::map<std::string, std::set<int> >::iterator it = mapIndices.find(key);
+        if (it != mapIndices.end()) {
+            it->second.erase(iPointer);
+            if (it->second.empty()) {
+                mapIndices.erase(it);
+            }
+        }
+    }
+
+    const std::vector<PtrType>& _vPointers;
+    std::map<std::string, std::set<int> > _mapIdIndices, _mapNameIndices; ///< indices of the unprocessed pointers
+    std::set<int> _setNoIdNameIndices; ///< indices of the unprocessed pointers without id and name
+};
+
 /// \brief Recursively call UpdateFromInfo on children. If children need to be added or removed, require re-init. Returns false if update fails and caller should not continue with other parts of the update.
 template<typename InfoPtrType, typename PtrType>
 bool UpdateChildrenFromInfo(const std::vector<InfoPtrType>& vInfos, std::vector<PtrType>& vPointers, UpdateFromInfoResult& result)
 {
+    // scanning is faster than building the index for the few geometries of a link
+    boost::shared_ptr< ChildrenIdNameIndex<PtrType> > pIndex;
+    if( vPointers.size() > 16 ) {
+        pIndex.reset(new ChildrenIdNameIndex<PtrType>(vPointers));
+    }
+
     int index = 0;
     for (typename std::vector<InfoPtrType>::const_iterator itInfo = vInfos.begin(); itInfo != vInfos.end(); ++itInfo, ++index) {
         const InfoPtrType pInfo = *itInfo;
         PtrType pMatchExistingPointer;
 
         {
-            typename std::vector<PtrType>::iterator itExistingSameId = vPointers.end();
-            typename std::vector<PtrType>::iterator itExistingSameName = vPointers.end();
-            typename std::vector<PtrType>::iterator itExistingSameIdName = vPointers.end();
-            typename std::vector<PtrType>::iterator itExistingNoIdName = vPointers.end();
-
-            // search only in the unprocessed part of vPointers
-            if( (int)vPointers.size() > index ) {
-                for (typename std::vector<PtrType>::iterator itPointer = vPointers.begin() + index; itPointer != vPointers.end(); ++itPointer) {
-                    // special case: no id or name, find next existing one that has no id or name
-                    if (pInfo->GetId().empty() && pInfo->GetName().empty()) {
-                        if ((*itPointer)->GetId().empty() && (*itPointer)->GetName().empty()) {
-                            itExistingNoIdName = itPointer;
-                            break;
-                        }
-                        continue;
-                    }
-
-                    bool bIdMatch = !(*itPointer)->GetId().empty() && (*itPointer)->GetId() == pInfo->GetId();
-                    bool bNameMatch = !(*itPointer)->GetName().empty() && (*itPointer)->GetName() == pInfo->GetName();
-                    if( bIdMatch && bNameMatch ) {
-                        itExistingSameIdName = itPointer;
-                        itExistingSameId = itPointer;
-                        itExistingSameName = itPointer;
-                        break;
-                    }
-                    if( bIdMatch && itExistingSameId == vPointers.end() ) {
-                        itExistingSameId = itPointer;
-                    }
-                    if( bNameMatch && itExistingSameName == vPointers.end() ) {
-                        itExistingSameName = itPointer;
-                    }
+            int iExisting = !!pIndex ? pIndex->Find(pInfo) : FindExistingChildFromInfo(pInfo, vPointers, index);
+            if( iExisting >= 0 ) {
+                pMatchExistingPointer = vPointers[iExisting];
+                if( !!pIndex ) {
+                    pIndex->Erase(iExisting);
                 }
-            }
-            typename std::vector<PtrType>::iterator itExisting = itExistingSameIdName;
-            if( itExisting == vPointers.end() ) {
-                itExisting = itExistingSameId;
-            }
-            if( itExisting == vPointers.end() ) {
-                itExisting = itExistingSameName;
-            }
-            if( itExisting == vPointers.end() ) {
-                itExisting = itExistingNoIdName;
-            }
-            if( itExisting != vPointers.end() ) {
-                pMatchExistingPointer = *itExisting;
-                if (index != itExisting-vPointers.begin()) {
+                if (index != iExisting) {
                     // re-arrange vPointers according to the order of infos
-                    PtrType pTemp = vPointers[index];
+                    if( !!pIndex ) {
+                        pIndex->Erase(index);
+                    }
+                    vPointers[iExisting] = vPointers[index];
                     vPointers[index] = pMatchExistingPointer;
-                    *itExisting = pTemp;
+                    if( !!pIndex ) {
+                        pIndex->Insert(iExisting);
+                    }
                 }
             }
         }
@@ -22,6 +22,214 @@
 #include <msgpack.hpp>
 #include <rapidjson/document.h>
 
+namespace {
+
+class vbuffer {
+public:
+    vbuffer(std::vector<char>& v) : _v(v) { }
+    void write(const char* buf, size_t len) {
+        _v.insert(_v.end(), buf, buf+len);
+    }
+private:
+    std::vector<char>& _v;
+};
+
+class osbuffer {
+public:
+    osbuffer(std::ostream& os) : _os(os) { }
+    void write(const char* buf, size_t len) {
+        _os.write(buf, len);
+    }
+private:
+    std::ostream& _os;
+};
+
+/// \brief packs a rapidjson value straight into a stream
+template <typename Stream>
+class MsgPackValueWriter
+{
+public:
+    MsgPackValueWriter(Stream& stream) : _packer(stream) {
+    }
+
+    void Write(const rapidjson::Value& v)
+    {
+        switch (v.GetType()) {
+        case rapidjson::kNullType:
+            _packer.pack_nil();
+            break;
+        case rapidjson::kFalseType:
+            _packer.pack_false();
+            break;
+        case rapidjson::kTrueType:
+            _packer.pack_true();
+            break;
+        case rapidjson::kObjectType: {
+            // the bytes of raw binary blobs (see orjson::SaveJsonBinaryBlob) are not utf-8, so write them as bin
+            rapidjson::Value::ConstMemberIterator itencoding = v.FindMember("encoding");
+            bool bRawBlob = itencoding != v.MemberEnd() && itencoding->value.IsString() && strcmp(itencoding->value.GetString(), "raw") == 0;
+            _packer.pack_map(v.MemberCount());
+            for (rapidjson::Value::ConstMemberIterator it = v.MemberBegin(); it != v.MemberEnd(); ++it) {
+                _packer.pack_str(it->name.GetStringLength());
+                _packer.pack_str_body(it->name.GetString(), it->name.GetStringLength());
+                if( bRawBlob && it->value.IsString() && strcmp(it->name.GetString(), "data") == 0 ) {
+                    _packer.pack_bin(it->value.GetStringLength());
+                    _packer.pack_bin_body(it->value.GetString(), it->value.GetStringLength());
+                    continue;
+                }
+                Write(it->value);
+            }
+            break;
+        }
+        case rapidjson::kArrayType:
+            _packer.pack_array(v.Size());
+            for (rapidjson::Value::ConstValueIterator it = v.Begin(); it != v.End(); ++it) {
+                Write(*it);
+            }
+            break;
+        case rapidjson::kStringType:
+            _packer.pack_str(v.GetStringLength());
+            _packer.pack_str_body(v.GetString(), v.GetStringLength());
+            break;
+        case rapidjson::kNumberType:
+            if (v.IsInt()) {
+                _packer.pack_int(v.GetInt());
+            }
+            else if (v.IsUint()) {
+                _packer.pack_unsigned_int(v.GetUint());
+            }
+            else if (v.IsInt64()) {
+                _packer.pack_int64(v.GetInt64());
+            }
+            else if (v.IsUint64()) {
+                _packer.pack_uint64(v.GetUint64());
+            }
+            else {
+                _packer.pack_double(v.GetDouble());
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+protected:
+    msgpack::packer<Stream> _packer;
+};
+
+#if MSGPACK_VERSION_MAJOR >= 2
+
+/// \brief forwards msgpack parse events to a rapidjson document so that no msgpack object tree is allocated
+class RapidJsonMsgPackVisitor : public msgpack::null_visitor
+{
+public:
+    RapidJsonMsgPackVisitor(rapidjson::Document& handler) : _handler(handler), _bInKey(false) {
+    }
+
+    bool visit_nil() {
+        return !_bInKey && _handler.Null();
+    }
+    bool visit_boolean(bool v) {
+        return !_bInKey && _handler.Bool(v);
+    }
+    bool visit_positive_integer(uint64_t v) {
+        return !_bInKey && _handler.Uint64(v);
+    }
+    bool visit_negative_integer(int64_t v) {
+        return !_bInKey && _handler.Int64(v);
+    }
+    bool visit_float32(float v) {
+        return !_bInKey && _handler.Double(v);
+    }
+    bool visit_float64(double v) {
+        return !_bInKey && _handler.Double(v);
+    }
+    /// msgpack versions before 2.1 do not distinguish float32 and float64
+    bool visit_float(double v) {
+        return !_bInKey && _handler.Double(v);
+    }
+    bool visit_str(const char* v, uint32_t size) {
+        return _handler.String(v, size, true);
+    }
+    bool visit_bin(const char* v, uint32_t size) {
+        return _handler.String(v, size, true);
+    }
+    /// ext types have no json equivalent
+    bool visit_ext(const char* v, uint32_t size) {
+        return false;
+    }
+    bool start_array(uint32_t num) {
+        if( _bInKey ) {
+            return false;
+        }
+        _vcounts.push_back(num);
+        return _handler.StartArray();
+    }
+    bool end_array() {
+        uint32_t num = _vcounts.back();
+        _vcounts.pop_back();
+        return _handler.EndArray(num);
+    }
+    bool start_map(uint32_t num) {
+        if( _bInKey ) {
+            return false;
+        }
+        _vcounts.push_back(num);
+        return _handler.StartObject();
+    }
+    bool start_map_key() {
+        _bInKey = true;
+        return true;
+    }
+    bool end_map_key() {
+        _bInKey = false;
+        return true;
+    }
+    bool end_map() {
+        uint32_t num = _vcounts.back();
+        _vcounts.pop_back();
+        return _handler.EndObject(num);
+    }
+    void parse_error(size_t parsed_offset, size_t error_offset) {
+        throw OPENRAVE_EXCEPTION_FORMAT("failed to parse msgpack data at offset %d", error_offset, OpenRAVE::ORE_InvalidArguments);
+    }
+    void insufficient_bytes(size_t parsed_offset, size_t error_offset) {
+        throw OPENRAVE_EXCEPTION_FORMAT("msgpack data is truncated at offset %d", error_offset, OpenRAVE::ORE_InvalidArguments);
+    }
+
+private:
+    rapidjson::Document& _handler;
+    std::vector<uint32_t> _vcounts; ///< number of elements or members of every open array and map
+    bool _bInKey;
+};
+
+/// \brief generator for rapidjson::Document::Populate
+class MsgPackDocumentGenerator
+{
+public:
+    MsgPackDocumentGenerator(const char* data, size_t size) : _data(data), _size(size) {
+    }
+
+    bool operator()(rapidjson::Document& handler) {
+        RapidJsonMsgPackVisitor visitor(handler);
+        size_t offset = 0;
+        if( !msgpack::v2::parse(_data, _size, offset, visitor) ) {
+            throw OPENRAVE_EXCEPTION_FORMAT("failed to convert msgpack data at offset %d, map keys have to be strings and ext types are not supported", offset, OpenRAVE::ORE_InvalidArguments);
+        }
+        return true;
+    }
+
+private:
+    const char* _data;
+    size_t _size;
+};
+
+#endif
+
+} // end namespace
+
+#if MSGPACK_VERSION_MAJOR < 2
+
 namespace msgpack {
 
 MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS) {
@@ -75,236 +283,50 @@ struct convert< rapidjson::GenericDocument<Encoding, Allocator, StackAllocator>
     }
 };
 
-template <typename Encoding, typename Allocator>
-struct convert< rapidjson::GenericValue<Encoding, Allocator> > {
-    msgpack::object const& operator()(msgpack::object const& o, rapidjson::GenericValue<Encoding, Allocator>& v) const {
-        rapidjson::GenericDocument<Encoding, Allocator> d;
-        o >> d;
-        return v = d;
-    }
-};
-
-template <typename Encoding, typename Allocator>
-struct pack< rapidjson::GenericValue<Encoding, Allocator> > {
-    template <typename Stream>
-    msgpack::packer<Stream>& operator()(msgpack::packer<Stream>& o, rapidjson::GenericValue<Encoding, Allocator> const& v) const {
-        switch (v.GetType())
-        {
-            case rapidjson::kNullType:
-                return o.pack_nil();
-            case rapidjson::kFalseType:
-                return o.pack_false();
-            case rapidjson::kTrueType:
-                return o.pack_true();
-            case rapidjson::kObjectType:
-            {
-                o.pack_map(v.MemberCount());
-                typename rapidjson::GenericValue<Encoding, Allocator>::ConstMemberIterator i = v.MemberBegin(), END = v.MemberEnd();
-                for (; i != END; ++i)
-                {
-                    o.pack_str(i->name.GetStringLength()).pack_str_body(i->name.GetString(), i->name.GetStringLength());
-                    o.pack(i->value);
-                }
-                return o;
-            }
-            case rapidjson::kArrayType:
-            {
-                o.pack_array(v.Size());
-                typename rapidjson::GenericValue<Encoding, Allocator>::ConstValueIterator i = v.Begin(), END = v.End();
-                for (;i < END; ++i)
-                    o.pack(*i);
-                return o;
-            }
-            case rapidjson::kStringType:
-                return o.pack_str(v.GetStringLength()).pack_str_body(v.GetString(), v.GetStringLength());
-            case rapidjson::kNumberType:
-                if (v.IsInt())
-                    return o.pack_int(v.GetInt());
-                if (v.IsUint())
-                    return o.pack_unsigned_int(v.GetUint());
-                if (v.IsInt64())
-                    return o.pack_int64(v.GetInt64());
-                if (v.IsUint64())
-                    return o.pack_uint64(v.GetUint64());
-                if (v.IsDouble()||v.IsNumber())
-                    return o.pack_double(v.GetDouble());
-            default:
-                return o;
-        }
-    }
-};
-
-template <typename Encoding, typename Allocator, typename StackAllocator>
-struct pack< rapidjson::GenericDocument<Encoding, Allocator, StackAllocator> > {
-    template <typename Stream>
-    msgpack::packer<Stream>& operator()(msgpack::packer<Stream>& o, rapidjson::GenericDocument<Encoding, Allocator, StackAllocator> const& v) const {
-        o << static_cast<const rapidjson::GenericValue<Encoding, Allocator>&>(v);
-        return o;
-    }
-};
-
-template <typename Encoding, typename Allocator>
-struct object_with_zone< rapidjson::GenericValue<Encoding, Allocator> > {
-    void operator()(msgpack::object::with_zone& o, rapidjson::GenericValue<Encoding, Allocator> const& v) const {
-        switch (v.GetType())
-        {
-            case rapidjson::kNullType:
-                o.type = type::NIL;
-                break;
-            case rapidjson::kFalseType:
-                o.type = type::BOOLEAN;
-                o.via.boolean = false;
-                break;
-            case rapidjson::kTrueType:
-                o.type = type::BOOLEAN;
-                o.via.boolean = true;
-                break;
-            case rapidjson::kObjectType:
-            {
-                o.type = type::MAP;
-                if (v.ObjectEmpty()) {
-                    o.via.map.ptr = NULL;
-                    o.via.map.size = 0;
-                }
-                else {
-                    size_t sz = v.MemberCount();
-                    object_kv* p = (object_kv*)o.zone.allocate_align(sizeof(object_kv)*sz);
-                    object_kv* const pend = p + sz;
-                    o.via.map.ptr = p;
-                    o.via.map.size = sz;
-                    typename rapidjson::GenericValue<Encoding, Allocator>::ConstMemberIterator it(v.MemberBegin());
-                    do {
-                        p->key = msgpack::object(it->name, o.zone);
-                        p->val = msgpack::object(it->value, o.zone);
-                        ++p;
-                        ++it;
-                    } while (p < pend);
-                }
-                break;
-            }
-            case rapidjson::kArrayType:
-            {
-                o.type = type::ARRAY;
-                if (v.Empty()) {
-                    o.via.array.ptr = NULL;
-                    o.via.array.size = 0;
-                }
-                else {
-                    msgpack::object* p = (msgpack::object*)o.zone.allocate_align(sizeof(msgpack::object)*v.Size());
-                    msgpack::object* const pend = p + v.Size();
-                    o.via.array.ptr = p;
-                    o.via.array.size = v.Size();
-                    typename rapidjson::GenericValue<Encoding, Allocator>::ConstValueIterator it(v.Begin());
-                    do {
-                        *p = msgpack::object(*it, o.zone);
-                        ++p;
-                        ++it;
-                    } while (p < pend);
-                }
-                break;
-            }
-            case rapidjson::kStringType:
-            {
-                o.type = type::STR;
-                size_t size = v.GetStringLength();
-                char* ptr = (char*)o.zone.allocate_align(size);
-                memcpy(ptr, v.GetString(), size);
-                o.via.str.ptr = ptr;
-                o.via.str.size = size;
-                break;
-            }
-            case rapidjson::kNumberType:
-                if (v.IsInt())
-                {
-                    o.type = type::NEGATIVE_INTEGER;
-                    o.via.i64 = v.GetInt();
-                }
-                else if (v.IsUint())
-                {
-                    o.type = type::POSITIVE_INTEGER;
-                    o.via.u64 = v.GetUint();
-                }
-                else if (v.IsInt64())
-                {
-                    o.type = type::NEGATIVE_INTEGER;
-                    o.via.i64 = v.GetInt64();
-                }
-                else if (v.IsUint64())
-                {
-                    o.type = type::POSITIVE_INTEGER;
-                    o.via.u64 = v.GetUint64();
-                }
-                else if (v.IsDouble())
-                {
-                    o.type = type::FLOAT;
-                    o.via.f64 = v.GetDouble();
-                }
-                break;
-            default:
-                break;
-
-        }
-    }
-};
-
-template <typename Encoding, typename Allocator, typename StackAllocator>
-struct object_with_zone< rapidjson::GenericDocument<Encoding, Allocator, StackAllocator> > {
-    void operator()(msgpack::object::with_zone& o, rapidjson::GenericDocument<Encoding, Allocator, StackAllocator> const& v) const {
-        o << static_cast<rapidjson::GenericValue<Encoding, Allocator> const&>(v);
-    }
-};
-
 } // namespace adaptor
 
-class vbuffer {
-public:
-    vbuffer(std::vector<char>& v) : _v(v) { }
-    void write(const char* buf, size_t len) {
-        std::copy_n(buf, len, std::back_inserter(_v));
-    }
-private:
-    std::vector<char>& _v;
-};
-
-
-class osbuffer {
-public:
-    osbuffer(std::ostream& os) : _os(os) { }
-    void write(const char* buf, size_t len) {
-        _os.write(buf, len);
-    }
-private:
-    std::ostream& _os;
-};
-
 } // MSGPACK_API_VERSION_NAMESPACE(MSGPACK_DEFAULT_API_NS)
 
 } // namespace msgpack
 
+#endif
+
 void OpenRAVE::MsgPack::DumpMsgPack(const rapidjson::Value& value, std::ostream& os)
 {
-    msgpack::osbuffer buf(os);
-    msgpack::pack(&buf, value);
+    osbuffer buf(os);
+    MsgPackValueWriter<osbuffer> writer(buf);
+    writer.Write(value);
 }
 
 void OpenRAVE::MsgPack::DumpMsgPack(const rapidjson::Value& value, std::vector<char>& output)
-{   
-    msgpack::vbuffer buf(output);
-    msgpack::pack(&buf, value);
+{
+    vbuffer buf(output);
+    MsgPackValueWriter<vbuffer> writer(buf);
+    writer.Write(value);
 }
 
-void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const std::string& str)
+void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const char* data, size_t size)
 {
+#if MSGPACK_VERSION_MAJOR >= 2
+    MsgPackDocumentGenerator generator(data, size);
+    d.Populate(generator);
+#else
     msgpack::unpacked unpacked;
-    msgpack::unpack(&unpacked, str.data(), str.size());
+    msgpack::unpack(&unpacked, data, size);
     unpacked.get().convert(d);
+#endif
+}
+
+void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const std::string& str)
+{
+    OpenRAVE::MsgPack::ParseMsgPack(d, str.data(), str.size());
 }
 
 void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, std::istream& is)
 {
     std::string str;
     str.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
-    OpenRAVE::MsgPack::ParseMsgPack(d, str);
+    OpenRAVE::MsgPack::ParseMsgPack(d, str.data(), str.size());
 }
 
 #else
@@ -329,4 +351,9 @@ void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, std::istream& is)
     throw OPENRAVE_EXCEPTION_FORMAT0("MsgPack support is not enabled", ORE_NotImplemented);
 }
 
+void OpenRAVE::MsgPack::ParseMsgPack(rapidjson::Document& d, const char* data, size_t size)
+{
+    throw OPENRAVE_EXCEPTION_FORMAT0("MsgPack support is not enabled", ORE_NotImplemented);
+}
+
 #endif
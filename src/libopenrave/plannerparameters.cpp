@@ -37,7 +37,7 @@ typedef bai::base64_from_binary<    // convert binary values to base64 character
             >
         > base64_text;
 
-WorkspaceTrajectoryParameters::WorkspaceTrajectoryParameters(EnvironmentBasePtr penv) : maxdeviationangle(0.15*PI), maintaintiming(false), greedysearch(true), ignorefirstcollision(0), ignorefirstcollisionee(0), ignorelastcollisionee(0), minimumcompletetime(0), _penv(penv), _bProcessing(false) {
+WorkspaceTrajectoryParameters::WorkspaceTrajectoryParameters(EnvironmentBasePtr penv) : maxdeviationangle(0.15*PI), maintaintiming(false), greedysearch(true), ignorefirstcollision(0), ignorefirstcollisionee(0), ignorelastcollisionee(0), minimumcompletetime(0), highratetracking(false), highratecheckinterval(10), _penv(penv), _bProcessing(false) {
     _vXMLParameters.push_back("maxdeviationangle");
     _vXMLParameters.push_back("maintaintiming");
     _vXMLParameters.push_back("greedysearch");
@@ -45,6 +45,8 @@ WorkspaceTrajectoryParameters::WorkspaceTrajectoryParameters(EnvironmentBasePtr
     _vXMLParameters.push_back("ignorefirstcollisionee");
     _vXMLParameters.push_back("ignorelastcollisionee");
     _vXMLParameters.push_back("minimumcompletetime");
+    _vXMLParameters.push_back("highratetracking");
+    _vXMLParameters.push_back("highratecheckinterval");
     _vXMLParameters.push_back("workspacetrajectory");
 }
 
@@ -61,6 +63,8 @@ bool WorkspaceTrajectoryParameters::serialize(std::ostream& O, int options) cons
     O << "<ignorefirstcollisionee>" << ignorefirstcollisionee << "</ignorefirstcollisionee>" << std::endl;
     O << "<ignorelastcollisionee>" << ignorelastcollisionee << "</ignorelastcollisionee>" << std::endl;
     O << "<minimumcompletetime>" << minimumcompletetime << "</minimumcompletetime>" << std::endl;
+    O << "<highratetracking>" << highratetracking << "</highratetracking>" << std::endl;
+    O << "<highratecheckinterval>" << highratecheckinterval << "</highratecheckinterval>" << std::endl;
     if( !!workspacetraj ) {
         O << "<workspacetrajectory><![CDATA[";
 
@@ -101,7 +105,7 @@ BaseXMLReader::ProcessElement WorkspaceTrajectoryParameters::startElement(const
 //        _bProcessing = false;
 //        return PE_Support;
 //    }
-    _bProcessing = name=="maxdeviationangle" || name=="maintaintiming" || name=="greedysearch" || name=="ignorefirstcollision" || name=="ignorefirstcollisionee" || name=="ignorelastcollisionee" || name=="minimumcompletetime" || name=="workspacetrajectory";
+    _bProcessing = name=="maxdeviationangle" || name=="maintaintiming" || name=="greedysearch" || name=="ignorefirstcollision" || name=="ignorefirstcollisionee" || name=="ignorelastcollisionee" || name=="minimumcompletetime" || name=="highratetracking" || name=="highratecheckinterval" || name=="workspacetrajectory";
     return _bProcessing ? PE_Support : PE_Pass;
 }
 
@@ -141,6 +145,12 @@ bool WorkspaceTrajectoryParameters::endElement(const std::string& name)
         else if( name == "minimumcompletetime" ) {
             _ss >> minimumcompletetime;
         }
+        else if( name == "highratetracking" ) {
+            _ss >> highratetracking;
+        }
+        else if( name == "highratecheckinterval" ) {
+            _ss >> highratecheckinterval;
+        }
         else if( name == "workspacetrajectory" ) {
             if( !workspacetraj ) {
                 workspacetraj = RaveCreateTrajectory(_penv,"");
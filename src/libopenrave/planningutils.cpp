@@ -404,7 +404,8 @@ public:
         OPENRAVE_ASSERT_OP_FORMAT0((int)_parameters->_vConfigResolution.size(), ==, _parameters->GetDOF(), "unexpected size",ORE_InvalidState);
     }
 
-    void VerifyTrajectory(TrajectoryBaseConstPtr trajectory, dReal samplingstep)
+    /// \param pool if initialized, the sampled segments are checked on the worker contexts of the pool
+    void VerifyTrajectory(TrajectoryBaseConstPtr trajectory, dReal samplingstep, PlannerParametersWorkerPoolPtr pool=PlannerParametersWorkerPoolPtr(), int nsegmentsperchunk=1)
     {
         OPENRAVE_ASSERT_FORMAT0(!!trajectory,"need valid trajectory",ORE_InvalidArguments);
 
@@ -417,7 +418,6 @@ public:
         fresolutionmean /= _parameters->_vConfigResolution.size();
 
         dReal fthresh = 5e-5f;
-        vector<dReal> deltaq(_parameters->GetDOF(),0);
         std::vector<dReal> vdata, vdatavel, vdiff;
         for(size_t ipoint = 0; ipoint < trajectory->GetNumWaypoints(); ++ipoint) {
             trajectory->GetWaypoint(ipoint,vdata,_parameters->_configurationspecification);
@@ -491,59 +491,45 @@ public:
                 }
                 IntervalType interval = bHasAllLinearInterpolation ? (IntervalType)(IT_Closed | IT_AllLinear) : IT_Closed;
 
-                std::vector<dReal> vprevdata, vprevdatavel;
-                ConstraintFilterReturnPtr filterreturn(new ConstraintFilterReturn());
-                trajectory->Sample(vprevdata,0,_parameters->_configurationspecification);
-                trajectory->Sample(vprevdatavel,0,velspec);
-                std::vector<dReal>::iterator itprevtime = vsampletimes.begin();
+                // sample all the configurations on this thread, only the constraint checking is distributed
+                std::vector<dReal> vsegmenttimes;
+                vsegmenttimes.reserve(vsampletimes.size());
+                vsegmenttimes.push_back(vsampletimes.at(0));
                 for(std::vector<dReal>::iterator itsampletime = vsampletimes.begin()+1; itsampletime != vsampletimes.end(); ++itsampletime) {
-                    if (*itsampletime < *itprevtime + 1e-5 ) {
+                    if (*itsampletime < vsegmenttimes.back() + 1e-5 ) {
                         continue;
                     }
-                    filterreturn->Clear();
-                    trajectory->Sample(vdata,*itsampletime,_parameters->_configurationspecification);
-                    trajectory->Sample(vdatavel,*itsampletime,velspec);
-                    dReal deltatime = *itsampletime - *itprevtime;
-                    vdiff = vdata;
-                    _parameters->_diffstatefn(vdiff,vprevdata);
-                    for(size_t i = 0; i < _parameters->_vConfigVelocityLimit.size(); ++i) {
-                        dReal velthresh = _parameters->_vConfigVelocityLimit.at(i)*deltatime+fthresh;
-                        OPENRAVE_ASSERT_OP_FORMAT(RaveFabs(vdiff.at(i)), <=, velthresh, "time %fs-%fs, dof %d traveled %f, but maxvelocity only allows %f, wrote trajectory to %s",*itprevtime%*itsampletime%i%RaveFabs(vdiff.at(i))%velthresh%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
-                    }
-                    if( _parameters->CheckPathAllConstraints(vprevdata,vdata,vprevdatavel, vdatavel, deltatime, interval, 0xffff|CFO_FillCheckedConfiguration, filterreturn) != 0 ) {
-                        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-                            _parameters->CheckPathAllConstraints(vprevdata,vdata,vprevdatavel, vdatavel, deltatime, interval, 0xffff|CFO_FillCheckedConfiguration, filterreturn);
-                        }
-                        throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, CheckPathAllConstraints failed, wrote trajectory to %s"),*itprevtime%*itsampletime%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
-                    }
-                    OPENRAVE_ASSERT_OP(filterreturn->_configurations.size()%_parameters->GetDOF(),==,0);
-                    std::vector<dReal>::iterator itprevconfig = filterreturn->_configurations.begin();
-                    std::vector<dReal>::iterator itcurconfig = itprevconfig + _parameters->GetDOF();
-                    for(; itcurconfig != filterreturn->_configurations.end(); itcurconfig += _parameters->GetDOF()) {
-                        std::vector<dReal> vprevconfig(itprevconfig,itprevconfig+_parameters->GetDOF());
-                        std::vector<dReal> vcurconfig(itcurconfig,itcurconfig+_parameters->GetDOF());
-                        for(int i = 0; i < _parameters->GetDOF(); ++i) {
-                            deltaq.at(i) = vcurconfig.at(i) - vprevconfig.at(i);
-                        }
-                        if( _parameters->SetStateValues(vprevconfig, 0) != 0 ) {
-                            throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, failed to set state values"), *itprevtime%*itsampletime, ORE_InconsistentConstraints);
-                        }
-                        vector<dReal> vtemp = vprevconfig;
-                        if( _parameters->_neighstatefn(vtemp,deltaq,NSO_OnlyHardConstraints) == NSS_Failed ) {
-                            throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, neighstatefn is rejecting configurations from CheckPathAllConstraints, wrote trajectory to %s"),*itprevtime%*itsampletime%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
-                        }
-                        else {
-                            dReal fprevdist = _parameters->_distmetricfn(vprevconfig,vtemp);
-                            dReal fcurdist = _parameters->_distmetricfn(vcurconfig,vtemp);
-                            if( fprevdist > g_fEpsilonLinear ) {
-                                OPENRAVE_ASSERT_OP_FORMAT(fprevdist, >, fcurdist, "time %fs-%fs, neighstatefn returned a configuration closer to the previous configuration %f than the expected current %f, wrote trajectory to %s",*itprevtime%*itsampletime%fprevdist%fcurdist%DumpTrajectory(trajectory), ORE_InconsistentConstraints);
-                            }
-                        }
-                        itprevconfig=itcurconfig;
+                    vsegmenttimes.push_back(*itsampletime);
+                }
+                _vsegmentdata.resize(vsegmenttimes.size()*_parameters->GetDOF());
+                _vsegmentdatavel.resize(vsegmenttimes.size()*_parameters->GetDOF());
+                for(size_t isample = 0; isample < vsegmenttimes.size(); ++isample) {
+                    // first sample is always at 0
+                    dReal fsampletime = isample == 0 ? 0 : vsegmenttimes[isample];
+                    trajectory->Sample(vdata,fsampletime,_parameters->_configurationspecification);
+                    trajectory->Sample(vdatavel,fsampletime,velspec);
+                    std::copy(vdata.begin(), vdata.end(), _vsegmentdata.begin()+isample*_parameters->GetDOF());
+                    std::copy(vdatavel.begin(), vdatavel.end(), _vsegmentdatavel.begin()+isample*_parameters->GetDOF());
+                }
+                _vsegmenttimes.swap(vsegmenttimes);
+
+                int nsegments = (int)_vsegmenttimes.size()-1;
+                if( !pool ) {
+                    ConstraintFilterReturnPtr filterreturn(new ConstraintFilterReturn());
+                    for(int isegment = 0; isegment < nsegments; ++isegment) {
+                        _CheckSampledSegment(_parameters, trajectory, isegment, interval, filterreturn);
                     }
-                    vprevdata.swap(vdata);
-                    vprevdatavel.swap(vdatavel);
-                    itprevtime = itsampletime;
+                }
+                else if( nsegments > 0 ) {
+                    if( nsegmentsperchunk <= 0 ) {
+                        nsegmentsperchunk = 1;
+                    }
+                    std::vector<ConstraintFilterReturnPtr> vfilterreturns(pool->GetNumWorkers());
+                    FOREACH(itfilterreturn, vfilterreturns) {
+                        itfilterreturn->reset(new ConstraintFilterReturn());
+                    }
+                    int nchunks = (nsegments+nsegmentsperchunk-1)/nsegmentsperchunk;
+                    pool->Evaluate(nchunks, boost::bind(&TrajectoryVerifier::_CheckSampledSegmentChunk, this, pool, trajectory, interval, nsegmentsperchunk, boost::ref(vfilterreturns), _1, _2));
                 }
             }
             else {
@@ -559,6 +545,7 @@ public:
 
     string DumpTrajectory(TrajectoryBaseConstPtr trajectory)
     {
+        boost::mutex::scoped_lock lock(_mutexDump);
         string filename = str(boost::format("%s/failedtrajectory%d.xml")%RaveGetHomeDirectory()%(RaveRandomInt()%1000));
         ofstream f(filename.c_str());
         f << std::setprecision(std::numeric_limits<dReal>::digits10+1);     /// have to do this or otherwise precision gets lost
@@ -567,7 +554,78 @@ public:
     }
 
 protected:
+    /// \brief checks the segment between sampled configurations isegment and isegment+1 with params, throws on failure
+    void _CheckSampledSegment(PlannerBase::PlannerParametersConstPtr params, TrajectoryBaseConstPtr trajectory, int isegment, IntervalType interval, ConstraintFilterReturnPtr filterreturn)
+    {
+        const dReal fthresh = 5e-5f;
+        const int dof = params->GetDOF();
+        const dReal fprevtime = _vsegmenttimes.at(isegment), ftime = _vsegmenttimes.at(isegment+1);
+        std::vector<dReal> vprevdata(_vsegmentdata.begin()+isegment*dof, _vsegmentdata.begin()+(isegment+1)*dof);
+        std::vector<dReal> vdata(_vsegmentdata.begin()+(isegment+1)*dof, _vsegmentdata.begin()+(isegment+2)*dof);
+        std::vector<dReal> vprevdatavel(_vsegmentdatavel.begin()+isegment*dof, _vsegmentdatavel.begin()+(isegment+1)*dof);
+        std::vector<dReal> vdatavel(_vsegmentdatavel.begin()+(isegment+1)*dof, _vsegmentdatavel.begin()+(isegment+2)*dof);
+        std::vector<dReal> deltaq(dof,0);
+
+        filterreturn->Clear();
+        dReal deltatime = ftime - fprevtime;
+        std::vector<dReal> vdiff = vdata;
+        params->_diffstatefn(vdiff,vprevdata);
+        for(size_t i = 0; i < params->_vConfigVelocityLimit.size(); ++i) {
+            dReal velthresh = params->_vConfigVelocityLimit.at(i)*deltatime+fthresh;
+            OPENRAVE_ASSERT_OP_FORMAT(RaveFabs(vdiff.at(i)), <=, velthresh, "time %fs-%fs, dof %d traveled %f, but maxvelocity only allows %f, wrote trajectory to %s",fprevtime%ftime%i%RaveFabs(vdiff.at(i))%velthresh%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
+        }
+        if( params->CheckPathAllConstraints(vprevdata,vdata,vprevdatavel, vdatavel, deltatime, interval, 0xffff|CFO_FillCheckedConfiguration, filterreturn) != 0 ) {
+            if( IS_DEBUGLEVEL(Level_Verbose) ) {
+                params->CheckPathAllConstraints(vprevdata,vdata,vprevdatavel, vdatavel, deltatime, interval, 0xffff|CFO_FillCheckedConfiguration, filterreturn);
+            }
+            throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, CheckPathAllConstraints failed, wrote trajectory to %s"),fprevtime%ftime%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
+        }
+        OPENRAVE_ASSERT_OP(filterreturn->_configurations.size()%dof,==,0);
+        std::vector<dReal>::iterator itprevconfig = filterreturn->_configurations.begin();
+        std::vector<dReal>::iterator itcurconfig = itprevconfig + dof;
+        for(; itcurconfig != filterreturn->_configurations.end(); itcurconfig += dof) {
+            std::vector<dReal> vprevconfig(itprevconfig,itprevconfig+dof);
+            std::vector<dReal> vcurconfig(itcurconfig,itcurconfig+dof);
+            for(int i = 0; i < dof; ++i) {
+                deltaq.at(i) = vcurconfig.at(i) - vprevconfig.at(i);
+            }
+            if( params->SetStateValues(vprevconfig, 0) != 0 ) {
+                throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, failed to set state values"), fprevtime%ftime, ORE_InconsistentConstraints);
+            }
+            vector<dReal> vtemp = vprevconfig;
+            if( params->_neighstatefn(vtemp,deltaq,NSO_OnlyHardConstraints) == NSS_Failed ) {
+                throw OPENRAVE_EXCEPTION_FORMAT(_("time %fs-%fs, neighstatefn is rejecting configurations from CheckPathAllConstraints, wrote trajectory to %s"),fprevtime%ftime%DumpTrajectory(trajectory),ORE_InconsistentConstraints);
+            }
+            else {
+                dReal fprevdist = params->_distmetricfn(vprevconfig,vtemp);
+                dReal fcurdist = params->_distmetricfn(vcurconfig,vtemp);
+                if( fprevdist > g_fEpsilonLinear ) {
+                    OPENRAVE_ASSERT_OP_FORMAT(fprevdist, >, fcurdist, "time %fs-%fs, neighstatefn returned a configuration closer to the previous configuration %f than the expected current %f, wrote trajectory to %s",fprevtime%ftime%fprevdist%fcurdist%DumpTrajectory(trajectory), ORE_InconsistentConstraints);
+                }
+            }
+            itprevconfig=itcurconfig;
+        }
+    }
+
+    /// \brief checks all the segments of one chunk on a worker of the pool, stops early if an earlier chunk already failed
+    int _CheckSampledSegmentChunk(PlannerParametersWorkerPoolPtr pool, TrajectoryBaseConstPtr trajectory, IntervalType interval, int nsegmentsperchunk, std::vector<ConstraintFilterReturnPtr>& vfilterreturns, int iworker, int ichunk)
+    {
+        int nsegments = (int)_vsegmenttimes.size()-1;
+        int isegmentend = min(nsegments, (ichunk+1)*nsegmentsperchunk);
+        for(int isegment = ichunk*nsegmentsperchunk; isegment < isegmentend; ++isegment) {
+            if( pool->IsCancelled(ichunk) ) {
+                break;
+            }
+            _CheckSampledSegment(pool->GetWorkerParameters(iworker), trajectory, isegment, interval, vfilterreturns.at(iworker));
+        }
+        return 0;
+    }
+
     PlannerBase::PlannerParametersConstPtr _parameters;
+
+    std::vector<dReal> _vsegmenttimes; ///< start times of the sampled segments, the last entry is the end time of the last segment
+    std::vector<dReal> _vsegmentdata, _vsegmentdatavel; ///< sampled configurations and velocities at _vsegmenttimes, _vsegmenttimes.size()*dof
+    boost::mutex _mutexDump; ///< workers can fail concurrently
 };
 
 void VerifyTrajectory(PlannerBase::PlannerParametersConstPtr parameters, TrajectoryBaseConstPtr trajectory, dReal samplingstep)
@@ -581,6 +639,90 @@ void VerifyTrajectory(PlannerBase::PlannerParametersConstPtr parameters, Traject
     v.VerifyTrajectory(trajectory,samplingstep);
 }
 
+/// \brief worker pools kept by VerifyTrajectoryParallel for the environments that were verified last.
+///
+/// A pool is removed while it is used, so concurrent calls on the same environment each get their own pool. Neither the pools nor the list keep
+/// the environments alive, the pools of destroyed environments are dropped on the next access.
+static boost::mutex s_mutexVerifyTrajectoryPools;
+static std::list< std::pair<EnvironmentBaseWeakPtr, PlannerParametersWorkerPoolPtr> > s_listVerifyTrajectoryPools; ///< most recently used first
+static const size_t s_nMaxVerifyTrajectoryPools = 4;
+
+/// \brief removes the pools of the destroyed environments, s_mutexVerifyTrajectoryPools has to be locked
+static void _RemoveExpiredVerifyTrajectoryPools()
+{
+    std::list< std::pair<EnvironmentBaseWeakPtr, PlannerParametersWorkerPoolPtr> >::iterator it = s_listVerifyTrajectoryPools.begin();
+    while( it != s_listVerifyTrajectoryPools.end() ) {
+        if( it->first.expired() ) {
+            it = s_listVerifyTrajectoryPools.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+static PlannerParametersWorkerPoolPtr _PopVerifyTrajectoryPool(EnvironmentBasePtr penv)
+{
+    PlannerParametersWorkerPoolPtr pool;
+    boost::mutex::scoped_lock lock(s_mutexVerifyTrajectoryPools);
+    _RemoveExpiredVerifyTrajectoryPools();
+    for(std::list< std::pair<EnvironmentBaseWeakPtr, PlannerParametersWorkerPoolPtr> >::iterator it = s_listVerifyTrajectoryPools.begin(); it != s_listVerifyTrajectoryPools.end(); ++it) {
+        if( it->first.lock() == penv ) {
+            pool = it->second;
+            s_listVerifyTrajectoryPools.erase(it);
+            break;
+        }
+    }
+    return pool;
+}
+
+static void _PushVerifyTrajectoryPool(EnvironmentBasePtr penv, PlannerParametersWorkerPoolPtr pool)
+{
+    boost::mutex::scoped_lock lock(s_mutexVerifyTrajectoryPools);
+    _RemoveExpiredVerifyTrajectoryPools();
+    s_listVerifyTrajectoryPools.push_front(std::make_pair(EnvironmentBaseWeakPtr(penv), pool));
+    while( s_listVerifyTrajectoryPools.size() > s_nMaxVerifyTrajectoryPools ) {
+        s_listVerifyTrajectoryPools.pop_back();
+    }
+}
+
+void VerifyTrajectoryParallel(PlannerBase::PlannerParametersConstPtr parameters, TrajectoryBaseConstPtr trajectory, PlannerParametersWorkerPoolPtr pool, dReal samplingstep, int nsegmentsperchunk)
+{
+    if( !parameters ) {
+        PlannerBase::PlannerParametersPtr newparams(new PlannerBase::PlannerParameters());
+        newparams->SetConfigurationSpecification(trajectory->GetEnv(), trajectory->GetConfigurationSpecification().GetTimeDerivativeSpecification(0));
+        parameters = newparams;
+    }
+    if( !!pool ) {
+        pool->Synchronize();
+        // the workers have to check with the same parameters as the sequential verification
+        pool->SetParameters(parameters);
+        TrajectoryVerifier v(parameters);
+        v.VerifyTrajectory(trajectory,samplingstep,pool,nsegmentsperchunk);
+        return;
+    }
+
+    // cloning the worker environments is expensive, so keep the pool of the environment for the next call
+    EnvironmentBasePtr penv = trajectory->GetEnv();
+    pool = _PopVerifyTrajectoryPool(penv);
+    if( !pool ) {
+        pool.reset(new PlannerParametersWorkerPool(penv, parameters));
+    }
+    else {
+        pool->Synchronize();
+        pool->SetParameters(parameters);
+    }
+    try {
+        TrajectoryVerifier v(parameters);
+        v.VerifyTrajectory(trajectory,samplingstep,pool,nsegmentsperchunk);
+    }
+    catch(...) {
+        _PushVerifyTrajectoryPool(penv, pool);
+        throw;
+    }
+    _PushVerifyTrajectoryPool(penv, pool);
+}
+
 PlannerStatus _PlanActiveDOFTrajectory(TrajectoryBasePtr traj, RobotBasePtr probot, bool hastimestamps, dReal fmaxvelmult, dReal fmaxaccelmult, const std::string& plannername, bool bsmooth, const std::string& plannerparameters)
 {
     if( traj->GetNumWaypoints() == 1 ) {
@@ -1209,6 +1351,195 @@ PlannerStatus RetimeTrajectory(TrajectoryBasePtr traj, bool hastimestamps, dReal
     return _PlanTrajectory(traj,hastimestamps,fmaxvelmult,fmaxaccelmult,GetPlannerFromInterpolation(traj,plannername), false,plannerparameters);
 }
 
+static const size_t s_nMaxRetimersPerThread = 16;
+
+/// \brief copies the waypoints and description of source into target, the trajectories can belong to different environments
+static void _CopyTrajectoryData(TrajectoryBasePtr target, TrajectoryBaseConstPtr source)
+{
+    std::vector<dReal> data;
+    source->GetWaypoints(0, source->GetNumWaypoints(), data);
+    target->Init(source->GetConfigurationSpecification());
+    target->Insert(0, data);
+    target->SetDescription(source->GetDescription());
+}
+
+TrajectoryRetimerBatch::TrajectoryRetimerBatch(const std::string& plannername, const std::string& plannerparameters, int nthreads) : _plannername(plannername), _extraparameters(plannerparameters), _nthreads(nthreads)
+{
+    _nthreads = utils::GetNumParallelThreads(_nthreads);
+    _vthreadretimers.resize(_nthreads);
+}
+
+TrajectoryRetimerBatch::~TrajectoryRetimerBatch()
+{
+    Reset();
+}
+
+void TrajectoryRetimerBatch::Reset()
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    FOREACH(itretimers, _vthreadretimers) {
+        itretimers->clear();
+    }
+    _pool.reset();
+}
+
+size_t TrajectoryRetimerBatch::GetMaxRetimersPerThread()
+{
+    return s_nMaxRetimersPerThread;
+}
+
+void TrajectoryRetimerBatch::PlanPaths(const std::vector<TrajectoryBasePtr>& vtrajs, std::vector<PlannerStatus>& vstatuses, bool hastimestamps, dReal fmaxvelmult, dReal fmaxaccelmult)
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    vstatuses.resize(0);
+    vstatuses.resize(vtrajs.size(), PlannerStatus(PS_Failed));
+    if( vtrajs.size() == 0 ) {
+        return;
+    }
+
+    // the assignment of trajectories to threads is static so that the same batch is always retimed by the same retimers
+    int nthreads = min(_nthreads, (int)vtrajs.size());
+    std::vector<CachedRetimerPtr> vretimers(vtrajs.size());
+    {
+        EnvironmentBasePtr penv = vtrajs.at(0)->GetEnv();
+        EnvironmentMutex::scoped_lock lockenv(penv->GetMutex());
+        _SynchronizeWorkers(penv);
+        for(size_t itraj = 0; itraj < vtrajs.size(); ++itraj) {
+            OPENRAVE_ASSERT_FORMAT(vtrajs[itraj]->GetEnv() == penv, "env=%d, trajectory %d belongs to a different environment", penv->GetId()%itraj, ORE_InvalidArguments);
+            if( vtrajs[itraj]->GetNumWaypoints() <= 1 ) {
+                continue;
+            }
+            try {
+                vretimers[itraj] = _GetRetimer(itraj%nthreads, vtrajs[itraj], hastimestamps, fmaxvelmult, fmaxaccelmult);
+            }
+            catch(const std::exception& ex) {
+                vstatuses[itraj] = PlannerStatus(str(boost::format("failed to initialize retimer: %s")%ex.what()), PS_Failed);
+            }
+        }
+    }
+
+    utils::ParallelFor(nthreads, boost::bind(&TrajectoryRetimerBatch::_RetimeThread, this, _1, nthreads, boost::cref(vtrajs), boost::cref(vretimers), boost::ref(vstatuses)), nthreads);
+}
+
+void TrajectoryRetimerBatch::_SynchronizeWorkers(EnvironmentBasePtr penv)
+{
+    bool bcloned = false;
+    if( !_pool || _pool->GetEnv() != penv ) {
+        // retimers hold bodies of the old worker environments, so release them first
+        FOREACH(itretimers, _vthreadretimers) {
+            itretimers->clear();
+        }
+        _pool.reset();
+        _pool.reset(new PlannerParametersWorkerPool(penv, PlannerBase::PlannerParametersConstPtr(), _nthreads));
+        bcloned = true;
+    }
+    else {
+        bcloned = _pool->Synchronize();
+    }
+    if( bcloned ) {
+        // limits could have changed
+        FOREACH(itretimers, _vthreadretimers) {
+            itretimers->clear();
+        }
+    }
+}
+
+TrajectoryRetimerBatch::CachedRetimerPtr TrajectoryRetimerBatch::_GetRetimer(int ithread, TrajectoryBasePtr traj, bool hastimestamps, dReal fmaxvelmult, dReal fmaxaccelmult)
+{
+    EnvironmentBasePtr penv = _pool->GetWorkerEnv(ithread);
+    EnvironmentMutex::scoped_lock lockworker(penv->GetMutex());
+    ConfigurationSpecification spec = traj->GetConfigurationSpecification().GetTimeDerivativeSpecification(0);
+    std::string plannername = GetPlannerFromInterpolation(traj, _plannername);
+    std::vector<CachedRetimerPtr>& vretimers = _vthreadretimers.at(ithread);
+    CachedRetimerPtr retimer;
+    for(std::vector<CachedRetimerPtr>::iterator itretimer = vretimers.begin(); itretimer != vretimers.end(); ++itretimer) {
+        if( (*itretimer)->plannername == plannername && (*itretimer)->spec == spec ) {
+            retimer = *itretimer;
+            // move to the back as the most recently used
+            vretimers.erase(itretimer);
+            vretimers.push_back(retimer);
+            if( retimer->hastimestamps == hastimestamps && retimer->fmaxvelmult == fmaxvelmult && retimer->fmaxaccelmult == fmaxaccelmult ) {
+                return retimer;
+            }
+            break;
+        }
+    }
+
+    if( !retimer ) {
+        retimer.reset(new CachedRetimer());
+        retimer->spec = spec;
+        retimer->plannername = plannername;
+        retimer->planner = RaveCreatePlanner(penv, plannername);
+        if( !retimer->planner ) {
+            throw OPENRAVE_EXCEPTION_FORMAT(_("env=%d, failed to create planner %s"), penv->GetId()%plannername, ORE_InvalidArguments);
+        }
+        retimer->parameters.reset(new TrajectoryTimingParameters());
+        retimer->parameters->SetConfigurationSpecification(penv, spec);
+        retimer->parameters->_setstatevaluesfn.clear();
+        retimer->parameters->_checkpathvelocityconstraintsfn.clear();
+        retimer->parameters->_sPostProcessingPlanner = ""; // have to turn off the second post processing stage
+        retimer->parameters->_sExtraParameters += _extraparameters;
+        retimer->vmaxvelocities = retimer->parameters->_vConfigVelocityLimit;
+        retimer->vmaxaccelerations = retimer->parameters->_vConfigAccelerationLimit;
+        if( vretimers.size() >= s_nMaxRetimersPerThread ) {
+            vretimers.erase(vretimers.begin());
+        }
+        vretimers.push_back(retimer);
+    }
+
+    retimer->hastimestamps = hastimestamps;
+    retimer->fmaxvelmult = fmaxvelmult;
+    retimer->fmaxaccelmult = fmaxaccelmult;
+    TrajectoryTimingParametersPtr params = retimer->parameters;
+    for(size_t i = 0; i < params->_vConfigVelocityLimit.size(); ++i) {
+        params->_vConfigVelocityLimit[i] = retimer->vmaxvelocities.at(i)*fmaxvelmult;
+    }
+    for(size_t i = 0; i < params->_vConfigAccelerationLimit.size(); ++i) {
+        params->_vConfigAccelerationLimit[i] = retimer->vmaxaccelerations.at(i)*fmaxaccelmult;
+    }
+    params->_hastimestamps = hastimestamps;
+    if( !retimer->planner->InitPlan(RobotBasePtr(), params) ) {
+        // force the retimer to be re-initialized next time
+        retimer->fmaxvelmult = -1;
+        throw OPENRAVE_EXCEPTION_FORMAT(_("env=%d, failed to init planner %s"), penv->GetId()%plannername, ORE_InvalidArguments);
+    }
+    return retimer;
+}
+
+void TrajectoryRetimerBatch::_RetimeThread(int ithread, int nthreads, const std::vector<TrajectoryBasePtr>& vtrajs, const std::vector<CachedRetimerPtr>& vretimers, std::vector<PlannerStatus>& vstatuses)
+{
+    EnvironmentBasePtr pworkerenv = _pool->GetWorkerEnv(ithread);
+    for(size_t itraj = ithread; itraj < vtrajs.size(); itraj += nthreads) {
+        TrajectoryBasePtr traj = vtrajs[itraj];
+        try {
+            if( traj->GetNumWaypoints() == 1 ) {
+                // don't need velocities, but should at least add a time group
+                ConfigurationSpecification spec = traj->GetConfigurationSpecification();
+                spec.AddDeltaTimeGroup();
+                vector<dReal> data;
+                traj->GetWaypoints(0,traj->GetNumWaypoints(),data,spec);
+                traj->Init(spec);
+                traj->Insert(0,data);
+                vstatuses[itraj] = PlannerStatus(PS_HasSolution);
+            }
+            else if( !!vretimers[itraj] ) {
+                // retime a copy inside the worker environment so that the source environment is never accessed
+                EnvironmentMutex::scoped_lock lockworker(pworkerenv->GetMutex());
+                TrajectoryBasePtr workertraj = RaveCreateTrajectory(pworkerenv, traj->GetXMLId());
+                _CopyTrajectoryData(workertraj, traj);
+                vstatuses[itraj] = vretimers[itraj]->planner->PlanPath(workertraj);
+                if( vstatuses[itraj].HasSolution() ) {
+                    _CopyTrajectoryData(traj, workertraj);
+                }
+            }
+        }
+        catch(const std::exception& ex) {
+            RAVELOG_WARN_FORMAT("env=%d, failed to retime trajectory %d: %s", traj->GetEnv()->GetId()%itraj%ex.what());
+            vstatuses[itraj] = PlannerStatus(ex.what(), PS_Failed);
+        }
+    }
+}
+
 size_t ExtendActiveDOFWaypoint(int waypointindex, const std::vector<dReal>& dofvalues, const std::vector<dReal>& dofvelocities, TrajectoryBasePtr traj, RobotBasePtr robot, dReal fmaxvelmult, dReal fmaxaccelmult, const std::string& plannername)
 {
     if( traj->GetNumWaypoints()<1) {
@@ -3331,6 +3662,241 @@ int DynamicsCollisionConstraint::Check(const std::vector<dReal>& q0, const std::
     return 0;
 }
 
+PlannerParametersWorkerPool::PlannerParametersWorkerPool(EnvironmentBasePtr penv, PlannerBase::PlannerParametersConstPtr parameters, int nworkers, int cloningoptions) : _penv(penv), _cloningoptions(cloningoptions), _nSourceStructureStamp(0), _nClonedStructureStamp(0), _nNextChunk(0), _nFirstFailedChunk(0)
+{
+    OPENRAVE_ASSERT_FORMAT0(!!penv, "need environment to create worker pool", ORE_InvalidArguments);
+    nworkers = utils::GetNumParallelThreads(nworkers);
+    std::vector<KinBodyPtr> vbodies;
+    penv->GetBodies(vbodies);
+    _vworkers.resize(nworkers);
+    for(size_t iworker = 0; iworker < _vworkers.size(); ++iworker) {
+        _vworkers[iworker].penv = penv->CloneSelf(cloningoptions);
+    }
+    _ResetSourceBodies(vbodies);
+    SetParameters(parameters);
+    RAVELOG_DEBUG_FORMAT("env=%d, created %d worker contexts", penv->GetId()%_vworkers.size());
+}
+
+PlannerParametersWorkerPool::~PlannerParametersWorkerPool()
+{
+    _vsourcebodycallbacks.clear();
+    FOREACH(itworker, _vworkers) {
+        itworker->parameters.reset();
+        if( !!itworker->penv ) {
+            itworker->penv->Destroy();
+        }
+    }
+    _vworkers.clear();
+}
+
+bool PlannerParametersWorkerPool::Synchronize(bool bforce)
+{
+    EnvironmentBasePtr penv = _penv.lock();
+    OPENRAVE_ASSERT_FORMAT0(!!penv, "source environment of worker pool was destroyed", ORE_InvalidState);
+    std::vector<KinBodyPtr> vbodies;
+    penv->GetBodies(vbodies);
+    bool bclone = bforce || _nSourceStructureStamp != _nClonedStructureStamp || vbodies.size() != _vsourcebodyids.size();
+    for(size_t ibody = 0; ibody < vbodies.size() && !bclone; ++ibody) {
+        bclone = vbodies[ibody]->GetEnvironmentId() != _vsourcebodyids[ibody];
+    }
+    if( bclone ) {
+        FOREACH(itworker, _vworkers) {
+            // bodies with the same name and kinematics hash are kept, so the worker parameters stay valid
+            itworker->penv->Clone(penv, _cloningoptions);
+        }
+        _ResetSourceBodies(vbodies);
+        return true;
+    }
+
+    // the bodies can only have moved, so copy the state of the ones whose stamp changed
+    std::vector<Transform> vtransforms;
+    std::vector<dReal> vdoflastsetvalues;
+    for(size_t ibody = 0; ibody < vbodies.size(); ++ibody) {
+        const KinBodyPtr& pbody = vbodies[ibody];
+        if( pbody->GetUpdateStamp() == _vsourcebodystamps[ibody] ) {
+            continue;
+        }
+        pbody->GetLinkTransformations(vtransforms, vdoflastsetvalues);
+        FOREACH(itworker, _vworkers) {
+            EnvironmentMutex::scoped_lock lockworker(itworker->penv->GetMutex());
+            KinBodyPtr pworkerbody = itworker->penv->GetKinBody(pbody->GetName());
+            if( !!pworkerbody ) {
+                pworkerbody->SetLinkTransformations(vtransforms, vdoflastsetvalues);
+            }
+        }
+        _vsourcebodystamps[ibody] = pbody->GetUpdateStamp();
+    }
+    return false;
+}
+
+void PlannerParametersWorkerPool::SetParameters(PlannerBase::PlannerParametersConstPtr parameters)
+{
+    _parameters = parameters;
+    FOREACH(itworker, _vworkers) {
+        WorkerContext& worker = *itworker;
+        worker.parameters.reset();
+        if( !parameters ) {
+            continue;
+        }
+        EnvironmentMutex::scoped_lock lockworker(worker.penv->GetMutex());
+        worker.parameters.reset(new PlannerBase::PlannerParameters());
+        worker.parameters->copy(parameters);
+        worker.parameters->SetConfigurationSpecification(worker.penv, parameters->_configurationspecification);
+        // limits could have been changed after the source parameters were setup, so keep them
+        worker.parameters->_vConfigLowerLimit = parameters->_vConfigLowerLimit;
+        worker.parameters->_vConfigUpperLimit = parameters->_vConfigUpperLimit;
+        worker.parameters->_vConfigVelocityLimit = parameters->_vConfigVelocityLimit;
+        worker.parameters->_vConfigAccelerationLimit = parameters->_vConfigAccelerationLimit;
+        worker.parameters->_vConfigResolution = parameters->_vConfigResolution;
+        worker.parameters->vinitialconfig = parameters->vinitialconfig;
+    }
+}
+
+int PlannerParametersWorkerPool::Evaluate(int nchunks, const ChunkFn& fn)
+{
+    boost::mutex::scoped_lock lockevaluate(_mutexEvaluate);
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        _nNextChunk = 0;
+        _nFirstFailedChunk = nchunks;
+        _firstexception = std::exception_ptr();
+    }
+    if( nchunks <= 0 ) {
+        return -1;
+    }
+
+    int nthreads = min((int)_vworkers.size(), nchunks);
+    utils::ParallelFor(nthreads, boost::bind(&PlannerParametersWorkerPool::_WorkerThread, this, _1, nchunks, boost::cref(fn)), nthreads);
+
+    boost::mutex::scoped_lock lock(_mutex);
+    if( _nFirstFailedChunk >= nchunks ) {
+        return -1;
+    }
+    if( !!_firstexception ) {
+        std::exception_ptr firstexception = _firstexception;
+        _firstexception = std::exception_ptr();
+        std::rethrow_exception(firstexception);
+    }
+    return _nFirstFailedChunk;
+}
+
+int PlannerParametersWorkerPool::CheckPathAllConstraints(const std::vector<dReal>& vwaypoints, const std::vector<dReal>& vvelocities, const std::vector<dReal>& vdeltatimes, IntervalType interval, int options, int nsegmentsperchunk, int& ifailedsegment)
+{
+    OPENRAVE_ASSERT_FORMAT0(!!_parameters, "worker pool was created without planner parameters", ORE_InvalidState);
+    const int dof = _parameters->GetDOF();
+    ifailedsegment = -1;
+    OPENRAVE_ASSERT_OP((int)vwaypoints.size()%dof,==,0);
+    int nsegments = (int)vwaypoints.size()/dof - 1;
+    if( nsegments <= 0 ) {
+        return 0;
+    }
+    if( vvelocities.size() > 0 ) {
+        OPENRAVE_ASSERT_OP(vvelocities.size(),==,vwaypoints.size());
+    }
+    if( vdeltatimes.size() > 0 ) {
+        OPENRAVE_ASSERT_OP((int)vdeltatimes.size(),==,nsegments);
+    }
+    if( nsegmentsperchunk <= 0 ) {
+        nsegmentsperchunk = 1;
+    }
+
+    std::vector<int> vsegmentreturns(nsegments, 0);
+    int nchunks = (nsegments+nsegmentsperchunk-1)/nsegmentsperchunk;
+    int ifailedchunk = Evaluate(nchunks, [&](int iworker, int ichunk) {
+        PlannerBase::PlannerParametersConstPtr params = _vworkers.at(iworker).parameters;
+        std::vector<dReal> q0(dof), q1(dof), dq0, dq1;
+        int isegmentend = min(nsegments, (ichunk+1)*nsegmentsperchunk);
+        for(int isegment = ichunk*nsegmentsperchunk; isegment < isegmentend; ++isegment) {
+            if( IsCancelled(ichunk) ) {
+                break;
+            }
+            std::copy(vwaypoints.begin()+isegment*dof, vwaypoints.begin()+(isegment+1)*dof, q0.begin());
+            std::copy(vwaypoints.begin()+(isegment+1)*dof, vwaypoints.begin()+(isegment+2)*dof, q1.begin());
+            if( vvelocities.size() > 0 ) {
+                dq0.assign(vvelocities.begin()+isegment*dof, vvelocities.begin()+(isegment+1)*dof);
+                dq1.assign(vvelocities.begin()+(isegment+1)*dof, vvelocities.begin()+(isegment+2)*dof);
+            }
+            int ret = params->CheckPathAllConstraints(q0, q1, dq0, dq1, vdeltatimes.size() > 0 ? vdeltatimes[isegment] : 0, interval, options);
+            if( ret != 0 ) {
+                vsegmentreturns[isegment] = ret;
+                return ret;
+            }
+        }
+        return 0;
+    });
+    if( ifailedchunk < 0 ) {
+        return 0;
+    }
+    // the first failing segment of the first failing chunk is the one the sequential check stops at
+    for(int isegment = ifailedchunk*nsegmentsperchunk; isegment < nsegments; ++isegment) {
+        if( vsegmentreturns[isegment] != 0 ) {
+            ifailedsegment = isegment;
+            return vsegmentreturns[isegment];
+        }
+    }
+    return 0;
+}
+
+bool PlannerParametersWorkerPool::IsCancelled(int ichunk) const
+{
+    boost::mutex::scoped_lock lock(_mutex);
+    return _nFirstFailedChunk < ichunk;
+}
+
+void PlannerParametersWorkerPool::_WorkerThread(int iworker, int nchunks, const ChunkFn& fn)
+{
+    WorkerContext& worker = _vworkers.at(iworker);
+    EnvironmentMutex::scoped_lock lockenv(worker.penv->GetMutex());
+    while(1) {
+        int ichunk = 0;
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            if( _nNextChunk >= _nFirstFailedChunk ) {
+                // either all chunks were dispatched, or an earlier chunk failed
+                break;
+            }
+            ichunk = _nNextChunk++;
+        }
+
+        int ret = 0;
+        std::exception_ptr exception;
+        try {
+            ret = fn(iworker, ichunk);
+        }
+        catch(...) {
+            ret = -1;
+            exception = std::current_exception();
+        }
+        if( ret != 0 ) {
+            boost::mutex::scoped_lock lock(_mutex);
+            if( ichunk < _nFirstFailedChunk ) {
+                _nFirstFailedChunk = ichunk;
+                _firstexception = exception;
+            }
+        }
+    }
+}
+
+void PlannerParametersWorkerPool::_ResetSourceBodies(const std::vector<KinBodyPtr>& vbodies)
+{
+    // motions are copied by Synchronize without cloning, every other change requires cloning again
+    const uint32_t properties = ~(uint32_t)(KinBody::Prop_LinkTransforms|KinBody::Prop_LinkDraw);
+    _vsourcebodyids.resize(vbodies.size());
+    _vsourcebodystamps.resize(vbodies.size());
+    _vsourcebodycallbacks.resize(vbodies.size());
+    for(size_t ibody = 0; ibody < vbodies.size(); ++ibody) {
+        _vsourcebodyids[ibody] = vbodies[ibody]->GetEnvironmentId();
+        _vsourcebodystamps[ibody] = vbodies[ibody]->GetUpdateStamp();
+        _vsourcebodycallbacks[ibody] = vbodies[ibody]->RegisterChangeCallback(properties, boost::bind(&PlannerParametersWorkerPool::_OnSourceBodyChanged, this));
+    }
+    _nClonedStructureStamp = _nSourceStructureStamp;
+}
+
+void PlannerParametersWorkerPool::_OnSourceBodyChanged()
+{
+    ++_nSourceStructureStamp;
+}
+
 SimpleDistanceMetric::SimpleDistanceMetric(RobotBasePtr robot) : _robot(robot)
 {
     _robot->GetActiveDOFWeights(weights2);
@@ -3386,6 +3952,8 @@ ManipulatorIKGoalSampler::ManipulatorIKGoalSampler(RobotBase::ManipulatorConstPt
 {
     _tempikindex = -1;
     _fjittermaxdist = 0;
+    _numparallelcandidates = 0;
+    _deadline = 0;
     _probot = _pmanip->GetRobot();
     _pindexsampler = RaveCreateSpaceSampler(_probot->GetEnv(),"mt19937");
     int orgindex = 0;
@@ -3453,176 +4021,201 @@ IkReturnPtr ManipulatorIKGoalSampler::Sample()
         }
         return ikreturnlocal;
     }
-    int numfree = _pmanip->GetIkSolver()->GetNumFreeParameters();
-    std::vector<dReal> vfree;
+    if( !!_pool ) {
+        return _SampleParallel();
+    }
     IkReturnPtr ikreturnjittered;
+    Candidate candidate;
     for(int itry = 0; itry < _nummaxtries; ++itry ) {
-        if( _listsamples.size() == 0 ) {
-            return IkReturnPtr();
+        if( _deadline > 0 && utils::GetMonotonicTime() > _deadline ) {
+            RAVELOG_VERBOSE("goal sampling deadline passed\n");
+            break;
         }
-        _pindexsampler->SampleSequence(vindex,1,IT_OpenEnd);
-        int isampleindex = (int)(vindex.at(0)*_listsamples.size());
-        std::list<SampleInfo>::iterator itsample = _listsamples.begin();
-        advance(itsample,isampleindex);
-
-        SampleInfo& sampleinfo = *itsample;
-
-        int numRedundantSamplesForEEChecking = 0;
-        if( (int)_pmanip->GetArmIndices().size() > sampleinfo._ikparam.GetDOF() ) {
-            numRedundantSamplesForEEChecking = 40;
+        int ret = _PopCandidate(candidate, ikreturnjittered);
+        if( ret < 0 ) {
+            return IkReturnPtr();
         }
-
-        bool bFullEndEffectorKnown = sampleinfo._ikparam.GetType() == IKP_Transform6D || _pmanip->GetArmDOF() <= sampleinfo._ikparam.GetDOF();
-        bool bCheckEndEffector = true;
-        bool bCheckEndEffectorSelf = true;
-        if( _ikfilteroptions & IKFO_IgnoreEndEffectorEnvCollisions ) {
-            // use requested end effector to be always ignored
-            bCheckEndEffector = false;
+        else if( ret == 0 ) {
+            continue;
         }
-        if( _ikfilteroptions & IKFO_IgnoreEndEffectorSelfCollisions ) {
-            // use requested end effector to be always ignored
-            bCheckEndEffectorSelf = false;
+        if( _pmanip->FindIKSolutions(candidate._ikparam, candidate._vfree, candidate._ikfilteroptions, candidate._vikreturns) ) {
+            return _ReturnCandidate(candidate);
         }
+    }
+    return IkReturnPtr();
+}
 
-        // if first grasp, quickly prune grasp is end effector is in collision
-        IkParameterization ikparam = sampleinfo._ikparam;
-        if( sampleinfo._numleft == _nummaxsamples && (bCheckEndEffector || bCheckEndEffectorSelf) ) { //!(_ikfilteroptions & IKFO_IgnoreEndEffectorEnvCollisions) ) {
-            // because a goal can be colliding, have to always go in this loop and check if the end effector
-            // could be jittered.
-            // if bCheckEndEffector is true, then should call CheckEndEffectorCollision to quickly prune samples; otherwise, have to rely on calling FindIKSolution
-            try {
-                if( (bCheckEndEffector && _pmanip->CheckEndEffectorCollision(ikparam,_report, numRedundantSamplesForEEChecking)) || (bCheckEndEffectorSelf && _pmanip->CheckEndEffectorSelfCollision(ikparam,_report, numRedundantSamplesForEEChecking,true))) {
-                    bool bcollision=true;
-                    if( _fjittermaxdist > 0 ) {
-                        // try jittering the end effector out
-                        RAVELOG_VERBOSE_FORMAT("starting jitter transform %f...", _fjittermaxdist);
-                        // randomly add small offset to the ik until it stops being in collision
-                        Transform tjitter;
-                        // before random sampling, first try sampling along the axes. try order z,y,x since z is most likely gravity
-                        int N = 4;
-                        dReal delta = _fjittermaxdist/N;
-                        for(int iaxis = 2; iaxis >= 0; --iaxis) {
-                            tjitter.trans = Vector();
-                            for(int iiter = 0; iiter < 2*N; ++iiter) {
-                                tjitter.trans[iaxis] = _fjittermaxdist*delta*(1+iiter/2);
-                                if( iiter & 1 ) {
-                                    // revert sign
-                                    tjitter.trans[iaxis] = -tjitter.trans[iaxis];
-                                }
-                                IkParameterization ikparamjittered = tjitter * ikparam;
-                                try {
-                                    if( (!bCheckEndEffector || !_pmanip->CheckEndEffectorCollision(ikparamjittered,_report, numRedundantSamplesForEEChecking)) && (!bCheckEndEffectorSelf || !_pmanip->CheckEndEffectorSelfCollision(ikparamjittered,_report, numRedundantSamplesForEEChecking,true)) ) {
-                                        // make sure at least one ik solution exists...
-                                        if( !ikreturnjittered ) {
-                                            ikreturnjittered.reset(new IkReturn(IKRA_Success));
-                                        }
-                                        bool biksuccess = _pmanip->FindIKSolution(ikparamjittered, _ikfilteroptions, ikreturnjittered);
-                                        if( biksuccess ) {
-                                            ikparam = ikparamjittered;
-                                            bcollision = false;
-                                            break;
-                                        }
-                                        else {
-                                            RAVELOG_VERBOSE_FORMAT("jitter succeed position, but ik failed: 0x%.8x", ikreturnjittered->_action);
-                                        }
+int ManipulatorIKGoalSampler::_PopCandidate(Candidate& candidate, IkReturnPtr& ikreturnjittered)
+{
+    if( _listsamples.size() == 0 ) {
+        return -1;
+    }
+    int numfree = _pmanip->GetIkSolver()->GetNumFreeParameters();
+    std::vector<dReal> vindex;
+    std::vector<dReal>& vfree = candidate._vfree;
+    _pindexsampler->SampleSequence(vindex,1,IT_OpenEnd);
+    int isampleindex = (int)(vindex.at(0)*_listsamples.size());
+    std::list<SampleInfo>::iterator itsample = _listsamples.begin();
+    advance(itsample,isampleindex);
+
+    SampleInfo& sampleinfo = *itsample;
+
+    int numRedundantSamplesForEEChecking = 0;
+    if( (int)_pmanip->GetArmIndices().size() > sampleinfo._ikparam.GetDOF() ) {
+        numRedundantSamplesForEEChecking = 40;
+    }
+
+    bool bFullEndEffectorKnown = sampleinfo._ikparam.GetType() == IKP_Transform6D || _pmanip->GetArmDOF() <= sampleinfo._ikparam.GetDOF();
+    bool bCheckEndEffector = true;
+    bool bCheckEndEffectorSelf = true;
+    if( _ikfilteroptions & IKFO_IgnoreEndEffectorEnvCollisions ) {
+        // use requested end effector to be always ignored
+        bCheckEndEffector = false;
+    }
+    if( _ikfilteroptions & IKFO_IgnoreEndEffectorSelfCollisions ) {
+        // use requested end effector to be always ignored
+        bCheckEndEffectorSelf = false;
+    }
+
+    // if first grasp, quickly prune grasp is end effector is in collision
+    IkParameterization ikparam = sampleinfo._ikparam;
+    if( sampleinfo._numleft == _nummaxsamples && (bCheckEndEffector || bCheckEndEffectorSelf) ) { //!(_ikfilteroptions & IKFO_IgnoreEndEffectorEnvCollisions) ) {
+        // because a goal can be colliding, have to always go in this loop and check if the end effector
+        // could be jittered.
+        // if bCheckEndEffector is true, then should call CheckEndEffectorCollision to quickly prune samples; otherwise, have to rely on calling FindIKSolution
+        try {
+            if( (bCheckEndEffector && _pmanip->CheckEndEffectorCollision(ikparam,_report, numRedundantSamplesForEEChecking)) || (bCheckEndEffectorSelf && _pmanip->CheckEndEffectorSelfCollision(ikparam,_report, numRedundantSamplesForEEChecking,true))) {
+                bool bcollision=true;
+                if( _fjittermaxdist > 0 ) {
+                    // try jittering the end effector out
+                    RAVELOG_VERBOSE_FORMAT("starting jitter transform %f...", _fjittermaxdist);
+                    // randomly add small offset to the ik until it stops being in collision
+                    Transform tjitter;
+                    // before random sampling, first try sampling along the axes. try order z,y,x since z is most likely gravity
+                    int N = 4;
+                    dReal delta = _fjittermaxdist/N;
+                    for(int iaxis = 2; iaxis >= 0; --iaxis) {
+                        tjitter.trans = Vector();
+                        for(int iiter = 0; iiter < 2*N; ++iiter) {
+                            tjitter.trans[iaxis] = _fjittermaxdist*delta*(1+iiter/2);
+                            if( iiter & 1 ) {
+                                // revert sign
+                                tjitter.trans[iaxis] = -tjitter.trans[iaxis];
+                            }
+                            IkParameterization ikparamjittered = tjitter * ikparam;
+                            try {
+                                if( (!bCheckEndEffector || !_pmanip->CheckEndEffectorCollision(ikparamjittered,_report, numRedundantSamplesForEEChecking)) && (!bCheckEndEffectorSelf || !_pmanip->CheckEndEffectorSelfCollision(ikparamjittered,_report, numRedundantSamplesForEEChecking,true)) ) {
+                                    // make sure at least one ik solution exists...
+                                    if( !ikreturnjittered ) {
+                                        ikreturnjittered.reset(new IkReturn(IKRA_Success));
+                                    }
+                                    bool biksuccess = _pmanip->FindIKSolution(ikparamjittered, _ikfilteroptions, ikreturnjittered);
+                                    if( biksuccess ) {
+                                        ikparam = ikparamjittered;
+                                        bcollision = false;
+                                        break;
+                                    }
+                                    else {
+                                        RAVELOG_VERBOSE_FORMAT("jitter succeed position, but ik failed: 0x%.8x", ikreturnjittered->_action);
                                     }
-                                }
-                                catch(const std::exception& ex) {
-                                    // ignore most likely ik failed in CheckEndEffectorCollision
                                 }
                             }
-                            if( !bcollision ) {
-                                break;
+                            catch(const std::exception& ex) {
+                                // ignore most likely ik failed in CheckEndEffectorCollision
                             }
                         }
+                        if( !bcollision ) {
+                            break;
+                        }
+                    }
 
-                        if( bcollision ) {
-                            // try random samples, most likely will fail...
-                            int nMaxIterations = 100;
-                            std::vector<dReal> xyzsamples(3);
-                            dReal delta = (_fjittermaxdist*2)/nMaxIterations;
-                            for(int iiter = 1; iiter <= nMaxIterations; ++iiter) {
-                                _pindexsampler->SampleSequence(xyzsamples,3,IT_Closed);
-                                tjitter.trans = Vector(xyzsamples[0]-0.5f, xyzsamples[1]-0.5f, xyzsamples[2]-0.5f) * (delta*iiter);
-                                IkParameterization ikparamjittered = tjitter * ikparam;
-                                try {
-                                    if( (!bCheckEndEffector || !_pmanip->CheckEndEffectorCollision(ikparamjittered, _report, numRedundantSamplesForEEChecking)) && (!bCheckEndEffectorSelf || !_pmanip->CheckEndEffectorSelfCollision(ikparamjittered, _report, numRedundantSamplesForEEChecking,true)) ) {
-                                        if( !ikreturnjittered ) {
-                                            ikreturnjittered.reset(new IkReturn(IKRA_Success));
-                                        }
-                                        bool biksuccess = _pmanip->FindIKSolution(ikparamjittered, _ikfilteroptions, ikreturnjittered);
-                                        if( biksuccess ) {
-                                            ikparam = ikparamjittered;
-                                            bcollision = false;
-                                            break;
-                                        }
-                                        else {
-                                            RAVELOG_VERBOSE_FORMAT("jitter succed position, but ik failed: 0x%.8x", ikreturnjittered->_action);
-                                        }
+                    if( bcollision ) {
+                        // try random samples, most likely will fail...
+                        int nMaxIterations = 100;
+                        std::vector<dReal> xyzsamples(3);
+                        dReal delta = (_fjittermaxdist*2)/nMaxIterations;
+                        for(int iiter = 1; iiter <= nMaxIterations; ++iiter) {
+                            _pindexsampler->SampleSequence(xyzsamples,3,IT_Closed);
+                            tjitter.trans = Vector(xyzsamples[0]-0.5f, xyzsamples[1]-0.5f, xyzsamples[2]-0.5f) * (delta*iiter);
+                            IkParameterization ikparamjittered = tjitter * ikparam;
+                            try {
+                                if( (!bCheckEndEffector || !_pmanip->CheckEndEffectorCollision(ikparamjittered, _report, numRedundantSamplesForEEChecking)) && (!bCheckEndEffectorSelf || !_pmanip->CheckEndEffectorSelfCollision(ikparamjittered, _report, numRedundantSamplesForEEChecking,true)) ) {
+                                    if( !ikreturnjittered ) {
+                                        ikreturnjittered.reset(new IkReturn(IKRA_Success));
+                                    }
+                                    bool biksuccess = _pmanip->FindIKSolution(ikparamjittered, _ikfilteroptions, ikreturnjittered);
+                                    if( biksuccess ) {
+                                        ikparam = ikparamjittered;
+                                        bcollision = false;
+                                        break;
+                                    }
+                                    else {
+                                        RAVELOG_VERBOSE_FORMAT("jitter succed position, but ik failed: 0x%.8x", ikreturnjittered->_action);
                                     }
-                                }
-                                catch(const std::exception& ex) {
-                                    // ignore most likely ik failed in CheckEndEffectorCollision
                                 }
                             }
+                            catch(const std::exception& ex) {
+                                // ignore most likely ik failed in CheckEndEffectorCollision
+                            }
                         }
                     }
-                    if( bcollision ) {
-                        RAVELOG_VERBOSE(str(boost::format("sampleiksolutions gripper in collision: %s.\n")%_report->__str__()));
-                        _listsamples.erase(itsample);
-                        continue;
-                    }
-                }
-            }
-            catch(const std::exception& ex) {
-                if( sampleinfo._ikparam.GetType() == IKP_Transform6D ) {
-                    RAVELOG_WARN(str(boost::format("CheckEndEffectorCollision threw exception: %s")%ex.what()));
                 }
-                else {
-                    // most likely the ik couldn't get solved
-                    RAVELOG_VERBOSE(str(boost::format("sampleiksolutions failed to solve ik: %s.\n")%ex.what()));
+                if( bcollision ) {
+                    RAVELOG_VERBOSE(str(boost::format("sampleiksolutions gripper in collision: %s.\n")%_report->__str__()));
                     _listsamples.erase(itsample);
-                    continue;
+                    return 0;
                 }
             }
         }
+        catch(const std::exception& ex) {
+            if( sampleinfo._ikparam.GetType() == IKP_Transform6D ) {
+                RAVELOG_WARN(str(boost::format("CheckEndEffectorCollision threw exception: %s")%ex.what()));
+            }
+            else {
+                // most likely the ik couldn't get solved
+                RAVELOG_VERBOSE(str(boost::format("sampleiksolutions failed to solve ik: %s.\n")%ex.what()));
+                _listsamples.erase(itsample);
+                return 0;
+            }
+        }
+    }
 
-        vfree.resize(0);
-        int orgindex = sampleinfo._orgindex;
-        if( numfree > 0 ) {
-            if( _searchfreeparameters ) {
-                // halton sampler
-                if( !sampleinfo._psampler ) {
-                    sampleinfo._psampler = RaveCreateSpaceSampler(_probot->GetEnv(),"halton");
-                    sampleinfo._psampler->SetSpaceDOF(numfree);
+    vfree.resize(0);
+    int orgindex = sampleinfo._orgindex;
+    if( numfree > 0 ) {
+        if( _searchfreeparameters ) {
+            // halton sampler
+            if( !sampleinfo._psampler ) {
+                sampleinfo._psampler = RaveCreateSpaceSampler(_probot->GetEnv(),"halton");
+                sampleinfo._psampler->SetSpaceDOF(numfree);
 #if 1
-                    // read all the samples and order them so that samples close to 0.5 are sampled first!
-                    sampleinfo._psampler->SampleSequence(sampleinfo._vfreesamples,_nummaxsamples);
-                    OPENRAVE_ASSERT_OP((int)sampleinfo._vfreesamples.size(),==,_nummaxsamples*numfree);
-                    sampleinfo._vcachedists.resize(_nummaxsamples);
-                    for(int isample = 0; isample < _nummaxsamples; ++isample) {
-                        dReal dist = 0;
-                        for(int jfree = 0; jfree < numfree; ++jfree) {
-                            dist += _vfreeweights[jfree]*RaveFabs(sampleinfo._vfreesamples[isample*numfree+jfree] - 0.5);
-                        }
-
-                        sampleinfo._vcachedists[isample].first = isample;
-                        sampleinfo._vcachedists[isample].second = dist;
+                // read all the samples and order them so that samples close to 0.5 are sampled first!
+                sampleinfo._psampler->SampleSequence(sampleinfo._vfreesamples,_nummaxsamples);
+                OPENRAVE_ASSERT_OP((int)sampleinfo._vfreesamples.size(),==,_nummaxsamples*numfree);
+                sampleinfo._vcachedists.resize(_nummaxsamples);
+                for(int isample = 0; isample < _nummaxsamples; ++isample) {
+                    dReal dist = 0;
+                    for(int jfree = 0; jfree < numfree; ++jfree) {
+                        dist += _vfreeweights[jfree]*RaveFabs(sampleinfo._vfreesamples[isample*numfree+jfree] - 0.5);
                     }
-                    std::sort(sampleinfo._vcachedists.begin(), sampleinfo._vcachedists.end(), ComparePriorityPair);
-#endif
+
+                    sampleinfo._vcachedists[isample].first = isample;
+                    sampleinfo._vcachedists[isample].second = dist;
                 }
+                std::sort(sampleinfo._vcachedists.begin(), sampleinfo._vcachedists.end(), ComparePriorityPair);
+#endif
+            }
 
 #if 1
-                if( sampleinfo._vcachedists.size() > 0 ) {
-                    int isample = sampleinfo._vcachedists.back().first;
-                    sampleinfo._vcachedists.pop_back();
-                    vfree.resize(numfree);
-                    std::copy(sampleinfo._vfreesamples.begin() + isample*numfree, sampleinfo._vfreesamples.begin() + (isample+1)*numfree, vfree.begin());
-                }
+            if( sampleinfo._vcachedists.size() > 0 ) {
+                int isample = sampleinfo._vcachedists.back().first;
+                sampleinfo._vcachedists.pop_back();
+                vfree.resize(numfree);
+                std::copy(sampleinfo._vfreesamples.begin() + isample*numfree, sampleinfo._vfreesamples.begin() + (isample+1)*numfree, vfree.begin());
+            }
 #else
-                sampleinfo._psampler->SampleSequence(vfree,1);
-                // it's pretty dangerous to add _vfreestart since if it starts on a joint limit (0), then it will start exploring from each of the joint limits. rather, we want ik solutions that are away from joint limits
+            sampleinfo._psampler->SampleSequence(vfree,1);
+            // it's pretty dangerous to add _vfreestart since if it starts on a joint limit (0), then it will start exploring from each of the joint limits. rather, we want ik solutions that are away from joint limits
 //                for(size_t i = 0; i < _vfreestart.size(); ++i) {
 //                    vfree.at(i) += _vfreestart[i];
 //                    if( vfree[i] < 0 ) {
@@ -3633,41 +4226,120 @@ IkReturnPtr ManipulatorIKGoalSampler::Sample()
 //                    }
 //                }
 #endif
-            }
-            else if (!_vfreegoalvalues.empty()) {
-                vfree = _vfreegoalvalues;
-            }
-            else {
-                _pmanip->GetIkSolver()->GetFreeParameters(vfree);
-            }
         }
-        if( IS_DEBUGLEVEL(Level_Verbose) ) {
-            std::stringstream ss; ss << "free=[";
-            FOREACHC(itfree, vfree) {
-                ss << *itfree << ", ";
+        else if (!_vfreegoalvalues.empty()) {
+            vfree = _vfreegoalvalues;
+        }
+        else {
+            _pmanip->GetIkSolver()->GetFreeParameters(vfree);
+        }
+    }
+    if( IS_DEBUGLEVEL(Level_Verbose) ) {
+        std::stringstream ss; ss << "free=[";
+        FOREACHC(itfree, vfree) {
+            ss << *itfree << ", ";
+        }
+        ss << "]";
+        RAVELOG_VERBOSE(ss.str());
+    }
+    candidate._ikparam = ikparam;
+    candidate._ikfilteroptions = _ikfilteroptions|(bFullEndEffectorKnown&&bCheckEndEffector ? IKFO_IgnoreEndEffectorEnvCollisions : 0);
+    candidate._orgindex = orgindex;
+    candidate._status = 0;
+    candidate._vikreturns.resize(0);
+    if( --sampleinfo._numleft <= 0 || vfree.size() == 0 || !_searchfreeparameters ) {
+        _listsamples.erase(itsample);
+    }
+    return 1;
+}
+
+IkReturnPtr ManipulatorIKGoalSampler::_ReturnCandidate(Candidate& candidate)
+{
+    _vikreturns.swap(candidate._vikreturns);
+    _tempikindex = candidate._orgindex;
+    _listreturnedsamples.push_back(candidate._orgindex);
+    IkReturnPtr ikreturnlocal = _vikreturns.back();
+    _vikreturns.pop_back();
+    if( _vikreturns.size() == 0 ) {
+        _tempikindex = -1;
+    }
+    return ikreturnlocal;
+}
+
+IkReturnPtr ManipulatorIKGoalSampler::_SampleParallel()
+{
+    IkReturnPtr ikreturnjittered;
+    int numcandidates = _numparallelcandidates > 0 ? _numparallelcandidates : _pool->GetNumWorkers();
+    int itry = 0;
+    while(itry < _nummaxtries) {
+        // return candidates that were already evaluated by an earlier batch in their sampling order
+        while(_listpendingcandidates.size() > 0 && _listpendingcandidates.front()._status != 0 ) {
+            Candidate candidate;
+            std::swap(candidate, _listpendingcandidates.front());
+            _listpendingcandidates.pop_front();
+            ++itry;
+            if( candidate._status == 2 ) {
+                return _ReturnCandidate(candidate);
             }
-            ss << "]";
-            RAVELOG_VERBOSE(ss.str());
         }
-        bool bsuccess = _pmanip->FindIKSolutions(ikparam, vfree, _ikfilteroptions|(bFullEndEffectorKnown&&bCheckEndEffector ? IKFO_IgnoreEndEffectorEnvCollisions : 0), _vikreturns);
-        if( --sampleinfo._numleft <= 0 || vfree.size() == 0 || !_searchfreeparameters ) {
-            _listsamples.erase(itsample);
+        if( itry >= _nummaxtries ) {
+            break;
+        }
+        if( _deadline > 0 && utils::GetMonotonicTime() > _deadline ) {
+            RAVELOG_VERBOSE("goal sampling deadline passed\n");
+            break;
         }
 
-        if( bsuccess ) {
-            _tempikindex = orgindex;
-            _listreturnedsamples.push_back(orgindex);
-            IkReturnPtr ikreturnlocal = _vikreturns.back();
-            _vikreturns.pop_back();
-            if( _vikreturns.size() == 0 ) {
-                _tempikindex = -1;
+        // pending candidates come first. if there are evaluated candidates after them, cannot add new ones in between
+        _vbatchcandidates.resize(0);
+        while(_listpendingcandidates.size() > 0 && _listpendingcandidates.front()._status == 0 && (int)_vbatchcandidates.size() < numcandidates) {
+            _vbatchcandidates.push_back(Candidate());
+            std::swap(_vbatchcandidates.back(), _listpendingcandidates.front());
+            _listpendingcandidates.pop_front();
+        }
+        bool bNoSamplesLeft = false;
+        if( _listpendingcandidates.size() == 0 ) {
+            Candidate candidate;
+            while((int)_vbatchcandidates.size() < numcandidates && itry + (int)_vbatchcandidates.size() < _nummaxtries) {
+                int ret = _PopCandidate(candidate, ikreturnjittered);
+                if( ret < 0 ) {
+                    bNoSamplesLeft = true;
+                    break;
+                }
+                else if( ret == 0 ) {
+                    ++itry;
+                    continue;
+                }
+                _vbatchcandidates.push_back(candidate);
             }
-            return ikreturnlocal;
         }
+        if( _vbatchcandidates.size() == 0 ) {
+            if( bNoSamplesLeft || itry >= _nummaxtries ) {
+                break;
+            }
+            continue;
+        }
+
+        _pool->Evaluate((int)_vbatchcandidates.size(), boost::bind(&ManipulatorIKGoalSampler::_EvaluateCandidate, this, _1, _2));
+        _listpendingcandidates.insert(_listpendingcandidates.begin(), _vbatchcandidates.begin(), _vbatchcandidates.end());
+        _vbatchcandidates.resize(0);
     }
     return IkReturnPtr();
 }
 
+int ManipulatorIKGoalSampler::_EvaluateCandidate(int iworker, int icandidate)
+{
+    Candidate& candidate = _vbatchcandidates.at(icandidate);
+    RobotBasePtr probot = _pool->GetWorkerEnv(iworker)->GetRobot(_probot->GetName());
+    OPENRAVE_ASSERT_FORMAT(!!probot, "worker env does not have robot %s", _probot->GetName(), ORE_InvalidState);
+    RobotBase::ManipulatorPtr pmanip = probot->GetManipulator(_pmanip->GetName());
+    OPENRAVE_ASSERT_FORMAT(!!pmanip, "worker robot %s does not have manipulator %s", _probot->GetName()%_pmanip->GetName(), ORE_InvalidState);
+    candidate._vikreturns.resize(0);
+    bool bsuccess = pmanip->FindIKSolutions(candidate._ikparam, candidate._vfree, candidate._ikfilteroptions, candidate._vikreturns);
+    candidate._status = bsuccess ? 2 : 1;
+    return bsuccess ? 1 : 0;
+}
+
 bool ManipulatorIKGoalSampler::SampleAll(std::list<IkReturnPtr>& samples, int maxsamples, int maxchecksamples)
 {
     // currently this is a very slow implementation...
@@ -3709,5 +4381,21 @@ void ManipulatorIKGoalSampler::SetJitter(dReal maxdist)
     _fjittermaxdist = maxdist;
 }
 
+void ManipulatorIKGoalSampler::SetParallel(PlannerParametersWorkerPoolPtr pool, int numcandidates)
+{
+    _pool = pool;
+    _numparallelcandidates = numcandidates;
+    _listpendingcandidates.clear();
+    if( !!_pool ) {
+        // the scene does not change while goals are sampled for one plan, so only need to synchronize once here instead of on every Sample
+        _pool->Synchronize();
+    }
+}
+
+void ManipulatorIKGoalSampler::SetDeadline(uint64_t deadline)
+{
+    _deadline = deadline;
+}
+
 } // planningutils
 } // OpenRAVE
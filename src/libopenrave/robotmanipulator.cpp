@@ -392,6 +392,24 @@ bool RobotBase::Manipulator::FindIKSolutions(const IkParameterization& goal, con
     return vFreeParameters.size() == 0 ? pIkSolver->SolveAll(localgoal,filteroptions,vikreturns) : pIkSolver->SolveAll(localgoal,vFreeParameters,filteroptions,vikreturns);
 }
 
+int RobotBase::Manipulator::FindIKSolutionsBatch(const std::vector<IkParameterization>& goals, int filteroptions, std::vector< std::vector<IkReturnPtr> >& vikreturns) const
+{
+    IkSolverBasePtr pIkSolver = GetIkSolver();
+    OPENRAVE_ASSERT_FORMAT(!!pIkSolver, "manipulator %s:%s does not have an IK solver set",RobotBasePtr(__probot)->GetName()%GetName(),ORE_Failed);
+    BOOST_ASSERT(pIkSolver->GetManipulator() == shared_from_this() );
+    std::vector<IkParameterization> vlocalgoals(goals.size());
+    if( !!__pBase ) {
+        Transform tBaseInv = __pBase->GetTransform().inverse();
+        for(size_t i = 0; i < goals.size(); ++i) {
+            vlocalgoals[i] = tBaseInv*goals[i];
+        }
+    }
+    else {
+        vlocalgoals = goals;
+    }
+    return pIkSolver->SolveAllBatch(vlocalgoals,filteroptions,vikreturns);
+}
+
 IkParameterization RobotBase::Manipulator::GetIkParameterization(IkParameterizationType iktype, bool inworld) const
 {
     IkParameterization ikp;
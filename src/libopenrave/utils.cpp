@@ -16,6 +16,8 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "libopenrave.h"
 #include <openrave/utils.h>
+#include <boost/thread/condition.hpp>
+#include <exception>
 
 #include "md5.h"
 
@@ -102,6 +104,152 @@ std::string& SearchAndReplace(std::string& out, const std::string& in, const std
     return out;
 }
 
+/// \brief state of one ParallelFor call shared by the threads that work on it
+struct ParallelForJob
+{
+    ParallelForJob(size_t count, const boost::function<void(size_t)>& fn, int nmaxworkers) : _count(count), _fn(fn), _nextindex(0), _nworkers(0), _nmaxworkers(nmaxworkers), _bFailed(false) {
+    }
+
+    size_t _count;
+    const boost::function<void(size_t)>& _fn;
+    size_t _nextindex; ///< next index to run
+    int _nworkers; ///< pool threads currently working on the job
+    int _nmaxworkers; ///< maximum number of pool threads working on the job, the calling thread is not counted
+    bool _bFailed; ///< true if fn threw, stops handing out indices
+    std::exception_ptr _exception; ///< first exception thrown by fn
+};
+
+/// \brief threads shared by all ParallelFor calls of the process
+class ParallelForPool
+{
+public:
+    ParallelForPool() : _bShutdown(false) {
+    }
+
+    ~ParallelForPool()
+    {
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            _bShutdown = true;
+        }
+        _conditionJobs.notify_all();
+        FOREACH(itthread, _vthreads) {
+            (*itthread)->join();
+        }
+    }
+
+    static ParallelForPool& GetInstance()
+    {
+        static ParallelForPool s_pool;
+        return s_pool;
+    }
+
+    void Run(size_t count, const boost::function<void(size_t)>& fn, int nthreads)
+    {
+        ParallelForJob job(count, fn, nthreads-1);
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            while( (int)_vthreads.size() < min(job._nmaxworkers, s_nMaxThreads) ) {
+                _vthreads.push_back(boost::shared_ptr<boost::thread>(new boost::thread(boost::bind(&ParallelForPool::_PoolThread, this))));
+            }
+            _listJobs.push_back(&job);
+        }
+        _conditionJobs.notify_all();
+        _Work(job);
+        {
+            boost::mutex::scoped_lock lock(_mutex);
+            // no pool thread can start on the job once it is removed, so only have to wait for the ones already on it
+            _listJobs.remove(&job);
+            while( job._nworkers > 0 ) {
+                _conditionDone.wait(lock);
+            }
+        }
+        if( !!job._exception ) {
+            std::rethrow_exception(job._exception);
+        }
+    }
+
+private:
+    /// \brief runs the indices of job until all are handed out or one failed
+    void _Work(ParallelForJob& job)
+    {
+        while(1) {
+            size_t index;
+            {
+                boost::mutex::scoped_lock lock(_mutex);
+                if( job._bFailed || job._nextindex >= job._count ) {
+                    return;
+                }
+                index = job._nextindex++;
+            }
+            try {
+                job._fn(index);
+            }
+            catch(...) {
+                boost::mutex::scoped_lock lock(_mutex);
+                if( !job._bFailed ) {
+                    job._bFailed = true;
+                    job._exception = std::current_exception();
+                }
+            }
+        }
+    }
+
+    void _PoolThread()
+    {
+        boost::mutex::scoped_lock lock(_mutex);
+        while( !_bShutdown ) {
+            ParallelForJob* pjob = NULL;
+            FOREACH(itjob, _listJobs) {
+                if( (*itjob)->_nworkers < (*itjob)->_nmaxworkers && !(*itjob)->_bFailed && (*itjob)->_nextindex < (*itjob)->_count ) {
+                    pjob = *itjob;
+                    break;
+                }
+            }
+            if( !pjob ) {
+                _conditionJobs.wait(lock);
+                continue;
+            }
+            ++pjob->_nworkers;
+            lock.unlock();
+            _Work(*pjob);
+            lock.lock();
+            if( --pjob->_nworkers == 0 ) {
+                _conditionDone.notify_all();
+            }
+        }
+    }
+
+    static const int s_nMaxThreads = 256;
+
+    boost::mutex _mutex; ///< protects all jobs and _listJobs
+    boost::condition _conditionJobs; ///< notified when a job is added or the pool shuts down
+    boost::condition _conditionDone; ///< notified when the last pool thread leaves a job
+    std::list<ParallelForJob*> _listJobs; ///< running ParallelFor calls, owned by their calling threads
+    std::vector< boost::shared_ptr<boost::thread> > _vthreads;
+    bool _bShutdown;
+};
+
+int GetNumParallelThreads(int nthreads)
+{
+    if( nthreads > 0 ) {
+        return nthreads;
+    }
+    return max(1, (int)boost::thread::hardware_concurrency());
+}
+
+void ParallelFor(size_t count, const boost::function<void(size_t)>& fn, int nthreads)
+{
+    nthreads = (int)min(size_t(GetNumParallelThreads(nthreads)), count);
+    if( nthreads <= 1 ) {
+        for(size_t index = 0; index < count; ++index) {
+            fn(index);
+        }
+        return;
+    }
+    ParallelForPool::GetInstance().Run(count, fn, nthreads);
+}
+
 std::string GetFilenameUntilSeparator(std::istream& sinput, char separator)
 {
     std::string filename;
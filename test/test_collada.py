@@ -561,3 +561,25 @@ class TestCOLLADA(EnvironmentSetup):
         env2.Load('test_externalgrab.dae')
         misc.CompareEnvironments(env, env2)
         
+
+    def test_parallelgeometry(self):
+        self.log.info('meshes converted by several threads should be the same as when converted by one thread')
+        env=self.env
+        env2 = Environment()
+        try:
+            for robotfile in ['robots/pr2-beta-static.zae', 'robots/neuronics-katana.zae']:
+                env.Reset()
+                env2.Reset()
+                robot1 = env.ReadRobotURI(robotfile, {'numthreads':'1'})
+                env.Add(robot1)
+                robot2 = env2.ReadRobotURI(robotfile, {'numthreads':'4'})
+                env2.Add(robot2)
+                for link1, link2 in zip(robot1.GetLinks(), robot2.GetLinks()):
+                    assert(link1.GetName() == link2.GetName())
+                    assert([geom.GetName() for geom in link1.GetGeometries()] == [geom.GetName() for geom in link2.GetGeometries()])
+                    mesh1 = link1.GetCollisionData()
+                    mesh2 = link2.GetCollisionData()
+                    assert(array_equal(mesh1.indices, mesh2.indices))
+                    assert(transdist(mesh1.vertices, mesh2.vertices) <= g_epsilon)
+        finally:
+            env2.Destroy()
@@ -15,6 +15,9 @@ from common_test_openrave import *
 from subprocess import Popen, PIPE
 import shutil
 import threading
+import json
+import struct
+import base64
 
 class TestEnvironment(EnvironmentSetup):
     def test_load(self):
@@ -56,6 +59,355 @@ class TestEnvironment(EnvironmentSetup):
         self.LoadDataEnv(xml)
         assert(env.GetBodies()[0].GetURI().find('data/mug1.dae') >= 0)
 
+    def test_msgpackmesh(self):
+        env=self.env
+        self.LoadEnv('data/mug1.dae')
+        body=env.GetBodies()[0]
+        data = env.WriteToMemory('msgpack')
+        env2=Environment()
+        try:
+            assert(env2.LoadData(data))
+            body2=env2.GetBodies()[0]
+            trimesh=env.Triangulate(body)
+            trimesh2=env2.Triangulate(body2)
+            assert(trimesh.indices.shape==trimesh2.indices.shape)
+            assert(transdist(trimesh.vertices,trimesh2.vertices) <= g_epsilon)
+        finally:
+            env2.Destroy()
+
+    def test_binarymesh(self):
+        env=self.env
+        self.LoadEnv('data/mug1.dae')
+        body=env.GetBodies()[0]
+        for format in ['json', 'msgpack']:
+            data = env.WriteToMemory(format)
+            binarydata = env.WriteToMemory(format, 0, {'binaryMesh':'1'})
+            assert(len(binarydata) < len(data))
+            if format == 'json':
+                scene = json.loads(binarydata)
+                meshes = [geometry['mesh'] for link in scene['bodies'][0]['links'] for geometry in link['geometries'] if 'mesh' in geometry]
+                assert(len(meshes) > 0)
+                assert(all([mesh['vertices']['encoding'] == 'base64' and mesh['indices']['dtype'] == 'int32' for mesh in meshes]))
+                # indices past the vertices and blobs with partial elements are rejected
+                for badindices in [struct.pack('=3i',0,0,1<<30), '\x00'*5]:
+                    meshes[0]['indices']['data'] = base64.b64encode(badindices)
+                    env3=Environment()
+                    try:
+                        try:
+                            bloaded = env3.LoadData(json.dumps(scene))
+                        except openrave_exception:
+                            bloaded = False
+                        assert(not bloaded)
+                    finally:
+                        env3.Destroy()
+            env2=Environment()
+            try:
+                assert(env2.LoadData(binarydata))
+                body2=env2.GetBodies()[0]
+                trimesh=env.Triangulate(body)
+                trimesh2=env2.Triangulate(body2)
+                assert(array_equal(trimesh.indices,trimesh2.indices))
+                assert(transdist(trimesh.vertices,trimesh2.vertices) <= g_epsilon)
+            finally:
+                env2.Destroy()
+
+    def test_cachedmeshimport(self):
+        env=self.env
+        RaveClearLoaderCaches(LoaderCacheType.MeshImport)
+        with env:
+            body1=env.ReadKinBodyURI('data/mug1.kinbody.xml')
+            env.Add(body1,True)
+            trimesh1=env.Triangulate(body1)
+            nhits,nmisses,nentries = RaveGetLoaderCacheStats(LoaderCacheType.MeshImport)
+            assert(nmisses > 0 and nentries > 0)
+            # scaled bodies share the file, but have to be imported separately
+            body2=env.ReadKinBodyURI('data/mug1.kinbody.xml',{'scalegeometry':'2'})
+            env.Add(body2,True)
+            trimesh2=env.Triangulate(body2)
+            assert(trimesh1.indices.shape==trimesh2.indices.shape)
+            assert(transdist(2*trimesh1.vertices,trimesh2.vertices) <= g_epsilon)
+            nhits2,nmisses2,nentries2 = RaveGetLoaderCacheStats(LoaderCacheType.MeshImport)
+            assert(nmisses2 > nmisses and nentries2 > nentries)
+        env2=Environment()
+        try:
+            with env2:
+                assert(env2.Load('data/mug1.kinbody.xml'))
+                body3=env2.GetBodies()[0]
+                trimesh3=env2.Triangulate(body3)
+                assert(trimesh1.indices.shape==trimesh3.indices.shape)
+                assert(transdist(trimesh1.vertices,trimesh3.vertices) <= g_epsilon)
+                nhits3,nmisses3,nentries3 = RaveGetLoaderCacheStats(LoaderCacheType.MeshImport)
+                assert(nhits3 > nhits2 and nmisses3 == nmisses2 and nentries3 == nentries2)
+        finally:
+            env2.Destroy()
+
+        RaveClearLoaderCaches(LoaderCacheType.MeshImport)
+        assert(RaveGetLoaderCacheStats(LoaderCacheType.MeshImport)[2] == 0)
+
+    def test_scenecache(self):
+        env=self.env
+        cachedir = os.path.join(os.getcwd(),'scenecachetest')
+        if os.path.exists(cachedir):
+            shutil.rmtree(cachedir)
+        os.mkdir(cachedir)
+        OPENRAVE_SCENE_CACHE_DIR = os.environ.get('OPENRAVE_SCENE_CACHE_DIR',None)
+        os.environ['OPENRAVE_SCENE_CACHE_DIR'] = cachedir
+        env2=Environment()
+        env3=Environment()
+        try:
+            self.LoadEnv('data/mug1.kinbody.xml')
+            assert(len([f for f in os.listdir(cachedir) if f.endswith('.orbin')])==1)
+            assert(env2.Load('data/mug1.kinbody.xml'))
+            assert(len(env2.GetBodies())==1)
+            body=env.GetBodies()[0]
+            body2=env2.GetBodies()[0]
+            assert(body.GetName()==body2.GetName())
+            assert(body.GetLinks()[0].GetMass()==body2.GetLinks()[0].GetMass())
+            trimesh=env.Triangulate(body)
+            trimesh2=env2.Triangulate(body2)
+            assert(trimesh.indices.shape==trimesh2.indices.shape)
+            assert(transdist(trimesh.vertices,trimesh2.vertices) <= g_epsilon)
+
+            # loading into an environment that already has the bodies has to behave the same as without the cache
+            del os.environ['OPENRAVE_SCENE_CACHE_DIR']
+            assert(env3.Load('data/mug1.kinbody.xml'))
+            bnocacheloaded = env3.Load('data/mug1.kinbody.xml')
+            nocachenames = sorted([b.GetName() for b in env3.GetBodies()])
+            os.environ['OPENRAVE_SCENE_CACHE_DIR'] = cachedir
+            bcacheloaded = env2.Load('data/mug1.kinbody.xml')
+            assert(bcacheloaded==bnocacheloaded)
+            assert(sorted([b.GetName() for b in env2.GetBodies()])==nocachenames)
+            assert(len([f for f in os.listdir(cachedir) if f.endswith('.orbin')])==1)
+        finally:
+            env2.Destroy()
+            env3.Destroy()
+            if OPENRAVE_SCENE_CACHE_DIR is None:
+                del os.environ['OPENRAVE_SCENE_CACHE_DIR']
+            else:
+                os.environ['OPENRAVE_SCENE_CACHE_DIR'] = OPENRAVE_SCENE_CACHE_DIR
+            shutil.rmtree(cachedir)
+
+    def test_collisionproxy(self):
+        env=self.env
+        cachedir = os.path.join(os.getcwd(),'collisionproxytest')
+        if os.path.exists(cachedir):
+            shutil.rmtree(cachedir)
+        atts = {'collisionproxy':'decimate', 'collisionproxymaxtriangles':'100', 'collisionproxycachedir':cachedir}
+        env2=Environment()
+        try:
+            assert(env.Load('data/mug1.kinbody.xml', atts))
+            link=env.GetBodies()[0].GetLinks()[0]
+            assert(link.GetGroupNumGeometries('collisionproxy') == len(link.GetGeometries()))
+            proxies=[info._meshcollision for info in link.GetGeometriesFromGroup('collisionproxy')]
+            assert(all([len(proxy.indices) <= 100 for proxy in proxies]))
+            # decimated proxies are inflated to contain the original meshes
+            for geom, proxy in zip(link.GetGeometries(), proxies):
+                vertices = geom.GetCollisionMesh().vertices
+                assert(all(numpy.min(proxy.vertices,0) <= numpy.min(vertices,0)+g_epsilon))
+                assert(all(numpy.max(proxy.vertices,0) >= numpy.max(vertices,0)-g_epsilon))
+            assert(len([f for f in os.listdir(cachedir) if f.endswith('.orproxy')]) > 0)
+            # the same meshes are read from the cache
+            assert(env2.Load('data/mug1.kinbody.xml', atts))
+            link2=env2.GetBodies()[0].GetLinks()[0]
+            proxies2=[info._meshcollision for info in link2.GetGeometriesFromGroup('collisionproxy')]
+            assert(len(proxies) == len(proxies2))
+            for proxy, proxy2 in zip(proxies, proxies2):
+                assert(array_equal(proxy.indices,proxy2.indices))
+                assert(transdist(proxy.vertices,proxy2.vertices) <= g_epsilon)
+
+            # convex hulls never have more vertices than the original meshes
+            env3=Environment()
+            try:
+                assert(env3.Load('data/mug1.kinbody.xml', {'collisionproxy':'convexhull', 'collisionproxycachedir':cachedir}))
+                link3=env3.GetBodies()[0].GetLinks()[0]
+                assert(link3.GetGroupNumGeometries('collisionproxy') == len(link3.GetGeometries()))
+                for geom, info in zip(link3.GetGeometries(), link3.GetGeometriesFromGroup('collisionproxy')):
+                    hull=info._meshcollision
+                    assert(len(hull.indices) > 0)
+                    assert(len(hull.vertices) <= len(geom.GetCollisionMesh().vertices))
+            finally:
+                env3.Destroy()
+
+            # only the loaded bodies are switched to the proxy group
+            checker=RaveCreateCollisionChecker(env2,'fcl_')
+            if checker is not None:
+                env2.Reset()
+                env2.SetCollisionChecker(checker)
+                box=RaveCreateKinBody(env2,'')
+                box.InitFromBoxes(array([[0,0,0,0.1,0.1,0.1]]),True)
+                box.SetName('box')
+                env2.Add(box)
+                assert(env2.Load('data/mug1.kinbody.xml', atts))
+                mug=[body for body in env2.GetBodies() if body != box][0]
+                assert(checker.GetBodyGeometryGroup(mug) == 'collisionproxy')
+                assert(checker.GetBodyGeometryGroup(box) == '')
+        finally:
+            env2.Destroy()
+            if os.path.exists(cachedir):
+                shutil.rmtree(cachedir)
+
+    def test_streamjsonwriter(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        data = env.WriteToMemory('json')
+        # the output is the same for any number of serializing threads
+        assert(data == env.WriteToMemory('json', 0, {'numThreads':'1'}))
+        scene = json.loads(data)
+        assert(sorted([body['name'] for body in scene['bodies']]) == sorted([body.GetName() for body in env.GetBodies()]))
+        env2=Environment()
+        try:
+            assert(env2.LoadData(data))
+            assert(len(env2.GetBodies()) == len(env.GetBodies()))
+            for body in env.GetBodies():
+                body2=env2.GetKinBody(body.GetName())
+                assert(transdist(body.GetTransform(),body2.GetTransform()) <= g_epsilon)
+                assert(len(body.GetLinks()) == len(body2.GetLinks()))
+        finally:
+            env2.Destroy()
+
+    def test_lazyload(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        data = env.WriteToMemory('json')
+        staticnames = [body.GetName() for body in env.GetBodies() if not body.IsRobot() and len(body.GetJoints()) == 0]
+        assert(len(staticnames) > 0)
+        env2=Environment()
+        try:
+            assert(env2.LoadData(data, {'lazyload':'1'}))
+            assert(len(env2.GetRobots()) == len(env.GetRobots()))
+            assert(sorted([name for name, ab in env2.GetLazyBodies()]) == sorted(staticnames))
+            assert(len(env2.GetBodies()) == len(env.GetBodies()) - len(staticnames))
+
+            # querying by name creates the body
+            body=env.GetKinBody(staticnames[0])
+            body2=env2.GetKinBody(staticnames[0])
+            assert(body2 is not None)
+            assert(transdist(body.GetTransform(),body2.GetTransform()) <= g_epsilon)
+            assert(len(env2.GetLazyBodies()) == len(staticnames)-1)
+
+            for name, ablazy in env2.GetLazyBodies():
+                ab2 = env.GetKinBody(name).ComputeAABB()
+                assert(transdist(ablazy.pos(),ab2.pos()) <= g_epsilon)
+                assert(transdist(ablazy.extents(),ab2.extents()) <= g_epsilon)
+
+            # extracted infos contain the lazy bodies without creating them
+            info = env2.ExtractInfo()
+            assert(sorted([bodyinfo._name for bodyinfo in info._vBodyInfos]) == sorted([body.GetName() for body in env.GetBodies()]))
+            assert(len(env2.GetLazyBodies()) == len(staticnames)-1)
+
+            # lazy bodies need names that are unique among the bodies and the other lazy bodies
+            lazyinfos = dict([(bodyinfo._name, bodyinfo) for bodyinfo in info._vBodyInfos])
+            for name in [staticnames[0], env2.GetLazyBodies()[0][0]]:
+                try:
+                    env2.AddLazyBody(lazyinfos[name])
+                    assert(False)
+                except openrave_exception:
+                    pass
+            assert(len(env2.GetLazyBodies()) == len(staticnames)-1)
+
+            # collision queries against the environment create the lazy bodies around the query
+            name, ablazy = env2.GetLazyBodies()[0]
+            with env2:
+                querybody = RaveCreateKinBody(env2,'')
+                querybody.InitFromBoxes(array([r_[ablazy.pos(),0.001,0.001,0.001]]),True)
+                querybody.SetName('lazyquery')
+                env2.Add(querybody)
+                env2.CheckCollision(querybody)
+                assert(name not in [lazyname for lazyname, ab in env2.GetLazyBodies()])
+                env2.Remove(querybody)
+
+            nlazy = len(env2.GetLazyBodies())
+            assert(env2.MaterializeLazyBodies(AABB([0,0,0],[1000,1000,1000])) == nlazy)
+            assert(len(env2.GetLazyBodies()) == 0)
+            assert(len(env2.GetBodies()) == len(env.GetBodies()))
+        finally:
+            env2.Destroy()
+
+        # serializing writes the lazy bodies
+        env3=Environment()
+        try:
+            assert(env3.LoadData(data, {'lazyload':'1'}))
+            assert(len(env3.GetLazyBodies()) == len(staticnames))
+            scene = json.loads(env3.WriteToMemory('json'))
+            assert(sorted([body['name'] for body in scene['bodies']]) == sorted([body.GetName() for body in env.GetBodies()]))
+            assert(len(env3.GetLazyBodies()) == 0)
+        finally:
+            env3.Destroy()
+
+    def test_jsondocumentcache(self):
+        env=self.env
+        self.LoadEnv('data/mug1.kinbody.xml')
+        env.GetBodies()[0].SetName('mug')
+        filename = os.path.join(os.getcwd(),'jsondocumentcachetest.json')
+        env.Save(filename)
+        RaveClearLoaderCaches(LoaderCacheType.JSONDocument)
+        assert(RaveGetLoaderCacheStats(LoaderCacheType.JSONDocument)[2] == 0)
+        env2=Environment()
+        env3=Environment()
+        try:
+            # documents read by other environments are shared
+            assert(env2.Load(filename))
+            nhits,nmisses,nentries = RaveGetLoaderCacheStats(LoaderCacheType.JSONDocument)
+            assert(nmisses > 0 and nentries == 1)
+            assert(env3.Load(filename))
+            nhits2,nmisses2,nentries2 = RaveGetLoaderCacheStats(LoaderCacheType.JSONDocument)
+            assert(nhits2 > nhits and nmisses2 == nmisses and nentries2 == 1)
+            assert(env2.GetKinBody('mug') is not None and env3.GetKinBody('mug') is not None)
+
+            # modified files are read again, even when they keep the same size
+            env.GetBodies()[0].SetName('gum')
+            env.Save(filename)
+            env3.Reset()
+            assert(env3.Load(filename))
+            assert(env3.GetKinBody('gum') is not None)
+            nhits3,nmisses3,nentries3 = RaveGetLoaderCacheStats(LoaderCacheType.JSONDocument)
+            assert(nmisses3 > nmisses2 and nentries3 == 1)
+        finally:
+            env2.Destroy()
+            env3.Destroy()
+            os.remove(filename)
+            RaveClearLoaderCaches(LoaderCacheType.JSONDocument)
+
+    def test_updatefrominforevision(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        info = env.ExtractInfo()
+        for bodyinfo in info._vBodyInfos:
+            bodyinfo._revision = 1
+        env2=Environment()
+        try:
+            createdbodies, modifiedbodies, removedbodies = env2.UpdateFromInfo(info)
+            assert(len(createdbodies)==len(env.GetBodies()))
+            createdbodies, modifiedbodies, removedbodies = env2.UpdateFromInfo(info)
+            assert(len(createdbodies)==0 and len(modifiedbodies)==0 and len(removedbodies)==0)
+
+            # moved bodies have to be updated even if the revision is the same
+            body2=env2.GetKinBody(info._vBodyInfos[0]._name)
+            T=body2.GetTransform()
+            body2.SetTransform(matrixFromAxisAngle([0,0,1]))
+            createdbodies, modifiedbodies, removedbodies = env2.UpdateFromInfo(info)
+            assert([body.GetName() for body in modifiedbodies]==[body2.GetName()])
+            assert(transdist(body2.GetTransform(),T) <= g_epsilon)
+
+            # so do bodies whose parameters changed without moving
+            body2.GetLinks()[0].Enable(not body2.GetLinks()[0].IsEnabled())
+            createdbodies, modifiedbodies, removedbodies = env2.UpdateFromInfo(info)
+            assert([body.GetName() for body in modifiedbodies]==[body2.GetName()])
+
+            # extracted infos carry the revision as long as the body is unchanged
+            assert(body2.ExtractInfo()._revision == 1)
+            assert(body2.ExtractInfo()._revision == 1)
+            body2.SetTransform(matrixFromAxisAngle([0,0,1]))
+            assert(body2.ExtractInfo()._revision == 0)
+            createdbodies, modifiedbodies, removedbodies = env2.UpdateFromInfo(info)
+
+            # reordered infos keep matching the same bodies
+            info._vBodyInfos = info._vBodyInfos[::-1]
+            createdbodies, modifiedbodies, removedbodies = env2.UpdateFromInfo(info)
+            assert(len(createdbodies)==0 and len(modifiedbodies)==0 and len(removedbodies)==0)
+        finally:
+            env2.Destroy()
+
     def test_scalegeometry(self):
         env=self.env
         with env:
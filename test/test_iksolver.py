@@ -94,6 +94,185 @@ class TestIkSolver(EnvironmentSetup):
             sampler=planningutils.ManipulatorIKGoalSampler(robot.GetActiveManipulator(),[ikparam],nummaxsamples=20,nummaxtries=10,jitter=0.03)
             assert(sampler.Sample() is not None)
 
+    def test_goalsamplerparallel(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot,IkParameterization.Type.Transform6D)
+        if not ikmodel.load():
+            ikmodel.autogenerate()
+
+        with env:
+            manip = robot.GetActiveManipulator()
+            ikparam=manip.GetIkParameterization(IkParameterizationType.Transform6D)
+            sampler=planningutils.ManipulatorIKGoalSampler(manip,[ikparam],nummaxsamples=20,nummaxtries=10,jitter=0)
+            serialsamples = sampler.SampleAll()
+            assert(len(serialsamples) > 0)
+            sampler=planningutils.ManipulatorIKGoalSampler(manip,[ikparam],nummaxsamples=20,nummaxtries=10,jitter=0)
+            sampler.SetParallel(4,0)
+            parallelsamples = sampler.SampleAll()
+            # same candidates are evaluated in the same order, so solutions have to match exactly
+            assert(len(parallelsamples) == len(serialsamples))
+            for serialsample, parallelsample in izip(serialsamples, parallelsamples):
+                assert(transdist(serialsample.GetSolution(), parallelsample.GetSolution()) <= g_epsilon)
+
+            sampler=planningutils.ManipulatorIKGoalSampler(manip,[ikparam],nummaxsamples=20,nummaxtries=10,jitter=0)
+            sampler.SetParallel(4,0)
+            sampler.SetDeadline(1)
+            assert(sampler.Sample() is None)
+
+    def test_findiksolutionsbatch(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot,IkParameterization.Type.Transform6D)
+        if not ikmodel.load():
+            ikmodel.autogenerate()
+
+        with env:
+            manip = ikmodel.manip
+            lower,upper = robot.GetDOFLimits(manip.GetArmIndices())
+            orgvalues = robot.GetDOFValues()
+            poses = []
+            for i in range(10):
+                robot.SetDOFValues(lower+numpy.random.rand(len(lower))*(upper-lower),manip.GetArmIndices())
+                poses.append(manip.GetTransform())
+            robot.SetDOFValues(orgvalues)
+            allsolutions = manip.FindIKSolutionsBatch(poses,IkFilterOptions.CheckEnvCollisions)
+            assert(len(allsolutions) == len(poses))
+            for T, solutions in izip(poses, allsolutions):
+                serialsolutions = manip.FindIKSolutions(T,IkFilterOptions.CheckEnvCollisions)
+                assert(len(solutions) == len(serialsolutions))
+                for solution, serialsolution in izip(solutions, serialsolutions):
+                    assert(transdist(solution, serialsolution) <= g_epsilon)
+            # robot state has to be restored
+            assert(transdist(robot.GetDOFValues(), orgvalues) <= g_epsilon)
+
+    def test_iksolutionpool(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot,IkParameterization.Type.Transform6D)
+        if not ikmodel.load():
+            ikmodel.autogenerate()
+
+        with env:
+            manip = ikmodel.manip
+            lower,upper = robot.GetDOFLimits(manip.GetArmIndices())
+            orgvalues = robot.GetDOFValues()
+            allposes = []
+            for i in range(3):
+                poses = []
+                for j in range(5):
+                    robot.SetDOFValues(lower+numpy.random.rand(len(lower))*(upper-lower),manip.GetArmIndices())
+                    poses.append(manip.GetTransform())
+                allposes.append(poses)
+            robot.SetDOFValues(orgvalues)
+            # the solution pools of one batch call are reused by the next ones, so results cannot leak between calls
+            firstsolutions = manip.FindIKSolutionsBatch(allposes[0],IkFilterOptions.IgnoreEndEffectorCollisions)
+            for poses in allposes[1:]+allposes[:1]:
+                allsolutions = manip.FindIKSolutionsBatch(poses,IkFilterOptions.IgnoreEndEffectorCollisions)
+                assert(len(allsolutions) == len(poses))
+                for T, solutions in izip(poses, allsolutions):
+                    serialsolutions = manip.FindIKSolutions(T,IkFilterOptions.IgnoreEndEffectorCollisions)
+                    assert(len(solutions) == len(serialsolutions))
+                    for solution, serialsolution in izip(solutions, serialsolutions):
+                        assert(transdist(solution, serialsolution) <= g_epsilon)
+            for solutions, solutions2 in izip(firstsolutions, allsolutions):
+                assert(len(solutions) == len(solutions2))
+                for solution, solution2 in izip(solutions, solutions2):
+                    assert(transdist(solution, solution2) <= g_epsilon)
+
+    def test_ikbatchsolver(self):
+        env=self.env
+        self.LoadEnv('robots/puma.robot.xml')
+        robot=env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot,IkParameterization.Type.Transform6D)
+        ikmodel.generate(batch=True)
+        import ctypes
+        assert(hasattr(ctypes.CDLL(ikmodel.getfilename(True)),'ComputeIkBatch'))
+
+        with env:
+            manip = ikmodel.manip
+            lower,upper = robot.GetDOFLimits(manip.GetArmIndices())
+            orgvalues = robot.GetDOFValues()
+            poses = []
+            for i in range(20):
+                robot.SetDOFValues(lower+numpy.random.rand(len(lower))*(upper-lower),manip.GetArmIndices())
+                poses.append(manip.GetTransform())
+            robot.SetDOFValues(orgvalues)
+            # ComputeIkBatch has to return the same solutions as solving every pose with ComputeIk2
+            for filteroptions in [0, IkFilterOptions.CheckEnvCollisions]:
+                allsolutions = manip.FindIKSolutionsBatch(poses,filteroptions)
+                assert(len(allsolutions) == len(poses))
+                for T, solutions in izip(poses, allsolutions):
+                    serialsolutions = manip.FindIKSolutions(T,filteroptions)
+                    assert(len(solutions) == len(serialsolutions))
+                    for solution, serialsolution in izip(solutions, serialsolutions):
+                        assert(transdist(solution, serialsolution) <= g_epsilon)
+            assert(transdist(robot.GetDOFValues(), orgvalues) <= g_epsilon)
+
+    def test_parallelfreejoints(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot,IkParameterization.Type.Transform6D)
+        if not ikmodel.load():
+            ikmodel.autogenerate()
+
+        with env:
+            manip = ikmodel.manip
+            iksolver = manip.GetIkSolver()
+            assert(iksolver.GetNumFreeParameters() > 0)
+            T = manip.GetTransform()
+            serialsolutions = manip.FindIKSolutions(T,IkFilterOptions.CheckEnvCollisions)
+            serialsolution = manip.FindIKSolution(T,IkFilterOptions.CheckEnvCollisions)
+            iksolver.SendCommand('SetParallelFreeJoints 4')
+            try:
+                assert(int(iksolver.SendCommand('GetParallelFreeJoints')) == 4)
+                parallelsolutions = manip.FindIKSolutions(T,IkFilterOptions.CheckEnvCollisions)
+                parallelsolution = manip.FindIKSolution(T,IkFilterOptions.CheckEnvCollisions)
+            finally:
+                iksolver.SendCommand('SetParallelFreeJoints 0')
+            assert(len(parallelsolutions) == len(serialsolutions))
+            for solution, parallel in izip(serialsolutions, parallelsolutions):
+                assert(transdist(solution, parallel) <= g_epsilon)
+            assert(transdist(serialsolution, parallelsolution) <= g_epsilon)
+
+    def test_solutioncache(self):
+        env=self.env
+        self.LoadEnv('data/lab1.env.xml')
+        robot=env.GetRobots()[0]
+        ikmodel = databases.inversekinematics.InverseKinematicsModel(robot,IkParameterization.Type.Transform6D)
+        if not ikmodel.load():
+            ikmodel.autogenerate()
+
+        with env:
+            manip = ikmodel.manip
+            iksolver = manip.GetIkSolver()
+            T = manip.GetTransform()
+            uncachedsolutions = manip.FindIKSolutions(T,IkFilterOptions.CheckEnvCollisions)
+            iksolver.SendCommand('SetSolutionCache 100')
+            try:
+                solutions0 = manip.FindIKSolutions(T,IkFilterOptions.CheckEnvCollisions)
+                # moving the arm does not invalidate the cache
+                robot.SetDOFValues(solutions0[-1],manip.GetArmIndices())
+                solutions1 = manip.FindIKSolutions(T,IkFilterOptions.CheckEnvCollisions)
+                hits, misses, insertions, evictions, entries = [int(x) for x in iksolver.SendCommand('GetSolutionCacheStats').split()]
+                assert(hits == 1 and misses == 1 and entries == 1)
+                # moving any other body does
+                body = env.GetBodies()[1] if env.GetBodies()[0] == robot else env.GetBodies()[0]
+                body.SetTransform(body.GetTransform())
+                manip.FindIKSolutions(T,IkFilterOptions.CheckEnvCollisions)
+                hits, misses, insertions, evictions, entries = [int(x) for x in iksolver.SendCommand('GetSolutionCacheStats').split()]
+                assert(hits == 1 and misses == 2)
+            finally:
+                iksolver.SendCommand('SetSolutionCache 0')
+            assert(len(solutions0) == len(uncachedsolutions) and len(solutions1) == len(uncachedsolutions))
+            for solution, solution0, solution1 in izip(uncachedsolutions, solutions0, solutions1):
+                assert(transdist(solution, solution0) <= g_epsilon)
+                assert(transdist(solution, solution1) <= g_epsilon)
+
     def test_jointlimitsfilter(self):
         env=self.env
         self.LoadEnv('data/lab1.env.xml')
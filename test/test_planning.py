@@ -49,7 +49,135 @@ class RunPlanning(EnvironmentSetup):
             assert(len(usedbodies) == 1 and usedbodies[0] == robot)
             useddofindices, usedconfigindices = spec.ExtractUsedIndices(robot)
             assert(sorted(useddofindices) == sorted(manip.GetArmIndices()))
-            
+
+    def test_verifytrajectoryparallel(self):
+        env = self.env
+        with env:
+            self.LoadEnv('data/lab1.env.xml')
+            robot = env.GetRobots()[0]
+            manip = robot.GetActiveManipulator()
+            robot.SetActiveDOFs(manip.GetArmIndices())
+            basemanip = interfaces.BaseManipulation(robot)
+            goal = robot.GetActiveDOFValues()
+            goal[0] += 0.5
+            goal[1] -= 0.3
+            traj = basemanip.MoveActiveJoints(goal=goal,maxiter=5000,steplength=0.01,maxtries=2,execute=False,outputtrajobj=True)
+            parameters = Planner.PlannerParameters()
+            parameters.SetRobotActiveJoints(robot)
+            with robot:
+                planningutils.VerifyTrajectory(parameters,traj,samplingstep=0.002)
+                planningutils.VerifyTrajectoryParallel(parameters,traj,samplingstep=0.002,nsegmentsperchunk=4)
+
+            # an obstacle on the path has to be found by both, and the pool of the environment has to see it
+            with robot:
+                robot.SetActiveDOFValues(traj.Sample(0.5*traj.GetDuration(),robot.GetActiveConfigurationSpecification()))
+                Tee = manip.GetEndEffectorTransform()
+            box = RaveCreateKinBody(env,'')
+            box.InitFromBoxes(array([[Tee[0,3],Tee[1,3],Tee[2,3],0.05,0.05,0.05]]),True)
+            box.SetName('obstacle')
+            env.Add(box)
+            messages = []
+            for verifyfn in [lambda: planningutils.VerifyTrajectory(parameters,traj,samplingstep=0.002), lambda: planningutils.VerifyTrajectoryParallel(parameters,traj,samplingstep=0.002,nsegmentsperchunk=4)]:
+                with robot:
+                    try:
+                        verifyfn()
+                        raise ValueError('verification should have failed')
+                    except openrave_exception as e:
+                        messages.append(str(e))
+            assert(messages[0] == messages[1])
+
+            # moving the obstacle away has to be synchronized too
+            Tbox = box.GetTransform()
+            box.SetTransform(matrixFromPose([1,0,0,0,10,10,10]))
+            with robot:
+                planningutils.VerifyTrajectoryParallel(parameters,traj,samplingstep=0.002,nsegmentsperchunk=4)
+
+            # moving it back only updates the transforms of the workers, which has to be seen as well
+            box.SetTransform(Tbox)
+            with robot:
+                try:
+                    planningutils.VerifyTrajectoryParallel(parameters,traj,samplingstep=0.002,nsegmentsperchunk=4)
+                    raise ValueError('verification should have failed')
+                except openrave_exception as e:
+                    assert(str(e) == messages[0])
+
+    def test_lazybirrt(self):
+        env = self.env
+        with env:
+            self.LoadEnv('data/lab1.env.xml')
+            robot = env.GetRobots()[0]
+            manip = robot.GetActiveManipulator()
+            robot.SetActiveDOFs(manip.GetArmIndices())
+            basemanip = interfaces.BaseManipulation(robot,plannername='lazybirrt')
+            goal = robot.GetActiveDOFValues()
+            goal[0] += 0.5
+            goal[1] -= 0.3
+            traj = basemanip.MoveActiveJoints(goal=goal,maxiter=5000,steplength=0.01,maxtries=2,execute=False,outputtrajobj=True)
+            with robot:
+                parameters = Planner.PlannerParameters()
+                parameters.SetRobotActiveJoints(robot)
+                planningutils.VerifyTrajectory(parameters,traj,samplingstep=0.002)
+            self.RunTrajectory(robot,traj)
+
+    def test_prm(self):
+        env = self.env
+        with env:
+            self.LoadEnv('data/lab1.env.xml')
+            robot = env.GetRobots()[0]
+            manip = robot.GetActiveManipulator()
+            robot.SetActiveDOFs(manip.GetArmIndices())
+            planner = RaveCreatePlanner(env,'prm')
+            basemanip = interfaces.BaseManipulation(robot,plannername='prm')
+            initial = robot.GetActiveDOFValues()
+            for i in range(2):
+                goal = array(initial)
+                goal[0] += 0.5
+                goal[1] -= 0.3*(i+1)
+                traj = basemanip.MoveActiveJoints(goal=goal,maxiter=5000,steplength=0.01,maxtries=1,execute=False,outputtrajobj=True)
+                with robot:
+                    parameters = Planner.PlannerParameters()
+                    parameters.SetRobotActiveJoints(robot)
+                    planningutils.VerifyTrajectory(parameters,traj,samplingstep=0.002)
+
+            # the roadmap is shared across planner instances, so the stats of a new planner show the grown roadmap
+            params = Planner.PlannerParameters()
+            params.SetRobotActiveJoints(robot)
+            params.SetInitialConfig(initial)
+            params.SetGoalConfig(goal)
+            assert(planner.InitPlan(robot,params))
+            key,numnodes,numedges,numqueries = planner.SendCommand('GetRoadmapStats').split()
+            assert(int(numnodes) >= 500)
+            filename = 'test_prm_roadmap.bin'
+            try:
+                assert(planner.SendCommand('SaveRoadmap %s'%filename) is not None)
+                planner.SendCommand('ClearRoadmap')
+                assert(int(planner.SendCommand('GetRoadmapStats').split()[1]) == 0)
+                planner.SendCommand('LoadRoadmap %s'%filename)
+                assert(int(planner.SendCommand('GetRoadmapStats').split()[1]) == int(numnodes))
+                traj = RaveCreateTrajectory(env,'')
+                assert(planner.PlanPath(traj))
+                planningutils.VerifyTrajectory(params,traj,samplingstep=0.002)
+            finally:
+                if os.path.exists(filename):
+                    os.remove(filename)
+
+            # collision results are kept per scene state, so moving an obstacle back reuses the results of its old place
+            obstacle = [body for body in env.GetBodies() if not body.IsRobot()][0]
+            Torig = obstacle.GetTransform()
+            obstacle.SetTransform(matrixFromPose([1,0,0,0,10,10,10]))
+            assert(planner.PlanPath(RaveCreateTrajectory(env,'')))
+            numstates = int(planner.SendCommand('GetRoadmapStats').split()[4])
+            obstacle.SetTransform(Torig)
+            assert(planner.PlanPath(RaveCreateTrajectory(env,'')))
+            assert(int(planner.SendCommand('GetRoadmapStats').split()[4]) == numstates)
+
+            # clearing the cache drops the roadmaps of the process, so initializing again starts an empty roadmap
+            planner.SendCommand('ClearRoadmapCache')
+            assert(int(planner.SendCommand('GetRoadmapStats').split()[5]) == 0)
+            assert(planner.InitPlan(robot,params))
+            stats = planner.SendCommand('GetRoadmapStats').split()
+            assert(int(stats[1]) == 0 and int(stats[5]) == 1)
+
     def test_ikplanning(self):
         env = self.env
         self.LoadEnv('data/lab1.env.xml')
@@ -245,6 +373,53 @@ class RunPlanning(EnvironmentSetup):
             traj = basemanip.MoveHandStraight(direction=array([ 0.78915764,  0.13771766,  0.59855163]),starteematrix=Tee,stepsize=0.01,minsteps=60,maxsteps=80,execute=False,outputtrajobj=True)
             self.RunTrajectory(robot,traj)
             
+    def test_workspacehighratetracking(self):
+        env = self.env
+        with env:
+            self.LoadEnv('data/lab1.env.xml')
+            robot = env.GetRobots()[0]
+            manip = robot.GetActiveManipulator()
+            ikmodel = databases.inversekinematics.InverseKinematicsModel(robot=robot,iktype=IkParameterization.Type.Transform6D)
+            if not ikmodel.load():
+                ikmodel.autogenerate()
+            robot.SetDOFValues(array([ -2.83686683e-01,   1.40828054e+00,   0.00000000e+00, 5.26754682e-01,  -3.14159265e+00,  -1.20655743e+00, -1.85448301e+00,   1.66533454e-16,   1.66533454e-16,         1.66533454e-16,   0.00000000e+00]))
+            robot.SetActiveDOFs(manip.GetArmIndices())
+            Tstart = manip.GetTransform()
+            Tgoal = array(Tstart)
+            Tgoal[2,3] -= 0.02
+            workspacetraj = RaveCreateTrajectory(env,'')
+            workspacetraj.Init(IkParameterization.GetConfigurationSpecificationFromType(IkParameterizationType.Transform6D,'linear'))
+            workspacetraj.Insert(0,r_[poseFromMatrix(Tstart),poseFromMatrix(Tgoal)])
+            planningutils.RetimeAffineTrajectory(workspacetraj,maxvelocities=ones(7),maxaccelerations=5*ones(7))
+
+            def track(extraparameters):
+                with robot:
+                    planner = RaveCreatePlanner(env,'workspacetrajectorytracker')
+                    params = Planner.PlannerParameters()
+                    params.SetRobotActiveJoints(robot)
+                    params.SetExtraParameters('<workspacetrajectory>%s</workspacetrajectory><_fsteplength>0.001</_fsteplength>%s'%(workspacetraj.serialize(0),extraparameters))
+                    assert(planner.InitPlan(robot,params))
+                    outputtraj = RaveCreateTrajectory(env,'')
+                    status = planner.PlanPath(outputtraj)
+                    if not (status.statusCode & PlannerStatusCode.HasSolution):
+                        return None
+                    robot.SetActiveDOFValues(outputtraj.Sample(outputtraj.GetDuration(),robot.GetActiveConfigurationSpecification()))
+                    assert(transdist(manip.GetTransform(),Tgoal) <= 1e-3)
+                    return outputtraj
+
+            steptraj = track('')
+            highratetraj = track('<highratetracking>1</highratetracking><highratecheckinterval>5</highratecheckinterval>')
+            assert(steptraj is not None and highratetraj is not None)
+
+            # an obstacle at the goal of the end effector is only allowed with ignorelastcollisionee
+            box = RaveCreateKinBody(env,'')
+            box.InitFromBoxes(array([[Tgoal[0,3],Tgoal[1,3],Tgoal[2,3],0.01,0.01,0.01]]),True)
+            box.SetName('obstacle')
+            env.Add(box)
+            for highrate in ['','<highratetracking>1</highratetracking><highratecheckinterval>5</highratecheckinterval>']:
+                assert(track(highrate) is None)
+                assert(track(highrate+'<ignorelastcollisionee>%f</ignorelastcollisionee>'%workspacetraj.GetDuration()) is not None)
+
     def test_movetohandpositiongrab(self):
         env=self.env
         self.LoadEnv('data/hanoi_complex2.env.xml')
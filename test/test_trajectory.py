@@ -297,6 +297,113 @@ class TestTrajectory(EnvironmentSetup):
                 data2 = traj2.Sample(t)
                 assert( transdist(data1,data2) <= g_epsilon)
 
+    def test_parallelshortcutting(self):
+        env = self.env
+        self.LoadEnv('data/katanatable.env.xml')
+        robot=env.GetRobots()[0]
+        with env:
+            robot.SetActiveDOFs(range(5))
+            origvalues = robot.GetActiveDOFValues()
+            traj = RaveCreateTrajectory(env,'')
+            traj.Init(robot.GetActiveConfigurationSpecification('linear'))
+            traj.Insert(0,origvalues)
+            traj.Insert(1,[ 1.2, -0.2, -0.7,  0.6,  1.1])
+            traj.Insert(2,[ 2.299995  , -0.43290472, -1.34459131,  1.18628988,  2.14568385])
+            parameters = Planner.PlannerParameters()
+            parameters.SetRobotActiveJoints(robot)
+            durations = []
+            for nworkers in [0,1,2,2]:
+                trajclone = RaveClone(traj,0)
+                ret=planningutils.SmoothActiveDOFTrajectory(trajclone,robot,maxvelmult=1,maxaccelmult=1,plannername='parabolicsmoother2',plannerparameters='<nshortcutworkers>%d</nshortcutworkers><nshortcutcandidates>4</nshortcutcandidates>'%nworkers)
+                assert(ret.statusCode==PlannerStatusCode.HasSolution)
+                durations.append(trajclone.GetDuration())
+                # the parallel shortcuts have to respect the limits and stay collision free like the sequential ones
+                planningutils.VerifyTrajectory(parameters,trajclone,samplingstep=0.002)
+                for t in arange(0,trajclone.GetDuration(),0.01):
+                    robot.SetActiveDOFValues(trajclone.Sample(t,robot.GetActiveConfigurationSpecification()))
+                    assert(not env.CheckCollision(robot) and not robot.CheckSelfCollision())
+                self.RunTrajectory(robot,trajclone)
+            robot.SetActiveDOFValues(origvalues)
+            # the sequential shortcutting samples one candidate per round, so it only has to reach a comparable duration
+            assert(durations[1] <= 1.2*durations[0])
+            # the chosen shortcuts do not depend on the number of workers, and a second plan reusing the workers gives the same result
+            assert(abs(durations[1]-durations[2]) <= g_epsilon)
+            assert(abs(durations[2]-durations[3]) <= g_epsilon)
+
+    def test_smoothingmemo(self):
+        env = self.env
+        self.LoadEnv('data/katanatable.env.xml')
+        robot=env.GetRobots()[0]
+        with env:
+            robot.SetActiveDOFs(range(5))
+            traj = RaveCreateTrajectory(env,'')
+            traj.Init(robot.GetActiveConfigurationSpecification('linear'))
+            traj.Insert(0,robot.GetActiveDOFValues())
+            traj.Insert(1,[ 2.299995  , -0.43290472, -1.34459131,  1.18628988,  2.14568385])
+            parameters = Planner.PlannerParameters()
+            parameters.SetRobotActiveJoints(robot)
+            planner = RaveCreatePlanner(env,'parabolicsmoother2')
+            assert(planner.InitPlan(robot,parameters))
+            def GetMemoStats():
+                return [int(s) for s in planner.SendCommand('GetFeasibilityMemoStats').split()]
+
+            trajclone = RaveClone(traj,0)
+            assert(planner.PlanPath(trajclone) == PlannerStatusCode.HasSolution)
+            hits1, misses1, entries1 = GetMemoStats()
+            assert(entries1 > 0)
+
+            # the second run starts by checking the same input segments, so it has to hit the memo
+            trajclone2 = RaveClone(traj,0)
+            assert(planner.PlanPath(trajclone2) == PlannerStatusCode.HasSolution)
+            hits2, misses2, entries2 = GetMemoStats()
+            assert(hits2 > hits1)
+            assert(misses2 >= misses1)
+            self.RunTrajectory(robot,trajclone2)
+
+            # moving an obstacle invalidates the memo, so the counts restart
+            table = [body for body in env.GetBodies() if body != robot][0]
+            T = table.GetTransform()
+            T[2,3] += 0.001
+            table.SetTransform(T)
+            assert(planner.PlanPath(RaveClone(traj,0)) == PlannerStatusCode.HasSolution)
+            hits3, misses3, entries3 = GetMemoStats()
+            assert(hits3+misses3 < hits2+misses2)
+            assert(misses3 > 0)
+
+            # so does changing the geometry of the planned robot
+            assert(planner.PlanPath(RaveClone(traj,0)) == PlannerStatusCode.HasSolution)
+            hits4, misses4, entries4 = GetMemoStats()
+            assert(hits4 > hits3)
+            geom = robot.GetLinks()[-1].GetGeometries()[0]
+            trimesh = geom.GetCollisionMesh()
+            trimesh.vertices *= 1.01
+            geom.SetCollisionMesh(trimesh)
+            assert(planner.PlanPath(RaveClone(traj,0)) == PlannerStatusCode.HasSolution)
+            hits5, misses5, entries5 = GetMemoStats()
+            assert(hits5+misses5 < hits4+misses4)
+            assert(misses5 > 0)
+
+    def test_bulkrampndevaluation(self):
+        env = self.env
+        planner = RaveCreatePlanner(env,'parabolicsmoother2')
+        ndof = 12
+        x0 = numpy.random.rand(ndof)-0.5
+        v0 = numpy.random.rand(ndof)-0.5
+        durations = 0.05+numpy.random.rand(6)
+        accelerations = 4*(numpy.random.rand(len(durations),ndof)-0.5)
+        switchtimes = numpy.cumsum(durations)
+        totalduration = switchtimes[-1]
+        # dense samples, the exact switch points, times outside of the path and an unsorted copy of all of them
+        times = numpy.r_[numpy.linspace(0,totalduration,2000), switchtimes, [-0.1, 0, totalduration, totalduration+0.1]]
+        times = numpy.r_[numpy.sort(times), numpy.random.permutation(times)]
+        cmd = '%d %s %s %d '%(ndof, ' '.join('%.16e'%x for x in x0), ' '.join('%.16e'%v for v in v0), len(durations))
+        cmd += ' '.join('%.16e %s'%(duration, ' '.join('%.16e'%a for a in accelerations[i])) for i, duration in enumerate(durations))
+        cmd += ' %d %s'%(len(times), ' '.join('%.16e'%t for t in times))
+        bulk = numpy.array([float(f) for f in planner.SendCommand('EvalParabolicPath bulk '+cmd).split()]).reshape(3,len(times),ndof)
+        single = numpy.array([float(f) for f in planner.SendCommand('EvalParabolicPath single '+cmd).split()]).reshape(3,len(times),ndof)
+        for i in range(3):
+            assert(numpy.max(numpy.abs(bulk[i]-single[i])) <= 1e-9)
+
     def test_multipleretiming(self):
         env=self.env
         env.Load('robots/barrettwam.robot.xml')
@@ -367,6 +474,51 @@ class TestTrajectory(EnvironmentSetup):
             ret=planningutils.RetimeActiveDOFTrajectory(traj,robot,False,maxvelmult=1,maxaccelmult=1,plannername='parabolictrajectoryretimer',plannerparameters='<multidofinterp>1</multidofinterp>')
             assert(ret.statusCode==PlannerStatusCode.HasSolution)
 
+    def test_batchretiming(self):
+        env=self.env
+        env.Load('robots/barrettwam.robot.xml')
+        with env:
+            robot=env.GetRobots()[0]
+            robot.SetActiveDOFs(range(7))
+            lower,upper = robot.GetActiveDOFLimits()
+            trajs = []
+            for i in range(7):
+                traj = RaveCreateTrajectory(env,'')
+                traj.Init(robot.GetActiveConfigurationSpecification('quadratic'))
+                traj.Insert(0,zeros(robot.GetActiveDOF()))
+                traj.Insert(1,numpy.minimum(0.1*(i+1),upper))
+                trajs.append(traj)
+            trajs.append(RaveClone(trajs[0],0))
+            trajs[-1].Remove(1,2) # single waypoint
+            expectedtrajs = [RaveClone(traj,0) for traj in trajs]
+            for traj in expectedtrajs:
+                ret=planningutils.RetimeTrajectory(traj,False,1,1)
+                assert(ret.statusCode==PlannerStatusCode.HasSolution)
+
+        batch = planningutils.TrajectoryRetimerBatch('','',3)
+        assert(batch.GetNumThreads()==3)
+        for itry in range(2): # second time reuses the cached retimers
+            testtrajs = [RaveClone(traj,0) for traj in trajs]
+            statuses = batch.PlanPaths(testtrajs,False,1,1)
+            assert(len(statuses)==len(trajs))
+            for status,testtraj,expectedtraj in zip(statuses,testtrajs,expectedtrajs):
+                assert(status.statusCode==PlannerStatusCode.HasSolution)
+                assert(testtraj.GetNumWaypoints()==expectedtraj.GetNumWaypoints())
+                assert(abs(testtraj.GetDuration()-expectedtraj.GetDuration()) <= g_epsilon)
+
+        testtrajs = [RaveClone(traj,0) for traj in trajs[:2]]
+        statuses = batch.PlanPaths(testtrajs,False,0.5,0.5)
+        assert(all([status.statusCode==PlannerStatusCode.HasSolution for status in statuses]))
+        assert(testtrajs[1].GetDuration() > expectedtrajs[1].GetDuration()+g_epsilon)
+
+        # changing the limits resynchronizes the worker environments without calling Reset
+        with env:
+            robot.SetDOFVelocityLimits(0.5*robot.GetDOFVelocityLimits())
+        testtrajs = [RaveClone(traj,0) for traj in trajs[:2]]
+        statuses = batch.PlanPaths(testtrajs,False,1,1)
+        assert(all([status.statusCode==PlannerStatusCode.HasSolution for status in statuses]))
+        assert(testtrajs[1].GetDuration() > expectedtrajs[1].GetDuration()+g_epsilon)
+
     def test_simpleretiming(self):
         env=self.env
         robot=self.LoadRobot('robots/pumaarm.zae')
@@ -397,7 +549,72 @@ class TestTrajectory(EnvironmentSetup):
         assert(ret == PlannerStatusCode.HasSolution)
         self.RunTrajectory(robot, traj)
         assert( abs(traj.GetDuration()-1.01688888888873) < g_epsilon)
-        
+
+        traj = RaveCreateTrajectory(robot.GetEnv(),'')
+        traj.Init(robot.GetActiveConfigurationSpecification())
+        traj.Insert(0,[-1.5707962927971486, -0.5115644004003523,  2.7255228159183407, 3.1415927831636017,  0.6431620887230958,  6.2831852909169683])
+        traj.Insert(1, [1.5707962849435657e+00,   2.9701411104634212e-01, 2.3875409344616441e+00,  -3.1415927489387800e+00, 1.1137587187130915e+00,   1.2949949709057725e-07])
+        activeretimer = planningutils.ActiveDOFTrajectoryRetimer(robot, plannername='TOPPRATrajectoryRetimer',plannerparameters='<gridstep>0.01</gridstep><usetorquelimits>0</usetorquelimits>')
+        ret=activeretimer.PlanPath(traj,False)
+        assert(ret == PlannerStatusCode.HasSolution)
+        assert(traj.GetDuration() > 0)
+        self.RunTrajectory(robot, traj)
+
+    def test_toppraretiming(self):
+        self.log.info('check the limits of the reachability analysis retimer and compare it with the parabolic retimer')
+        env=self.env
+        robot=self.LoadRobot('robots/pumaarm.zae')
+        with env:
+            robot.SetActiveDOFs(range(robot.GetDOF()))
+            spec = robot.GetActiveConfigurationSpecification()
+            velspec = spec.ConvertToVelocitySpecification()
+            maxvel = robot.GetActiveDOFMaxVel()
+            maxaccel = robot.GetActiveDOFMaxAccel()
+            q0 = zeros(robot.GetActiveDOF())
+            q1 = 0.5*ones(robot.GetActiveDOF())
+            q2 = array(q1)
+            q2[:3] = [1.0, 0.0, 1.0]
+
+            def retime(waypoints, plannername, plannerparameters=''):
+                traj = RaveCreateTrajectory(env,'')
+                traj.Init(spec)
+                traj.Insert(0, concatenate(waypoints))
+                ret = planningutils.RetimeActiveDOFTrajectory(traj,robot,False,1,1,plannername,plannerparameters)
+                assert(ret.statusCode==PlannerStatusCode.HasSolution)
+                return traj
+
+            def checklimits(traj):
+                # positions are quadratic between waypoints, so the accelerations are constant in every waypoint interval
+                prevvel = None
+                for iwaypoint in range(traj.GetNumWaypoints()):
+                    data = traj.GetWaypoint(iwaypoint)
+                    vel = velspec.ExtractJointValues(traj.GetWaypoint(iwaypoint,velspec),robot,robot.GetActiveDOFIndices(),0)
+                    assert(all(abs(vel) <= maxvel*(1+1e-6)+1e-7))
+                    deltatime = traj.GetConfigurationSpecification().ExtractDeltaTime(data)
+                    if prevvel is not None and deltatime > 0:
+                        assert(all(abs(vel-prevvel)/deltatime <= maxaccel*(1+1e-4)+1e-6))
+                    prevvel = vel
+
+            parameters = '<gridstep>0.005</gridstep><usetorquelimits>0</usetorquelimits>'
+            # on a straight path both retimers are time-optimal, toppra only loses time by the discretization
+            trajparabolic = retime([q0,q1], 'ParabolicTrajectoryRetimer')
+            trajtoppra = retime([q0,q1], 'TOPPRATrajectoryRetimer', parameters)
+            checklimits(trajtoppra)
+            assert(abs(trajtoppra.GetDuration()-trajparabolic.GetDuration()) <= 0.02*trajparabolic.GetDuration())
+
+            # both stop at the corner unless it is blended
+            trajparabolic = retime([q0,q1,q2], 'ParabolicTrajectoryRetimer')
+            trajtoppra = retime([q0,q1,q2], 'TOPPRATrajectoryRetimer', parameters)
+            checklimits(trajtoppra)
+            assert(trajtoppra.GetDuration() <= trajparabolic.GetDuration()*1.02)
+            trajblended = retime([q0,q1,q2], 'TOPPRATrajectoryRetimer', parameters+'<blendradius>0.1</blendradius>')
+            checklimits(trajblended)
+            assert(trajblended.GetDuration() < trajtoppra.GetDuration()-g_epsilon)
+            # the blend does not go through the corner, but is never further away from it than the blend radius
+            for iwaypoint in range(trajblended.GetNumWaypoints()):
+                q = spec.ExtractJointValues(trajblended.GetWaypoint(iwaypoint,spec),robot,robot.GetActiveDOFIndices(),0)
+                assert(min(linalg.norm(q-q1), linalg.norm(q-q0)+linalg.norm(q-q1)-linalg.norm(q1-q0), linalg.norm(q-q1)+linalg.norm(q-q2)-linalg.norm(q2-q1)) <= 0.1+1e-6)
+
     def test_ikparamretiming(self):
         self.log.info('retime workspace ikparam')
         env=self.env